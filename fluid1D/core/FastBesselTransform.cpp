@@ -0,0 +1,382 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of Fluid1D.
+
+Fluid1D is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fluid1D is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fluid1D.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/FastBesselTransform.h>
+#include <core/GridInfo.h>
+#include <core/BlasExtra.h>
+#include <core/Util.h>
+#include <gsl/gsl_sf.h>
+#include <cmath>
+
+const int FastBesselTransform::nSpread = 15;
+const int FastBesselTransform::minBlockRows = 16;
+
+FastBesselTransform::FastBesselTransform(const GridInfo& gInfo, double h) : gInfo(gInfo), h(h)
+{
+}
+
+FastBesselTransform::~FastBesselTransform()
+{	for(Block& b: blocks)
+		if(b.iFar < gInfo.S)
+		{	fftw_destroy_plan(b.planForward);
+			fftw_destroy_plan(b.planBackward);
+		}
+}
+
+void FastBesselTransform::setupBlocks(double xNear)
+{	const int S = gInfo.S;
+	//Divide rows into blocks:
+	std::vector<int> jBoundaries(1, 0);
+	for(int jStop=std::min(S,minBlockRows); ; jStop*=2)
+	{	jBoundaries.push_back(std::min(S, jStop));
+		if(jStop >= S) break;
+	}
+	blocks.resize(jBoundaries.size()-1);
+	for(unsigned iBlock=0; iBlock<blocks.size(); iBlock++)
+	{	Block& b = blocks[iBlock];
+		b.jStart = jBoundaries[iBlock];
+		b.jStop = jBoundaries[iBlock+1];
+		int W = b.jStop - b.jStart;
+		//Split columns into near and far:
+		b.iFar = S;
+		if(iBlock) //first block is always direct
+		{	double Gnear = xNear / gInfo.r[b.jStart];
+			b.iFar = 1;
+			while(b.iFar<S && gInfo.G[b.iFar]<Gnear) b.iFar++;
+		}
+		//Near-field matrices:
+		for(int k=0; k<nKernels; k++)
+		{	b.near[k].resize(W * b.iFar);
+			for(int j=b.jStart; j<b.jStop; j++)
+				for(int i=0; i<b.iFar; i++)
+					b.near[k][(j-b.jStart)*b.iFar + i] = kernel(Kernel(k), gInfo.G[i], gInfo.r[j]);
+		}
+		if(b.iFar == S) continue;
+		//NUFFT setup:
+		b.Mr = std::max(2*W, 4*nSpread);
+		while(b.Mr % 2 || !fftSuitable(b.Mr)) b.Mr++;
+		int M = b.Mr/2; //number of modes (oversampling ratio 2)
+		b.k0 = (b.jStart+1) + M/2;
+		b.tau = M_PI * nSpread / (M * M * 3.); //= (pi/M^2) nSpread / (R (R-0.5)) for R = 2
+		double hFine = 2*M_PI / b.Mr;
+		b.E3.resize(2*nSpread);
+		for(int l=1-nSpread; l<=nSpread; l++)
+			b.E3[l+nSpread-1] = exp(-pow(l*hFine,2)/(4*b.tau));
+		int nFar = S - b.iFar;
+		b.l0.resize(nFar); b.E1.resize(nFar); b.E2.resize(nFar); b.phase.resize(nFar);
+		for(int i=0; i<nFar; i++)
+		{	double theta = gInfo.G[b.iFar+i] * h;
+			b.l0[i] = int(floor(theta / hFine));
+			double d = theta - b.l0[i]*hFine;
+			b.E1[i] = exp(-d*d/(4*b.tau));
+			b.E2[i] = exp(hFine*d/(2*b.tau));
+			b.phase[i] = complex(cos(b.k0*theta), -sin(b.k0*theta));
+		}
+		b.deconv.resize(W);
+		for(int j=b.jStart; j<b.jStop; j++)
+		{	int m = (j+1) - b.k0;
+			b.deconv[j-b.jStart] = sqrt(M_PI/b.tau) * exp(m*m*b.tau) / b.Mr;
+		}
+		fftw_complex* buf = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*b.Mr);
+		b.planForward = fftw_plan_dft_1d(b.Mr, buf, buf, FFTW_FORWARD, FFTW_ESTIMATE);
+		b.planBackward = fftw_plan_dft_1d(b.Mr, buf, buf, FFTW_BACKWARD, FFTW_ESTIMATE);
+		fftw_free(buf);
+	}
+}
+
+void FastBesselTransform::sums(const Block& b, const complex* c, complex* F) const
+{	complex* fine = (complex*)fftw_malloc(sizeof(complex)*b.Mr);
+	for(int l=0; l<b.Mr; l++) fine[l] = 0.;
+	//Spread shifted coefficients onto fine grid with Gaussians:
+	int nFar = gInfo.S - b.iFar;
+	for(int i=0; i<nFar; i++)
+	{	complex ci = b.phase[i] * c[i];
+		double E2pow = pow(b.E2[i], 1-nSpread);
+		for(int l=1-nSpread; l<=nSpread; l++)
+		{	int lFine = b.l0[i] + l; if(lFine<0) lFine += b.Mr; if(lFine>=b.Mr) lFine -= b.Mr;
+			fine[lFine] += ci * (b.E1[i] * E2pow * b.E3[l+nSpread-1]);
+			E2pow *= b.E2[i];
+		}
+	}
+	fftw_execute_dft(b.planForward, (fftw_complex*)fine, (fftw_complex*)fine);
+	//Deconvolve and collect selected modes:
+	for(int j=b.jStart; j<b.jStop; j++)
+	{	int lFine = (j+1) - b.k0; if(lFine<0) lFine += b.Mr;
+		F[j-b.jStart] = fine[lFine] * b.deconv[j-b.jStart];
+	}
+	fftw_free(fine);
+}
+
+void FastBesselTransform::sumsT(const Block& b, const complex* f, complex* T) const
+{	complex* fine = (complex*)fftw_malloc(sizeof(complex)*b.Mr);
+	for(int l=0; l<b.Mr; l++) fine[l] = 0.;
+	//Set deconvolved modes:
+	for(int j=b.jStart; j<b.jStop; j++)
+	{	int lFine = (j+1) - b.k0; if(lFine<0) lFine += b.Mr;
+		fine[lFine] = f[j-b.jStart] * b.deconv[j-b.jStart];
+	}
+	fftw_execute_dft(b.planBackward, (fftw_complex*)fine, (fftw_complex*)fine);
+	//Interpolate with Gaussians to each node and unshift:
+	int nFar = gInfo.S - b.iFar;
+	for(int i=0; i<nFar; i++)
+	{	complex Ti = 0.;
+		double E2pow = pow(b.E2[i], 1-nSpread);
+		for(int l=1-nSpread; l<=nSpread; l++)
+		{	int lFine = b.l0[i] + l; if(lFine<0) lFine += b.Mr; if(lFine>=b.Mr) lFine -= b.Mr;
+			Ti += fine[lFine] * (b.E1[i] * E2pow * b.E3[l+nSpread-1]);
+			E2pow *= b.E2[i];
+		}
+		T[i] = Ti * b.phase[i].conj();
+	}
+	fftw_free(fine);
+}
+
+void FastBesselTransform::apply(Kernel kernel, bool transpose, const double* x, double* y) const
+{	static StopWatch watch("FastBesselTransform"); watch.start();
+	const int S = gInfo.S;
+	if(transpose) for(int i=0; i<S; i++) y[i] = 0.;
+	for(unsigned iBlock=0; iBlock<blocks.size(); iBlock++)
+	{	const Block& b = blocks[iBlock];
+		int W = b.jStop - b.jStart;
+		//Near field:
+		const std::vector<double>& near = b.near[kernel];
+		if(transpose)
+			cblas_dgemv(CblasRowMajor, CblasTrans, W, b.iFar, 1., near.data(), b.iFar, x+b.jStart,1, 1., y,1);
+		else
+			cblas_dgemv(CblasRowMajor, CblasNoTrans, W, b.iFar, 1., near.data(), b.iFar, x,1, 0., y+b.jStart,1);
+		//Far field:
+		if(b.iFar < S) applyFar(iBlock, kernel, transpose, x, y);
+	}
+	watch.stop();
+}
+
+//---------- Spherical ----------
+
+const double FastSphericalTransform::xNear = 2.;
+
+FastSphericalTransform::FastSphericalTransform(const GridInfo& gInfo) : FastBesselTransform(gInfo, gInfo.r[0])
+{	assert(gInfo.coord == GridInfo::Spherical);
+	for(int j=0; j<gInfo.S; j++)
+		assert(fabs(gInfo.r[j] - (j+1)*h) < 1e-12*gInfo.rMax); //uniform radial grid
+	setupBlocks(xNear);
+}
+
+double FastSphericalTransform::kernel(Kernel kernel, double G, double r) const
+{	switch(kernel)
+	{	case KernelI: return gsl_sf_bessel_j0(G*r);
+		case KernelID: return -G * gsl_sf_bessel_j1(G*r);
+		case KernelIDD: return G*G * gsl_sf_bessel_j2(G*r); // j0''-j0'/r
+		default: return 0.;
+	}
+}
+
+void FastSphericalTransform::applyFar(int iBlock, Kernel kernel, bool transpose, const double* x, double* y) const
+{	const Block& b = blocks[iBlock];
+	const int W = b.jStop - b.jStart;
+	const int nFar = gInfo.S - b.iFar;
+	const double* rB = gInfo.r.data() + b.jStart; //radii in block
+	const double* Gf = gInfo.G.data() + b.iFar; //far-field momenta
+	//Express j0, j1 and j2 in terms of trigonometric sums: Sn = Sum sin(G_i r), Cs = Sum cos(G_i r) etc.
+	if(!transpose)
+	{	const double* xf = x + b.iFar;
+		double* yB = y + b.jStart;
+		std::vector<complex> c(nFar), F(W);
+		std::vector<double> Sn(W), Cs(W);
+		for(int i=0; i<nFar; i++) c[i] = xf[i] / Gf[i];
+		sums(b, c.data(), F.data());
+		for(int j=0; j<W; j++) Sn[j] = -F[j].imag(); //Sn = Sum_i (x_i/G_i) sin(G_i r)
+		if(kernel != KernelI)
+		{	for(int i=0; i<nFar; i++) c[i] = xf[i];
+			sums(b, c.data(), F.data());
+			for(int j=0; j<W; j++) Cs[j] = F[j].real(); //Cs = Sum_i x_i cos(G_i r)
+		}
+		switch(kernel)
+		{	case KernelI:
+				for(int j=0; j<W; j++) yB[j] += Sn[j]/rB[j];
+				break;
+			case KernelID:
+				for(int j=0; j<W; j++) yB[j] += (Cs[j] - Sn[j]/rB[j])/rB[j];
+				break;
+			case KernelIDD:
+			{	for(int i=0; i<nFar; i++) c[i] = xf[i] * Gf[i];
+				sums(b, c.data(), F.data()); //-Im(F) = Sum_i x_i G_i sin(G_i r)
+				for(int j=0; j<W; j++) yB[j] += (3.*(Sn[j]/rB[j] - Cs[j])/rB[j] + F[j].imag())/rB[j];
+				break;
+			}
+			default: break;
+		}
+	}
+	else
+	{	const double* xB = x + b.jStart;
+		double* yf = y + b.iFar;
+		std::vector<complex> f(W), T(nFar);
+		for(int j=0; j<W; j++) f[j] = xB[j]/rB[j];
+		sumsT(b, f.data(), T.data()); //Sum_j (x_j/r_j) exp(i G r_j)
+		switch(kernel)
+		{	case KernelI:
+			{	for(int i=0; i<nFar; i++) yf[i] += T[i].imag()/Gf[i];
+				break;
+			}
+			case KernelID:
+			{	std::vector<double> Tc(nFar);
+				for(int i=0; i<nFar; i++) Tc[i] = T[i].real();
+				for(int j=0; j<W; j++) f[j] *= 1./rB[j];
+				sumsT(b, f.data(), T.data());
+				for(int i=0; i<nFar; i++) yf[i] += Tc[i] - T[i].imag()/Gf[i];
+				break;
+			}
+			case KernelIDD:
+			{	std::vector<double> Tn(nFar), Tc(nFar);
+				for(int i=0; i<nFar; i++) Tn[i] = T[i].imag();
+				for(int j=0; j<W; j++) f[j] *= 1./rB[j];
+				sumsT(b, f.data(), T.data());
+				for(int i=0; i<nFar; i++) Tc[i] = T[i].real();
+				for(int j=0; j<W; j++) f[j] *= 1./rB[j];
+				sumsT(b, f.data(), T.data());
+				for(int i=0; i<nFar; i++) yf[i] += 3.*(T[i].imag()/Gf[i] - Tc[i]) - Gf[i]*Tn[i];
+				break;
+			}
+			default: break;
+		}
+	}
+}
+
+//---------- Cylindrical ----------
+
+const double FastCylindricalTransform::xNear = 200.;
+
+FastCylindricalTransform::FastCylindricalTransform(const GridInfo& gInfo)
+: FastBesselTransform(gInfo, M_PI*gInfo.rMax/gsl_sf_bessel_zero_J1(gInfo.S))
+{	assert(gInfo.coord == GridInfo::Cylindrical);
+	const int S = gInfo.S;
+	const double tol = 1e-17; //truncation threshold for asymptotic and Taylor expansions
+	setupBlocks(xNear);
+	
+	//Asymptotic expansion coefficients of J_nu for nu = 0, 1, 2 (see class documentation):
+	const int nuMax = 2;
+	std::vector<double> a[nuMax+1];
+	for(int nu=0; nu<=nuMax; nu++) a[nu].assign(1, 1.);
+	for(nAsymp=1; ; nAsymp++)
+	{	int k = nAsymp;
+		double errMax = 0.;
+		for(int nu=0; nu<=nuMax; nu++)
+		{	a[nu].push_back(a[nu].back() * (4*nu*nu - (2*k-1)*(2*k-1)) / (8.*k)); //a_k(nu)
+			errMax = std::max(errMax, fabs(a[nu].back()) * pow(xNear,-k)); //magnitude of first omitted term
+		}
+		if(errMax < tol) break;
+	}
+	//--- combine into the kernels as G^a J_nu(x) = Re Sum_k alpha_k G^(a-k-1/2) r^(-k-1/2) exp(i G r):
+	std::vector<complex> alpha[nKernels];
+	for(int k=0; k<nAsymp; k++)
+	{	auto term = [&](int nu) { return sqrt(2./M_PI) * a[nu][k] * cis(0.5*M_PI*(k-nu) - 0.25*M_PI); }; //i^k a_k(nu) exp(-i(nu pi/2 + pi/4))
+		alpha[KernelI].push_back(term(0)); //J0
+		alpha[KernelID].push_back(-term(1)); //-G J1
+		alpha[KernelIDD].push_back(0.75*term(2) - 0.25*term(0)); //G^2 (3 J2 - J0)/4
+	}
+	
+	//Far-field expansion coefficients for each block:
+	farCoeff.resize(blocks.size());
+	const double Gmax = gInfo.G.back();
+	for(unsigned iBlock=0; iBlock<blocks.size(); iBlock++)
+	{	const Block& b = blocks[iBlock];
+		if(b.iFar == S) continue;
+		FarCoeff& fc = farCoeff[iBlock];
+		const int W = b.jStop - b.jStart;
+		//Deviations from uniform grid and Taylor expansion order:
+		std::vector<double> u(W);
+		double uMax = 0.;
+		for(int j=0; j<W; j++)
+		{	u[j] = gInfo.r[b.jStart+j] - (b.jStart+j+0.75)*h;
+			uMax = std::max(uMax, fabs(u[j]));
+		}
+		double term = 1.; fc.nTaylor = 1;
+		while((term *= Gmax*uMax/fc.nTaylor) >= tol) fc.nTaylor++;
+		//Row coefficients for each power p = n - k:
+		fc.pMin = 1 - nAsymp;
+		fc.nP = nAsymp + fc.nTaylor - 1;
+		for(int kernel=0; kernel<nKernels; kernel++)
+		{	std::vector<complex>& rowCoeff = fc.rowCoeff[kernel];
+			rowCoeff.assign(fc.nP * W, 0.);
+			for(int j=0; j<W; j++)
+			{	double r = gInfo.r[b.jStart+j];
+				double rPow = 1./sqrt(r); //r^(-k-1/2)
+				for(int k=0; k<nAsymp; k++)
+				{	complex uPow = 1.; //(i u)^n / n!
+					for(int n=0; n<fc.nTaylor; n++)
+					{	rowCoeff[(n-k-fc.pMin)*W + j] += alpha[kernel][k] * uPow * rPow;
+						uPow *= complex(0., u[j]/(n+1));
+					}
+					rPow /= r;
+				}
+			}
+		}
+	}
+}
+
+double FastCylindricalTransform::kernel(Kernel kernel, double G, double r) const
+{	switch(kernel)
+	{	case KernelI: return gsl_sf_bessel_J0(G*r);
+		case KernelID: return -G * gsl_sf_bessel_J1(G*r);
+		case KernelIDD: return G*G * (3*gsl_sf_bessel_Jn(2,G*r) - gsl_sf_bessel_J0(G*r))/4; //J0''-J0'/2r
+		default: return 0.;
+	}
+}
+
+void FastCylindricalTransform::applyFar(int iBlock, Kernel kernel, bool transpose, const double* x, double* y) const
+{	const Block& b = blocks[iBlock];
+	const FarCoeff& fc = farCoeff[iBlock];
+	const int W = b.jStop - b.jStart;
+	const int nFar = gInfo.S - b.iFar;
+	const double* Gf = gInfo.G.data() + b.iFar; //far-field momenta
+	//Column factors G_i^(a-1/2+p) exp(-i G_i h/4), starting at p = pMin (a = kernel derivative order):
+	std::vector<complex> colFactor(nFar);
+	for(int i=0; i<nFar; i++)
+		colFactor[i] = pow(Gf[i], int(kernel) - 0.5 + fc.pMin) * cis(-0.25*Gf[i]*h);
+	//Accumulate contributions of each power p of G:
+	const complex* rowCoeff = fc.rowCoeff[kernel].data();
+	if(!transpose)
+	{	const double* xf = x + b.iFar;
+		double* yB = y + b.jStart;
+		std::vector<complex> c(nFar), F(W);
+		for(int ip=0; ip<fc.nP; ip++)
+		{	for(int i=0; i<nFar; i++)
+			{	c[i] = xf[i] * colFactor[i].conj();
+				colFactor[i] *= Gf[i];
+			}
+			sums(b, c.data(), F.data()); //conj(F_j) = Sum_i x_i G_i^(a-1/2+p) exp(i G_i r_j - i G_i u_j)
+			for(int j=0; j<W; j++)
+				yB[j] += (rowCoeff[ip*W+j] * F[j].conj()).real();
+		}
+	}
+	else
+	{	const double* xB = x + b.jStart;
+		double* yf = y + b.iFar;
+		std::vector<complex> f(W), T(nFar);
+		for(int ip=0; ip<fc.nP; ip++)
+		{	for(int j=0; j<W; j++)
+				f[j] = rowCoeff[ip*W+j] * xB[j];
+			sumsT(b, f.data(), T.data()); //T_i = Sum_j f_j exp(i G_i r_j - i G_i u_j) exp(i G_i h/4)
+			for(int i=0; i<nFar; i++)
+			{	yf[i] += (colFactor[i] * T[i]).real();
+				colFactor[i] *= Gf[i];
+			}
+		}
+	}
+}
@@ -0,0 +1,148 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of Fluid1D.
+
+Fluid1D is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Fluid1D is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Fluid1D.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef FLUID1D_CORE1D_FASTBESSELTRANSFORM_H
+#define FLUID1D_CORE1D_FASTBESSELTRANSFORM_H
+
+/** @file FastBesselTransform.h
+@brief O(S log S) discrete spherical and cylindrical Bessel transforms
+*/
+
+#include <core/scalar.h>
+#include <fftw3.h>
+#include <vector>
+
+class GridInfo;
+
+/** @brief Fast replacement for the dense transform matrices GridInfo::matI, matID and matIDD
+//! @ingroup griddata
+
+The radial grids have r_j = (j+1) h - rShift + u_j, where u_j is zero for the spherical grid and small for
+the cylindrical grid, so that at large G_i r_j the Bessel kernels reduce to trigonometric sums with uniform
+integer frequencies j+1 and non-uniform nodes theta_i = G_i h in [0,pi). These are evaluated by Gaussian-gridding
+non-uniform FFTs (Greengard and Lee, SIAM Review 46, 443 (2004)). The expressions used for the far field lose
+precision (spherical) or are invalid (cylindrical) when G_i r_j is small, so the rows are split into dyadic blocks,
+and within each block the columns with G_i r_j < xNear (which include G=0) are applied directly as small dense matrices.
+Each block then costs O(S) for gridding and O(W log W) for the FFT (W = rows in block), giving O(S log S) overall
+in time and memory. Derived classes provide the kernels and the far-field expressions.
+*/
+class FastBesselTransform
+{
+public:
+	//! Matrices that can be applied (see GridInfo::matI, matID and matIDD)
+	enum Kernel
+	{	KernelI, //!< Bessel function of order 0 at G r
+		KernelID, //!< its derivative with respect to r
+		KernelIDD, //!< its second derivative with respect to r, minus first derivative / r
+		nKernels
+	};
+	
+	virtual ~FastBesselTransform();
+	
+	//! Compute y = A.x (or y = A^T.x if transpose=true), where A_ji is the kernel evaluated at G_i r_j
+	void apply(Kernel kernel, bool transpose, const double* x, double* y) const;
+	
+	static const int nSpread; //!< half-width (in fine-grid points) of Gaussian spreading (sets NUFFT accuracy)
+	static const int minBlockRows; //!< rows before the first NUFFT block (all applied directly)
+	
+protected:
+	const GridInfo& gInfo;
+	const double h; //!< grid spacing that sets the NUFFT nodes theta_i = G_i h
+	
+	//! Dyadic row block with a direct near-field part and an NUFFT far-field part
+	struct Block
+	{	int jStart, jStop; //!< row range
+		int iFar; //!< columns >= iFar are evaluated by NUFFT
+		std::vector<double> near[nKernels]; //!< (jStop-jStart) x iFar row-major near-field matrices
+		//NUFFT parameters (unused if iFar = S):
+		int Mr; //!< fine grid size (twice the number of modes)
+		int k0; //!< frequency k = j+1 corresponding to the central mode
+		double tau; //!< Gaussian width parameter
+		std::vector<double> E3; //!< Gaussian spreading factors that depend only on grid offset
+		std::vector<int> l0; //!< fine grid point just below each far node
+		std::vector<double> E1, E2; //!< Gaussian spreading factors for each far node
+		std::vector<complex> phase; //!< exp(-i k0 theta_i) for each far node
+		std::vector<double> deconv; //!< Gaussian deconvolution factors for each row
+		fftw_plan planForward, planBackward;
+	};
+	std::vector<Block> blocks;
+	
+	FastBesselTransform(const GridInfo& gInfo, double h);
+	
+	//! Set up blocks, with columns below G_i r_jStart = xNear in the near field (call from derived constructor)
+	void setupBlocks(double xNear);
+	
+	virtual double kernel(Kernel kernel, double G, double r) const=0; //!< kernel for the near-field matrices
+	
+	//! Add the far-field contribution of blocks[iBlock] to y (see apply)
+	virtual void applyFar(int iBlock, Kernel kernel, bool transpose, const double* x, double* y) const=0;
+	
+	//! Type-1 NUFFT: F_k = Sum_i c_i exp(-i k theta_i) over far nodes, for k = j+1 in the block's row range
+	void sums(const Block& b, const complex* c, complex* F) const;
+	
+	//! Type-2 NUFFT: T_i = Sum_k f_k exp(i k theta_i) for far nodes, with k = j+1 in the block's row range
+	void sumsT(const Block& b, const complex* f, complex* T) const;
+};
+
+
+//! @brief Fast spherical transforms with kernels j0(G r), -G j1(G r) and G^2 j2(G r)
+//! @ingroup griddata
+//! The spherical grid is uniform, r_j = (j+1) h, and j0, j1 and j2 are exactly expressible in terms of sin and cos.
+class FastSphericalTransform : public FastBesselTransform
+{
+public:
+	FastSphericalTransform(const GridInfo& gInfo);
+	static const double xNear; //!< pairs with G_i r_j below this are applied directly
+protected:
+	double kernel(Kernel kernel, double G, double r) const;
+	void applyFar(int iBlock, Kernel kernel, bool transpose, const double* x, double* y) const;
+};
+
+
+/** @brief Fast cylindrical transforms with kernels J0(G r), -G J1(G r) and G^2 (3 J2(G r) - J0(G r))/4
+//! @ingroup griddata
+
+The cylindrical grid has r_j = (j+3/4) h + u_j with u_j ~ h / (8 pi^2 j) (McMahon expansion of the zeros of J0).
+For G r >= xNear, the Bessel functions are evaluated using the Hankel asymptotic expansion
+J_nu(x) = sqrt(2/(pi x)) Re[exp(i(x - nu pi/2 - pi/4)) Sum_k i^k a_k(nu) / x^k], truncated at nAsymp terms,
+and exp(i G u_j) is Taylor expanded to nTaylor (chosen per block) terms. Each term then separates into a power of G
+times a power of r times exp(i theta_i (j+1)), so that each block requires nAsymp + nTaylor - 1 complex NUFFTs.
+*/
+class FastCylindricalTransform : public FastBesselTransform
+{
+public:
+	FastCylindricalTransform(const GridInfo& gInfo);
+	static const double xNear; //!< pairs with G_i r_j below this are applied directly
+protected:
+	double kernel(Kernel kernel, double G, double r) const;
+	void applyFar(int iBlock, Kernel kernel, bool transpose, const double* x, double* y) const;
+private:
+	int nAsymp; //!< number of terms in asymptotic expansion (sufficient for machine precision at xNear)
+	
+	//! Far-field expansion of each block in powers p = n - k of G, with n and k the Taylor and asymptotic term indices
+	struct FarCoeff
+	{	int nTaylor; //!< number of terms in Taylor expansion of exp(i G u_j)
+		int pMin, nP; //!< range of powers p
+		std::vector<complex> rowCoeff[nKernels]; //!< nP x (jStop-jStart) row-major: Sum_{n-k=p} alpha_k (i u_j)^n / n! r_j^(-k-1/2)
+	};
+	std::vector<FarCoeff> farCoeff; //!< for each block
+};
+
+#endif // FLUID1D_CORE1D_FASTBESSELTRANSFORM_H
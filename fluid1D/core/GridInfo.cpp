@@ -19,12 +19,23 @@ along with Fluid1D.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/GridInfo.h>
 #include <core/Data.h>
+#include <core/FastBesselTransform.h>
+#include <core/Util.h>
 #include <cmath>
 #include <gsl/gsl_sf.h>
 
-GridInfo::GridInfo(GridInfo::CoordinateSystem coord, int S, double hMean)
+const int GridInfo::fastSphericalMinS = 2048;
+const int GridInfo::fastCylindricalMinS = 8192; //far field needs ~10 NUFFTs per block (vs 1-3 for spherical)
+
+GridInfo::GridInfo(GridInfo::CoordinateSystem coord, int S, double hMean, TransformMethod transformMethod)
 : coord(coord), S(S), rMax(S*hMean), r(S), G(S), w(S), wTilde(S)
 {
+	if(transformMethod == TransformAuto)
+		transformMethod = ((coord==Spherical && S>=fastSphericalMinS) || (coord==Cylindrical && S>=fastCylindricalMinS))
+			? TransformFast : TransformDense;
+	if(transformMethod==TransformFast && coord==Planar)
+		die("Fast transforms are only available for spherical and cylindrical grids.\n");
+	
 	switch(coord)
 	{
 		case Spherical:
@@ -43,6 +54,10 @@ GridInfo::GridInfo(GridInfo::CoordinateSystem coord, int S, double hMean)
 				wTilde[i] = 1. / ((i ? 2 : 4.0/3) * M_PI * pow(rMax,3) * pow(gsl_sf_bessel_j0(y[i]),2));
 			}
 			//Setup transform matrices
+			if(transformMethod == TransformFast)
+			{	fastTransform = std::make_shared<FastSphericalTransform>(*this);
+				break;
+			}
 			matI.resize(S*S); auto elemI = matI.begin();
 			matID.resize(S*S); auto elemID = matID.begin();
 			matIDD.resize(S*S); auto elemIDD = matIDD.begin();
@@ -71,6 +86,10 @@ GridInfo::GridInfo(GridInfo::CoordinateSystem coord, int S, double hMean)
 				wTilde[i] = 1. / (M_PI * pow(rMax*gsl_sf_bessel_J0(Y[i]), 2));
 			}
 			//Setup transform matrices
+			if(transformMethod == TransformFast)
+			{	fastTransform = std::make_shared<FastCylindricalTransform>(*this);
+				break;
+			}
 			matI.resize(S*S); auto elemI = matI.begin();
 			matID.resize(S*S); auto elemID = matID.begin();
 			matIDD.resize(S*S); auto elemIDD = matIDD.begin();
@@ -26,6 +26,7 @@ along with Fluid1D.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fftw3.h>
 #include <vector>
+#include <memory>
 
 /** @brief Simulation grid descriptor
 //! @ingroup griddata
@@ -42,11 +43,21 @@ public:
 	const int S; //!< Sample count
 	const double rMax; //!< Length or maximum radius of simulation grid
 	
+	//! Algorithm for spherical/cylindrical transforms
+	enum TransformMethod
+	{	TransformAuto, //!< Fast for spherical grids with S >= fastSphericalMinS, cylindrical grids with S >= fastCylindricalMinS, dense otherwise
+		TransformDense, //!< Dense SxS matrices: O(S^2) time and memory
+		TransformFast //!< Non-uniform FFT based (see FastBesselTransform): O(S log S) time and memory
+	};
+	static const int fastSphericalMinS; //!< Smallest spherical grid for which TransformAuto selects TransformFast
+	static const int fastCylindricalMinS; //!< Smallest cylindrical grid for which TransformAuto selects TransformFast
+	
 	//! Setup simulation grid
 	//! @param coord Coordinate system
 	//! @param S Sample count (equal to basis function count for all implemented bases)
 	//! @param hMean Mean grid spacing, defined by rMax/S
-	GridInfo(CoordinateSystem coord, int S, double hMean);
+	//! @param transformMethod Algorithm for spherical/cylindrical transforms
+	GridInfo(CoordinateSystem coord, int S, double hMean, TransformMethod transformMethod=TransformAuto);
 	~GridInfo();
 	
 	std::vector<double> r; //!< Nodes of quadrature grid
@@ -57,7 +68,8 @@ public:
 	double Volume() const; //!< Simulation cell volume (per unit length for cylindrical, or unit area for planar)
 	
 	fftw_plan planPlanarI, planPlanarIdag, planPlanarID, planPlanarIDdag; //!< FFTW plans for planar transforms
-	std::vector<double> matI, matID, matIDD; //!< Dense SxS row-major matrices for spherical/cylindrical transforms
+	std::vector<double> matI, matID, matIDD; //!< Dense SxS row-major matrices for spherical/cylindrical transforms (empty if fastTransform is used)
+	std::shared_ptr<class FastBesselTransform> fastTransform; //!< Fast spherical/cylindrical transforms (if selected by transformMethod)
 };
 
 #endif // FLUID1D_CORE1D_DATA_H
@@ -20,6 +20,7 @@ along with Fluid1D.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Operators.h>
 #include <core/BlasExtra.h>
 #include <core/Random.h>
+#include <core/FastBesselTransform.h>
 
 //------------------------------ Linear Unary operators ------------------------------
 
@@ -48,6 +49,17 @@ inline void dgemv(bool transpose, const std::vector<double>& A, const ManagedMem
 		M, N, 1., A.data(), M,  X.data(),1, 0., Y.data(),1);
 }
 
+//Spherical/cylindrical transform (Y = A.X) using the dense matrix A or the equivalent fast transform (if available)
+inline void besselTransform(const GridInfo& gInfo, bool transpose, const std::vector<double>& A,
+	FastBesselTransform::Kernel kernel, const ManagedMemory& X, ManagedMemory& Y)
+{	if(gInfo.fastTransform)
+	{	assert(X.nData() == size_t(gInfo.S));
+		assert(Y.nData() == size_t(gInfo.S));
+		gInfo.fastTransform->apply(kernel, transpose, X.data(), Y.data());
+	}
+	else dgemv(transpose, A, X, Y);
+}
+
 ScalarFieldTilde O(const ScalarFieldTilde& Y)
 {	ScalarFieldTilde tmp(Y);
 	return O((ScalarFieldTilde&&)tmp);
@@ -75,7 +87,7 @@ ScalarField I(const ScalarFieldTilde& Xtilde)
 		case GridInfo::Cylindrical:
 		{	ScalarFieldTilde tmp(Xtilde);
 			dmul(gInfo.wTilde, tmp); //premultiply by basis weights
-			dgemv(false, gInfo.matI, tmp, X); //multiply by matI
+			besselTransform(gInfo, false, gInfo.matI, FastBesselTransform::KernelI, tmp, X); //multiply by matI
 			break;
 		}
 		case GridInfo::Planar:
@@ -97,7 +109,7 @@ ScalarField ID(const ScalarFieldTilde& Xtilde)
 		case GridInfo::Cylindrical:
 		{	ScalarFieldTilde tmp(Xtilde);
 			dmul(gInfo.wTilde, tmp); //premultiply by basis weights
-			dgemv(false, gInfo.matID, tmp, X); //multiply by matID
+			besselTransform(gInfo, false, gInfo.matID, FastBesselTransform::KernelID, tmp, X); //multiply by matID
 			break;
 		}
 		case GridInfo::Planar:
@@ -126,7 +138,7 @@ ScalarField IDD(const ScalarFieldTilde& Xtilde)
 		case GridInfo::Cylindrical:
 		{	ScalarFieldTilde tmp(Xtilde);
 			dmul(gInfo.wTilde, tmp); //premultiply by basis weights
-			dgemv(false, gInfo.matIDD, tmp, X); //multiply by matIDD
+			besselTransform(gInfo, false, gInfo.matIDD, FastBesselTransform::KernelIDD, tmp, X); //multiply by matIDD
 			break;
 		}
 		case GridInfo::Planar:
@@ -149,7 +161,7 @@ ScalarField Jdag(const ScalarFieldTilde& Xtilde)
 	{
 		case GridInfo::Spherical:
 		case GridInfo::Cylindrical:
-		{	dgemv(false, gInfo.matI, Xtilde, X); //multiply by matI
+		{	besselTransform(gInfo, false, gInfo.matI, FastBesselTransform::KernelI, Xtilde, X); //multiply by matI
 			dmul(gInfo.w, X); //postmultiply by quadrature weights
 			break;
 		}
@@ -176,7 +188,7 @@ ScalarFieldTilde J(const ScalarField& X)
 		case GridInfo::Cylindrical:
 		{	ScalarField tmp(X);
 			dmul(gInfo.w, tmp); //premultiply by quadrature weights
-			dgemv(true, gInfo.matI, tmp, Xtilde); //multiply by transpose(matI)
+			besselTransform(gInfo, true, gInfo.matI, FastBesselTransform::KernelI, tmp, Xtilde); //multiply by transpose(matI)
 			break;
 		}
 		case GridInfo::Planar:
@@ -196,7 +208,7 @@ ScalarFieldTilde Idag(const ScalarField& X)
 	{
 		case GridInfo::Spherical:
 		case GridInfo::Cylindrical:
-		{	dgemv(true, gInfo.matI, X, Xtilde); //multiply by transpose(matI)
+		{	besselTransform(gInfo, true, gInfo.matI, FastBesselTransform::KernelI, X, Xtilde); //multiply by transpose(matI)
 			dmul(gInfo.wTilde, Xtilde); //postmultiply by basis weights
 			break;
 		}
@@ -218,7 +230,7 @@ ScalarFieldTilde IDdag(const ScalarField& X)
 	{
 		case GridInfo::Spherical:
 		case GridInfo::Cylindrical:
-		{	dgemv(true, gInfo.matID, X, Xtilde); //multiply by transpose(matID)
+		{	besselTransform(gInfo, true, gInfo.matID, FastBesselTransform::KernelID, X, Xtilde); //multiply by transpose(matID)
 			dmul(gInfo.wTilde, Xtilde); //postmultiply by basis weights
 			break;
 		}
@@ -245,7 +257,7 @@ ScalarFieldTilde IDDdag(const ScalarField& X)
 	{
 		case GridInfo::Spherical:
 		case GridInfo::Cylindrical:
-		{	dgemv(true, gInfo.matIDD, X, Xtilde); //multiply by transpose(matIDD)
+		{	besselTransform(gInfo, true, gInfo.matIDD, FastBesselTransform::KernelIDD, X, Xtilde); //multiply by transpose(matIDD)
 			dmul(gInfo.wTilde, Xtilde); //postmultiply by basis weights
 			break;
 		}
@@ -20,6 +20,20 @@ along with Fluid1D.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Operators.h>
 #include <core/Util.h>
 #include <cmath>
+#include <algorithm>
+
+//Copy data between fields on grids of identical size (but different transform methods)
+template<typename T> T copyToGrid(const T& X, const GridInfo& gInfo)
+{	T Y(&gInfo);
+	assert(Y.nData() == X.nData());
+	std::copy(X.data(), X.data()+X.nData(), Y.data());
+	return Y;
+}
+
+//Relative error of a fast-transform result with respect to the dense-transform result
+template<typename T> double relErr(const T& Xfast, const T& Xdense)
+{	return nrm2(copyToGrid(Xfast, *Xdense.gInfo) - Xdense) / nrm2(Xdense);
+}
 
 int main(int argc, char** argv)
 {	initSystem(argc, argv);
@@ -75,4 +89,35 @@ int main(int argc, char** argv)
 			fprintf(fp, "%lf\t%le\t%le\t%le\t%le\t%le\n", gInfo.r[i], xData[i], DxData[i], numDxData[i], DDxData[i], numDDxData[i]);
 		fclose(fp);
 	}
+
+	puts("\nTest 5: Fast spherical and cylindrical transforms against dense matrices:");
+	for(GridInfo::CoordinateSystem coord: {GridInfo::Spherical, GridInfo::Cylindrical})
+	{	printf("   %s:\n", coord==GridInfo::Spherical ? "Spherical" : "Cylindrical");
+		const int S = 1024; const double hMean = 0.05;
+		GridInfo gInfoDense(coord, S, hMean, GridInfo::TransformDense);
+		GridInfo gInfoFast(coord, S, hMean, GridInfo::TransformFast);
+		ScalarField x(&gInfoDense); initRandom(x);
+		ScalarFieldTilde xTilde = J(x);
+		ScalarField xFast = copyToGrid(x, gInfoFast);
+		ScalarFieldTilde xTildeFast = copyToGrid(xTilde, gInfoFast);
+		printf("\tRelative error in I:      %le\n", relErr(I(xTildeFast), I(xTilde)));
+		printf("\tRelative error in ID:     %le\n", relErr(ID(xTildeFast), ID(xTilde)));
+		printf("\tRelative error in IDD:    %le\n", relErr(IDD(xTildeFast), IDD(xTilde)));
+		printf("\tRelative error in Jdag:   %le\n", relErr(Jdag(xTildeFast), Jdag(xTilde)));
+		printf("\tRelative error in J:      %le\n", relErr(J(xFast), J(x)));
+		printf("\tRelative error in Idag:   %le\n", relErr(Idag(xFast), Idag(x)));
+		printf("\tRelative error in IDdag:  %le\n", relErr(IDdag(xFast), IDdag(x)));
+		printf("\tRelative error in IDDdag: %le\n", relErr(IDDdag(xFast), IDDdag(x)));
+		printf("\tRelative error between A.IDDdag(B) and IDD(A).B (fast): %le\n",
+			dot(xTildeFast,IDDdag(xFast))/dot(xFast,IDD(xTildeFast))-1.);
+		//Timing:
+		const int nRepeat = 20;
+		double tDense = clock_us();
+		for(int iRepeat=0; iRepeat<nRepeat; iRepeat++) { xTilde = J(I(xTilde)); }
+		tDense = (clock_us() - tDense) / nRepeat;
+		double tFast = clock_us();
+		for(int iRepeat=0; iRepeat<nRepeat; iRepeat++) { xTildeFast = J(I(xTildeFast)); }
+		tFast = (clock_us() - tFast) / nRepeat;
+		printf("\tTime for J(I()) at S=%d: dense %.1lf us, fast %.1lf us\n", S, tDense, tFast);
+	}
 }
@@ -0,0 +1,75 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Util.h>
+#include <core/matrix.h>
+
+//Compare replicated LAPACK and distributed (ScaLAPACK) diagonalization of subspace-sized hermitian matrices,
+//for the standard (Hsub) and generalized (Davidson expanded subspace) eigenproblems.
+//Run with several MPI processes; dimensions below the automatic threshold fall back to LAPACK in both columns.
+
+//Random hermitian matrix, identical on all processes
+matrix randomHermitian(int N)
+{	matrix A(N, N);
+	if(mpiWorld->isHead()) randomize(A);
+	mpiWorld->bcastData(A);
+	return dagger_symmetrize(A);
+}
+
+//Return time per call in seconds (slowest process), along with the eigenvalues
+double timeDiag(const matrix& H, const matrix* O, const MPIUtil* mpiUtil, diagMatrix& eigs, int nRepeat)
+{	matrix evecs;
+	double t0 = clock_sec();
+	for(int iRepeat=0; iRepeat<nRepeat; iRepeat++)
+	{	if(O) H.diagonalize(*O, evecs, eigs, mpiUtil);
+		else H.diagonalize(evecs, eigs, mpiUtil);
+	}
+	double t = (clock_sec()-t0)/nRepeat;
+	mpiWorld->allReduce(t, MPIUtil::ReduceMax);
+	return t;
+}
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	logPrintf("\nComparing replicated and distributed subspace diagonalization over %d processes:\n", mpiWorld->nProcesses());
+	logPrintf("%6s  %10s %10s %8s  %10s %10s %8s  %9s\n", "N",
+		"std:serial", "std:dist", "speedup", "gen:serial", "gen:dist", "speedup", "maxErr");
+	const int Nlist[] = { 128, 256, 512, 1024, 2048, 4096 };
+	for(int N: Nlist)
+	{	matrix H = randomHermitian(N);
+		matrix A = randomHermitian(N);
+		matrix O = eye(N) + (0.1/N) * dagger_symmetrize(A * A); //positive-definite overlap
+		int nRepeat = std::max(1, int(1e9 / (double(N)*N*N))); //keep total work roughly constant
+
+		diagMatrix eigsSerial, eigsDist, eigsGenSerial, eigsGenDist;
+		double tSerial = timeDiag(H, 0, 0, eigsSerial, nRepeat);
+		double tDist = timeDiag(H, 0, mpiWorld, eigsDist, nRepeat);
+		double tGenSerial = timeDiag(H, &O, 0, eigsGenSerial, nRepeat);
+		double tGenDist = timeDiag(H, &O, mpiWorld, eigsGenDist, nRepeat);
+		double maxErr = 0.;
+		for(int i=0; i<N; i++)
+		{	maxErr = std::max(maxErr, fabs(eigsDist[i] - eigsSerial[i]));
+			maxErr = std::max(maxErr, fabs(eigsGenDist[i] - eigsGenSerial[i]));
+		}
+		logPrintf("%6d  %9.4lfs %9.4lfs %7.2lfx  %9.4lfs %9.4lfs %7.2lfx  %9.2le\n", N,
+			tSerial, tDist, tSerial/tDist, tGenSerial, tGenDist, tGenSerial/tGenDist, maxErr);
+	}
+	finalizeSystem();
+	return 0;
+}
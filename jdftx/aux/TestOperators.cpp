@@ -28,6 +28,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Random.h>
 #include <core/SphericalHarmonics.h>
 #include <core/Blip.h>
+#include <core/DistributedFFT.h>
 #include <fluid/SO3quad.h>
 #include <gsl/gsl_sf.h>
 #include <stdlib.h>
@@ -101,6 +102,35 @@ public:
 			ScalarField r2(ScalarFieldData::alloc(gInfo)); initRandom(r2);
 			logPrintf("\tAnti-hermiticity of D: %le\n", fabs(dot(r1,gradient(r2)[0])/dot(r2,gradient(r1)[0]) + 1.));
 		}
+
+		{	logPrintf("\nTest 6: Fused elementwise expressions\n");
+			ScalarField a(ScalarFieldData::alloc(gInfo)); initRandomFlat(a);
+			ScalarField b(ScalarFieldData::alloc(gInfo)); initRandomFlat(b);
+			ScalarField fused = a*exp(-b) + 0.5*sqrt(a)*b;
+			//Same evaluated eagerly using the destructible-input operators:
+			ScalarField eager = clone(a); eager *= exp(clone(b) * (-1.));
+			ScalarField term2 = sqrt(clone(a)); term2 *= b; axpy(0.5, term2, eager);
+			logPrintf("\tRelative error of fused evaluation: %le (should be 0 within roundoff)\n", nrm2(fused - eager)/nrm2(eager));
+			logPrintf("\tRelative error of fused integral: %le (should be 0 within roundoff)\n", integral(a*b)/(gInfo.dV*dot(a,b)) - 1.);
+		}
+
+		{	logPrintf("\nTest 7: Distributed Fourier transforms over %d processes\n", mpiWorld->nProcesses());
+			DistributedFFT fftDist(gInfo, mpiWorld);
+			ScalarField r1(ScalarFieldData::alloc(gInfo)); initRandom(r1);
+			r1->bcastData(mpiWorld); //comparisons below expect replicated inputs
+			ScalarFieldTilde g1 = Idag(r1);
+			ManagedArray<double> rLocal; rLocal.init(std::max(fftDist.nrMine(), size_t(1)));
+			ManagedArray<complex> gLocal; gLocal.init(std::max(fftDist.nGmine(), size_t(1)));
+			fftDist.scatter(r1, rLocal.data());
+			fftDist.forward(rLocal.data(), gLocal.data());
+			logPrintf("\tRelative error in forward: %le (should be 0 within roundoff)\n", nrm2(fftDist.gather(gLocal.data()) - g1)/nrm2(g1));
+			fftDist.inverse(gLocal.data(), rLocal.data());
+			logPrintf("\tRelative error in inverse: %le (should be 0 within roundoff)\n", nrm2(fftDist.gather(rLocal.data()) - I(g1))/nrm2(I(g1)));
+			RadialFunctionG w; w.init(0, 0.02, gInfo.GmaxGrid, RadialFunctionG::gaussTilde, 1., 1.);
+			ScalarField wr1 = I(w*J(r1));
+			logPrintf("\tRelative error in convolve: %le (should be 0 within roundoff)\n", nrm2(fftDist.convolve(r1, w) - wr1)/nrm2(wr1));
+			w.free();
+		}
 	}
 
 	void timeParallel()
@@ -106,6 +106,21 @@ void testTranslationOperators(const ScalarFieldArray& N)
 	checkSymmetry(test0, test1, opF, offset);
 	checkSymmetry(test0, test1, opC, offset);
 	checkSymmetry(test0, test1, opL, offset);
+	
+	//Check fused multi-translations (with and without kernel caching) against individual translations:
+	TranslationOperatorFourier opFcached(gInfo, true);
+	std::vector<std::vector<vector3<>>> tArr(2);
+	tArr[0].push_back(offset); tArr[0].push_back(-2.*offset);
+	tArr[1].push_back(0.5*offset);
+	ScalarField ySeparate; opF.taxpy(offset, 1.0, test0, ySeparate); opF.taxpy(-2.*offset, 1.0, test0, ySeparate); opF.taxpy(0.5*offset, 1.0, test1, ySeparate);
+	ScalarFieldArray sources(2); sources[0] = test0; sources[1] = test1;
+	for(int iRepeat=0; iRepeat<2; iRepeat++) //second pass uses cached kernels
+	{	ScalarField yGather; opFcached.taxpyGather(tArr, 1.0, opFcached.prepareSources(sources.data(), 2), yGather);
+		ScalarFieldArray yScatter(2); opFcached.taxpyScatter(tArr, 1.0, test0, yScatter.data());
+		ScalarField yScatterSeparate; opF.taxpy(0.5*offset, 1.0, test0, yScatterSeparate);
+		logPrintf("Fused translation relative errors (pass %d): gather = %le, scatter = %le\n", iRepeat+1,
+			nrm2(yGather-ySeparate)/nrm2(ySeparate), nrm2(yScatter[1]-yScatterSeparate)/nrm2(yScatterSeparate));
+	}
 
 	printStats(N[0], "N0");
 	printStats(N[1], "N1");
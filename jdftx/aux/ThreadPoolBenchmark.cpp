@@ -0,0 +1,112 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/GridInfo.h>
+#include <core/Operators.h>
+#include <core/Thread.h>
+
+//Compare launch overhead of the persistent thread pool against spawning threads per launch,
+//using pointwise grid kernels representative of eblas / operator loops at various grid sizes
+
+void scaleAdd_sub(size_t iStart, size_t iStop, double alpha, const double* x, double* y)
+{	for(size_t i=iStart; i<iStop; i++) y[i] += alpha * x[i];
+}
+
+double dot_sub(size_t i, const double* x, const double* y)
+{	return x[i] * y[i];
+}
+
+//Work proportional to index, so that contiguous equal-length blocks are unbalanced across threads:
+void triangular_sub(size_t iStart, size_t iStop, size_t N, const double* x, double* y)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	double sum = 0.;
+		for(size_t j=0; j<i; j+=N/1024+1) sum += x[j];
+		y[i] = sum;
+	}
+}
+
+//Return time per launch in microseconds for nLaunches of each kernel
+void timeLaunches(const ScalarField& x, ScalarField& y, int nLaunches, double& tLaunch, double& tAccum)
+{	size_t N = x->nElem;
+	double t0 = clock_us();
+	for(int iLaunch=0; iLaunch<nLaunches; iLaunch++)
+		threadLaunch(scaleAdd_sub, N, 1e-3, x->data(), y->data());
+	double t1 = clock_us();
+	double result = 0.;
+	for(int iLaunch=0; iLaunch<nLaunches; iLaunch++)
+		result += threadedAccumulate(dot_sub, N, (const double*)x->data(), (const double*)y->data());
+	double t2 = clock_us();
+	if(std::isnan(result)) logPrintf("Unexpected NaN in accumulation.\n"); //prevent optimizing away the loop
+	tLaunch = (t1-t0)/nLaunches;
+	tAccum = (t2-t1)/nLaunches;
+}
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	logPrintf("\nComparing pooled and spawned thread launches with %d threads:\n", nProcsAvailable);
+	logPrintf("%6s %10s  %12s %12s %8s  %12s %12s %8s\n", "S", "nr",
+		"axpy:pool", "axpy:spawn", "speedup", "dot:pool", "dot:spawn", "speedup");
+	const int Slist[] = { 8, 16, 24, 32, 48, 64, 96, 128 };
+	for(int S: Slist)
+	{	GridInfo gInfo;
+		gInfo.S = vector3<int>(S, S, S);
+		gInfo.R = matrix3<>(1,1,1) * (0.2*S);
+		logSuspend(); gInfo.initialize(); logResume();
+		ScalarField x(ScalarFieldData::alloc(gInfo)), y(ScalarFieldData::alloc(gInfo));
+		initRandomFlat(x); initRandomFlat(y);
+		int nLaunches = std::max(10, int(2e8 / gInfo.nr)); //keep total work roughly constant
+		
+		double tLaunchPool, tAccumPool, tLaunchSpawn, tAccumSpawn;
+		threadPoolEnabled = true;
+		timeLaunches(x, y, 1, tLaunchPool, tAccumPool); //warm up pool
+		timeLaunches(x, y, nLaunches, tLaunchPool, tAccumPool);
+		threadPoolEnabled = false;
+		timeLaunches(x, y, nLaunches, tLaunchSpawn, tAccumSpawn);
+		threadPoolEnabled = true;
+		
+		logPrintf("%6d %10d  %10.2lfus %10.2lfus %7.2lfx  %10.2lfus %10.2lfus %7.2lfx\n", S, gInfo.nr,
+			tLaunchPool, tLaunchSpawn, tLaunchSpawn/tLaunchPool,
+			tAccumPool, tAccumSpawn, tAccumSpawn/tAccumPool);
+	}
+	
+	//Effect of work-stealing granularity on an unbalanced loop:
+	logPrintf("\nUnbalanced (triangular) loop with %d threads versus chunks per thread:\n", nProcsAvailable);
+	logPrintf("%8s %12s %8s\n", "chunks", "time", "speedup");
+	{	const size_t N = 1<<18;
+		ManagedArray<double> x, y; x.init(N); y.init(N);
+		for(size_t i=0; i<N; i++) x.data()[i] = 1./(1+i);
+		const int nLaunches = 10;
+		int chunksPerThreadDefault = threadPoolChunksPerThread;
+		double tBase = 0.;
+		const int chunksList[] = { 1, 2, 4, 8, 16 };
+		for(int chunksPerThread: chunksList)
+		{	threadPoolChunksPerThread = chunksPerThread;
+			threadLaunch(triangular_sub, N, N, x.data(), y.data()); //warm up
+			double t0 = clock_us();
+			for(int iLaunch=0; iLaunch<nLaunches; iLaunch++)
+				threadLaunch(triangular_sub, N, N, x.data(), y.data());
+			double t = (clock_us()-t0)/nLaunches;
+			if(chunksPerThread==1) tBase = t;
+			logPrintf("%8d %10.2lfus %7.2lfx\n", chunksPerThread, t, tBase/t);
+		}
+		threadPoolChunksPerThread = chunksPerThreadDefault;
+	}
+	finalizeSystem();
+	return 0;
+}
@@ -0,0 +1,92 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/GridInfo.h>
+#include <core/Operators.h>
+#include <core/Thread.h>
+#include <atomic>
+
+//Compare running many small independent tasks one at a time (each threaded over all processors)
+//against running them concurrently in thread teams (see threadTeamLaunch), as done for quantum numbers
+//in band minimization with elec-eigen-teams. Each task is a sequence of small FFTs and pointwise operations.
+
+//Representative small task: repeated transforms of a field
+double runTask(const ScalarField& x, int nRepeat)
+{	ScalarField y = clone(x);
+	for(int iRepeat=0; iRepeat<nRepeat; iRepeat++)
+	{	ScalarFieldTilde yTilde = J(y);
+		y = I(yTilde * 0.5) + 0.5*x;
+	}
+	return dot(y, y);
+}
+
+//Run tasks taken one at a time from iNext within a team
+void runTeam(int iTeam, int nTeams, const std::vector<ScalarField>* x, int nRepeat,
+	std::vector<double>* results, std::atomic<int>* iNext, std::vector<int>* teamThreads)
+{	(*teamThreads)[iTeam] = nOperatorThreads();
+	for(int iTask=(*iNext)++; iTask<int(x->size()); iTask=(*iNext)++)
+		(*results)[iTask] = runTask((*x)[iTask], nRepeat);
+}
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	const int nTasks = 32;
+	logPrintf("\nRunning %d small tasks with %d threads, one at a time vs. in thread teams:\n", nTasks, nProcsAvailable);
+	logPrintf("%4s %8s %12s %12s %8s %10s  %s\n", "S", "nTeams", "t:serial", "t:teams", "speedup", "maxErr", "threads/team");
+	const int Slist[] = { 12, 16, 24, 32, 48 };
+	for(int S: Slist)
+	{	GridInfo gInfo;
+		gInfo.S = vector3<int>(S, S, S);
+		gInfo.R = matrix3<>(1,1,1) * (0.2*S);
+		logSuspend(); gInfo.initialize(); logResume();
+		std::vector<ScalarField> x(nTasks);
+		for(ScalarField& xi: x)
+		{	xi = ScalarFieldData::alloc(gInfo);
+			initRandom(xi);
+		}
+		int nRepeat = std::max(1, int(2e6 / gInfo.nr));
+		
+		//Serial over tasks, threaded operators:
+		std::vector<double> resultsSerial(nTasks);
+		runTask(x[0], 1); //warm up (FFT plans, thread pool)
+		double t0 = clock_sec();
+		for(int iTask=0; iTask<nTasks; iTask++)
+			resultsSerial[iTask] = runTask(x[iTask], nRepeat);
+		double tSerial = clock_sec() - t0;
+		
+		for(int nTeams=2; nTeams<=nProcsAvailable; nTeams*=2)
+		{	std::vector<double> results(nTasks);
+			std::vector<int> teamThreads(nTeams);
+			std::atomic<int> iNext(0);
+			double t0 = clock_sec();
+			threadTeamLaunch(nTeams, runTeam, (const std::vector<ScalarField>*)&x, nRepeat, &results, &iNext, &teamThreads);
+			double tTeams = clock_sec() - t0;
+			double maxErr = 0.;
+			for(int iTask=0; iTask<nTasks; iTask++)
+				maxErr = std::max(maxErr, fabs(results[iTask]/resultsSerial[iTask] - 1.));
+			string threadsString;
+			for(int n: teamThreads) { char buf[16]; sprintf(buf, " %d", n); threadsString += buf; }
+			logPrintf("%4d %8d %10.3lfs %10.3lfs %7.2lfx %10.2le  %s\n", S, nTeams,
+				tSerial, tTeams, tSerial/tTeams, maxErr, threadsString.c_str());
+		}
+	}
+	finalizeSystem();
+	return 0;
+}
@@ -136,3 +136,54 @@ struct CommandForcesOutputCoords : public Command
 	}
 }
 commandForcesOutputCoords;
+
+
+EnumStringMap<Profiler::Mode> profileModeMap
+(	Profiler::ModeOff, "Off",
+	Profiler::ModeSummary, "Summary",
+	Profiler::ModeTrace, "Trace"
+);
+
+EnumStringMap<Profiler::Mode> profileModeDescMap
+(	Profiler::ModeOff, "No runtime profiling (default)",
+	Profiler::ModeSummary, "Print a tree of timed scopes after each electronic / SCF iteration",
+	Profiler::ModeTrace, "Summary, and additionally write a timeline of every scope to <traceFile> at the end"
+);
+
+struct CommandProfile : public Command
+{
+	CommandProfile() : Command("profile", "jdftx/Output")
+	{
+		format = "<mode>=" + profileModeMap.optionList() + " [<traceFile>=jdftx.trace.json]";
+		comments =
+			"Record the sections of code timed by StopWatch at run time (without requiring\n"
+			"a build with EnableProfiling), where <mode> is one of:"
+			+ addDescriptions(profileModeMap.optionList(), linkDescription(profileModeMap, profileModeDescMap)) +
+			"\n\n"
+			"Sections started within other sections are reported as nested scopes\n"
+			"(eg. SCF cycle > bandMinimize > Idag_DiagV_I > FFT), along with the memory\n"
+			"allocated and the time spent in blocking MPI calls and waits within each.\n"
+			"Times of scopes run by worker threads are summed over threads, and nested\n"
+			"under the scope that launched them. Each iteration's table also lists the\n"
+			"spread of iteration and MPI times over processes.\n"
+			"\n"
+			"The trace file is in the Chrome trace-event JSON format (viewable in\n"
+			"ui.perfetto.dev or chrome://tracing), with one track per process and thread.\n"
+			"Trace mode keeps every scope instance in memory (upto 2^20 per thread),\n"
+			"so it is best used on short runs.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	Profiler::Mode mode; string traceFilename;
+		pl.get(mode, Profiler::ModeOff, profileModeMap, "mode");
+		pl.get(traceFilename, string("jdftx.trace.json"), "traceFile");
+		Profiler::setMode(mode, traceFilename);
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", profileModeMap.getString(Profiler::mode));
+		if(Profiler::mode == Profiler::ModeTrace) logPrintf(" %s", Profiler::traceFilename.c_str());
+	}
+}
+commandProfile;
@@ -26,6 +26,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Dump_internal.h>
 #include <electronic/DumpBGW_internal.h>
 #include <core/Units.h>
+#include <core/AsyncWrite.h>
 
 struct CommandDumpOnly : public Command
 {
@@ -191,6 +192,17 @@ EnumStringMap<DumpVariable> varDescMap
 	DumpFermiDensity,	"Electron density from fermi-derivative at specified energy" 
 );
 
+//Reject dump outputs that do not yet support band-parallel process groups (more than one process per group with -G)
+void checkBandParallel(DumpVariable var)
+{	if(mpiGroup->nProcesses() == 1) return;
+	switch(var)
+	{	case DumpQMC: case DumpOcean: case DumpBGW: case DumpPolarizability: case DumpElectronScattering:
+		case DumpSIC: case DumpExcitations: case DumpFCI:
+			throw string(varMap.getString(var)) + " output does not support band-parallel process groups: use one process per group (-G)";
+		default:;
+	}
+}
+
 struct CommandDump : public Command
 {
 	CommandDump() : Command("dump", "jdftx/Output")
@@ -222,6 +234,7 @@ struct CommandDump : public Command
 			if(var==DumpDelim) break; //will happen at end of command line
 			e.dump.insert(std::make_pair(freq,var));
 			//Check for unsupported features:
+			checkBandParallel(var);
 			#ifndef HDF5_ENABLED
 			if(var==DumpBGW) throw string("BerkeleyGW interface requires HDF5 support (CMake option EnableHDF5)\n");
 			#endif
@@ -325,6 +338,41 @@ struct CommandDumpName : public Command
 commandDumpName;
 
 
+struct CommandDumpAsync : public Command
+{
+	CommandDumpAsync() : Command("dump-async", "jdftx/Output")
+	{
+		format = "yes|no [<maxStagingMB>=1024]";
+		comments =
+			"Write wavefunctions and scalar fields (densities, potentials etc.) from a background\n"
+			"I/O thread on each process (no by default). Each dump then only copies the data to\n"
+			"a staging buffer, and the calculation continues while the files are written.\n"
+			"If the buffers pending output would exceed <maxStagingMB> megabytes on a process,\n"
+			"the next dump waits for earlier writes to complete instead.\n"
+			"\n"
+			"Pending output is always completed at the end of the calculation, on errors,\n"
+			"and on SIGTERM or a quit requested by Ctrl+C. Wavefunctions are written by\n"
+			"each process directly to its own segment of the file (using POSIX I/O instead\n"
+			"of MPI-IO); builds with MPI_SAFE_WRITE still write wavefunctions synchronously.\n"
+			"Small outputs (fillings, eigenvalues, positions, fluid state etc.) are always\n"
+			"written synchronously.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(asyncWriteEnabled, false, boolMap, "enable");
+		double maxStagingMB; pl.get(maxStagingMB, 1024., "maxStagingMB");
+		if(maxStagingMB <= 0.) throw string("<maxStagingMB> must be positive");
+		asyncWriteMaxStaging = size_t(maxStagingMB * (1<<20));
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg", boolMap.getString(asyncWriteEnabled), asyncWriteMaxStaging/double(1<<20));
+	}
+}
+commandDumpAsync;
+
+
 EnumStringMap<Polarizability::EigenBasis> polarizabilityMap
 (	Polarizability::NonInteracting, "NonInteracting",
 	Polarizability::External, "External",
@@ -342,7 +390,8 @@ struct CommandPolarizability : public Command
 	}
 	
 	void process(ParamList& pl, Everything& e)
-	{	e.dump.polarizability = std::make_shared<Polarizability>();
+	{	checkBandParallel(DumpPolarizability);
+		e.dump.polarizability = std::make_shared<Polarizability>();
 		pl.get(e.dump.polarizability->eigenBasis, Polarizability::NonInteracting, polarizabilityMap, "eigenBasis");
 		pl.get(e.dump.polarizability->Ecut, 0., "Ecut");
 		pl.get(e.dump.polarizability->nEigs, 0, "nEigs");
@@ -366,6 +415,8 @@ enum ElectronScatteringMember
 	ESM_slabResponse,
 	ESM_EcutTransverse,
 	ESM_computeRange,
+	ESM_distributedWfns,
+	ESM_wfnsCache,
 	ESM_delim
 };
 EnumStringMap<ElectronScatteringMember> esmMap
@@ -376,7 +427,9 @@ EnumStringMap<ElectronScatteringMember> esmMap
 	ESM_RPA, "RPA",
 	ESM_slabResponse, "slabResponse",
 	ESM_EcutTransverse, "EcutTransverse",
-	ESM_computeRange, "computeRange"
+	ESM_computeRange, "computeRange",
+	ESM_distributedWfns, "distributedWfns",
+	ESM_wfnsCache, "wfnsCache"
 );
 
 struct CommandElectronScattering : public Command
@@ -415,14 +468,24 @@ struct CommandElectronScattering : public Command
 			"   If specified, only calculate momentum transfers in range [iqStart , iqStop] in\n"
 			"   the current run, in order to split the overall calculation into smaller jobs.\n"
 			"   Note that the indices are 1-based, and the range includes both end-points.\n"
-			"   To combine the final results, perform a final run without computeRange specified.";
+			"   To combine the final results, perform a final run without computeRange specified.\n"
+			"\n+ distributedWfns yes|no\n\n"
+			"   If yes, do not replicate wavefunctions of all k-points on every process.\n"
+			"   Instead, spill them to a scratch file (dump variable name wfnsSpill,\n"
+			"   removed on completion) and fetch the ones needed for each k-point pair\n"
+			"   on demand, prefetching the next pair while the current one is processed.\n"
+			"   Reduces memory per process at the expense of I/O. (default: no)\n"
+			"\n+ wfnsCache <MB>\n\n"
+			"   Memory limit in MB for wavefunctions fetched on demand by each process,\n"
+			"   only used when distributedWfns = yes. (default: 1024)";
 			
 		require("coulomb-interaction");
 		forbid("polarizability"); //both are major operations that are given permission to destroy Everything if necessary
 	}
 	
 	void process(ParamList& pl, Everything& e)
-	{	e.dump.electronScattering = std::make_shared<ElectronScattering>();
+	{	checkBandParallel(DumpElectronScattering);
+		e.dump.electronScattering = std::make_shared<ElectronScattering>();
 		e.dump.insert(std::make_pair(DumpFreq_End, DumpElectronScattering));
 		ElectronScattering& es = *(e.dump.electronScattering);
 		while(true)
@@ -444,6 +507,8 @@ struct CommandElectronScattering : public Command
 					es.iqStart -= 1; //convert to 0-based index. Note that iqStop becomes a non-included 0-based index without change
 					break;
 				}
+				case ESM_distributedWfns: pl.get(es.distributedWfns, false, boolMap, "distributedWfns", true); break;
+				case ESM_wfnsCache: pl.get(es.wfnsCacheMB, 0., "wfnsCache", true); if(es.wfnsCacheMB <= 0.) throw string("Must have wfnsCache > 0"); break;
 				case ESM_delim: break; //never encountered; to suppress compiler warning
 			}
 		}
@@ -467,6 +532,8 @@ struct CommandElectronScattering : public Command
 		logPrintf(" \\\n\tslabResponse %s", boolMap.getString(es.slabResponse));
 		if(es.slabResponse) logPrintf(" \\\n\tEcutTransverse %lg", es.EcutTransverse);
 		if(es.computeRange)  logPrintf(" \\\n\tcomputeRange %lu %lu", es.iqStart+1, es.iqStop);
+		logPrintf(" \\\n\tdistributedWfns %s", boolMap.getString(es.distributedWfns));
+		if(es.distributedWfns) logPrintf(" \\\n\twfnsCache %lg", es.wfnsCacheMB);
 	}
 }
 commandElectronScattering;
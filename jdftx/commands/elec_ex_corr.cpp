@@ -148,6 +148,14 @@ protected:
 			#endif
 			else throw key + " is not a recognized exchange or exchange-correlation functional";
 		}
+		//Exact exchange does not yet support band-parallel process groups:
+		//(LibXC hybrids are only identified once the functional is set up, and are rejected then)
+		switch(exCorr.exCorrType)
+		{	case ExCorrHYB_PBE0: case ExCorrHYB_HSE06: case ExCorrHYB_HSE12: case ExCorrHYB_HSE12s: case ExCorrHF:
+				if(mpiGroup->nProcesses() > 1)
+					throw string("Exact exchange does not support band-parallel process groups: use one process per group (-G)");
+			default:;
+		}
 		#ifdef LIBXC_ENABLED
 		if((exCorr.xcExchange || exCorr.xcExcorr) && !exCorr.xcCorr)
 		{	//LibXC will be used:
@@ -345,3 +353,36 @@ struct CommandExchangeBlockSize : public Command
 	}
 }
 commandExchangeBlockSize;
+
+
+struct CommandExchangeAce : public Command
+{
+	CommandExchangeAce() : Command("exchange-ace", "jdftx/Electronic/Functional")
+	{
+		format = "<nRebuildsMax> [<EbandThreshold>=1e-6]";
+		comments =
+			"Use the adaptively compressed exchange (ACE) operator for exact exchange\n"
+			"in band minimizations (fixed-Hamiltonian calculations and the inner loop of SCF).\n"
+			"The exchange operator is applied in full once to the current wavefunctions\n"
+			"to construct low-rank ACE projectors, after which each Hamiltonian application\n"
+			"reduces to dense matrix multiplies against these projectors.\n"
+			"\n"
+			"The projectors are rebuilt from the updated wavefunctions after each pass of\n"
+			"band minimization, at most <nRebuildsMax> times per band minimization, stopping\n"
+			"once the band energy changes by less than <EbandThreshold>. In SCF, a small value\n"
+			"of <nRebuildsMax> (eg. 1) suffices since projectors are also rebuilt each SCF cycle.\n"
+			"Specify <nRebuildsMax> = 0 to disable ACE (default).";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.exxAceRebuilds, 0, "nRebuildsMax", true);
+		pl.get(e.cntrl.exxAceThreshold, 1e-6, "EbandThreshold");
+		if(e.cntrl.exxAceRebuilds < 0) throw string("<nRebuildsMax> must be >= 0");
+		if(e.cntrl.exxAceThreshold < 0.) throw string("<EbandThreshold> must be >= 0");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d %lg", e.cntrl.exxAceRebuilds, e.cntrl.exxAceThreshold);
+	}
+}
+commandExchangeAce;
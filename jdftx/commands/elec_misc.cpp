@@ -19,6 +19,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <commands/command.h>
 #include <electronic/Everything.h>
+#include <core/DistributedFFT.h>
 
 //! @file elec_misc.cpp Miscellaneous properties of the electronic system
 
@@ -301,6 +302,126 @@ commandCacheProjectors;
 
 //-------------------------------------------------------------------------------------------------
 
+static EnumStringMap<GridInfo::PlanEffort> fftwPlanEffortMap
+(	GridInfo::PlanEstimate, "Estimate",
+	GridInfo::PlanMeasure, "Measure",
+	GridInfo::PlanPatient, "Patient",
+	GridInfo::PlanExhaustive, "Exhaustive"
+);
+
+struct CommandFftwPlanning : public Command
+{
+	CommandFftwPlanning() : Command("fftw-planning", "jdftx/Miscellaneous")
+	{
+		format = "<effort>=" + fftwPlanEffortMap.optionList() + " [<wisdomFile>]";
+		comments =
+			"Control the creation of FFTW plans for all CPU Fourier transforms on the\n"
+			"wavefunction, density, Coulomb and fluid grids. <effort> selects the planner\n"
+			"rigour, trading planning time at startup for transform speed:\n"
+			"+ Estimate: heuristic plans without any timing (quickest startup)\n"
+			"+ Measure: time a few candidate algorithms (default)\n"
+			"+ Patient: time a wider range of algorithms\n"
+			"+ Exhaustive: time all algorithms (slowest startup)\n"
+			"\n"
+			"If <wisdomFile> is specified, FFTW wisdom is imported from that file before\n"
+			"the first plan is created, and any new plans are merged back into it once at\n"
+			"the end of the run, so that subsequent runs on identical grids (and thread\n"
+			"counts) skip planning. The file may be shared by concurrent jobs: the merge is\n"
+			"serialized using <wisdomFile>.lock and the file is updated by atomic replacement.\n"
+			"Wisdom from a higher <effort> is reused by runs requesting a lower one.\n"
+			"(Wisdom files are not supported when FFTs are provided by MKL.)";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(GridInfo::planEffort, GridInfo::PlanMeasure, fftwPlanEffortMap, "effort");
+		pl.get(GridInfo::wisdomFile, string(), "wisdomFile");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	fputs(fftwPlanEffortMap.getString(GridInfo::planEffort), globalLog);
+		if(GridInfo::wisdomFile.length())
+			logPrintf(" %s", GridInfo::wisdomFile.c_str());
+	}
+}
+commandFftwPlanning;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandFftDistributed : public Command
+{
+	CommandFftDistributed() : Command("fft-distributed", "jdftx/Miscellaneous")
+	{
+		format = "yes|no [<nrMin>=262144]";
+		comments =
+			"Divide the Fourier transforms of the nonlinear PCM preconditioner amongst MPI\n"
+			"processes (no by default). When enabled, for grids with at least <nrMin> points\n"
+			"(64^3 by default), each application of the preconditioner uses slab-decomposed\n"
+			"transforms: each process transforms its share of planes, and the data is transposed\n"
+			"between processes, remaining distributed from the real-space input to the real-space\n"
+			"output, which is then collected on all processes. This is the only use: all other\n"
+			"density-grid transforms, and all fields, remain replicated on every process.\n"
+			"Whether it pays off depends on the interconnect speed relative to the FFTs.\n"
+			"Not available in GPU builds.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(DistributedFFT::enabled, false, boolMap, "shouldUse");
+		pl.get(DistributedFFT::nrMin, 64*64*64, "nrMin");
+		if(DistributedFFT::nrMin < 0) throw string("<nrMin> must be non-negative");
+		#ifdef GPU_ENABLED
+		if(DistributedFFT::enabled) throw string("fft-distributed is not available in GPU builds");
+		#endif
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %d", boolMap.getString(DistributedFFT::enabled), DistributedFFT::nrMin);
+	}
+}
+commandFftDistributed;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandRealSpaceProjectors : public Command
+{
+	CommandRealSpaceProjectors() : Command("real-space-projectors", "jdftx/Miscellaneous")
+	{
+		format = "yes|no [<normThreshold>=1e-4]";
+		comments =
+			"Apply nonlocal-pseudopotential projectors in real space (no by default).\n"
+			"When enabled, projections are computed after the wavefunction FFT using\n"
+			"only the grid points within a sphere around each atom, instead of with\n"
+			"plane-wave projectors spanning the entire basis. This scales linearly with\n"
+			"system size and avoids storing projectors per k-point, which pays off\n"
+			"for large cells with many atoms.\n"
+			"\n"
+			"The sphere radius for each species is chosen so that at most a fraction\n"
+			"<normThreshold> of the norm of any projector is discarded. Species whose\n"
+			"spheres would overlap their own periodic images fall back to plane-wave\n"
+			"projectors. The projectors on each sphere are evaluated directly from the\n"
+			"radial functions (band-limited to the wavefunction cutoff) in real space.\n"
+			"Forces are computed with the real-space projectors. The nonlocal stress\n"
+			"contribution of these species is evaluated with the plane-wave projectors\n"
+			"(and their lattice derivatives) instead, so it is consistent with the\n"
+			"real-space energy only to within <normThreshold>.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.realSpaceProjectors, false, boolMap, "shouldUse", true);
+		pl.get(e.cntrl.realSpaceProjectorThreshold, 1e-4, "normThreshold");
+		if(e.cntrl.realSpaceProjectorThreshold <= 0. || e.cntrl.realSpaceProjectorThreshold >= 1.)
+			throw string("<normThreshold> must be in (0,1)");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg", boolMap.getString(e.cntrl.realSpaceProjectors), e.cntrl.realSpaceProjectorThreshold);
+	}
+}
+commandRealSpaceProjectors;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandBasis : public Command
 {
 	CommandBasis() : Command("basis", "jdftx/Electronic/Parameters")
@@ -320,17 +441,61 @@ struct CommandBasis : public Command
 }
 commandBasis;
 
+//-------------------------------------------------------------------------------------------------
+
+struct CommandGammaOnly : public Command
+{
+	CommandGammaOnly() : Command("gamma-only", "jdftx/Electronic/Parameters")
+	{
+		format = "yes|no";
+		comments =
+			"Constrain wavefunctions to be real in real space when the Gamma point is the\n"
+			"only k-point (no by default). This exploits C(-G) = C(G)* to store only half\n"
+			"of the G-sphere (halving wavefunction memory), to transform two wavefunctions\n"
+			"per FFT, and to compute subspace overlaps, Hamiltonians and rotations with real\n"
+			"matrix operations at roughly half the cost. Wavefunction files are still\n"
+			"written and read on the full G-sphere, so they are interchangeable with\n"
+			"calculations without this option.\n"
+			"Not available with noncollinear magnetism or spin-orbit coupling, with phonon,\n"
+			"or with the dump outputs that access the raw wavefunction basis (QMC, Ocean,\n"
+			"BGW, Polarizability, ElectronScattering, SIC, Excitations and FCI).";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.gammaOnly, false, boolMap, "shouldUse");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(e.cntrl.gammaOnly));
+	}
+}
+commandGammaOnly;
+
 
 //-------------------------------------------------------------------------------------------------
 
-static EnumStringMap<ElecEigenAlgo> elecEigenMap(ElecEigenCG, "CG", ElecEigenDavidson, "Davidson");
+static EnumStringMap<ElecEigenAlgo> elecEigenMap
+(	ElecEigenCG, "CG",
+	ElecEigenDavidson, "Davidson",
+	ElecEigenLOBPCG, "LOBPCG",
+	ElecEigenRMMDIIS, "RMM-DIIS"
+);
+static EnumStringMap<ElecEigenAlgo> elecEigenDescMap
+(	ElecEigenCG, "Preconditioned conjugate gradients on the band-structure energy",
+	ElecEigenDavidson, "Davidson with a working set of up to davidson-band-ratio x nBands",
+	ElecEigenLOBPCG, "Locally-optimal block preconditioned CG, with a working set bounded by 3 x nBands",
+	ElecEigenRMMDIIS, "Band-by-band residual minimization (DIIS) without inner orthonormalization (needs reasonable starting wavefunctions, eg. within SCF)"
+);
 
 struct CommandElecEigenAlgo : public Command
 {
     CommandElecEigenAlgo() : Command("elec-eigen-algo", "jdftx/Electronic/Optimization")
 	{
 		format = "<algo>=" + elecEigenMap.optionList();
-		comments = "Selects eigenvalue algorithm for band-structure calculations or inner loop of SCF.";
+		comments = "Selects eigenvalue algorithm for band-structure calculations or inner loop of SCF,\n"
+			"where <algo> is one of:"
+			+ addDescriptions(elecEigenMap.optionList(), linkDescription(elecEigenMap, elecEigenDescMap));
 		hasDefault = true;
 	}
 
@@ -346,6 +511,37 @@ commandElecEigenAlgo;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandElecEigenTeams : public Command
+{
+	CommandElecEigenTeams() : Command("elec-eigen-teams", "jdftx/Electronic/Optimization")
+	{
+		format = "<nTeams>";
+		comments =
+			"Split the threads of each process into <nTeams> teams (default 1), which minimize\n"
+			"different quantum numbers (k-points and spins) concurrently in band-structure\n"
+			"calculations and in the inner eigenvalue loop of SCF. This is faster than threading\n"
+			"each operator over all threads when the FFT boxes are small and each process has\n"
+			"several quantum numbers, e.g. for small unit cells with dense k-point meshes.\n"
+			"\n"
+			"Falls back to one quantum number at a time on GPUs, when processes share quantum\n"
+			"numbers (more processes than quantum-number groups), and with exact exchange\n"
+			"unless ACE is enabled (see exchange-ace).";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.elecEigenTeams, 1, "nTeams");
+		if(e.cntrl.elecEigenTeams < 1) throw string("<nTeams> must be >= 1");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.elecEigenTeams);
+	}
+}
+commandElecEigenTeams;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandRhoExternal : public Command
 {
 	CommandRhoExternal() : Command("rhoExternal", "jdftx/Coulomb interactions")
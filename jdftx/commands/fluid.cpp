@@ -186,6 +186,42 @@ struct CommandFluidVdwScale : public Command
 commandFluidVDWscale;
 
 
+struct CommandFluidMultigrid : public Command
+{
+	CommandFluidMultigrid() : Command("fluid-multigrid", "jdftx/Fluid/Optimization")
+	{
+		format = "<fraction1> [<fraction2> ...]";
+		comments = "Warm-start classical DFT fluid minimization from solutions on coarser grids.\n"
+			"Each <fraction> in (0,1) specifies a coarse level with sample counts scaled by\n"
+			"that fraction (rounded up to FFT-suitable values). Levels are solved coarsest first,\n"
+			"with each solution Fourier-interpolated as the initial guess for the next finer level,\n"
+			"and finally for the minimize on the full grid. For example, \"fluid-multigrid 0.25 0.5\".\n"
+			"This applies only to the first fluid minimize from a fresh (not read-in) fluid state,\n"
+			"since subsequent minimizes start from the previous solution. Default: disabled.";
+		require("fluid");
+	}
+	
+	void process(ParamList& pl, Everything& e)
+	{	std::vector<double>& levels = e.eVars.fluidParams.multigridLevels;
+		while(true)
+		{	double fraction = 0.;
+			pl.get(fraction, 0., "fraction", levels.size()==0);
+			if(!fraction) break;
+			if(fraction<=0. || fraction>=1.) throw string("<fraction> must be in (0,1)");
+			levels.push_back(fraction);
+		}
+		if(e.eVars.fluidParams.fluidType != FluidClassicalDFT)
+			throw string("fluid-multigrid is only supported for the ClassicalDFT fluid");
+	}
+	
+	void printStatus(Everything& e, int iRep)
+	{	for(double fraction: e.eVars.fluidParams.multigridLevels)
+			logPrintf(" %lg", fraction);
+	}
+}
+commandFluidMultigrid;
+
+
 EnumStringMap<FluidComponent::Name> solventMap
 (	FluidComponent::H2O, "H2O",
 	FluidComponent::CHCl3, "CHCl3",
@@ -233,7 +269,8 @@ EnumStringMap<FluidComponent::Functional> functionalMap
 EnumStringMap<FluidComponent::TranslationMode> translationModeMap
 (	FluidComponent::ConstantSpline, "ConstantSpline",
 	FluidComponent::LinearSpline, "LinearSpline",
-	FluidComponent::Fourier, "Fourier"
+	FluidComponent::Fourier, "Fourier",
+	FluidComponent::FourierCached, "FourierCached"
 );
 
 EnumStringMap<FluidComponent::Representation> representationMap
@@ -43,6 +43,7 @@ enum IonicDynamicsParamsMember
 	IDPM_chainLengthT,
 	IDPM_chainLengthP,
 	IDPM_B0,
+	IDPM_wfnsExtrapolation,
 	IDPM_Delim //!< delimiter to detect end of input
 };
 
@@ -57,7 +58,8 @@ EnumStringMap<IonicDynamicsParamsMember> idpmMap
 	IDPM_tDampP, "tDampP",
 	IDPM_chainLengthT, "chainLengthT",
 	IDPM_chainLengthP, "chainLengthP",
-	IDPM_B0, "B0"
+	IDPM_B0, "B0",
+	IDPM_wfnsExtrapolation, "wfnsExtrapolation"
 );
 
 EnumStringMap<IonicDynamicsParamsMember> idpmDescMap
@@ -71,7 +73,8 @@ EnumStringMap<IonicDynamicsParamsMember> idpmDescMap
 	IDPM_tDampP, "barostat damping time [fs]",
 	IDPM_chainLengthT, "Nose-Hoover chain length for thermostat",
 	IDPM_chainLengthP, "Nose-Hoover chain length for barostat",
-	IDPM_B0, "Characteristic bulk modulus [bar] for Berendsen barostat (damping ~ B0 * tDampP)"
+	IDPM_B0, "Characteristic bulk modulus [bar] for Berendsen barostat (damping ~ B0 * tDampP)",
+	IDPM_wfnsExtrapolation, "order K of ASPC wavefunction extrapolation from the previous K+2 steps, replacing wavefunction drag (default -1 => disabled)"
 );
 
 struct CommandIonicDynamics : public Command
@@ -122,6 +125,7 @@ struct CommandIonicDynamics : public Command
 				case IDPM_chainLengthT: pl.get(idp.chainLengthT, 3, "chainLengthT", true); break;
 				case IDPM_chainLengthP: pl.get(idp.chainLengthP, 3, "chainLengthP", true); break;
 				case IDPM_B0: pl.get(idp.B0, nanVal, "B0", true); idp.B0 *= Bar; break;
+				case IDPM_wfnsExtrapolation: pl.get(idp.wfnsExtrapolation, -1, "wfnsExtrapolation", true); break;
 				case IDPM_Delim: 
 					if((not std::isnan(idp.P0)) and (not std::isnan(trace(idp.stress0))))
 						throw(string("Cannot specify both P0 (hydrostatic) and stress0 (anisotropic) barostats"));
@@ -145,6 +149,7 @@ struct CommandIonicDynamics : public Command
 		logPrintf(" \\\n\tchainLengthT %d", idp.chainLengthT);
 		logPrintf(" \\\n\tchainLengthP %d", idp.chainLengthP);
 		logPrintf(" \\\n\tB0           %lg", idp.B0/Bar);
+		logPrintf(" \\\n\twfnsExtrapolation %d", idp.wfnsExtrapolation);
 	}
 }
 commandIonicDynamics;
@@ -28,7 +28,8 @@ enum PulayParamsMember
 	PPM_residualThreshold,
 	PPM_mixFraction,
 	PPM_qMetric,
-	PPM_history
+	PPM_history,
+	PPM_historyStorage
 };
 
 EnumStringMap<PulayParamsMember> pulayParamsMap
@@ -37,7 +38,14 @@ EnumStringMap<PulayParamsMember> pulayParamsMap
 	PPM_residualThreshold, "residualThreshold",
 	PPM_mixFraction, "mixFraction",
 	PPM_qMetric, "qMetric",
-	PPM_history, "history"
+	PPM_history, "history",
+	PPM_historyStorage, "historyStorage"
+);
+
+EnumStringMap<PulayParams::HistoryStorage> historyStorageMap
+(	PulayParams::HistoryInMemory, "InMemory",
+	PulayParams::HistorySinglePrecision, "SinglePrecision",
+	PulayParams::HistoryDisk, "Disk"
 );
 
 EnumStringMap<PulayParamsMember> pulayParamsDescMap
@@ -46,7 +54,8 @@ EnumStringMap<PulayParamsMember> pulayParamsDescMap
 	PPM_residualThreshold, "convergence threshold for the residual in the mixed variable",
 	PPM_mixFraction, "mix fraction (default 0.5)",
 	PPM_qMetric, "wavevector controlling the metric for overlaps (default: 0.8 bohr^-1)",
-	PPM_history, "number of past residuals that are cached and used for mixing"
+	PPM_history, "number of past residuals that are cached and used for mixing",
+	PPM_historyStorage, "storage of older past variables and residuals: InMemory (default), SinglePrecision (about half the memory; variables are stored as differences from the latest) or Disk (temporary file in $TMPDIR or /tmp)"
 );
 
 //Base class for pulay-mixing commands
@@ -74,6 +83,7 @@ protected:
 					case PPM_mixFraction: pl.get(pp.mixFraction, 0.5, "mixFraction", true); break;
 					case PPM_qMetric: pl.get(pp.qMetric, 0.8, "qMetric", true); break;
 					case PPM_history: pl.get(pp.history, 10, "history", true); if(pp.history<1) throw string("<history> must be >= 1"); break;
+					case PPM_historyStorage: pl.get(pp.historyStorage, PulayParams::HistoryInMemory, historyStorageMap, "historyStorage", true); break;
 				}
 			}
 			else process_sub(keyStr, pl, e);
@@ -90,6 +100,7 @@ protected:
 		PRINT(qMetric, %lg)
 		PRINT(history, %d)
 		#undef PRINT
+		logPrintf(" \\\n\thistoryStorage\t%s", historyStorageMap.getString(pp.historyStorage));
 	}
 	
 	//Derived class should handle keys other than those in PulayParams, and throw error if key is not recognized
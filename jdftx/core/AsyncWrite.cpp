@@ -0,0 +1,131 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/AsyncWrite.h>
+#include <core/Util.h>
+#include <atomic>
+#include <csignal>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unistd.h>
+
+bool asyncWriteEnabled = false;
+size_t asyncWriteMaxStaging = size_t(1)<<30;
+
+namespace AsyncWritePrivate
+{
+	volatile sig_atomic_t termRequested = 0; //set by sigTermHandler, acted upon by the I/O thread
+	
+	//Installed once the I/O thread exists: only flags the request, so that no locks or I/O happen in the handler
+	void sigTermHandler(int sig)
+	{	termRequested = 1;
+	}
+	
+	class Writer
+	{
+	public:
+		Writer() : stagingBytes(0), nPending(0), worker(&Writer::run, this) {}
+		
+		void submit(const std::function<void()>& job, size_t bytes)
+		{	std::unique_lock<std::mutex> lock(m);
+			//Back-pressure: wait till the snapshot fits in the staging limit (always admit one job when idle):
+			cvDone.wait(lock, [&]{ return !nPending.load() || stagingBytes + bytes <= asyncWriteMaxStaging; });
+			queue.push_back(std::make_pair(job, bytes));
+			stagingBytes += bytes;
+			nPending++;
+			cvStart.notify_one();
+		}
+		
+		void flush()
+		{	if(std::this_thread::get_id() == worker.get_id()) return; //e.g. die() within a job
+			std::unique_lock<std::mutex> lock(m);
+			cvDone.wait(lock, [this]{ return !nPending.load(); });
+		}
+		
+		void flushFromSignal()
+		{	if(std::this_thread::get_id() == worker.get_id()) return;
+			while(nPending.load()) usleep(1000);
+		}
+		
+	private:
+		std::mutex m;
+		std::condition_variable cvStart, cvDone;
+		std::deque<std::pair<std::function<void()>,size_t>> queue; //pending jobs and their snapshot sizes
+		size_t stagingBytes; //total snapshot size of pending jobs (including the one in progress)
+		std::atomic<int> nPending; //number of jobs queued or in progress
+		std::thread worker;
+		
+		void run()
+		{	while(true)
+			{	std::unique_lock<std::mutex> lock(m);
+				//Wake up periodically to check for SIGTERM (signal handlers cannot notify condition variables):
+				while(!cvStart.wait_for(lock, std::chrono::milliseconds(100), [this]{ return !queue.empty(); }))
+					if(termRequested) terminate();
+				std::function<void()> job = queue.front().first;
+				size_t bytes = queue.front().second;
+				queue.pop_front();
+				lock.unlock();
+				job(); //release snapshot (captured in job) before reporting completion
+				job = std::function<void()>();
+				lock.lock();
+				stagingBytes -= bytes;
+				nPending--;
+				cvDone.notify_all();
+			}
+		}
+		
+		//Called by the I/O thread when SIGTERM was received and no jobs are pending:
+		void terminate()
+		{	fprintf(stderr, "Received SIGTERM, pending output completed; exiting.\n");
+			signal(SIGTERM, SIG_DFL);
+			raise(SIGTERM); //terminate the process the way SIGTERM would have without the handler
+		}
+	};
+	
+	Writer* writer = 0; //created on first deferred write; intentionally never destroyed (worker blocked at program exit)
+	std::mutex writerLock;
+}
+
+void asyncWrite(const std::function<void()>& job, size_t stagingBytes)
+{	using namespace AsyncWritePrivate;
+	if(!asyncWriteEnabled)
+	{	job();
+		return;
+	}
+	{	std::lock_guard<std::mutex> lock(writerLock);
+		if(!writer)
+		{	writer = new Writer();
+			signal(SIGTERM, sigTermHandler); //complete pending output before exiting (eg. on job time limits)
+		}
+	}
+	writer->submit(job, stagingBytes);
+}
+
+void asyncWriteFlush()
+{	using namespace AsyncWritePrivate;
+	if(writer) writer->flush();
+}
+
+void asyncWriteFlushFromSignal()
+{	using namespace AsyncWritePrivate;
+	if(writer) writer->flushFromSignal();
+}
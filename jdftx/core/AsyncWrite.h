@@ -0,0 +1,48 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_ASYNCWRITE_H
+#define JDFTX_CORE_ASYNCWRITE_H
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file AsyncWrite.h Background I/O thread for non-blocking output
+
+#include <functional>
+#include <cstddef>
+
+extern bool asyncWriteEnabled; //!< whether asyncWrite defers jobs to the background I/O thread (false by default => run immediately)
+extern size_t asyncWriteMaxStaging; //!< limit in bytes on the snapshot memory held by pending jobs (asyncWrite blocks beyond this)
+
+/**
+Run job on the background I/O thread, and return without waiting for it to complete.
+The job must own (typically by capturing copies) all the data it writes; stagingBytes is the size
+of that snapshot, which counts against asyncWriteMaxStaging till the job completes.
+Jobs are run one at a time in submission order, so later writes to the same file win.
+If asyncWriteEnabled is false, the job is run immediately on the calling thread.
+*/
+void asyncWrite(const std::function<void()>& job, size_t stagingBytes);
+
+void asyncWriteFlush(); //!< Wait for all pending jobs to complete (no-op when called from the I/O thread itself)
+void asyncWriteFlushFromSignal(); //!< Same as asyncWriteFlush(), but polls without locking for use from signal handlers
+
+//! @}
+#endif // JDFTX_CORE_ASYNCWRITE_H
@@ -85,6 +85,41 @@ void eblas_zgemm(
 	#endif
 }
 
+void eblas_dgemm_sub(size_t iMin, size_t iMax,
+	const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB, const int M, const int N, const int K,
+	double alpha, const double *A, const int lda, const double *B, const int ldb,
+	double beta, double *C, const int ldc)
+{
+	int Msub, Nsub; const double *Asub, *Bsub; double *Csub;
+	if(M>N)
+	{	Msub = iMax-iMin;
+		Nsub = N;
+		Asub = A+iMin*(TransA==CblasNoTrans ? 1 : lda);
+		Bsub = B;
+		Csub = C+iMin;
+	}
+	else
+	{	Msub = M;
+		Nsub = iMax-iMin;
+		Asub = A;
+		Bsub = B+iMin*(TransB==CblasNoTrans ? ldb : 1);
+		Csub = C+iMin*ldc;
+	}
+	cblas_dgemm(CblasColMajor, TransA, TransB, Msub, Nsub, K, alpha, Asub, lda, Bsub, ldb, beta, Csub, ldc);
+}
+void eblas_dgemm(
+	const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB, const int M, const int N, const int K,
+	double alpha, const double *A, const int lda, const double *B, const int ldb,
+	double beta, double *C, const int ldc)
+{
+	#ifdef THREADED_BLAS
+	cblas_dgemm(CblasColMajor, TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+	#else
+	threadLaunch(eblas_dgemm_sub, std::max(M,N), //parallelize along larger dimension of output
+ 		TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+	#endif
+}
+
 template<typename scalar, typename scalar2, typename Conjugator>
 void eblas_scatter_axpy_sub(size_t iStart, size_t iStop, scalar2 a, const int* index, const scalar* x, scalar* y, const scalar* w, const Conjugator& conjugator)
 {	for(size_t i=iStart; i<iStop; i++) y[index[i]] += a * conjugator(x,i, w,i);
@@ -156,6 +191,24 @@ void eblas_symmetrize(int N, int n, const int* symmIndex, const int* symmMult, c
 		eblas_symmetrize_phase_rot_sub, N, n, symmIndex, symmMult, phase, rotSpin, complexPtr4(x));
 }
 
+void eblas_symmetrize_half_sub(size_t iStart, size_t iStop, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x)
+{	for(size_t i=iStart; i<iStop; i++)
+		eblas_symmetrize_half_calc(i, n, symmIndex, symmMirror, symmMult, phase, x);
+}
+void eblas_symmetrize_half(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x)
+{	threadLaunch((N*n<10000) ? 1 : 0, //force single threaded for small problem sizes
+		eblas_symmetrize_half_sub, N, n, symmIndex, symmMirror, symmMult, phase, x);
+}
+
+void eblas_symmetrize_half_rot_sub(size_t iStart, size_t iStop, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, complexPtr4 x)
+{	for(size_t i=iStart; i<iStop; i++)
+		eblas_symmetrize_half_rot_calc(i, n, symmIndex, symmMirror, symmMult, phase, rotSpin, x);
+}
+void eblas_symmetrize_half(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, std::vector<complex*> x)
+{	threadLaunch((N*n<10000) ? 1 : 0, //force single threaded for small problem sizes
+		eblas_symmetrize_half_rot_sub, N, n, symmIndex, symmMirror, symmMult, phase, rotSpin, complexPtr4(x));
+}
+
 //BLAS-1 threaded wrappers
 
 void eblas_zscal_sub(size_t iStart, size_t iStop, const complex* a, complex* x, int incx)
@@ -163,6 +163,28 @@ void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, const int* symmMul
 	gpuErrorCheck();
 }
 
+__global__
+void eblas_symmetrize_half_kernel(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x)
+{	int i=kernelIndex1D();
+	if(i<N) eblas_symmetrize_half_calc(i, n, symmIndex, symmMirror, symmMult, phase, x);
+}
+void eblas_symmetrize_half_gpu(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x)
+{	GpuLaunchConfig1D glc(eblas_symmetrize_half_kernel, N);
+	eblas_symmetrize_half_kernel<<<glc.nBlocks,glc.nPerBlock>>>(N, n, symmIndex, symmMirror, symmMult, phase, x);
+	gpuErrorCheck();
+}
+
+__global__
+void eblas_symmetrize_half_rot_kernel(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, complexPtr4 x)
+{	int i=kernelIndex1D();
+	if(i<N) eblas_symmetrize_half_rot_calc(i, n, symmIndex, symmMirror, symmMult, phase, rotSpin, x);
+}
+void eblas_symmetrize_half_gpu(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, std::vector<complex*> x)
+{	GpuLaunchConfig1D glc(eblas_symmetrize_half_rot_kernel, N);
+	eblas_symmetrize_half_rot_kernel<<<glc.nBlocks,glc.nPerBlock>>>(N, n, symmIndex, symmMirror, symmMult, phase, rotSpin, complexPtr4(x));
+	gpuErrorCheck();
+}
+
 //BLAS-1 wrappers:
 void eblas_dscal_gpu(int N, double a, double* x, int incx)
 {	cublasDscal_v2(cublasHandle, N, &a, x, incx);
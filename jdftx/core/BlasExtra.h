@@ -135,6 +135,11 @@ void eblas_lincomb_gpu(const int N,
 void eblas_zgemm(CBLAS_TRANSPOSE TransA, CBLAS_TRANSPOSE TransB, int M, int N, int K,
 	const complex& alpha, const complex *A, const int lda, const complex *B, const int ldb,
 	const complex& beta, complex *C, const int ldc);
+//! @brief Threaded real matrix multiply (threaded wrapper around dgemm)
+//! All the parameters have the same meaning as in cblas_dgemm, except element order is always Column Major (FORTRAN order!)
+void eblas_dgemm(CBLAS_TRANSPOSE TransA, CBLAS_TRANSPOSE TransB, int M, int N, int K,
+	double alpha, const double *A, const int lda, const double *B, const int ldb,
+	double beta, double *C, const int ldc);
 #ifdef GPU_ENABLED
 //! @brief Wrap cublasZgemm to provide the same interface as eblas_zgemm()
 void eblas_zgemm_gpu(CBLAS_TRANSPOSE TransA, CBLAS_TRANSPOSE TransB, int M, int N, int K,
@@ -253,6 +258,28 @@ void eblas_symmetrize(int N, int n, const int* symmIndex, const int* symmMult, c
 void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, std::vector<complex*> x);
 #endif
 
+//! @brief Symmetrize the half-G space (r2c layout) Fourier transform x of a real field, using N n-fold equivalence classes.
+//! Equivalent to eblas_symmetrize() with phases on the full-G space transform, without forming the latter.
+//! @param N Number of equivalence classes (each class also covers the negated class, if distinct)
+//! @param n Length of symmetry equivalence classes
+//! @param symmIndex Half-G space index for each entry of each class, or ~index if the entry is the conjugate of x at that index
+//! @param symmMirror Half-G space index of the negated entry to be updated in addition to symmIndex (or -1 if none)
+//! @param symmMult Multiplicity per equivalence class (number of repetitions of each element in orbit)
+//! @param phase Phase factors corresponding to each entry in symmIndex
+//! @param x Data array to be symmetrized in place
+void eblas_symmetrize_half(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x);
+#ifdef GPU_ENABLED
+//! @brief Equivalent of eblas_symmetrize_half() for GPU data pointers
+void eblas_symmetrize_half_gpu(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x);
+#endif
+
+//! @brief Equivalent of eblas_symmetrize_half() for the quadruplet of spin-density matrix channels (see eblas_symmetrize() with rotSpin)
+void eblas_symmetrize_half(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, std::vector<complex*> x);
+#ifdef GPU_ENABLED
+//! @brief Equivalent of eblas_symmetrize_half() for GPU data pointers
+void eblas_symmetrize_half_gpu(int N, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, std::vector<complex*> x);
+#endif
+
 //Threaded-wrappers for BLAS1 functions (Cblas)
 //! @brief Copy a data array
 //! @tparam T Data type of the input and output arrays
@@ -84,6 +84,29 @@ __hostanddev__ void eblas_symmetrize_phase_calc(size_t i, int n, const int* symm
 		x[symmIndex[n*i+j]] += xSum * phase[n*i+j].conj();
 }
 
+//Half-G space index encoding used below: i >= 0 refers to x[i], while i < 0 refers to conj(x[~i])
+__hostanddev__ complex eblas_symmetrize_half_get(const complex* x, int i)
+{	return (i>=0) ? x[i] : x[~i].conj();
+}
+
+__hostanddev__ void eblas_symmetrize_half_calc(size_t i, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, complex* x)
+{	complex xSum = 0.;
+	for(int j=0; j<n; j++)
+		xSum += eblas_symmetrize_half_get(x, symmIndex[n*i+j]) * phase[n*i+j];
+	xSum *= 1./(n*symmMult[i]); //average n in the equivalence class, with weight for accumulation below accounted)
+	for(int j=0; j<n; j++)
+	{	int iDirect = symmIndex[n*i+j], iMirror = symmMirror[n*i+j];
+		if(iDirect >= 0) x[iDirect] = 0.;
+		if(iMirror >= 0) x[iMirror] = 0.;
+	}
+	for(int j=0; j<n; j++)
+	{	complex xj = xSum * phase[n*i+j].conj();
+		int iDirect = symmIndex[n*i+j], iMirror = symmMirror[n*i+j];
+		if(iDirect >= 0) x[iDirect] += xj;
+		if(iMirror >= 0) x[iMirror] += xj.conj(); //-G counterpart stored separately (only when -G is not in the same class)
+	}
+}
+
 //! Quadruplet of complex arrays corresponding to spin density matrix channels
 class complexPtr4
 {	complex *up, *dn, *re, *im; //!< UpUp, DnDn, Re(UpDn), Im(UpDn) components respectively
@@ -100,6 +123,19 @@ public:
 		re[i] += alphaHlf*v[0];
 		im[i] -= alphaHlf*v[1];
 	}
+	__hostanddev__ void getHalf(int i, const complex& alpha, complex& s, vector3<complex>& v) const //same as get, but for half-G space index encoding (see eblas_symmetrize_half_get)
+	{	if(i >= 0) { get(i, alpha, s, v); return; }
+		i = ~i; //conjugate each (real-space real) channel
+		s = alpha*(up[i]+dn[i]).conj();
+		v = alpha*vector3<complex>(2.*re[i].conj(), -2.*im[i].conj(), (up[i]-dn[i]).conj());
+	}
+	__hostanddev__ void accumConj(int i, const complex& alpha, const complex& s, const vector3<complex>& v) //accumulate conjugate of each channel of accum()
+	{	complex alphaHlf = 0.5*alpha;
+		up[i] += (alphaHlf*(s+v[2])).conj();
+		dn[i] += (alphaHlf*(s-v[2])).conj();
+		re[i] += (alphaHlf*v[0]).conj();
+		im[i] -= (alphaHlf*v[1]).conj();
+	}
 	__hostanddev__ void zero(int i) //set to zero
 	{	up[i] = 0.;
 		dn[i] = 0.;
@@ -130,6 +166,34 @@ __hostanddev__ void eblas_symmetrize_phase_rot_calc(size_t i, int n, const int*
 		x.accum(symmIndex[n*i+j], phase[n*i+j].conj(), sSum, vSum * rotSpin[j]); //rotation conjugate to above
 }
 
+__hostanddev__ void eblas_symmetrize_half_rot_calc(size_t i, int n, const int* symmIndex, const int* symmMirror, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, complexPtr4 x)
+{	//Gather sums:
+	complex sSum = 0.;
+	vector3<complex> vSum;
+	for(int j=0; j<n; j++)
+	{	complex s; vector3<complex> v;
+		x.getHalf(symmIndex[n*i+j], phase[n*i+j], s, v);
+		sSum += s;
+		vSum += rotSpin[j] * v;
+	}
+	//Normalize to average:
+	double scaleFac = 1./(n*symmMult[i]); //account for multiplicity in accumulation below
+	sSum *= scaleFac;
+	vSum *= scaleFac;
+	//Zero target:
+	for(int j=0; j<n; j++)
+	{	int iDirect = symmIndex[n*i+j], iMirror = symmMirror[n*i+j];
+		if(iDirect >= 0) x.zero(iDirect);
+		if(iMirror >= 0) x.zero(iMirror);
+	}
+	//Scatter averages:
+	for(int j=0; j<n; j++)
+	{	int iDirect = symmIndex[n*i+j], iMirror = symmMirror[n*i+j];
+		if(iDirect >= 0) x.accum(iDirect, phase[n*i+j].conj(), sSum, vSum * rotSpin[j]); //rotation conjugate to above
+		if(iMirror >= 0) x.accumConj(iMirror, phase[n*i+j].conj(), sSum, vSum * rotSpin[j]);
+	}
+}
+
 //! @endcond
 
 #endif // JDFTX_CORE_BLASEXTRA_INTERNAL_H
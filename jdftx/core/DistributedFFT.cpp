@@ -0,0 +1,292 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/DistributedFFT.h>
+#include <core/Thread.h>
+#include <cstring>
+
+bool DistributedFFT::enabled = false;
+int DistributedFFT::nrMin = 64*64*64;
+
+DistributedFFT::DistributedFFT(const GridInfo& gInfo, const MPIUtil* mpiUtil)
+: gInfo(gInfo), mpiUtil(mpiUtil), S(gInfo.S), nzHalf(gInfo.S[2]/2+1),
+	planR2C(0), planC2R(0), planXforward(0), planXinverse(0)
+{	//Divide planes amongst processes:
+	int nProcs = mpiUtil->nProcesses();
+	TaskDivision xDiv(S[0], mpiUtil), yDiv(S[1], mpiUtil);
+	ixStarts.resize(nProcs+1); iyStarts.resize(nProcs+1);
+	for(int iProc=0; iProc<nProcs; iProc++)
+	{	ixStarts[iProc] = xDiv.start(iProc);
+		iyStarts[iProc] = yDiv.start(iProc);
+	}
+	ixStarts[nProcs] = S[0];
+	iyStarts[nProcs] = S[1];
+	xDiv.myRange(ixStart, ixStop);
+	yDiv.myRange(iyStart, iyStop);
+	//Buffers (allocated with at least one element, so that every process has valid pointers):
+	size_t nxMine = ixStop-ixStart, nyMine = iyStop-iyStart;
+	rBuf.init(std::max(nrMine(), size_t(1)));
+	xBuf.init(std::max(nxMine*S[1]*nzHalf, size_t(1)));
+	yBuf.init(std::max(nGmine(), size_t(1)));
+	size_t nTransposeMax = std::max(nxMine*S[1], nyMine*S[0]) * nzHalf;
+	sendBuf.init(std::max(nTransposeMax, size_t(1)));
+	recvBuf.init(std::max(nTransposeMax, size_t(1)));
+	#ifdef MPI_ENABLED
+	MPI_Type_contiguous(S[2], MPI_DOUBLE, &rowTypeR); MPI_Type_commit(&rowTypeR);
+	MPI_Type_contiguous(nzHalf, MPI_C_DOUBLE_COMPLEX, &rowTypeG); MPI_Type_commit(&rowTypeG);
+	#endif
+}
+
+DistributedFFT::~DistributedFFT()
+{	for(fftw_plan plan: { planR2C, planC2R, planXforward, planXinverse })
+		if(plan) fftw_destroy_plan(plan);
+	#ifdef MPI_ENABLED
+	int finalized; MPI_Finalized(&finalized);
+	if(!finalized) //grids may outlive MPI (eg. Everything in main)
+	{	MPI_Type_free(&rowTypeR);
+		MPI_Type_free(&rowTypeG);
+	}
+	#endif
+}
+
+void DistributedFFT::makePlans()
+{	std::lock_guard<std::mutex> lock(GridInfo::planLock); //planner routines are not thread safe
+	if(planR2C || planXforward) return; //already planned
+	GridInfo::importWisdom();
+	fftw_init_threads();
+	fftw_plan_with_nthreads(nProcsAvailable);
+	unsigned flags = GridInfo::getPlannerFlags();
+	int nxMine = ixStop-ixStart, nyMine = iyStop-iyStart;
+	//2D transforms of local planes:
+	if(nxMine)
+	{	int n[2] = { S[1], S[2] };
+		int rDist = S[1]*S[2], cDist = S[1]*nzHalf;
+		planR2C = fftw_plan_many_dft_r2c(2, n, nxMine, rBuf.data(), 0, 1, rDist, (fftw_complex*)xBuf.data(), 0, 1, cDist, flags);
+		planC2R = fftw_plan_many_dft_c2r(2, n, nxMine, (fftw_complex*)xBuf.data(), 0, 1, cDist, rBuf.data(), 0, 1, rDist, flags);
+		if(!(planR2C && planC2R)) die("Failed to create distributed FFT plans for %d local planes.\n", nxMine);
+	}
+	//1D transforms along first dimension, executed once per local iy (which need not preserve alignment):
+	if(nyMine)
+	{	unsigned xFlags = flags | (((S[0]*nzHalf) % 2) ? FFTW_UNALIGNED : 0);
+		fftw_complex* data = (fftw_complex*)yBuf.data();
+		planXforward = fftw_plan_many_dft(1, &S[0], nzHalf, data, 0, nzHalf, 1, data, 0, nzHalf, 1, FFTW_FORWARD, xFlags);
+		planXinverse = fftw_plan_many_dft(1, &S[0], nzHalf, data, 0, nzHalf, 1, data, 0, nzHalf, 1, FFTW_BACKWARD, xFlags);
+		if(!(planXforward && planXinverse)) die("Failed to create distributed FFT plans for %d local columns.\n", nyMine);
+	}
+	GridInfo::wisdomChanged = true;
+}
+
+void DistributedFFT::allToAll(const std::vector<int>& sendCounts, const std::vector<int>& recvCounts)
+{	int nProcs = mpiUtil->nProcesses();
+	#ifdef MPI_ENABLED
+	std::vector<int> sendOffsets(nProcs, 0), recvOffsets(nProcs, 0);
+	for(int iProc=1; iProc<nProcs; iProc++)
+	{	sendOffsets[iProc] = sendOffsets[iProc-1] + sendCounts[iProc-1];
+		recvOffsets[iProc] = recvOffsets[iProc-1] + recvCounts[iProc-1];
+	}
+	MPI_Alltoallv(sendBuf.data(), sendCounts.data(), sendOffsets.data(), rowTypeG,
+		recvBuf.data(), recvCounts.data(), recvOffsets.data(), rowTypeG, mpiUtil->communicator());
+	#else
+	assert(nProcs == 1);
+	memcpy(recvBuf.data(), sendBuf.data(), size_t(sendCounts[0])*nzHalf*sizeof(complex));
+	#endif
+}
+
+void DistributedFFT::transposeXtoY()
+{	static StopWatch watch("DistributedFFT::transposeXtoY"); watch.start();
+	int nProcs = mpiUtil->nProcesses();
+	int nxMine = ixStop-ixStart, nyMine = iyStop-iyStart;
+	std::vector<int> sendCounts(nProcs), recvCounts(nProcs); //in rows of nzHalf (at most S[0]*S[1] each)
+	//Pack [ix-ixStart][iy][iz] for each destination's range of iy:
+	const complex* xData = xBuf.data();
+	complex* sendData = sendBuf.data();
+	for(int iProc=0; iProc<nProcs; iProc++)
+	{	int ny = iyStarts[iProc+1] - iyStarts[iProc];
+		for(int ixL=0; ixL<nxMine; ixL++)
+		{	memcpy(sendData, xData + (size_t(ixL)*S[1] + iyStarts[iProc])*nzHalf, size_t(ny)*nzHalf*sizeof(complex));
+			sendData += size_t(ny)*nzHalf;
+		}
+		sendCounts[iProc] = nxMine * ny;
+		recvCounts[iProc] = (ixStarts[iProc+1] - ixStarts[iProc]) * nyMine;
+	}
+	allToAll(sendCounts, recvCounts);
+	//Unpack [ix][iy-iyStart][iz] from each source's range of ix to [iy-iyStart][ix][iz]:
+	const complex* recvData = recvBuf.data();
+	complex* yData = yBuf.data();
+	for(int ix=0; ix<S[0]; ix++) //sources are in order of ix ranges
+		for(int iyL=0; iyL<nyMine; iyL++)
+		{	memcpy(yData + (size_t(iyL)*S[0] + ix)*nzHalf, recvData, nzHalf*sizeof(complex));
+			recvData += nzHalf;
+		}
+	watch.stop();
+}
+
+void DistributedFFT::transposeYtoX()
+{	static StopWatch watch("DistributedFFT::transposeYtoX"); watch.start();
+	int nProcs = mpiUtil->nProcesses();
+	int nxMine = ixStop-ixStart, nyMine = iyStop-iyStart;
+	std::vector<int> sendCounts(nProcs), recvCounts(nProcs); //in rows of nzHalf (at most S[0]*S[1] each)
+	//Pack [ix][iy-iyStart][iz] for each destination's range of ix (destinations are in order of ix ranges):
+	const complex* yData = yBuf.data();
+	complex* sendData = sendBuf.data();
+	for(int ix=0; ix<S[0]; ix++)
+		for(int iyL=0; iyL<nyMine; iyL++)
+		{	memcpy(sendData, yData + (size_t(iyL)*S[0] + ix)*nzHalf, nzHalf*sizeof(complex));
+			sendData += nzHalf;
+		}
+	for(int iProc=0; iProc<nProcs; iProc++)
+	{	sendCounts[iProc] = (ixStarts[iProc+1] - ixStarts[iProc]) * nyMine;
+		recvCounts[iProc] = nxMine * (iyStarts[iProc+1] - iyStarts[iProc]);
+	}
+	allToAll(sendCounts, recvCounts);
+	//Unpack [ix-ixStart][iy][iz] from each source's range of iy:
+	const complex* recvData = recvBuf.data();
+	complex* xData = xBuf.data();
+	for(int iProc=0; iProc<nProcs; iProc++)
+	{	int ny = iyStarts[iProc+1] - iyStarts[iProc];
+		for(int ixL=0; ixL<nxMine; ixL++)
+		{	memcpy(xData + (size_t(ixL)*S[1] + iyStarts[iProc])*nzHalf, recvData, size_t(ny)*nzHalf*sizeof(complex));
+			recvData += size_t(ny)*nzHalf;
+		}
+	}
+	watch.stop();
+}
+
+void DistributedFFT::forwardBuf()
+{	makePlans();
+	if(planR2C) fftw_execute(planR2C);
+	transposeXtoY();
+	fftw_complex* yData = (fftw_complex*)yBuf.data();
+	for(int iyL=0; iyL<iyStop-iyStart; iyL++)
+	{	fftw_complex* data = yData + size_t(iyL)*S[0]*nzHalf;
+		fftw_execute_dft(planXforward, data, data);
+	}
+}
+
+void DistributedFFT::inverseBuf()
+{	makePlans();
+	fftw_complex* yData = (fftw_complex*)yBuf.data();
+	for(int iyL=0; iyL<iyStop-iyStart; iyL++)
+	{	fftw_complex* data = yData + size_t(iyL)*S[0]*nzHalf;
+		fftw_execute_dft(planXinverse, data, data);
+	}
+	transposeYtoX();
+	if(planC2R) fftw_execute(planC2R); //destroys xBuf
+}
+
+void DistributedFFT::forward(const double* in, complex* out)
+{	memcpy(rBuf.data(), in, nrMine()*sizeof(double));
+	forwardBuf();
+	memcpy(out, yBuf.data(), nGmine()*sizeof(complex));
+}
+
+void DistributedFFT::inverse(const complex* in, double* out)
+{	memcpy(yBuf.data(), in, nGmine()*sizeof(complex));
+	inverseBuf();
+	memcpy(out, rBuf.data(), nrMine()*sizeof(double));
+}
+
+void DistributedFFT::convolve(const double* in, double* out, const RadialFunctionG& w)
+{	memcpy(rBuf.data(), in, nrMine()*sizeof(double));
+	convolveBuf(w);
+	memcpy(out, rBuf.data(), nrMine()*sizeof(double));
+}
+
+void DistributedFFT::convolveBuf(const RadialFunctionG& w)
+{	static StopWatch watch("DistributedFFT::convolve"); watch.start();
+	forwardBuf();
+	//Multiply local columns [iy-iyStart][ix][iz] by w(G)/nr (the normalization of J):
+	const matrix3<>& GGT = gInfo.GGT;
+	double normFac = 1./gInfo.nr;
+	complex* yData = yBuf.data();
+	vector3<int> iG;
+	for(int iy=iyStart; iy<iyStop; iy++)
+	{	iG[1] = (2*iy>S[1]) ? iy-S[1] : iy;
+		for(int ix=0; ix<S[0]; ix++)
+		{	iG[0] = (2*ix>S[0]) ? ix-S[0] : ix;
+			for(iG[2]=0; iG[2]<nzHalf; iG[2]++)
+				*(yData++) *= normFac * w(sqrt(GGT.metric_length_squared(iG)));
+		}
+	}
+	inverseBuf();
+	watch.stop();
+}
+
+void DistributedFFT::scatter(const ScalarField& in, double* out) const
+{	memcpy(out, in->data(false) + size_t(ixStart)*S[1]*S[2], nrMine()*sizeof(double));
+}
+
+ScalarField DistributedFFT::gather(const double* in) const
+{	static StopWatch watch("DistributedFFT::gatherR"); watch.start();
+	//Planes are contiguous in standard layout, and processes are in order of ix ranges:
+	ScalarField out(ScalarFieldData::alloc(gInfo));
+	double* outData = out->data(false);
+	int nProcs = mpiUtil->nProcesses();
+	#ifdef MPI_ENABLED
+	std::vector<int> counts(nProcs), offsets(nProcs); //in rows of S[2]
+	for(int iProc=0; iProc<nProcs; iProc++)
+	{	offsets[iProc] = ixStarts[iProc] * S[1];
+		counts[iProc] = (ixStarts[iProc+1] - ixStarts[iProc]) * S[1];
+	}
+	MPI_Allgatherv(in, counts[mpiUtil->iProcess()], rowTypeR,
+		outData, counts.data(), offsets.data(), rowTypeR, mpiUtil->communicator());
+	#else
+	assert(nProcs == 1);
+	memcpy(outData, in, nrMine()*sizeof(double));
+	#endif
+	watch.stop();
+	return out;
+}
+
+ScalarFieldTilde DistributedFFT::gather(const complex* in) const
+{	static StopWatch watch("DistributedFFT::gatherG"); watch.start();
+	//Collect columns from all processes (overall layout [iy][ix][iz], since processes are in order of iy ranges):
+	int nProcs = mpiUtil->nProcesses();
+	ManagedArray<complex> all; all.init(gInfo.nG);
+	#ifdef MPI_ENABLED
+	std::vector<int> counts(nProcs), offsets(nProcs); //in rows of nzHalf
+	for(int iProc=0; iProc<nProcs; iProc++)
+	{	offsets[iProc] = iyStarts[iProc] * S[0];
+		counts[iProc] = (iyStarts[iProc+1] - iyStarts[iProc]) * S[0];
+	}
+	MPI_Allgatherv(in, counts[mpiUtil->iProcess()], rowTypeG,
+		all.data(), counts.data(), offsets.data(), rowTypeG, mpiUtil->communicator());
+	#else
+	assert(nProcs == 1);
+	memcpy(all.data(), in, nGmine()*sizeof(complex));
+	#endif
+	//Reorder to standard layout [ix][iy][iz]:
+	ScalarFieldTilde out(ScalarFieldTildeData::alloc(gInfo));
+	complex* outData = out->data(false);
+	const complex* allData = all.data();
+	for(int iy=0; iy<S[1]; iy++)
+		for(int ix=0; ix<S[0]; ix++)
+			memcpy(outData + (size_t(ix)*S[1] + iy)*nzHalf, allData + (size_t(iy)*S[0] + ix)*nzHalf, nzHalf*sizeof(complex));
+	watch.stop();
+	return out;
+}
+
+ScalarField DistributedFFT::convolve(const ScalarField& in, const RadialFunctionG& w)
+{	scatter(in, rBuf.data());
+	convolveBuf(w);
+	ScalarField out = gather(rBuf.data());
+	out->scale = in->scale;
+	return out;
+}
@@ -0,0 +1,98 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_DISTRIBUTEDFFT_H
+#define JDFTX_CORE_DISTRIBUTEDFFT_H
+
+//! @addtogroup Operators
+//! @{
+
+//! @file DistributedFFT.h Slab-decomposed real-to-complex FFTs over MPI
+
+#include <core/ScalarField.h>
+#include <core/ManagedMemory.h>
+#include <core/RadialFunction.h>
+
+/**
+@brief Slab-decomposed 3D real <-> half-complex FFT over an MPI communicator
+
+Real-space data is divided along the first dimension: each process owns planes [ixStart,ixStop),
+which is a contiguous chunk of the standard ScalarField layout. Reciprocal-space (half-G) data is
+divided along the second dimension: each process owns iy in [iyStart,iyStop) for all ix and iz,
+stored transposed as [iy-iyStart][ix][iz]. A transform consists of 2D FFTs of the local planes,
+an all-to-all transposition, and 1D FFTs along the first dimension of the local columns.
+
+forward(), inverse() and convolve() operate purely on the distributed layouts, so that a sequence of
+transforms and reciprocal-space operations keeps the data distributed throughout. Replicated fields
+are only assembled when explicitly requested using gather(). None of this is invoked implicitly by
+I() or Idag(): callers opt in per call, and every member function that communicates is collective
+over the communicator, so it must be called by all its processes together.
+
+Currently, the only user is the preconditioner of NonlinearPCM (see command fft-distributed):
+all other density-grid transforms, and all ScalarFields, remain replicated on every process.
+*/
+class DistributedFFT
+{
+public:
+	static bool enabled; //!< whether the nonlinear PCM preconditioner uses distributed transforms (when running on more than one process)
+	static int nrMin; //!< minimum grid size (number of real-space points) for which distributed transforms are created
+	
+	DistributedFFT(const GridInfo& gInfo, const MPIUtil* mpiUtil);
+	~DistributedFFT();
+	
+	const GridInfo& gInfo;
+	const MPIUtil* mpiUtil;
+	int ixStart, ixStop; //!< real-space planes (along first dimension) on current process
+	int iyStart, iyStop; //!< reciprocal-space planes (along second dimension) on current process
+	size_t nrMine() const { return size_t(ixStop-ixStart) * S[1] * S[2]; } //!< number of local real-space points
+	size_t nGmine() const { return size_t(iyStop-iyStart) * S[0] * nzHalf; } //!< number of local reciprocal-space points
+	
+	void forward(const double* in, complex* out); //!< Forward r2c transform (without normalization, as in Idag) from local real-space to local reciprocal-space data
+	void inverse(const complex* in, double* out); //!< Inverse c2r transform (as in I) from local reciprocal-space to local real-space data
+	void convolve(const double* in, double* out, const RadialFunctionG& w); //!< Local real-space data of I(w*J(in)), without assembling any replicated field
+	
+	void scatter(const ScalarField& in, double* out) const; //!< Extract local real-space data from a replicated field (no communication)
+	ScalarField gather(const double* in) const; //!< Assemble replicated field from local real-space data on all processes
+	ScalarFieldTilde gather(const complex* in) const; //!< Assemble replicated field from local reciprocal-space data on all processes
+	
+	ScalarField convolve(const ScalarField& in, const RadialFunctionG& w); //!< I(w*J(in)) for a replicated input, with a single gather of the output
+
+private:
+	vector3<int> S; int nzHalf; //grid dimensions and reduced last dimension S[2]/2+1
+	std::vector<int> ixStarts, iyStarts; //plane divisions on all processes (with final entry = S[0] and S[1] respectively)
+	ManagedArray<double> rBuf; //local real-space planes
+	ManagedArray<complex> xBuf; //local planes after 2D transforms: [ix-ixStart][iy][iz]
+	ManagedArray<complex> yBuf; //local columns after transposition: [iy-iyStart][ix][iz]
+	ManagedArray<complex> sendBuf, recvBuf; //transposition buffers
+	fftw_plan planR2C, planC2R, planXforward, planXinverse; //created on first use
+	#ifdef MPI_ENABLED
+	MPI_Datatype rowTypeR, rowTypeG; //contiguous rows of S[2] reals and nzHalf complex numbers (keeps MPI counts within int range)
+	#endif
+	void makePlans();
+	void forwardBuf(); //rBuf -> yBuf
+	void inverseBuf(); //yBuf -> rBuf (destroys yBuf)
+	void convolveBuf(const RadialFunctionG& w); //rBuf -> rBuf
+	void transposeXtoY(); //xBuf -> yBuf
+	void transposeYtoX(); //yBuf -> xBuf
+	void allToAll(const std::vector<int>& sendCounts, const std::vector<int>& recvCounts); //sendBuf -> recvBuf (counts in rows of nzHalf)
+};
+
+//! @}
+#endif // JDFTX_CORE_DISTRIBUTEDFFT_H
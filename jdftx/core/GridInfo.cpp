@@ -23,6 +23,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Operators.h>
 #include <core/LatticeUtils.h>
 #include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
 
 #ifdef MKL_PROVIDES_FFT
 #include <fftw3_mkl.h>
@@ -271,10 +274,24 @@ void GridInfo::initialize(bool skipHeader, const std::vector<SpaceGroupOp> sym)
 }
 
 std::mutex GridInfo::planLock;
+GridInfo::PlanEffort GridInfo::planEffort = GridInfo::PlanMeasure;
+string GridInfo::wisdomFile;
+bool GridInfo::wisdomImported = false;
+bool GridInfo::wisdomChanged = false;
 
 fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
+{	return getPlan(planType, nThreads, 1);
+}
+
+fftw_plan GridInfo::getPlanBatch(GridInfo::PlanType planType, int nThreads, int howMany) const
+{	assert((planType==PlanForwardInPlace) || (planType==PlanInverseInPlace));
+	assert(howMany >= 1);
+	return getPlan(planType, nThreads, howMany);
+}
+
+fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads, int howMany) const
 {	//Return cached plan if available:
-	auto key = std::make_pair(planType, nThreads);
+	auto key = std::make_tuple(planType, nThreads, howMany);
 	planLock.lock();
 	auto iter = planCache.find(key);
 	if(iter != planCache.end())
@@ -283,7 +300,7 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	}
 	//Create plan:
 	//--- import wisdom if available:
-	fftw_import_system_wisdom();
+	importWisdom();
 	//--- setup threading:
 	#ifdef MKL_PROVIDES_FFT
 	fftw3_mkl.number_of_user_threads = ceildiv(nProcsAvailable, nThreads); //maximum number of user threads from which plan could be called simultaneously
@@ -293,7 +310,7 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	//--- temp data for planning:
 	bool inPlace = (planType==PlanForwardInPlace) || (planType==PlanInverseInPlace);
 	ManagedArray<fftw_complex> testMem, testMem2;
-	testMem.init(nr);
+	testMem.init(howMany>1 ? size_t(batchStride())*howMany : size_t(nr));
 	fftw_complex* testData = testMem.data();
 	fftw_complex* testData2 = 0;
 	if(!inPlace)
@@ -301,19 +318,81 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 		testData2 = testMem2.data();
 	}
 	//--- plan:
-	#define PLANNER_FLAGS FFTW_MEASURE
+	unsigned plannerFlags = getPlannerFlags();
 	fftw_plan plan = 0;
-	switch(planType)
-	{	case PlanInverse:        plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_BACKWARD, PLANNER_FLAGS); break;
-		case PlanForward:        plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_FORWARD, PLANNER_FLAGS); break;
-		case PlanInverseInPlace: plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData, FFTW_BACKWARD, PLANNER_FLAGS); break;
-		case PlanForwardInPlace: plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData, FFTW_FORWARD, PLANNER_FLAGS); break;
-		case PlanRtoC:           plan = fftw_plan_dft_r2c_3d(S[0], S[1], S[2], (double*)testData, testData2, PLANNER_FLAGS); break;
-		case PlanCtoR:           plan = fftw_plan_dft_c2r_3d(S[0], S[1], S[2], testData, (double*)testData2, PLANNER_FLAGS); break;
+	if(howMany > 1)
+	{	int sign = (planType==PlanForwardInPlace) ? FFTW_FORWARD : FFTW_BACKWARD;
+		int dist = batchStride();
+		plan = fftw_plan_many_dft(3, &S[0], howMany, testData, 0, 1, dist, testData, 0, 1, dist, sign, plannerFlags);
+	}
+	else switch(planType)
+	{	case PlanInverse:        plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_BACKWARD, plannerFlags); break;
+		case PlanForward:        plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_FORWARD, plannerFlags); break;
+		case PlanInverseInPlace: plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData, FFTW_BACKWARD, plannerFlags); break;
+		case PlanForwardInPlace: plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData, FFTW_FORWARD, plannerFlags); break;
+		case PlanRtoC:           plan = fftw_plan_dft_r2c_3d(S[0], S[1], S[2], (double*)testData, testData2, plannerFlags); break;
+		case PlanCtoR:           plan = fftw_plan_dft_c2r_3d(S[0], S[1], S[2], testData, (double*)testData2, plannerFlags); break;
 	}
-	if(!plan) die("Failed to create FFT plan with %d threads",  nThreads);
+	if(!plan) die("Failed to create FFT plan with %d threads and batch size %d",  nThreads, howMany);
 	//--- cache and return plan:
 	((GridInfo*)this)->planCache.insert(std::make_pair(key, plan));
+	wisdomChanged = true;
 	planLock.unlock();
 	return plan;
 }
+
+//Called with planLock held
+void GridInfo::importWisdom()
+{	if(wisdomImported) return;
+	fftw_import_system_wisdom();
+	#ifndef MKL_PROVIDES_FFT
+	if(wisdomFile.length())
+	{	if(fftw_import_wisdom_from_filename(wisdomFile.c_str()))
+			logPrintf("Imported FFTW wisdom from '%s'.\n", wisdomFile.c_str());
+		else
+			logPrintf("No usable FFTW wisdom in '%s'; it will be created.\n", wisdomFile.c_str());
+	}
+	#endif
+	wisdomImported = true;
+}
+
+unsigned GridInfo::getPlannerFlags()
+{	switch(planEffort)
+	{	case PlanEstimate: return FFTW_ESTIMATE;
+		case PlanPatient: return FFTW_PATIENT;
+		case PlanExhaustive: return FFTW_EXHAUSTIVE;
+		default: return FFTW_MEASURE;
+	}
+}
+
+void GridInfo::exportWisdom()
+{
+	#ifndef MKL_PROVIDES_FFT
+	if(!(wisdomFile.length() && mpiWorld->isHead())) return;
+	std::lock_guard<std::mutex> lock(planLock);
+	if(!wisdomChanged) return; //nothing new to contribute
+	//Serialize the read-merge-write with other jobs sharing this file:
+	string lockFile = wisdomFile + ".lock";
+	int lockFd = open(lockFile.c_str(), O_RDWR | O_CREAT, 0666);
+	if(lockFd<0 || flock(lockFd, LOCK_EX))
+	{	logPrintf("WARNING: could not lock '%s'; FFTW wisdom not saved.\n", lockFile.c_str());
+		if(lockFd>=0) close(lockFd);
+		return;
+	}
+	//Re-read the file first, so that plans added meanwhile by other jobs are retained:
+	fftw_import_wisdom_from_filename(wisdomFile.c_str());
+	//Write to a temporary file and rename, so that readers that do not lock never see a partial file:
+	char tmpSuffix[32]; sprintf(tmpSuffix, ".tmp%d", int(getpid()));
+	string tmpFile = wisdomFile + tmpSuffix;
+	if(fftw_export_wisdom_to_filename(tmpFile.c_str()) && rename(tmpFile.c_str(), wisdomFile.c_str())==0)
+	{	logPrintf("Saved FFTW wisdom to '%s'.\n", wisdomFile.c_str());
+		wisdomChanged = false;
+	}
+	else
+	{	unlink(tmpFile.c_str());
+		logPrintf("WARNING: could not write FFTW wisdom to '%s'.\n", wisdomFile.c_str());
+	}
+	flock(lockFd, LOCK_UN);
+	close(lockFd);
+	#endif
+}
@@ -25,11 +25,13 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/matrix3.h>
 #include <core/GpuUtil.h>
+#include <core/string.h>
 #include <fftw3.h>
 #include <stdint.h>
 #include <cstdio>
 #include <mutex>
 #include <map>
+#include <tuple>
 
 /** @brief Simulation grid descriptor
 
@@ -119,6 +121,23 @@ public:
 		PlanCtoR, //!< Complex to real transform
 	};
 	fftw_plan getPlan(PlanType planType, int nThreads) const; //get an FFTW plan of specified type with specified thread count
+	
+	//! Get an FFTW plan for howMany simultaneous in-place complex transforms (planType must be PlanForwardInPlace or PlanInverseInPlace),
+	//! operating on howMany consecutive arrays separated by batchStride(), with specified thread count
+	//! Each distinct howMany is planned (and cached) separately, so callers should restrict it to a small fixed set of sizes
+	fftw_plan getPlanBatch(PlanType planType, int nThreads, int howMany) const;
+	inline int batchStride() const { return (nr + 3) & (~3); } //!< offset between arrays in batched transforms (padded to preserve alignment)
+	
+	//! Planning effort for CPU (FFTW) plans, shared by all grids in the process
+	enum PlanEffort
+	{	PlanEstimate, //!< heuristic plans without timing (fastest planning, possibly slower transforms)
+		PlanMeasure, //!< time a few candidate algorithms (default)
+		PlanPatient, //!< time a wider range of algorithms
+		PlanExhaustive //!< time all algorithms (slowest planning)
+	};
+	static PlanEffort planEffort; //!< planning effort used by getPlan / getPlanBatch
+	static string wisdomFile; //!< if non-empty, FFTW wisdom is imported from this file before planning and merged back into it by exportWisdom()
+	static void exportWisdom(); //!< merge plans created in this run into wisdomFile (head process only, under a lock file); called once from finalizeSystem
 	#ifdef GPU_ENABLED
 	cufftHandle planZ2Z; //!< CUFFT plan for all the complex transforms
 	cufftHandle planD2Z; //!< CUFFT plan for R -> G
@@ -148,9 +167,15 @@ private:
 	bool initialized; //!< keep track of whether initialize() has been called
 	void updateSdependent();
 	
-	//FFTW plans by thread count and type:
-	std::map<std::pair<PlanType,int>,fftw_plan> planCache;
+	//FFTW plans by thread count, batch size and type:
+	std::map<std::tuple<PlanType,int,int>,fftw_plan> planCache;
+	fftw_plan getPlan(PlanType planType, int nThreads, int howMany) const; //common implementation of getPlan and getPlanBatch
 	static std::mutex planLock; //Global lock since planner routines are not thread safe
+	static bool wisdomImported; //whether system and user wisdom have been loaded (once per process)
+	static bool wisdomChanged; //whether any plans have been created since wisdom was imported
+	static void importWisdom(); //load system and user wisdom, if not already done
+	static unsigned getPlannerFlags(); //FFTW planner flags corresponding to planEffort
+	friend class DistributedFFT; //shares planner settings and lock
 };
 
 //! @}
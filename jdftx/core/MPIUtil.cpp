@@ -141,17 +141,30 @@ void MPIUtil::checkErrors(const ostringstream& oss) const
 
 //-------------------- Asynchronous support functions ---------------------------
 
+namespace MPIUtilPrivate
+{	StopWatch watchSend("MPI_Send", true);
+	StopWatch watchRecv("MPI_Recv", true);
+	StopWatch watchBcast("MPI_Bcast", true);
+	StopWatch watchAllReduce("MPI_Allreduce", true);
+	StopWatch watchReduce("MPI_Reduce", true);
+	StopWatch watchWait("MPI_Wait", true);
+}
+
 void MPIUtil::wait(MPIUtil::Request request)
 {
 #ifdef MPI_ENABLED
+	MPIUtilPrivate::watchWait.start();
 	MPI_Wait(&request, MPI_STATUS_IGNORE);
+	MPIUtilPrivate::watchWait.stop();
 #endif
 }
 
 void MPIUtil::waitAll(const std::vector<Request>& requests)
 {
 #ifdef MPI_ENABLED
+	MPIUtilPrivate::watchWait.start();
 	MPI_Waitall(requests.size(), (Request*)requests.data(), MPI_STATUS_IGNORE);
+	MPIUtilPrivate::watchWait.stop();
 #endif
 }
 
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_CORE_MPIUTIL_H
 
 #include <core/string.h>
+#include <core/Profiler.h>
 #include <core/matrix3.h>
 #include <cstdlib>
 #include <cstdio>
@@ -160,6 +161,9 @@ private:
 //!@cond
 namespace MPIUtilPrivate
 {
+	//Time spent in blocking communication (reported as MPI time by Profiler):
+	extern StopWatch watchSend, watchRecv, watchBcast, watchAllReduce, watchReduce, watchWait;
+	
 #ifdef MPI_ENABLED
 	//Elementary data types directly supported by MPI:
 	template<typename...> struct DataType;
@@ -247,7 +251,10 @@ template<typename T> void MPIUtil::send(const T* data, size_t nData, int dest, i
 	{	if(request)
 			MPI_Isend((void*)data, DataType<T>::nElem*nData, DataType<T>::get(), dest, tag, comm, request);
 		else
+		{	watchSend.start();
 			MPI_Send((void*)data, DataType<T>::nElem*nData, DataType<T>::get(), dest, tag, comm);
+			watchSend.stop();
+		}
 	}
 	#endif
 }
@@ -265,7 +272,10 @@ template<typename T> void MPIUtil::recv(T* data, size_t nData, int src, int tag,
 	{	if(request)
 			MPI_Irecv(data, DataType<T>::nElem*nData, DataType<T>::get(), src, tag, comm, request);
 		else
+		{	watchRecv.start();
 			MPI_Recv(data, DataType<T>::nElem*nData, DataType<T>::get(), src, tag, comm, MPI_STATUS_IGNORE);
+			watchRecv.stop();
+		}
 	}
 	#endif
 }
@@ -288,7 +298,10 @@ template<typename T> void MPIUtil::bcast(T* data, size_t nData, int root, Reques
 			MPI_Ibcast(data, DataType<T>::nElem*nData, DataType<T>::get(), root, comm, request);
 		else
 		#endif
+		{	watchBcast.start();
 			MPI_Bcast(data, DataType<T>::nElem*nData, DataType<T>::get(), root, comm);
+			watchBcast.stop();
+		}
 	}
 	#endif
 }
@@ -304,7 +317,9 @@ template<typename T> void MPIUtil::allReduce(T* data, size_t nData, MPIUtil::Red
 	#ifdef MPI_ENABLED
 	if(nProcs>1)
 	{	if(safeMode) //Reduce to root node and then broadcast result (to ensure identical values)
-		{	MPI_Reduce(isHead()?MPI_IN_PLACE:data, data, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), 0, comm);
+		{	watchAllReduce.start();
+			MPI_Reduce(isHead()?MPI_IN_PLACE:data, data, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), 0, comm);
+			watchAllReduce.stop();
 			bcast(data, nData, 0);
 			if(request) throw string("Asynchronous allReduce not supported in safeMode");
 		}
@@ -317,7 +332,10 @@ template<typename T> void MPIUtil::allReduce(T* data, size_t nData, MPIUtil::Red
 				MPI_Iallreduce(MPI_IN_PLACE, data, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), comm, request);
 			else
 			#endif
+			{	watchAllReduce.start();
 				MPI_Allreduce(MPI_IN_PLACE, data, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), comm);
+				watchAllReduce.stop();
+			}
 		}
 	}
 	#endif
@@ -331,7 +349,9 @@ template<typename T> void MPIUtil::allReduce(T& data, int& index, MPIUtil::Reduc
 	if(nProcs>1)
 	{	typename DataTypeIntPair<T>::Elem pair;
 		pair.data = data; pair.index = index;
+		watchAllReduce.start();
 		MPI_Allreduce(MPI_IN_PLACE, &pair, 1, DataTypeIntPair<T>::get(), mpiLocOp(op), comm);
+		watchAllReduce.stop();
 		data = pair.data; index = pair.index;
 	}
 	#endif
@@ -352,7 +372,10 @@ template<typename T> void MPIUtil::reduce(T* data, size_t nData, MPIUtil::Reduce
 			MPI_Ireduce((iProc==root)?MPI_IN_PLACE:data, data, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), root, comm, request);
 		else
 		#endif
+		{	watchReduce.start();
 			MPI_Reduce((iProc==root)?MPI_IN_PLACE:data, data, DataType<T>::nElem*nData, DataType<T>::get(), mpiOp(op), root, comm);
+			watchReduce.stop();
+		}
 	}
 	#endif
 }
@@ -365,7 +388,9 @@ template<typename T> void MPIUtil::reduce(T& data, int& index, MPIUtil::ReduceOp
 	if(nProcs>1)
 	{	typename DataTypeIntPair<T>::Elem pair;
 		pair.data = data; pair.index = index;
+		watchReduce.start();
 		MPI_Reduce((iProc==root)?MPI_IN_PLACE:&pair, &pair, 1, DataTypeIntPair<T>::get(), mpiLocOp(op), root, comm);
+		watchReduce.stop();
 		data = pair.data; index = pair.index;
 	}
 	#endif
@@ -21,11 +21,17 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/GpuUtil.h>
 #include <fftw3.h>
 #include <mutex>
+#include <atomic>
 #include <map>
 #include <set>
+#include <unordered_map>
 
 //-------- Memory usage profiler ---------
 
+namespace MemCache
+{	void getCachedUsage(size_t& cached, size_t& cachedPeak, size_t& reservedPeak); //bytes held idle in caches (current and peak), and peak of used + cached
+}
+
 namespace MemUsageReport
 {
 	enum Mode { Add, Remove, Print };
@@ -87,6 +93,11 @@ namespace MemUsageReport
 			{	for(auto entry: usageMap)
 					logPrintf("MEMUSAGE: %30s %12.6lf GB\n", entry.first.c_str(), entry.second.peak * bytesToGB);
 				logPrintf("MEMUSAGE: %30s %12.6lf GB\n", "Total", usageTotal.peak * bytesToGB);
+				//Memory held by the allocator caches, not included above:
+				size_t cached, cachedPeak, reservedPeak;
+				MemCache::getCachedUsage(cached, cachedPeak, reservedPeak);
+				logPrintf("MEMUSAGE: %30s %12.6lf GB (currently %.6lf GB)\n", "Cached (idle)", cachedPeak * bytesToGB, cached * bytesToGB);
+				logPrintf("MEMUSAGE: %30s %12.6lf GB\n", "Total including cached", reservedPeak * bytesToGB);
 				break;
 			}
 		}
@@ -112,6 +123,9 @@ namespace MemPool
 		//Available 'holes' in memory:
 		std::map<size_t,size_t> holes; //start -> stop
 		std::map<size_t,std::set<size_t>> holesBySize; //size -> set of starts
+		//Statistics:
+		size_t usedBytes, usedBytesPeak; //current and peak usage within pool
+		size_t nExternal; //number of allocations that did not fit in pool
 		//--- helper functions for managing holes
 		typedef std::map<size_t,size_t>::iterator MapIter;
 		typedef std::map<size_t,std::set<size_t>>::iterator MapSetIter;
@@ -159,7 +173,7 @@ namespace MemPool
 			//logPrintf("Deleted (%lu,%lu)\t", start,start+size); printHoles();
 		}
 	public:
-		MemPool() : pool(0)
+		MemPool() : pool(0), usedBytes(0), usedBytesPeak(0), nExternal(0)
 		{	if(mempoolSize)
 			{	pool = (uint8_t*)MemSpace::alloc(mempoolSize);
 				if(!pool) MemSpace::outOfMemory();
@@ -180,6 +194,7 @@ namespace MemPool
 			MapSetIter ubound = holesBySize.upper_bound(size);
 			if(ubound == holesBySize.end())
 			{	//No hole big enough left, so allocate externally:
+				nExternal++;
 				lock.unlock();
 				void* ptr = MemSpace::alloc(sizeRequested);
 				if(!ptr) MemSpace::outOfMemory();
@@ -192,6 +207,8 @@ namespace MemPool
 				used[start] = start+size; //mark allocated range
 				removeHole(start, 0, &ubound); //remove old hole
 				if(holeSize > size) addHole(start+size, holeSize-size); //add hole left behind (if any)
+				usedBytes += size;
+				usedBytesPeak = std::max(usedBytesPeak, usedBytes);
 				lock.unlock();
 				return (void*)(pool+start);
 			}
@@ -211,9 +228,23 @@ namespace MemPool
 				size_t size = usedIter->second - start;
 				used.erase(usedIter); //remove from used
 				addHole(start, size); //add corresponding hole
+				usedBytes -= size;
 			}
 			lock.unlock();
 		}
+		void report(const char* spaceName)
+		{	if(!mempoolSize) return;
+			const double bytesToGB = 1./pow(1024.,3);
+			lock.lock();
+			size_t largestHole = holesBySize.size() ? holesBySize.rbegin()->first : 0;
+			size_t freeBytes = mempoolSize - usedBytes;
+			logPrintf("MEMPOOL: %s pool: peak usage %.6lf of %.6lf GB, %lu allocations outside pool\n",
+				spaceName, usedBytesPeak*bytesToGB, mempoolSize*bytesToGB, nExternal);
+			logPrintf("MEMPOOL: %s pool: %lu holes, largest %.6lf of %.6lf GB free (fragmentation %.1lf%%)\n",
+				spaceName, holes.size(), largestHole*bytesToGB, freeBytes*bytesToGB,
+				freeBytes ? 100.*(1. - double(largestHole)/freeBytes) : 0.);
+			lock.unlock();
+		}
 	};
 	
 	//---- MemSpace classes for each memory space ----
@@ -258,10 +289,211 @@ namespace MemPool
 }
 
 
+//-------- Thread-caching allocator in front of the CPU memory pool ---------
+
+namespace MemCache
+{
+	//Size class of an allocation: a multiple of the cache-line size below a page, and of the page size above.
+	//Grid quantities and ColumnBundles recur with a handful of exact sizes, so this keys the classes to
+	//those sizes (and reuses their blocks exactly) without the rounding waste of power-of-two classes.
+	inline size_t sizeClass(size_t nBytes)
+	{	const size_t unit = (nBytes < 4096) ? 64 : 4096;
+		return (nBytes + unit-1) & ~(unit-1);
+	}
+	
+	//Blocks larger than this bypass the caches (allocated rarely and expensive to fill anyway):
+	inline size_t maxCachedSize() { return memcacheSize/4; }
+	
+	typedef std::unordered_map<size_t, std::vector<void*>> Bins; //available blocks by size class
+	
+	//Statistics (collected only when profiling, to avoid contention on the counters otherwise):
+	#ifdef ENABLE_PROFILING
+	struct Stats
+	{	std::atomic<size_t> nAlloc, nThreadHits, nSharedHits; //allocation counts: total, and those served from thread and shared caches
+		std::atomic<size_t> requested, used, usedPeak; //bytes requested and (class-rounded) bytes used by live blocks
+		std::atomic<size_t> cached, cachedPeak, reservedPeak; //bytes held idle in caches (current and peak), and peak of used + cached
+		
+		static void updatePeak(std::atomic<size_t>& peak, size_t value)
+		{	size_t prev = peak.load(std::memory_order_relaxed);
+			while(prev < value && !peak.compare_exchange_weak(prev, value, std::memory_order_relaxed));
+		}
+		void alloc(size_t nBytes, size_t size, bool fromCache, bool threadHit)
+		{	nAlloc++;
+			if(threadHit) nThreadHits++; else if(fromCache) nSharedHits++;
+			requested += nBytes;
+			size_t usedNew = (used += size);
+			updatePeak(usedPeak, usedNew);
+			size_t cachedNew = fromCache ? (cached -= size) : cached.load();
+			updatePeak(reservedPeak, usedNew + cachedNew);
+		}
+		void free(size_t nBytes, size_t size, bool toCache)
+		{	requested -= nBytes;
+			used -= size;
+			if(toCache) updatePeak(cachedPeak, cached += size);
+		}
+		void release(size_t size) { cached -= size; } //cached block returned to pool
+	};
+	Stats& stats() { static Stats s; return s; }
+	#define MEMCACHE_STATS(code) stats().code;
+	#else
+	#define MEMCACHE_STATS(code)
+	#endif
+	
+	//Cache shared by all threads, which absorbs overflow from (and refills) the thread caches.
+	//Only accessed in batches, so that its lock is acquired for a small fraction of allocations.
+	struct SharedCache
+	{	std::mutex lock;
+		Bins bins;
+		size_t nBytes; //total size of blocks held
+		SharedCache() : nBytes(0) {}
+	};
+	SharedCache& shared() { static SharedCache* s = new SharedCache; return *s; } //never destroyed: must outlive all thread caches
+	
+	//Add blocks to the shared cache, releasing the excess over its capacity back to the pool (unless threadExit, when the pool may be gone):
+	void sharedAdd(size_t size, void** blocks, size_t nBlocks, bool threadExit=false)
+	{	SharedCache& sc = shared();
+		std::lock_guard<std::mutex> lock(sc.lock);
+		std::vector<void*>& bin = sc.bins[size];
+		bin.insert(bin.end(), blocks, blocks+nBlocks);
+		sc.nBytes += size * nBlocks;
+		if(threadExit) return;
+		const size_t capacity = memcacheSharedSize;
+		for(auto iter=sc.bins.begin(); sc.nBytes>capacity && iter!=sc.bins.end(); iter++)
+			while(iter->second.size() && sc.nBytes>capacity)
+			{	MemPool::CPU().free(iter->second.back());
+				iter->second.pop_back();
+				sc.nBytes -= iter->first;
+				MEMCACHE_STATS(release(iter->first))
+			}
+	}
+	
+	//Per-thread cache, accessed without any locks:
+	struct ThreadCache
+	{	Bins bins;
+		size_t nBytes; //total size of blocks held
+		ThreadCache() : nBytes(0) {}
+		~ThreadCache();
+		
+		//Move blocks to the shared cache till at most nBytesTarget remain, preferring bins other than sizeKeep:
+		void trim(size_t nBytesTarget, size_t sizeKeep=0, bool threadExit=false)
+		{	for(int pass=0; pass<2; pass++)
+				for(auto& entry: bins)
+				{	if(nBytes <= nBytesTarget) return;
+					if((entry.first==sizeKeep) != (pass==1)) continue; //sizeKeep in second pass only
+					std::vector<void*>& bin = entry.second;
+					size_t nMove = std::min(bin.size(), (nBytes - nBytesTarget + entry.first - 1) / entry.first);
+					if(!nMove) continue;
+					sharedAdd(entry.first, bin.data() + (bin.size()-nMove), nMove, threadExit);
+					bin.resize(bin.size()-nMove);
+					nBytes -= nMove * entry.first;
+				}
+		}
+	};
+	static thread_local bool threadCacheDestroyed = false; //trivially destructible, so remains valid during thread exit
+	ThreadCache::~ThreadCache()
+	{	trim(0, 0, true);
+		threadCacheDestroyed = true;
+	}
+	
+	//Get this thread's cache (null once it has been destroyed during thread exit):
+	inline ThreadCache* threadCache()
+	{	if(threadCacheDestroyed) return 0;
+		static thread_local ThreadCache tc; //constructed on first use in each thread
+		return &tc;
+	}
+	
+	void* alloc(size_t nBytes)
+	{	size_t size = sizeClass(nBytes);
+		if(size > maxCachedSize()) //uncached
+		{	MEMCACHE_STATS(alloc(nBytes, size, false, false))
+			return MemPool::CPU().alloc(size);
+		}
+		ThreadCache* tc = threadCache();
+		//Try thread cache:
+		if(tc)
+		{	auto iter = tc->bins.find(size);
+			if(iter!=tc->bins.end() && iter->second.size())
+			{	void* ptr = iter->second.back();
+				iter->second.pop_back();
+				tc->nBytes -= size;
+				MEMCACHE_STATS(alloc(nBytes, size, true, true))
+				return ptr;
+			}
+		}
+		//Try shared cache, moving a batch of blocks into the thread cache to amortize the lock:
+		{	SharedCache& sc = shared();
+			std::lock_guard<std::mutex> lock(sc.lock);
+			auto iter = sc.bins.find(size);
+			if(iter!=sc.bins.end() && iter->second.size())
+			{	std::vector<void*>& bin = iter->second;
+				void* ptr = bin.back(); bin.pop_back();
+				sc.nBytes -= size;
+				if(tc)
+				{	size_t nMove = std::min(bin.size(), std::min(size_t(8), (memcacheSize/2) / size));
+					std::vector<void*>& tcBin = tc->bins[size];
+					tcBin.insert(tcBin.end(), bin.end()-nMove, bin.end());
+					bin.resize(bin.size()-nMove);
+					sc.nBytes -= nMove * size;
+					tc->nBytes += nMove * size;
+				}
+				MEMCACHE_STATS(alloc(nBytes, size, true, false))
+				return ptr;
+			}
+		}
+		//Allocate from pool (at the class size, so that the block can be reused for any size in its class):
+		MEMCACHE_STATS(alloc(nBytes, size, false, false))
+		return MemPool::CPU().alloc(size);
+	}
+	
+	void free(void* ptr, size_t nBytes)
+	{	size_t size = sizeClass(nBytes);
+		if(size > maxCachedSize()) //uncached
+		{	MEMCACHE_STATS(free(nBytes, size, false))
+			return MemPool::CPU().free(ptr);
+		}
+		MEMCACHE_STATS(free(nBytes, size, true))
+		ThreadCache* tc = threadCache();
+		if(!tc) { sharedAdd(size, &ptr, 1, true); return; } //thread exiting
+		tc->bins[size].push_back(ptr);
+		tc->nBytes += size;
+		if(tc->nBytes > memcacheSize) tc->trim(memcacheSize/2, size);
+	}
+	
+	void report()
+	{
+		#ifdef ENABLE_PROFILING
+		const double bytesToGB = 1./pow(1024.,3);
+		const Stats& s = stats();
+		size_t nAlloc = std::max(size_t(1), s.nAlloc.load());
+		logPrintf("MEMCACHE: %lu allocations: %.1lf%% from thread caches, %.1lf%% from shared cache\n",
+			s.nAlloc.load(), s.nThreadHits*100./nAlloc, s.nSharedHits*100./nAlloc);
+		logPrintf("MEMCACHE: size-class rounding overhead %.6lf GB of current usage %.6lf GB (peak %.6lf GB)\n",
+			(s.used-s.requested)*bytesToGB, s.used*bytesToGB, s.usedPeak*bytesToGB);
+		#endif
+	}
+	
+	void getCachedUsage(size_t& cached, size_t& cachedPeak, size_t& reservedPeak)
+	{
+		#ifdef ENABLE_PROFILING
+		const Stats& s = stats();
+		cached = s.cached; cachedPeak = s.cachedPeak; reservedPeak = s.reservedPeak;
+		#else
+		cached = cachedPeak = reservedPeak = 0;
+		#endif
+	}
+	#undef MEMCACHE_STATS
+}
+
+
 //---------- class ManagedMemoryBase -----------
 
 void ManagedMemoryBase::reportUsage()
 {	MemUsageReport::manager(MemUsageReport::Print);
+	MemCache::report();
+	MemPool::CPU().report("CPU");
+	#ifdef GPU_ENABLED
+	MemPool::GPU().report("GPU");
+	#endif
 }
 
 //Free memory
@@ -275,7 +507,7 @@ void ManagedMemoryBase::memFree()
 		assert(!"onGpu=true without GPU_ENABLED"); //Should never get here!
 		#endif
 	}
-	else MemPool::CPU().free(c);
+	else MemCache::free(c, nBytes);
 	MemUsageReport::manager(MemUsageReport::Remove, category, nBytes);
 	onGpu = false;
 	c = 0;
@@ -298,8 +530,9 @@ void ManagedMemoryBase::memInit(string category, size_t nBytes, bool onGpu)
 		assert(!"onGpu=true without GPU_ENABLED");
 		#endif
 	}
-	else c = MemPool::CPU().alloc(nBytes);
+	else c = MemCache::alloc(nBytes);
 	MemUsageReport::manager(MemUsageReport::Add, category, nBytes);
+	Profiler::addBytes(nBytes);
 }
 
 void ManagedMemoryBase::memMove(ManagedMemoryBase&& mOther)
@@ -316,7 +549,7 @@ void ManagedMemoryBase::toCpu() const
 #ifdef GPU_ENABLED
 	assert(isGpuMine());
 	ManagedMemoryBase& me = *((ManagedMemoryBase*)this);
-	void* cCpu = MemPool::CPU().alloc(nBytes);
+	void* cCpu = MemCache::alloc(nBytes);
 	cudaMemcpy(cCpu, me.c, nBytes, cudaMemcpyDeviceToHost);
 	MemPool::GPU().free(me.c); //Free GPU mem
 	me.c = cCpu; //Make c a cpu pointer
@@ -332,7 +565,7 @@ void ManagedMemoryBase::toGpu() const
 	ManagedMemoryBase& me = *((ManagedMemoryBase*)this);
 	void* cGpu = MemPool::GPU().alloc(nBytes);
 	cudaMemcpy(cGpu, me.c, nBytes, cudaMemcpyHostToDevice);
-	MemPool::CPU().free(me.c); //Free CPU mem
+	MemCache::free(me.c, nBytes); //Free CPU mem
 	me.c = cGpu; //Make c a gpu pointer
 	me.onGpu = true;
 #else
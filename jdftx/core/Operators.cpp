@@ -124,16 +124,22 @@ complexScalarFieldTilde O(const complexScalarFieldTilde& in) { return in * in->g
 complexScalarFieldTilde O(complexScalarFieldTilde&& in) { return in *= in->gInfo.detR; }
 
 
+static StopWatch watchFFT("FFT"); //shared by all the serial transforms below
+
 //Forward transform
 ScalarField I(ScalarFieldTilde&& in, int nThreads)
 {	//c2r transforms may destroy input, but this input can be destroyed
 	ScalarField out(ScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
+	watchFFT.start();
 	cufftExecZ2D(in->gInfo.planZ2D, (double2*)in->dataGpu(false), out->dataGpu(false));
+	watchFFT.stop();
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
+	watchFFT.start();
 	fftw_execute_dft_c2r(in->gInfo.getPlan(GridInfo::PlanCtoR, nThreads),
 		(fftw_complex*)in->data(false), out->data(false));
+	watchFFT.stop();
 	#endif
 	out->scale = in->scale;
 	return out;
@@ -145,11 +151,15 @@ ScalarField I(const ScalarFieldTilde& in, int nThreads)
 complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
 {	complexScalarField out(complexScalarFieldData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
+	watchFFT.start();
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_INVERSE);
+	watchFFT.stop();
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
+	watchFFT.start();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverse, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
+	watchFFT.stop();
 	#endif
 	out->scale = in->scale;
 	return out;
@@ -157,11 +167,15 @@ complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
 complexScalarField I(complexScalarFieldTilde&& in, int nThreads)
 {	//Destructible input (transform in place):
 	#ifdef GPU_ENABLED
+	watchFFT.start();
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_INVERSE);
+	watchFFT.stop();
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
+	watchFFT.start();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverseInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
+	watchFFT.stop();
 	#endif
 	return std::static_pointer_cast<complexScalarFieldData>(std::static_pointer_cast<FieldData<complex>>(in));
 }
@@ -171,11 +185,15 @@ ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 {	//r2c transform does not destroy input (no backing up needed)
 	ScalarFieldTilde out(ScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
+	watchFFT.start();
 	cufftExecD2Z(in->gInfo.planD2Z, in->dataGpu(false), (double2*)out->dataGpu(false));
+	watchFFT.stop();
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
+	watchFFT.start();
 	fftw_execute_dft_r2c(in->gInfo.getPlan(GridInfo::PlanRtoC, nThreads),
 		in->data(false), (fftw_complex*)out->data(false));
+	watchFFT.stop();
 	#endif
 	out->scale = in->scale;
 	return out;
@@ -183,11 +201,15 @@ ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
 {	complexScalarFieldTilde out(complexScalarFieldTildeData::alloc(in->gInfo, isGpuEnabled()));
 	#ifdef GPU_ENABLED
+	watchFFT.start();
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_FORWARD);
+	watchFFT.stop();
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
+	watchFFT.start();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForward, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
+	watchFFT.stop();
 	#endif
 	out->scale = in->scale;
 	return out;
@@ -195,11 +217,15 @@ complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
 complexScalarFieldTilde Idag(complexScalarField&& in, int nThreads)
 {	//Destructible input (transform in place):
 	#ifdef GPU_ENABLED
+	watchFFT.start();
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_FORWARD);
+	watchFFT.stop();
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
+	watchFFT.start();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForwardInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
+	watchFFT.stop();
 	#endif
 	return std::static_pointer_cast<complexScalarFieldTildeData>(std::static_pointer_cast<FieldData<complex>>(in));
 }
@@ -620,7 +646,9 @@ ScalarField exp(ScalarField&& X)
 	X->scale = 1.0;
 	return X;
 }
+#ifdef GPU_ENABLED
 ScalarField exp(const ScalarField& X) { return exp(X->clone()); }
+#endif
 
 void log_sub(size_t i, double* X, double prefac) { X[i] = log(prefac*X[i]); }
 #ifdef GPU_ENABLED
@@ -636,7 +664,9 @@ ScalarField log(ScalarField&& X)
 	X->scale = 1.0;
 	return X;
 }
+#ifdef GPU_ENABLED
 ScalarField log(const ScalarField& X) { return log(X->clone()); }
+#endif
 
 
 void sqrt_sub(size_t i, double* X, double prefac) { X[i] = sqrt(prefac*X[i]); }
@@ -653,7 +683,9 @@ ScalarField sqrt(ScalarField&& X)
 	X->scale = 1.0;
 	return X;
 }
+#ifdef GPU_ENABLED
 ScalarField sqrt(const ScalarField& X) { return sqrt(X->clone()); }
+#endif
 
 
 void inv_sub(size_t i, double* X, double prefac) { X[i] = prefac/X[i]; }
@@ -670,7 +702,9 @@ ScalarField inv(ScalarField&& X)
 	X->scale = 1.0;
 	return X;
 }
+#ifdef GPU_ENABLED
 ScalarField inv(const ScalarField& X) { return inv(X->clone()); }
+#endif
 
 void pow_sub(size_t i, double* X, double scale, double alpha) { X[i] = pow(scale*X[i],alpha); }
 #ifdef GPU_ENABLED
@@ -686,7 +720,9 @@ ScalarField pow(ScalarField&& X, double alpha)
 	X->scale = 1.0;
 	return X;
 }
+#ifdef GPU_ENABLED
 ScalarField pow(const ScalarField& X, double alpha) { return pow(X->clone(), alpha); }
+#endif
 
 
 //------------------------------ Multiplication operators------------------------------
@@ -734,17 +770,19 @@ ScalarField& operator+=(ScalarField& in, double scalar)
 	callPref(eblas_daxpy)(in->nElem, 1.0, dataScalar.dataPref(), 0, in->dataPref(), 1);
 	return in;
 }
-ScalarField operator+(double scalar, const ScalarField& in) { ScalarField out(in->clone()); return out += scalar; }
-ScalarField operator+(const ScalarField& in, double scalar) { ScalarField out(in->clone()); return out += scalar; }
 ScalarField operator+(double scalar, ScalarField&& in) { return in += scalar; }
 ScalarField operator+(ScalarField&& in, double scalar) { return in += scalar; }
 ScalarField& operator-=(ScalarField& in, double scalar)
 {	return (in += -scalar);
 }
-ScalarField operator-(double scalar, const ScalarField& in) { ScalarField out(in->clone()); return (out *= -1.0) += scalar; }
-ScalarField operator-(const ScalarField& in, double scalar) { ScalarField out(in->clone()); return out -= scalar; }
 ScalarField operator-(double scalar, ScalarField&& in) { return (in *= -1.0) += scalar; }
 ScalarField operator-(ScalarField&& in, double scalar) { return in -= scalar; }
+#ifdef GPU_ENABLED
+ScalarField operator+(double scalar, const ScalarField& in) { ScalarField out(in->clone()); return out += scalar; }
+ScalarField operator+(const ScalarField& in, double scalar) { ScalarField out(in->clone()); return out += scalar; }
+ScalarField operator-(double scalar, const ScalarField& in) { ScalarField out(in->clone()); return (out *= -1.0) += scalar; }
+ScalarField operator-(const ScalarField& in, double scalar) { ScalarField out(in->clone()); return out -= scalar; }
+#endif
 
 
 //------------------------------ Dot products and 2-norms ------------------------------
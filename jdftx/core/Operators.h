@@ -112,19 +112,18 @@ matrix3<> convolveStress(const RadialFunctionG& w, const ScalarFieldTilde& X, co
 
 //------------------------------ Nonlinear Unary operators ------------------------------
 
+//Versions preserving input are fused expressions in CPU builds (see ScalarFieldExpression.h)
+#ifdef GPU_ENABLED
 ScalarField exp(const ScalarField&); //!< Elementwise exponential (preserve input)
-ScalarField exp(ScalarField&&); //!< Elementwise exponential (destructible input)
-
 ScalarField log(const ScalarField&); //!< Elementwise logarithm (preserve input)
-ScalarField log(ScalarField&&); //!< Elementwise logarithm (destructible input)
-
 ScalarField sqrt(const ScalarField&); //!< Elementwise square root (preserve input)
-ScalarField sqrt(ScalarField&&); //!< Elementwise square root (destructible input)
-
 ScalarField inv(const ScalarField&); //!< Elementwise reciprocal (preserve input)
-ScalarField inv(ScalarField&&); //!< Elementwise reciprocal (destructible input)
-
 ScalarField pow(const ScalarField&, double alpha); //!< Elementwise power (preserve input)
+#endif
+ScalarField exp(ScalarField&&); //!< Elementwise exponential (destructible input)
+ScalarField log(ScalarField&&); //!< Elementwise logarithm (destructible input)
+ScalarField sqrt(ScalarField&&); //!< Elementwise square root (destructible input)
+ScalarField inv(ScalarField&&); //!< Elementwise reciprocal (destructible input)
 ScalarField pow(ScalarField&&, double alpha); //!< Elementwise power (destructible input)
 
 #define Tptr std::shared_ptr<T> //!< shorthand for writing the template operators (undef'd at end of header)
@@ -199,17 +198,22 @@ template<class T> Tptr operator-(Tptr&& in1, const Tptr& in2) { return in1 -= in
 template<class T> Tptr operator-(Tptr&& in1, Tptr&& in2) { return in1 -= in2; } //!< Subtract (destructible inputs)
 template<class T> Tptr operator-(const Tptr& in) { return (-1.0)*in; } //!< Negate
 template<class T> Tptr operator-(Tptr&& in) { return in*=(-1.0); } //!< Negate
-//Extra operators in R-space alone for scalar additions:
+//Extra operators in R-space alone for scalar additions (versions preserving input are fused expressions in CPU builds):
 ScalarField& operator+=(ScalarField&, double); //!< Increment by scalar
-ScalarField operator+(double, const ScalarField&); //!< Add scalar (preserve inputs)
-ScalarField operator+(const ScalarField&, double); //!< Add scalar (preserve inputs)
 ScalarField operator+(double, ScalarField&&); //!< Add scalar (destructible input)
 ScalarField operator+(ScalarField&&, double); //!< Add scalar (destructible input)
 ScalarField& operator-=(ScalarField&, double); //!< Decrement by scalar
-ScalarField operator-(double, const ScalarField&); //!< Subtract from scalar (preserve inputs)
-ScalarField operator-(const ScalarField&, double); //!< Subtract scalar (preserve inputs)
 ScalarField operator-(double, ScalarField&&); //!< Subtract from scalar (destructible input)
 ScalarField operator-(ScalarField&&, double); //!< Subtract scalar (destructible input)
+#ifdef GPU_ENABLED
+ScalarField operator+(double, const ScalarField&); //!< Add scalar (preserve inputs)
+ScalarField operator+(const ScalarField&, double); //!< Add scalar (preserve inputs)
+ScalarField operator-(double, const ScalarField&); //!< Subtract from scalar (preserve inputs)
+ScalarField operator-(const ScalarField&, double); //!< Subtract scalar (preserve inputs)
+#endif
+
+//Fused elementwise expressions of real-space scalar fields (CPU only):
+#include <core/ScalarFieldExpression.h>
 
 
 //------------------------------ Norms and dot products ------------------------------
@@ -0,0 +1,387 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/Profiler.h>
+#include <core/Util.h>
+#include <core/GpuUtil.h>
+#include <mutex>
+#include <map>
+
+#ifdef ENABLE_PROFILING
+bool Profiler::active = true;
+#else
+bool Profiler::active = false;
+#endif
+Profiler::Mode Profiler::mode = Profiler::ModeOff;
+string Profiler::traceFilename;
+
+namespace ProfilerPrivate
+{
+	//Open scope on a thread's stack:
+	struct Frame
+	{	const StopWatch* watch;
+		int path; //index into Registry::paths
+		double tStart; //clock_us() at start
+		size_t bytesStart; double tMPIstart; //thread totals at start
+	};
+	
+	//Completed scope instance (recorded only in ModeTrace):
+	struct Event
+	{	int path;
+		double tStart, tStop;
+		size_t bytes;
+	};
+	const size_t maxEvents = size_t(1) << 20; //per-thread limit on recorded trace events
+	
+	//Accumulated statistics of a path (times in microseconds):
+	struct PathStats
+	{	size_t nCalls; double T, Tsq, tMPI; size_t bytes;
+		PathStats() : nCalls(0), T(0.), Tsq(0.), tMPI(0.), bytes(0) {}
+	};
+	
+	//State of each thread, modified only by that thread. Its statistics are read by cycleEnd
+	//and finalize, which are called when worker threads are idle (between iterations / at exit).
+	struct ThreadState
+	{	int index; //order of first use (thread id in trace)
+		int basePath; //path under which outermost scopes nest (inherited from the caller in pool workers)
+		int mpiDepth; //number of open MPI scopes (only outermost one counts towards tMPI)
+		size_t bytes; //total bytes allocated by thread while active
+		double tMPI; //total MPI time of thread in microseconds
+		size_t nDropped; //events not recorded beyond maxEvents
+		std::vector<Frame> stack;
+		std::vector<Event> events;
+		std::map<std::pair<int,const StopWatch*>,int> pathCache; //paths looked up by this thread (avoids locking the registry)
+		std::vector<PathStats> stats; //statistics of scopes completed on this thread, indexed by path
+		ThreadState() : index(0), basePath(0), mpiDepth(0), bytes(0), tMPI(0.), nDropped(0) {}
+	};
+	
+	//Node in tree of scopes, identified by its parent path and watch:
+	struct Path : public PathStats
+	{	int parent; //-1 for root
+		const StopWatch* watch;
+		Path(int parent=-1, const StopWatch* watch=0) : parent(parent), watch(watch) {}
+	};
+	
+	struct Registry
+	{	std::mutex m;
+		std::multimap<string,const StopWatch*> watches; //all watches by name (for flat report)
+		std::vector<Path> paths; //paths[0] is the root
+		std::map<std::pair<int,const StopWatch*>,int> pathIndex;
+		std::vector<ThreadState*> threads; //never freed, so that trace includes threads that have exited
+		std::vector<Path> pathsPrev; double tPrev, tMPIprev; //state at previous cycleEnd
+		Registry() : paths(1), tPrev(0.), tMPIprev(0.) {}
+		
+		//Get index of path for watch within parent (call with m locked):
+		int getPath(int parent, const StopWatch* watch)
+		{	auto key = std::make_pair(parent, watch);
+			auto iter = pathIndex.find(key);
+			if(iter != pathIndex.end()) return iter->second;
+			int path = paths.size();
+			paths.push_back(Path(parent, watch));
+			pathIndex[key] = path;
+			return path;
+		}
+		
+		//Paths with statistics summed over threads (call with m locked):
+		std::vector<Path> mergedPaths() const
+		{	std::vector<Path> merged(paths.size());
+			for(size_t i=0; i<paths.size(); i++)
+			{	merged[i].parent = paths[i].parent;
+				merged[i].watch = paths[i].watch;
+			}
+			for(const ThreadState* ts: threads)
+				for(size_t i=0; i<ts->stats.size(); i++)
+				{	const PathStats& s = ts->stats[i];
+					Path& p = merged[i];
+					p.nCalls += s.nCalls;
+					p.T += s.T;
+					p.Tsq += s.Tsq;
+					p.tMPI += s.tMPI;
+					p.bytes += s.bytes;
+				}
+			return merged;
+		}
+	};
+	Registry& registry() { static Registry* reg = new Registry(); return *reg; } //never destroyed (may be used during static destruction)
+	
+	thread_local ThreadState* threadState = 0;
+	ThreadState& getThreadState()
+	{	if(!threadState)
+		{	ThreadState* ts = new ThreadState();
+			Registry& reg = registry();
+			std::lock_guard<std::mutex> lock(reg.m);
+			ts->index = reg.threads.size();
+			reg.threads.push_back(ts);
+			threadState = ts;
+		}
+		return *threadState;
+	}
+	
+	//Escape string for JSON output:
+	string jsonEscape(const string& s)
+	{	string out;
+		for(char c: s)
+		{	if(c=='"' || c=='\\') out += '\\';
+			if(c >= 0 && c < 32) continue; //drop control characters
+			out += c;
+		}
+		return out;
+	}
+	
+	//Write events of current process in Chrome trace format (each entry preceded by a comma):
+	string traceEvents(double tOffset)
+	{	Registry& reg = registry();
+		int pid = mpiWorld->iProcess();
+		ostringstream oss;
+		oss << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"process " << pid << "\"}}";
+		char buf[256];
+		for(const ThreadState* ts: reg.threads)
+		{	oss << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << ts->index
+				<< ",\"args\":{\"name\":\"thread " << ts->index << "\"}}";
+			for(const Event& event: ts->events)
+			{	const StopWatch* watch = reg.paths[event.path].watch;
+				sprintf(buf, "\"ph\":\"X\",\"ts\":%.3lf,\"dur\":%.3lf,\"pid\":%d,\"tid\":%d,\"args\":{\"bytes\":%zu}}",
+					event.tStart+tOffset, event.tStop-event.tStart, pid, ts->index, event.bytes);
+				oss << ",\n{\"name\":\"" << jsonEscape(watch->getName()) << "\",\"cat\":\"" << (watch->getIsMPI() ? "MPI" : "scope") << "\"," << buf;
+			}
+			if(ts->nDropped)
+				logPrintf("WARNING: profile trace dropped %zu events on thread %d beyond the limit of %zu per thread.\n", ts->nDropped, ts->index, maxEvents);
+		}
+		return oss.str();
+	}
+}
+
+void Profiler::setMode(Profiler::Mode mode, string traceFilename)
+{	using namespace ProfilerPrivate;
+	Profiler::mode = mode;
+	Profiler::traceFilename = traceFilename;
+	#ifndef ENABLE_PROFILING
+	active = (mode != ModeOff);
+	#endif
+	//Start first cycle now:
+	ThreadState& ts = getThreadState();
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.m);
+	reg.pathsPrev = reg.mergedPaths();
+	reg.tPrev = clock_us();
+	reg.tMPIprev = ts.tMPI;
+}
+
+int Profiler::currentPath()
+{	using namespace ProfilerPrivate;
+	ThreadState& ts = getThreadState();
+	return ts.stack.size() ? ts.stack.back().path : ts.basePath;
+}
+
+int Profiler::setBasePath(int path)
+{	using namespace ProfilerPrivate;
+	ThreadState& ts = getThreadState();
+	std::swap(ts.basePath, path);
+	return path;
+}
+
+void Profiler::addBytes(size_t nBytes)
+{	if(active) ProfilerPrivate::getThreadState().bytes += nBytes;
+}
+
+void Profiler::cycleEnd(const char* label, int iter)
+{	using namespace ProfilerPrivate;
+	if(mode == ModeOff) return;
+	ThreadState& ts = getThreadState();
+	Registry& reg = registry();
+	//Statistics of this cycle:
+	std::vector<Path> paths, pathsPrev;
+	double tCycle, tMPI;
+	{	std::lock_guard<std::mutex> lock(reg.m);
+		double tNow = clock_us();
+		tCycle = 1e-6*(tNow - reg.tPrev);
+		tMPI = 1e-6*(ts.tMPI - reg.tMPIprev);
+		paths = reg.mergedPaths();
+		std::swap(pathsPrev, reg.pathsPrev);
+		reg.pathsPrev = paths;
+		reg.tPrev = tNow;
+		reg.tMPIprev = ts.tMPI;
+	}
+	pathsPrev.resize(paths.size());
+	std::vector<bool> show(paths.size(), false); //paths with calls in this cycle, and their ancestors
+	for(size_t i=1; i<paths.size(); i++)
+	{	Path& p = paths[i];
+		const Path& pPrev = pathsPrev[i];
+		p.nCalls -= pPrev.nCalls;
+		p.T -= pPrev.T;
+		p.tMPI -= pPrev.tMPI;
+		p.bytes -= pPrev.bytes;
+		if(p.nCalls)
+			for(int j=i; j>0 && !show[j]; j=paths[j].parent)
+				show[j] = true;
+	}
+	std::vector<std::vector<int>> children(paths.size());
+	for(size_t i=1; i<paths.size(); i++)
+		if(show[i]) children[paths[i].parent].push_back(i);
+	//Spread over processes:
+	double tCycleMin = tCycle, tCycleMax = tCycle, tMPImin = tMPI, tMPImax = tMPI;
+	mpiWorld->allReduce(tCycleMin, MPIUtil::ReduceMin);
+	mpiWorld->allReduce(tCycleMax, MPIUtil::ReduceMax);
+	mpiWorld->allReduce(tMPImin, MPIUtil::ReduceMin);
+	mpiWorld->allReduce(tMPImax, MPIUtil::ReduceMax);
+	//Print tree (depth first):
+	logPrintf("\nPROFILE: %s cycle %d: %.3lf s (%.3lf to %.3lf s over processes), MPI %.3lf to %.3lf s\n",
+		label, iter, tCycle, tCycleMin, tCycleMax, tMPImin, tMPImax);
+	logPrintf("PROFILE: %-40s %8s %10s %6s %10s %10s\n", "scope", "calls", "time[s]", "%", "alloc[MB]", "MPI[s]");
+	std::vector<std::pair<int,int>> pending; //path and depth
+	for(auto iter=children[0].rbegin(); iter!=children[0].rend(); iter++) pending.push_back(std::make_pair(*iter, 0));
+	while(pending.size())
+	{	int i = pending.back().first;
+		int depth = pending.back().second;
+		pending.pop_back();
+		const Path& p = paths[i];
+		string name = string(2*depth, ' ') + p.watch->getName();
+		if(p.nCalls)
+			logPrintf("PROFILE: %-40s %8zu %10.4lf %6.1lf %10.1lf %10.4lf\n", name.c_str(), p.nCalls,
+				1e-6*p.T, 1e-4*p.T/tCycle, p.bytes/double(1<<20), 1e-6*p.tMPI);
+		else
+			logPrintf("PROFILE: %-40s %8s\n", name.c_str(), "(open)");
+		for(auto iter=children[i].rbegin(); iter!=children[i].rend(); iter++)
+			pending.push_back(std::make_pair(*iter, depth+1));
+	}
+	logPrintf("\n");
+}
+
+void Profiler::finalize(bool successful)
+{	using namespace ProfilerPrivate;
+	Registry& reg = registry();
+	if(active)
+	{	//Total statistics of each watch over all its paths and threads:
+		std::map<const StopWatch*,PathStats> watchStats;
+		{	std::lock_guard<std::mutex> lock(reg.m);
+			std::vector<Path> paths = reg.mergedPaths();
+			for(size_t i=1; i<paths.size(); i++)
+			{	const Path& p = paths[i];
+				PathStats& s = watchStats[p.watch];
+				s.nCalls += p.nCalls;
+				s.T += p.T;
+				s.Tsq += p.Tsq;
+			}
+		}
+		logPrintf("\n");
+		for(const auto& wPair: reg.watches)
+		{	const PathStats& s = watchStats[wPair.second];
+			if(s.nCalls)
+			{	double meanT = s.T/s.nCalls;
+				double sigmaT = sqrt(std::max(0., s.Tsq/s.nCalls - meanT*meanT));
+				logPrintf("PROFILER: %30s %12.6lf +/- %12.6lf s, %4zu calls, %13.6lf s total\n",
+					wPair.first.c_str(), meanT*1e-6, sigmaT*1e-6, s.nCalls, s.T*1e-6);
+			}
+		}
+	}
+	if(successful && mode==ModeTrace && traceFilename.length())
+	{	//Align clocks of processes using the epoch time at which clock_us() started:
+		timeval tv; gettimeofday(&tv, NULL);
+		double tZero = (double(tv.tv_sec)*1e6 + tv.tv_usec) - clock_us();
+		double tZeroMin = tZero; mpiWorld->allReduce(tZeroMin, MPIUtil::ReduceMin);
+		string events = traceEvents(tZero - tZeroMin);
+		//Collect on head and write:
+		if(mpiWorld->isHead())
+		{	logPrintf("Writing profile trace to '%s' ... ", traceFilename.c_str()); logFlush();
+			FILE* fp = fopen(traceFilename.c_str(), "w");
+			if(!fp) { logPrintf("failed to open file.\n"); }
+			for(int jProcess=1; jProcess<mpiWorld->nProcesses(); jProcess++)
+			{	string eventsProc;
+				mpiWorld->recv(eventsProc, jProcess, 0);
+				if(fp) events += eventsProc;
+			}
+			if(fp)
+			{	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[%s\n]}\n", events.c_str()+1); //skip leading comma
+				fclose(fp);
+				logPrintf("done.\n");
+			}
+		}
+		else mpiWorld->send(events, 0, 0);
+	}
+}
+
+//------------ class StopWatch ------------
+
+StopWatch::StopWatch(string name, bool isMPI) : name(name), isMPI(isMPI)
+{	ProfilerPrivate::Registry& reg = ProfilerPrivate::registry();
+	std::lock_guard<std::mutex> lock(reg.m);
+	reg.watches.insert(std::make_pair(name, this));
+}
+
+void StopWatch::startScope()
+{	using namespace ProfilerPrivate;
+	#ifdef GPU_ENABLED
+	cudaDeviceSynchronize();
+	#endif
+	ThreadState& ts = getThreadState();
+	int parent = ts.stack.size() ? ts.stack.back().path : ts.basePath;
+	Frame frame;
+	auto key = std::make_pair(parent, (const StopWatch*)this);
+	auto iter = ts.pathCache.find(key);
+	if(iter != ts.pathCache.end()) frame.path = iter->second;
+	else //first use of this path on this thread:
+	{	Registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.m);
+		frame.path = reg.getPath(parent, this);
+		ts.pathCache[key] = frame.path;
+	}
+	if(isMPI) ts.mpiDepth++;
+	frame.watch = this;
+	frame.bytesStart = ts.bytes;
+	frame.tMPIstart = ts.tMPI;
+	frame.tStart = clock_us();
+	ts.stack.push_back(frame);
+}
+
+void StopWatch::stopScope()
+{	using namespace ProfilerPrivate;
+	#ifdef GPU_ENABLED
+	cudaDeviceSynchronize();
+	#endif
+	double tStop = clock_us();
+	ThreadState& ts = getThreadState();
+	//Find matching frame (discarding any left open by inner watches):
+	int iFrame = int(ts.stack.size())-1;
+	while(iFrame>=0 && ts.stack[iFrame].watch != this) iFrame--;
+	if(iFrame < 0) return; //not started while active (eg. profiler switched on within this scope)
+	for(int j=int(ts.stack.size())-1; j>iFrame; j--)
+		if(ts.stack[j].watch->isMPI) ts.mpiDepth--;
+	Frame frame = ts.stack[iFrame];
+	ts.stack.resize(iFrame);
+	double T = tStop - frame.tStart;
+	if(isMPI && !(--ts.mpiDepth)) ts.tMPI += T; //only outermost MPI scope counts
+	size_t bytes = ts.bytes - frame.bytesStart;
+	//Accumulate statistics (on this thread, merged in cycleEnd and finalize):
+	if(size_t(frame.path) >= ts.stats.size()) ts.stats.resize(frame.path+1);
+	PathStats& s = ts.stats[frame.path];
+	s.nCalls++;
+	s.T += T;
+	s.Tsq += T*T;
+	s.tMPI += ts.tMPI - frame.tMPIstart;
+	s.bytes += bytes;
+	//Record event for trace:
+	if(Profiler::mode == Profiler::ModeTrace)
+	{	if(ts.events.size() < maxEvents)
+		{	Event event = { frame.path, frame.tStart, tStop, bytes };
+			ts.events.push_back(event);
+		}
+		else ts.nDropped++;
+	}
+}
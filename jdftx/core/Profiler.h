@@ -0,0 +1,83 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_PROFILER_H
+#define JDFTX_CORE_PROFILER_H
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file Profiler.h Runtime hierarchical profiler built on StopWatch scopes
+
+#include <core/string.h>
+
+//! Runtime profiler settings and reports (see command profile)
+namespace Profiler
+{
+	enum Mode
+	{	ModeOff, //!< no runtime profiling (only the flat exit report of ENABLE_PROFILING builds)
+		ModeSummary, //!< record nested scopes and print a summary table each cycle
+		ModeTrace //!< additionally record every scope instance for Chrome / Perfetto trace output
+	};
+	
+	extern bool active; //!< whether StopWatch scopes are recorded (always in ENABLE_PROFILING builds, else when mode != ModeOff)
+	extern Mode mode; //!< current runtime profiling mode
+	extern string traceFilename; //!< Chrome trace JSON output from all processes (written by head at exit in ModeTrace)
+	
+	void setMode(Mode mode, string traceFilename=string()); //!< switch runtime profiling mode (call identically on all processes)
+	
+	//! Scope path that newly started StopWatches on this thread will nest under.
+	//! Used to propagate the caller's scope to worker threads (see threadPoolRun).
+	int currentPath();
+	int setBasePath(int path); //!< set the path under which this thread's outermost scopes nest, returning the previous value
+	
+	void addBytes(size_t nBytes); //!< attribute an allocation of nBytes to the open scopes on this thread
+	
+	//! Print tree summary of all scopes completed since the previous call (or start), including
+	//! the spread of cycle and MPI times over processes. No-op if mode == ModeOff; otherwise collective.
+	void cycleEnd(const char* label, int iter);
+	
+	//! Print flat timings (if active) and write trace file (if successful and mode == ModeTrace; collective)
+	void finalize(bool successful);
+}
+
+//! Quick drop-in profiler for any function. Usage:
+//! * Create a static object of this class in the function
+//! * Call start and stop before and after the section to be timed
+//! * Timing statistics of the code block will be printed on exit (ENABLE_PROFILING builds),
+//!   and with command profile, watches started within other watches are reported as nested scopes.
+//! Recording is thread-safe, and costs only a flag check while the profiler is inactive.
+class StopWatch
+{
+public:
+	StopWatch(string name, bool isMPI=false); //!< isMPI marks communication / wait sections, whose time is reported as MPI time of enclosing scopes
+	inline void start() { if(Profiler::active) startScope(); }
+	inline void stop() { if(Profiler::active) stopScope(); }
+	const string& getName() const { return name; }
+	bool getIsMPI() const { return isMPI; }
+private:
+	string name;
+	bool isMPI;
+	void startScope();
+	void stopScope();
+};
+
+//! @}
+#endif // JDFTX_CORE_PROFILER_H
@@ -21,9 +21,11 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_CORE_PULAY_H
 
 #include <core/PulayParams.h>
+#include <core/PulayHistory.h>
 #include <core/matrix.h>
 #include <core/string.h>
 #include <cfloat>
+#include <memory>
 
 //! @addtogroup Algorithms
 //! @{
@@ -76,9 +78,16 @@ protected:
 
 private:
 	const PulayParams& pp; //!< Pulay parameters
-	std::vector<Variable> pastVariables; //!< Previous variables
-	std::vector<Variable> pastResiduals; //!< Previous residuals
+	std::vector<Variable> pastVariables; //!< Previous variables (only the most recent ones if pp.historyStorage != HistoryInMemory)
+	std::vector<Variable> pastResiduals; //!< Previous residuals (only the most recent ones if pp.historyStorage != HistoryInMemory)
+	std::shared_ptr<PulayHistory> storedVariables; //!< Older variables, if pp.historyStorage != HistoryInMemory
+	std::shared_ptr<PulayHistory> storedResiduals; //!< Older residuals, if pp.historyStorage != HistoryInMemory
 	matrix overlap; //!< Overlap matrix of residuals
+	
+	size_t nPast() const; //!< Number of past variables / residuals in history
+	Variable getPast(const std::vector<Variable>& past, const std::shared_ptr<PulayHistory>& stored, size_t j) const; //!< Get j'th entry of history (oldest first)
+	void archiveHistory(); //!< Move in-memory history to storedVariables and storedResiduals, if pp.historyStorage != HistoryInMemory
+	void removeOldest(); //!< Drop oldest entry of history
 };
 
 //! @}
@@ -87,7 +96,7 @@ private:
 //!@cond
 
 #include <core/Minimize.h>
-#include <memory>
+#include <cstdio>
 
 //Norm convergence check (eigenvalue-difference or residual)
 //Make sure value is within tolerance for nCheck consecutive cycles
@@ -131,11 +140,11 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 	{
 		//If history is full, remove oldest member
 		assert(pastResiduals.size() == pastVariables.size());
-		if((int)pastResiduals.size() >= pp.history)
-		{	size_t ndim = pastResiduals.size();
+		archiveHistory();
+		if((int)nPast() >= pp.history)
+		{	size_t ndim = nPast();
 			if(ndim>1) overlap.set(0,ndim-1, 0,ndim-1, overlap(1,ndim, 1,ndim));
-			pastVariables.erase(pastVariables.begin());
-			pastResiduals.erase(pastResiduals.begin());
+			removeOldest();
 		}
 		
 		//Cache the old energy and variables
@@ -195,10 +204,10 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 		//---- DIIS/Pulay mixing -----
 			
 		//Update the overlap matrix
-		size_t ndim = pastResiduals.size();
+		size_t ndim = nPast();
 		Variable MlastResidual = applyMetric(pastResiduals.back());
 		for(size_t j=0; j<ndim; j++)
-		{	double thisOverlap = dot(pastResiduals[j], MlastResidual);
+		{	double thisOverlap = dot(getPast(pastResiduals, storedResiduals, j), MlastResidual);
 			overlap.set(j, ndim-1, thisOverlap);
 			overlap.set(ndim-1, j, thisOverlap);
 		}
@@ -217,8 +226,8 @@ template<typename Variable> double Pulay<Variable>::minimize(double Eprev, std::
 		Variable v;
 		for(size_t j=0; j<ndim; j++)
 		{	double alpha = cOverlap_inv.data()[cOverlap_inv.index(j, ndim)].real();
-			axpy(alpha, pastVariables[j], v);
-			axpy(alpha, precondition(pastResiduals[j]), v);
+			axpy(alpha, getPast(pastVariables, storedVariables, j), v);
+			axpy(alpha, precondition(getPast(pastResiduals, storedResiduals, j)), v);
 		}
 		setVariable(v);
 	}
@@ -244,34 +253,32 @@ template<typename Variable> void Pulay<Variable>::loadState(const char* filename
 	if(nBytesFile % nBytesCycle != 0)
 		die("Pulay history file '%s' does not contain an integral multiple of the mixed variables and residuals.\n", filename);
 	fprintf(pp.fpLog, "%sReading %lu past variables and residuals from '%s' ... ", pp.linePrefix, ndim, filename); logFlush();
-	pastVariables.resize(ndim);
-	pastResiduals.resize(ndim);
+	clearState();
 	FILE* fp = fopen(filename, "r");
 	if(dimOffset) fseek(fp, dimOffset*nBytesCycle, SEEK_SET);
-	for(size_t idim=0; idim<ndim; idim++)
-	{	readVariable(pastVariables[idim], fp);
-		readVariable(pastResiduals[idim], fp);
-	}
-	fclose(fp);
-	fprintf(pp.fpLog, "done.\n"); fflush(pp.fpLog);
-	//Compute overlaps of loaded history:
 	for(size_t i=0; i<ndim; i++)
-	{	Variable Mresidual_i = applyMetric(pastResiduals[i]);
+	{	archiveHistory();
+		pastVariables.push_back(Variable()); readVariable(pastVariables.back(), fp);
+		pastResiduals.push_back(Variable()); readVariable(pastResiduals.back(), fp);
+		//Compute overlaps with previously loaded history:
+		Variable Mresidual_i = applyMetric(pastResiduals.back());
 		for(size_t j=0; j<=i; j++)
-		{	double thisOverlap = dot(pastResiduals[j], Mresidual_i);
+		{	double thisOverlap = dot(getPast(pastResiduals, storedResiduals, j), Mresidual_i);
 			overlap.set(i,j, thisOverlap);
 			overlap.set(j,i, thisOverlap);
 		}
 	}
+	fclose(fp);
+	fprintf(pp.fpLog, "done.\n"); fflush(pp.fpLog);
 }
 
 template<typename Variable> void Pulay<Variable>::saveState(const char* filename) const
 {
 	if(mpiWorld->isHead())
 	{	FILE* fp = fopen(filename, "w");
-		for(size_t idim=0; idim<pastVariables.size(); idim++)
-		{	writeVariable(pastVariables[idim], fp);
-			writeVariable(pastResiduals[idim], fp);
+		for(size_t idim=0; idim<nPast(); idim++)
+		{	writeVariable(getPast(pastVariables, storedVariables, idim), fp);
+			writeVariable(getPast(pastResiduals, storedResiduals, idim), fp);
 		}
 		fclose(fp);
 	}
@@ -280,6 +287,57 @@ template<typename Variable> void Pulay<Variable>::saveState(const char* filename
 template<typename Variable> void Pulay<Variable>::clearState()
 {	pastVariables.clear();
 	pastResiduals.clear();
+	if(storedVariables) storedVariables->clear();
+	if(storedResiduals) storedResiduals->clear();
+}
+
+template<typename Variable> size_t Pulay<Variable>::nPast() const
+{	return pastVariables.size() + (storedVariables ? storedVariables->size() : 0);
+}
+
+template<typename Variable> Variable Pulay<Variable>::getPast(const std::vector<Variable>& past, const std::shared_ptr<PulayHistory>& stored, size_t j) const
+{	size_t nStored = stored ? stored->size() : 0;
+	if(j >= nStored) return past[j-nStored];
+	//Deserialize from storage:
+	std::vector<char> buf;
+	stored->get(j, buf);
+	FILE* fp = fmemopen(buf.data(), buf.size(), "rb");
+	Variable result;
+	readVariable(result, fp);
+	fclose(fp);
+	return result;
+}
+
+template<typename Variable> void Pulay<Variable>::archiveHistory()
+{	if(pp.historyStorage == PulayParams::HistoryInMemory) return;
+	if(!storedVariables)
+	{	storedVariables = std::make_shared<PulayHistory>(pp.historyStorage, variableSize(), true); //differences from latest, for accurate mixing
+		storedResiduals = std::make_shared<PulayHistory>(pp.historyStorage, variableSize());
+	}
+	std::vector<char> buf(variableSize());
+	for(int iType=0; iType<2; iType++)
+	{	std::vector<Variable>& past = iType ? pastResiduals : pastVariables;
+		PulayHistory& stored = iType ? *storedResiduals : *storedVariables;
+		for(const Variable& X: past)
+		{	FILE* fp = fmemopen(buf.data(), buf.size(), "wb");
+			writeVariable(X, fp);
+			assert(size_t(ftell(fp)) == buf.size());
+			fclose(fp);
+			stored.push_back(buf);
+		}
+		past.clear();
+	}
+}
+
+template<typename Variable> void Pulay<Variable>::removeOldest()
+{	if(storedVariables && storedVariables->size())
+	{	storedVariables->pop_front();
+		storedResiduals->pop_front();
+	}
+	else
+	{	pastVariables.erase(pastVariables.begin());
+		pastResiduals.erase(pastResiduals.begin());
+	}
 }
 
 //!@endcond
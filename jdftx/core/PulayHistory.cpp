@@ -0,0 +1,123 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/PulayHistory.h>
+#include <core/Util.h>
+#include <cstdlib>
+#include <unistd.h>
+#include <algorithm>
+
+PulayHistory::PulayHistory(PulayParams::HistoryStorage storage, size_t nBytes, bool relative)
+: storage(storage), nBytes(nBytes), relative(relative), nSlots(0), fp(0)
+{	assert(storage != PulayParams::HistoryInMemory);
+	if(storage == PulayParams::HistorySinglePrecision)
+		assert(nBytes % sizeof(double) == 0);
+	if(storage == PulayParams::HistoryDisk)
+	{	const char* tmpDir = getenv("TMPDIR");
+		string filename = string((tmpDir && *tmpDir) ? tmpDir : "/tmp") + "/jdftxPulayXXXXXX";
+		std::vector<char> filenameBuf(filename.begin(), filename.end()); filenameBuf.push_back(0);
+		int fd = mkstemp(filenameBuf.data());
+		if(fd < 0) die("Could not create temporary file '%s' for Pulay history.\n", filename.c_str());
+		unlink(filenameBuf.data()); //file is removed automatically once closed
+		fp = fdopen(fd, "w+b");
+		if(!fp) die("Could not open temporary file for Pulay history.\n");
+	}
+}
+
+PulayHistory::~PulayHistory()
+{	if(fp) fclose(fp);
+}
+
+size_t PulayHistory::allocSlot()
+{	if(freeSlots.size())
+	{	size_t slot = freeSlots.back();
+		freeSlots.pop_back();
+		return slot;
+	}
+	if(storage == PulayParams::HistorySinglePrecision)
+		floatData.push_back(std::vector<float>(nBytes / sizeof(double)));
+	return nSlots++;
+}
+
+void PulayHistory::push_back(const std::vector<char>& buf)
+{	assert(buf.size() == nBytes);
+	size_t slot = allocSlot();
+	switch(storage)
+	{	case PulayParams::HistorySinglePrecision:
+		{	std::vector<float>& data = floatData[slot];
+			std::vector<double> x((const double*)buf.data(), (const double*)buf.data() + data.size());
+			convertFromLE(x.data(), sizeof(double), x.size());
+			if(relative)
+			{	//Rebase existing differences on the new entry, which becomes the reference:
+				if(ref.size())
+					for(size_t s: slots)
+						for(size_t i=0; i<x.size(); i++)
+							floatData[s][i] = float(floatData[s][i] + (ref[i] - x[i]));
+				ref.swap(x);
+				std::fill(data.begin(), data.end(), 0.f);
+			}
+			else
+				for(size_t i=0; i<data.size(); i++) data[i] = float(x[i]);
+			break;
+		}
+		case PulayParams::HistoryDisk:
+		{	fseeko(fp, off_t(slot)*nBytes, SEEK_SET);
+			if(fwrite(buf.data(), 1, nBytes, fp) < nBytes)
+				die("Error writing Pulay history to temporary file.\n");
+			break;
+		}
+		default: assert(!"Invalid history storage");
+	}
+	slots.push_back(slot);
+}
+
+void PulayHistory::get(size_t i, std::vector<char>& buf) const
+{	assert(i < slots.size());
+	size_t slot = slots[i];
+	buf.resize(nBytes);
+	switch(storage)
+	{	case PulayParams::HistorySinglePrecision:
+		{	const std::vector<float>& data = floatData[slot];
+			double* out = (double*)buf.data();
+			for(size_t j=0; j<data.size(); j++) out[j] = relative ? ref[j] + data[j] : data[j];
+			convertToLE(out, sizeof(double), data.size());
+			break;
+		}
+		case PulayParams::HistoryDisk:
+		{	fseeko(fp, off_t(slot)*nBytes, SEEK_SET);
+			if(fread(buf.data(), 1, nBytes, fp) < nBytes)
+				die("Error reading Pulay history from temporary file.\n");
+			break;
+		}
+		default: assert(!"Invalid history storage");
+	}
+}
+
+void PulayHistory::pop_front()
+{	assert(slots.size());
+	freeSlots.push_back(slots.front());
+	slots.pop_front();
+}
+
+void PulayHistory::clear()
+{	freeSlots.insert(freeSlots.end(), slots.begin(), slots.end());
+	slots.clear();
+	ref.clear();
+}
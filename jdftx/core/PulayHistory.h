@@ -0,0 +1,65 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_PULAYHISTORY_H
+#define JDFTX_CORE_PULAYHISTORY_H
+
+#include <core/PulayParams.h>
+#include <vector>
+#include <deque>
+
+//! @addtogroup Algorithms
+//! @{
+
+//! @brief Serialized past variables or residuals of Pulay, stored in reduced precision or on disk.
+//! Entries are byte buffers in the little-endian binary format of Pulay::writeVariable,
+//! which must consist entirely of doubles for HistorySinglePrecision.
+//! With relative=true, HistorySinglePrecision keeps the most recently added entry in double precision
+//! and the others as single-precision differences from it, so that their error is relative to their
+//! distance from the latest entry (which vanishes at convergence) rather than to their magnitude.
+//! Use this for variables; residuals can be stored directly since they vanish at convergence themselves.
+class PulayHistory
+{
+public:
+	PulayHistory(PulayParams::HistoryStorage storage, size_t nBytes, bool relative=false); //!< Initialize storage for entries of nBytes each
+	~PulayHistory();
+	
+	size_t size() const { return slots.size(); } //!< Number of stored entries
+	void push_back(const std::vector<char>& buf); //!< Append an entry (buf must contain nBytes)
+	void get(size_t i, std::vector<char>& buf) const; //!< Retrieve entry i (oldest first) into buf (resized to nBytes)
+	void pop_front(); //!< Remove the oldest entry
+	void clear(); //!< Remove all entries
+	
+private:
+	const PulayParams::HistoryStorage storage;
+	const size_t nBytes; //!< size of each entry in bytes
+	const bool relative; //!< whether single-precision entries are differences from ref
+	std::deque<size_t> slots; //!< storage slot of each entry, in order of age
+	std::vector<size_t> freeSlots; //!< slots freed by removed entries, available for reuse
+	size_t nSlots; //!< total slots allocated so far
+	std::vector<std::vector<float>> floatData; //!< single-precision data for each slot (HistorySinglePrecision)
+	std::vector<double> ref; //!< most recently added entry (HistorySinglePrecision with relative=true)
+	FILE* fp; //!< temporary file containing each slot at offset slot*nBytes (HistoryDisk)
+	
+	size_t allocSlot(); //!< get a free slot, allocating a new one if necessary
+};
+
+//! @}
+#endif //JDFTX_CORE_PULAYHISTORY_H
@@ -41,10 +41,18 @@ struct PulayParams
 	double mixFraction;  //!< Mixing fraction for total density / potential
 	double qMetric; //!< Wavevector controlling the metric for overlaps
 	
+	//! Storage of past variables and residuals (other than the most recent ones, which are always kept in memory)
+	enum HistoryStorage
+	{	HistoryInMemory, //!< Full-precision copies in memory
+		HistorySinglePrecision, //!< Single-precision residuals and variable differences from the latest variable in memory (about half the memory)
+		HistoryDisk //!< Full-precision copies in an unlinked temporary file (in $TMPDIR, or /tmp if unset)
+	}
+	historyStorage; //!< Storage of past variables and residuals (default: HistoryInMemory)
+	
 	PulayParams()
 	: fpLog(stdout), linePrefix("Pulay: "), energyLabel("E"), energyFormat("%22.15le"),
 		nIterations(50), energyDiffThreshold(1e-8), residualThreshold(1e-7),
-		history(10), mixFraction(0.5), qMetric(0.8)
+		history(10), mixFraction(0.5), qMetric(0.8), historyStorage(HistoryInMemory)
 	{
 	}
 };
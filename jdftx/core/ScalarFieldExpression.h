@@ -0,0 +1,246 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_SCALARFIELDEXPRESSION_H
+#define JDFTX_CORE_SCALARFIELDEXPRESSION_H
+
+//! @addtogroup Operators
+//! @{
+
+/** @file ScalarFieldExpression.h
+@brief Fused (lazily evaluated) elementwise arithmetic on real-space #ScalarField's
+
+In CPU builds, elementwise arithmetic between #ScalarField's (+, -, *, with each other and with scalars)
+and the elementwise functions exp, log, sqrt, inv and pow of #ScalarField's do not evaluate immediately.
+Instead, they build an expression which is evaluated in a single threaded pass over the grid when it is
+converted to a #ScalarField, accumulated into one (+=, -=, *=), or reduced by sum(), integral() or dot().
+A chain such as `ScalarField y = a*exp(-b) + 0.5*c*c` therefore allocates only y and makes one memory pass.
+Operations on destructible (rvalue) #ScalarField's retain their in-place eager versions in Operators.h.
+
+Expressions reference their operand data, so they must be used within the full-expression
+that creates them (i.e. never store them in an `auto` variable). As with axpy(), null operands are treated as zero.
+GPU builds use the eager operators in Operators.h instead.
+*/
+
+#ifndef GPU_ENABLED
+
+#include <core/ScalarField.h>
+#include <core/Thread.h>
+#include <cmath>
+
+//! Base class (CRTP) of all lazily-evaluated elementwise expressions of real-space scalar fields
+template<typename E> struct ScalarFieldExpr
+{	const E& self() const { return static_cast<const E&>(*this); } //!< the derived expression
+	operator ScalarField() const; //!< evaluate into a newly allocated ScalarField
+};
+
+//! Expression leaf referencing the data of a ScalarField (with its pending scale factor)
+struct ScalarFieldExprLeaf : public ScalarFieldExpr<ScalarFieldExprLeaf>
+{	const double* data; //!< data pointer (null for a null ScalarField, which is treated as zero)
+	double scale; //!< pending scale factor of the ScalarField
+	const GridInfo* gInfo; //!< grid of the ScalarField (null for a null ScalarField)
+	ScalarFieldExprLeaf(const ScalarField& X) : data(X ? X->data(false) : 0), scale(X ? X->scale : 0.), gInfo(X ? &X->gInfo : 0) {}
+	const GridInfo* getGrid() const { return gInfo; }
+	double operator[](size_t i) const { return data ? scale*data[i] : 0.; }
+};
+
+//! Expression leaf for a scalar constant
+struct ScalarFieldExprConst : public ScalarFieldExpr<ScalarFieldExprConst>
+{	double value;
+	ScalarFieldExprConst(double value) : value(value) {}
+	const GridInfo* getGrid() const { return 0; }
+	double operator[](size_t i) const { return value; }
+};
+
+//! Elementwise unary function of an expression
+template<typename Op, typename A> struct ScalarFieldExprUnary : public ScalarFieldExpr<ScalarFieldExprUnary<Op,A>>
+{	Op op; A a;
+	ScalarFieldExprUnary(const Op& op, const A& a) : op(op), a(a) {}
+	const GridInfo* getGrid() const { return a.getGrid(); }
+	double operator[](size_t i) const { return op(a[i]); }
+};
+
+//! Elementwise binary operation between expressions
+template<typename Op, typename A, typename B> struct ScalarFieldExprBinary : public ScalarFieldExpr<ScalarFieldExprBinary<Op,A,B>>
+{	A a; B b;
+	ScalarFieldExprBinary(const A& a, const B& b) : a(a), b(b) {}
+	const GridInfo* getGrid() const { const GridInfo* g = a.getGrid(); return g ? g : b.getGrid(); }
+	double operator[](size_t i) const { return Op::apply(a[i], b[i]); }
+};
+
+//! Elementwise operations used in expressions
+namespace ScalarFieldExprOps
+{	struct Add { static double apply(double a, double b) { return a + b; } };
+	struct Sub { static double apply(double a, double b) { return a - b; } };
+	struct Mul { static double apply(double a, double b) { return a * b; } };
+	struct Neg { double operator()(double x) const { return -x; } };
+	struct Exp { double operator()(double x) const { return std::exp(x); } };
+	struct Log { double operator()(double x) const { return std::log(x); } };
+	struct Sqrt { double operator()(double x) const { return std::sqrt(x); } };
+	struct Inv { double operator()(double x) const { return 1./x; } };
+	struct Pow { double alpha; double operator()(double x) const { return std::pow(x, alpha); } };
+}
+
+//!@cond
+namespace ScalarFieldExprPrivate
+{	//Convert operands to expression nodes:
+	inline ScalarFieldExprLeaf node(const ScalarField& X) { return ScalarFieldExprLeaf(X); }
+	inline ScalarFieldExprConst node(double x) { return ScalarFieldExprConst(x); }
+	template<typename E> const E& node(const ScalarFieldExpr<E>& e) { return e.self(); }
+	template<typename T> struct Node { typedef decltype(node(std::declval<T>())) RefType; typedef typename std::decay<RefType>::type type; };
+
+	template<typename Op, typename A, typename B> ScalarFieldExprBinary<Op, typename Node<A>::type, typename Node<B>::type> binary(const A& a, const B& b)
+	{	return ScalarFieldExprBinary<Op, typename Node<A>::type, typename Node<B>::type>(node(a), node(b));
+	}
+	template<typename Op, typename A> ScalarFieldExprUnary<Op, typename Node<A>::type> unary(const A& a, const Op& op=Op())
+	{	return ScalarFieldExprUnary<Op, typename Node<A>::type>(op, node(a));
+	}
+
+	//Evaluate expression into output array (local copy of expression lets the compiler keep leaf pointers in registers):
+	template<typename E> void evaluate_sub(size_t iStart, size_t iStop, const E* expr, double* out)
+	{	const E e(*expr);
+		for(size_t i=iStart; i<iStop; i++) out[i] = e[i];
+	}
+	template<typename E> void evaluate(const E& expr, ScalarField& X)
+	{	threadLaunch(evaluate_sub<E>, X->nElem, &expr, X->data(false));
+		X->scale = 1.;
+	}
+
+	//Sum over fixed-size blocks (so that the result does not depend on the number of threads):
+	static const size_t sumBlockSize = 4096;
+	template<typename E> void sum_sub(size_t iBlockStart, size_t iBlockStop, const E* expr, size_t nElem, double* blockSums)
+	{	const E e(*expr);
+		for(size_t iBlock=iBlockStart; iBlock<iBlockStop; iBlock++)
+		{	size_t iStop = std::min(nElem, (iBlock+1)*sumBlockSize);
+			double blockSum = 0.;
+			for(size_t i=iBlock*sumBlockSize; i<iStop; i++) blockSum += e[i];
+			blockSums[iBlock] = blockSum;
+		}
+	}
+	template<typename E> double sum(const E& expr)
+	{	const GridInfo* gInfo = expr.getGrid(); assert(gInfo);
+		size_t nElem = gInfo->nr;
+		size_t nBlocks = (nElem + sumBlockSize - 1) / sumBlockSize;
+		std::vector<double> blockSums(nBlocks);
+		threadLaunch(sum_sub<E>, nBlocks, &expr, nElem, blockSums.data());
+		double result = 0.;
+		for(double blockSum: blockSums) result += blockSum;
+		return result;
+	}
+
+	//Type checks for enabling operators:
+	template<typename T> struct IsOperand
+	{	typedef typename std::decay<T>::type D;
+		template<typename E> static std::true_type check(const ScalarFieldExpr<E>*);
+		static std::false_type check(...);
+		static const bool isExpr = decltype(check((D*)0))::value;
+		static const bool value = isExpr or std::is_same<D,ScalarField>::value;
+	};
+	//Enable binary operator for (ScalarField or expression) with (ScalarField, expression or scalar), excluding (ScalarField, ScalarField/scalar),
+	//which are declared explicitly below so as to participate in overload resolution against the eager template versions in Operators.h
+	template<typename A, typename B> struct EnableBinary
+	{	static const bool value = (IsOperand<A>::isExpr and (IsOperand<B>::value or std::is_arithmetic<B>::value))
+			or (IsOperand<B>::isExpr and (IsOperand<A>::value or std::is_arithmetic<A>::value));
+	};
+	//Result type of enabled binary operators (undefined otherwise, so that the operators drop out of overload resolution):
+	template<typename Op, typename A, typename B, bool enable=EnableBinary<A,B>::value> struct BinaryResult {};
+	template<typename Op, typename A, typename B> struct BinaryResult<Op,A,B,true>
+	{	typedef ScalarFieldExprBinary<Op, typename Node<A>::type, typename Node<B>::type> type;
+	};
+}
+//!@endcond
+
+template<typename E> ScalarFieldExpr<E>::operator ScalarField() const
+{	const GridInfo* gInfo = self().getGrid(); assert(gInfo);
+	ScalarField X(ScalarFieldData::alloc(*gInfo));
+	ScalarFieldExprPrivate::evaluate(self(), X);
+	return X;
+}
+
+#define SFE_ENABLE_BINARY(Op) typename ScalarFieldExprPrivate::BinaryResult<ScalarFieldExprOps::Op,A,B>::type
+
+//------------------------------ Arithmetic operators ------------------------------
+
+//Between ScalarField's and scalars (destructible ScalarField's instead use the in-place versions in Operators.h):
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Add,ScalarFieldExprLeaf,ScalarFieldExprLeaf> operator+(const ScalarField& a, const ScalarField& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Add>(a, b); } //!< Add
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Sub,ScalarFieldExprLeaf,ScalarFieldExprLeaf> operator-(const ScalarField& a, const ScalarField& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Sub>(a, b); } //!< Subtract
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Mul,ScalarFieldExprLeaf,ScalarFieldExprLeaf> operator*(const ScalarField& a, const ScalarField& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Mul>(a, b); } //!< Elementwise multiply
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Add,ScalarFieldExprLeaf,ScalarFieldExprConst> operator+(const ScalarField& a, double b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Add>(a, b); } //!< Add scalar
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Add,ScalarFieldExprConst,ScalarFieldExprLeaf> operator+(double a, const ScalarField& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Add>(a, b); } //!< Add scalar
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Sub,ScalarFieldExprLeaf,ScalarFieldExprConst> operator-(const ScalarField& a, double b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Sub>(a, b); } //!< Subtract scalar
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Sub,ScalarFieldExprConst,ScalarFieldExprLeaf> operator-(double a, const ScalarField& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Sub>(a, b); } //!< Subtract from scalar
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Mul,ScalarFieldExprLeaf,ScalarFieldExprConst> operator*(const ScalarField& a, double b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Mul>(a, b); } //!< Scalar multiply
+inline ScalarFieldExprBinary<ScalarFieldExprOps::Mul,ScalarFieldExprConst,ScalarFieldExprLeaf> operator*(double a, const ScalarField& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Mul>(a, b); } //!< Scalar multiply
+inline ScalarFieldExprUnary<ScalarFieldExprOps::Neg,ScalarFieldExprLeaf> operator-(const ScalarField& a) { return ScalarFieldExprPrivate::unary<ScalarFieldExprOps::Neg>(a); } //!< Negate
+
+//Involving at least one expression:
+template<typename A, typename B> SFE_ENABLE_BINARY(Add) operator+(const A& a, const B& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Add>(a, b); } //!< Add
+template<typename A, typename B> SFE_ENABLE_BINARY(Sub) operator-(const A& a, const B& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Sub>(a, b); } //!< Subtract
+template<typename A, typename B> SFE_ENABLE_BINARY(Mul) operator*(const A& a, const B& b) { return ScalarFieldExprPrivate::binary<ScalarFieldExprOps::Mul>(a, b); } //!< Elementwise / scalar multiply
+template<typename E> ScalarFieldExprUnary<ScalarFieldExprOps::Neg,E> operator-(const ScalarFieldExpr<E>& a) { return ScalarFieldExprPrivate::unary<ScalarFieldExprOps::Neg>(a); } //!< Negate
+
+#undef SFE_ENABLE_BINARY
+
+//------------------------------ Nonlinear elementwise functions ------------------------------
+
+#define SFE_UNARY_FUNC(func, Op) \
+	inline ScalarFieldExprUnary<ScalarFieldExprOps::Op,ScalarFieldExprLeaf> func(const ScalarField& a) { return ScalarFieldExprPrivate::unary<ScalarFieldExprOps::Op>(a); } \
+	template<typename E> ScalarFieldExprUnary<ScalarFieldExprOps::Op,E> func(const ScalarFieldExpr<E>& a) { return ScalarFieldExprPrivate::unary<ScalarFieldExprOps::Op>(a); }
+SFE_UNARY_FUNC(exp, Exp) //!< Elementwise exponential
+SFE_UNARY_FUNC(log, Log) //!< Elementwise logarithm
+SFE_UNARY_FUNC(sqrt, Sqrt) //!< Elementwise square root
+SFE_UNARY_FUNC(inv, Inv) //!< Elementwise reciprocal
+#undef SFE_UNARY_FUNC
+inline ScalarFieldExprUnary<ScalarFieldExprOps::Pow,ScalarFieldExprLeaf> pow(const ScalarField& a, double alpha) { return ScalarFieldExprPrivate::unary(a, ScalarFieldExprOps::Pow{alpha}); } //!< Elementwise power
+template<typename E> ScalarFieldExprUnary<ScalarFieldExprOps::Pow,E> pow(const ScalarFieldExpr<E>& a, double alpha) { return ScalarFieldExprPrivate::unary(a, ScalarFieldExprOps::Pow{alpha}); } //!< Elementwise power
+
+//------------------------------ Accumulation into ScalarField's ------------------------------
+
+//! Increment by expression in a single pass (a null X is treated as zero)
+template<typename E> ScalarField& operator+=(ScalarField& X, const ScalarFieldExpr<E>& e)
+{	if(!X) X = e;
+	else ScalarFieldExprPrivate::evaluate(ScalarFieldExprLeaf(X) + e, X);
+	return X;
+}
+//! Decrement by expression in a single pass (a null X is treated as zero)
+template<typename E> ScalarField& operator-=(ScalarField& X, const ScalarFieldExpr<E>& e)
+{	if(!X) X = -e;
+	else ScalarFieldExprPrivate::evaluate(ScalarFieldExprLeaf(X) - e, X);
+	return X;
+}
+//! Elementwise multiply by expression in a single pass
+template<typename E> ScalarField& operator*=(ScalarField& X, const ScalarFieldExpr<E>& e)
+{	ScalarFieldExprPrivate::evaluate(ScalarFieldExprLeaf(X) * e, X);
+	return X;
+}
+//! Linear combine Y += alpha * e in a single pass (a null Y is treated as zero)
+template<typename E> void axpy(double alpha, const ScalarFieldExpr<E>& e, ScalarField& Y) { Y += alpha * e; }
+
+//------------------------------ Fused reductions ------------------------------
+
+template<typename E> double sum(const ScalarFieldExpr<E>& e) { return ScalarFieldExprPrivate::sum(e.self()); } //!< Sum of elements
+template<typename E> double integral(const ScalarFieldExpr<E>& e) { return e.self().getGrid()->dV * sum(e); } //!< Integral in the unit cell (dV times sum())
+template<typename E> double dot(const ScalarFieldExpr<E>& X, const ScalarField& Y) { return sum(X * Y); } //!< Inner product
+template<typename E> double dot(const ScalarField& X, const ScalarFieldExpr<E>& Y) { return sum(X * Y); } //!< Inner product
+template<typename E1, typename E2> double dot(const ScalarFieldExpr<E1>& X, const ScalarFieldExpr<E2>& Y) { return sum(X * Y); } //!< Inner product
+
+#endif //GPU_ENABLED
+
+//! @}
+#endif //JDFTX_CORE_SCALARFIELDEXPRESSION_H
@@ -28,6 +28,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ScalarField.h>
 #include <core/vector3.h>
 #include <core/Util.h>
+#include <core/AsyncWrite.h>
 
 #define Tptr std::shared_ptr<T>
 
@@ -44,6 +45,16 @@ template<typename T> void saveRawBinary(const Tptr& X, const char* filename)
 	fclose(fp);
 }
 
+//! Save the data in raw binary format to file from the background I/O thread (see asyncWrite),
+//! working on a snapshot so that X may be modified as soon as this returns
+template<typename T> void saveRawBinaryAsync(const Tptr& X, const char* filename)
+{	if(!asyncWriteEnabled) { saveRawBinary(X, filename); return; }
+	Tptr snapshot(X->clone());
+	snapshot->data(); //fetch to CPU on the calling thread
+	string fname(filename);
+	asyncWrite([snapshot, fname]() { saveRawBinary(snapshot, fname.c_str()); }, snapshot->nElem * sizeof(typename T::DataType));
+}
+
 //! Load the data in raw binary format from stream
 template<typename T> void loadRawBinary(Tptr& X, FILE* fp)
 {	int nRead = freadLE(X->data(), sizeof(typename T::DataType), X->nElem, fp);
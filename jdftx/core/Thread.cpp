@@ -18,6 +18,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 -------------------------------------------------------------------*/
 
 #include <core/Thread.h>
+#include <core/Profiler.h>
 
 #include <float.h>
 #include <string.h>
@@ -41,19 +42,36 @@ int getPhysicalCores()
 int nProcsAvailable = getPhysicalCores();
 bool threadOperators = true;
 
+namespace ThreadPoolPrivate { class ThreadPool; }
+
+//Operator threading state of a thread leading a team within threadTeamLaunch
+struct ThreadTeamState
+{	int nThreads; //number of threads available to the team
+	bool threadOperators; //team-local version of the global threadOperators
+	ThreadPoolPrivate::ThreadPool* pool; //thread pool private to this team
+};
+static thread_local ThreadTeamState* teamState = 0; //null when not leading a team
+
 bool shouldThreadOperators()
-{	return threadOperators;
+{	return teamState ? teamState->threadOperators : threadOperators;
+}
+
+int nOperatorThreads()
+{	if(!shouldThreadOperators()) return 1;
+	return teamState ? teamState->nThreads : nProcsAvailable;
 }
 
 void suspendOperatorThreading()
-{	threadOperators = false;
+{	if(teamState) { teamState->threadOperators = false; return; } //workers of team pools already see global threading suspended
+	threadOperators = false;
 	#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 	mkl_set_num_threads(1);
 	#endif
 }
 
 void resumeOperatorThreading()
-{	threadOperators = true;
+{	if(teamState) { teamState->threadOperators = true; return; }
+	threadOperators = true;
 	#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 	mkl_set_num_threads(nProcsAvailable);
 	mkl_free_buffers();
@@ -62,3 +80,226 @@ void resumeOperatorThreading()
 	#endif
 	#endif
 }
+
+//---------------------- Persistent thread pool ---------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool threadPoolEnabled = true;
+int threadPoolChunksPerThread = 4;
+int threadPoolPinOffset = -1;
+
+namespace ThreadPoolPrivate
+{
+	//Chunk range owned by one participating thread (padded to avoid false sharing):
+	struct alignas(64) ChunkQueue
+	{	std::atomic<size_t> next; //next unclaimed chunk
+		size_t stop; //end of chunk range
+	};
+	
+	//Initialize chunk ranges for nThreads participants:
+	void initQueues(ChunkQueue* queues, int nThreads, size_t nChunks)
+	{	for(int t=0; t<nThreads; t++)
+		{	queues[t].next = (t*nChunks)/nThreads;
+			queues[t].stop = ((t+1)*nChunks)/nThreads;
+		}
+	}
+	
+	//Process own chunks of thread iThread, and then steal from the others:
+	void processChunks(ChunkQueue* queues, int nThreads, int iThread, ThreadPoolJob job, void* context)
+	{	for(int k=0; k<nThreads; k++)
+		{	ChunkQueue& q = queues[(iThread+k) % nThreads];
+			while(true)
+			{	size_t iChunk = q.next.fetch_add(1, std::memory_order_relaxed);
+				if(iChunk >= q.stop) break;
+				job(context, iChunk);
+			}
+		}
+	}
+	
+	//Pin current thread to the iCore'th core amongst those available to the process:
+	void pinThread(int iCore)
+	{
+		#ifdef __linux__
+		cpu_set_t available; CPU_ZERO(&available);
+		if(sched_getaffinity(0, sizeof(cpu_set_t), &available)) return;
+		int nAvailable = CPU_COUNT(&available);
+		if(!nAvailable) return;
+		iCore = iCore % nAvailable;
+		for(int cpu=0; cpu<CPU_SETSIZE; cpu++)
+			if(CPU_ISSET(cpu, &available) && !(iCore--))
+			{	cpu_set_t target; CPU_ZERO(&target); CPU_SET(cpu, &target);
+				pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &target);
+				return;
+			}
+		#endif
+	}
+	
+	class ThreadPool
+	{
+	public:
+		ThreadPool(int pinBase=0) : pinBase(pinBase), generation(0), busy(false), stopping(false), nPending(0), nActive(0), job(0), context(0) {}
+		
+		//Stop and join workers (only used for team pools; the global pool lives till program exit)
+		~ThreadPool()
+		{	{	std::lock_guard<std::mutex> lock(m);
+				stopping = true;
+				generation++;
+			}
+			cvStart.notify_all();
+			for(std::thread& t: workers) t.join();
+		}
+		
+		//Run job using the pool; return false without doing anything if pool is in use
+		bool run(int nThreads, size_t nChunks, ThreadPoolJob job, void* context)
+		{	if(busy.exchange(true)) return false; //pool in use by a nested or concurrent launch
+			//Grow pool if needed:
+			while(int(workers.size()) < nThreads-1)
+				workers.push_back(std::thread(&ThreadPool::worker, this, int(workers.size())));
+			if(int(queues.size()) < nThreads)
+				queues = std::vector<ChunkQueue>(nThreads);
+			initQueues(queues.data(), nThreads, nChunks);
+			//Signal workers:
+			{	std::lock_guard<std::mutex> lock(m);
+				this->job = job;
+				this->context = context;
+				nActive = nThreads;
+				nPending = nThreads-1;
+				generation++;
+			}
+			cvStart.notify_all();
+			//Participate in the job, and wait for workers to finish:
+			processChunks(queues.data(), nThreads, 0, job, context);
+			for(int spin=0; spin<spinCount && nPending.load(); spin++)
+				std::this_thread::yield();
+			{	std::unique_lock<std::mutex> lock(m);
+				cvDone.wait(lock, [this]{ return !nPending.load(); });
+			}
+			busy = false;
+			return true;
+		}
+		
+	private:
+		static const int spinCount = 1000; //number of yields before blocking while waiting
+		const int pinBase; //offset of this pool's threads within the available cores (for pinning)
+		std::vector<std::thread> workers;
+		std::vector<ChunkQueue> queues;
+		std::mutex m;
+		std::condition_variable cvStart, cvDone;
+		std::atomic<size_t> generation; //incremented for each job
+		std::atomic<bool> busy; //whether a job is currently running
+		std::atomic<bool> stopping; //whether workers should exit
+		std::atomic<int> nPending; //number of workers yet to finish current job
+		int nActive; //number of threads (including caller) in current job
+		ThreadPoolJob job; void* context; //current job
+		
+		void worker(int iWorker)
+		{	if(threadPoolPinOffset >= 0) pinThread(threadPoolPinOffset + pinBase + iWorker + 1);
+			size_t genSeen = 0;
+			while(true)
+			{	//Wait for the next job (spin briefly before blocking):
+				for(int spin=0; spin<spinCount && generation.load()==genSeen; spin++)
+					std::this_thread::yield();
+				std::unique_lock<std::mutex> lock(m);
+				cvStart.wait(lock, [&]{ return generation.load() != genSeen; });
+				if(stopping) return;
+				genSeen = generation.load();
+				int iThread = iWorker + 1; //caller is thread 0
+				if(iThread >= nActive) continue; //not needed for this job
+				ThreadPoolJob job = this->job; void* context = this->context;
+				int nThreads = nActive;
+				lock.unlock();
+				//Run job and report completion:
+				processChunks(queues.data(), nThreads, iThread, job, context);
+				if(--nPending == 0)
+				{	std::lock_guard<std::mutex> lockDone(m);
+					cvDone.notify_one();
+				}
+			}
+		}
+	};
+	
+	//Fallback when the pool is unavailable: spawn threads for this job alone
+	void spawnRun(int nThreads, size_t nChunks, ThreadPoolJob job, void* context)
+	{	std::vector<ChunkQueue> queues(nThreads);
+		initQueues(queues.data(), nThreads, nChunks);
+		std::vector<std::thread> threads;
+		for(int t=1; t<nThreads; t++)
+			threads.push_back(std::thread(processChunks, queues.data(), nThreads, t, job, context));
+		processChunks(queues.data(), nThreads, 0, job, context);
+		for(std::thread& t: threads) t.join();
+	}
+	
+	//Wrapper that runs a job within the profiler scope of the launching thread:
+	struct ProfiledJob
+	{	ThreadPoolJob job; void* context;
+		int path; //Profiler::currentPath() of launching thread
+	};
+	void profiledJob(void* context, size_t iChunk)
+	{	const ProfiledJob& pj = *((const ProfiledJob*)context);
+		int pathPrev = Profiler::setBasePath(pj.path);
+		pj.job(pj.context, iChunk);
+		Profiler::setBasePath(pathPrev);
+	}
+}
+
+void threadPoolRun(int nThreads, size_t nChunks, ThreadPoolJob job, void* context)
+{	using namespace ThreadPoolPrivate;
+	if(nThreads <= 1)
+	{	for(size_t iChunk=0; iChunk<nChunks; iChunk++) job(context, iChunk);
+		return;
+	}
+	ProfiledJob profiled = { job, context, 0 };
+	if(Profiler::active) //nest worker scopes under that of the caller
+	{	profiled.path = Profiler::currentPath();
+		job = profiledJob; context = &profiled;
+	}
+	static ThreadPool* globalPool = new ThreadPool(); //intentionally never destroyed: workers are blocked (or exiting) at program exit
+	ThreadPool* pool = teamState ? teamState->pool : globalPool;
+	if(!(threadPoolEnabled && pool->run(nThreads, nChunks, job, context)))
+		spawnRun(nThreads, nChunks, job, context);
+}
+
+//---------------------- Thread teams ---------------------------
+
+namespace ThreadPoolPrivate
+{
+	//Lead team iTeam of nTeams: set up team-local threading state and run the job
+	void runTeam(int iTeam, int nTeams, ThreadPoolJob job, void* context)
+	{	int pinBase = (iTeam * nProcsAvailable) / nTeams;
+		int pinStop = ((iTeam+1) * nProcsAvailable) / nTeams;
+		if(iTeam && threadPoolPinOffset >= 0) pinThread(threadPoolPinOffset + pinBase);
+		ThreadPool pool(pinBase);
+		ThreadTeamState state = { std::max(1, pinStop-pinBase), true, &pool };
+		teamState = &state;
+		job(context, iTeam);
+		teamState = 0;
+	}
+}
+
+void threadTeamRun(int nTeams, ThreadPoolJob job, void* context)
+{	using namespace ThreadPoolPrivate;
+	nTeams = std::max(1, std::min(nTeams, nProcsAvailable));
+	if(nTeams==1 || teamState || !shouldThreadOperators())
+	{	for(int iTeam=0; iTeam<nTeams; iTeam++) job(context, iTeam);
+		return;
+	}
+	suspendOperatorThreading(); //threads outside the team leaders (eg. team pool workers) should not nest further
+	ProfiledJob profiled = { job, context, 0 };
+	if(Profiler::active) //nest team scopes under that of the caller
+	{	profiled.path = Profiler::currentPath();
+		job = profiledJob; context = &profiled;
+	}
+	std::vector<std::thread> leaders;
+	for(int iTeam=1; iTeam<nTeams; iTeam++)
+		leaders.push_back(std::thread(runTeam, iTeam, nTeams, job, context));
+	runTeam(0, nTeams, job, context);
+	for(std::thread& t: leaders) t.join();
+	resumeOperatorThreading();
+}
@@ -47,6 +47,28 @@ bool shouldThreadOperators();
 void suspendOperatorThreading(); //!< call from multi-threaded top-level code to disable threading within operators called from a parallel section
 void resumeOperatorThreading(); //!< call after a parallel section in top-level code to resume threading within subsequent operator calls
 
+//! Number of threads operators should use: 1 if operator threading is suspended,
+//! the current team's share within threadTeamLaunch, and nProcsAvailable otherwise
+int nOperatorThreads();
+
+//! Job type executed by the thread pool: invoked once per chunk index with a caller-supplied context
+typedef void (*ThreadPoolJob)(void* context, size_t iChunk);
+
+extern bool threadPoolEnabled; //!< whether threadLaunch uses the persistent thread pool (true, default) or spawns threads per launch (false)
+extern int threadPoolChunksPerThread; //!< number of chunks per thread for jobs split by threadLaunch with the default thread count (default 4; >1 allows load balancing by work stealing at the cost of more calls)
+extern int threadPoolPinOffset; //!< if non-negative, pin pool workers to successive available cores starting after this offset
+
+/**
+Run job(context, iChunk) for 0 <= iChunk < nChunks using nThreads threads (including the calling thread).
+Chunks are initially distributed in contiguous blocks amongst the threads; threads that finish their block
+steal remaining chunks from the others. The persistent worker pool is used when available, and fresh threads
+are spawned otherwise (pool disabled, pool already in use eg. by a nested or concurrent launch).
+*/
+void threadPoolRun(int nThreads, size_t nChunks, ThreadPoolJob job, void* context);
+
+//! Run job(context, iTeam) for 0 <= iTeam < nTeams concurrently, each in its own thread team (see threadTeamLaunch)
+void threadTeamRun(int nTeams, ThreadPoolJob job, void* context);
+
 
 /**
 @brief A simple utility for running muliple threads
@@ -60,7 +82,13 @@ instead, where 0 <= iThread < nThreads. This mode allows for more flexible threa
 evenly split job management indicated above. This could be used as a convenient interface for
 launching threads for any parallel routine requiring as many threads as processors.
 
-@param nThreads Number of threads to launch (if <=0, as many as processors on system)
+The threads are drawn from a persistent pool (see threadPoolRun) rather than created per call,
+so that launches from frequently called operators do not pay for thread creation and joining.
+With the default thread count, the jobs are split into threadPoolChunksPerThread chunks per thread
+for load balancing; with an explicit nThreads, each of the nThreads calls of func instead gets
+one contiguous range of jobs (for callers whose correctness depends on the per-thread ranges).
+
+@param nThreads Number of threads to launch (if <=0, nOperatorThreads() with chunked load balancing)
 @param func The function / object with operator() to invoke in a multithreaded fashion
 @param nJobs The number of jobs to be split between the various func threads
 @param args Arguments to pass to func
@@ -75,6 +103,24 @@ with nThreads = number of online processors.
 template<typename Callable,typename ... Args>
 void threadLaunch(Callable* func, size_t nJobs, Args... args);
 
+/**
+@brief Run several top-level tasks concurrently, each with its own share of threads
+
+Calls func(iTeam, nTeams, args) concurrently for 0 <= iTeam < nTeams, splitting the nProcsAvailable
+processors evenly between the teams (nTeams is reduced to nProcsAvailable if necessary).
+Unlike threadLaunch, operator threading is not suspended within func: operators called by func
+use nOperatorThreads() = the team's share of threads, drawn from a thread pool private to the team.
+This is useful when the individual tasks are too small to use all threads efficiently.
+Note that func and everything it calls must therefore be safe to invoke concurrently.
+Nested team launches, and launches with operator threading suspended, run the teams one after the other.
+
+@param nTeams Number of teams
+@param func The function / object with operator() to invoke once per team
+@param args Arguments to pass to func
+*/
+template<typename Callable,typename ... Args>
+void threadTeamLaunch(int nTeams, Callable* func, Args... args);
+
 
 /**
 @brief A parallelized loop
@@ -114,22 +160,27 @@ double threadedAccumulate(Callable* func, size_t nIter, Args... args);
 //##########################
 //! @cond
 
+template<typename Chunk> void threadPoolJob(void* context, size_t iChunk)
+{	(*((Chunk*)context))(iChunk);
+}
+
 template<typename Callable,typename ... Args>
 void threadLaunch(int nThreads, Callable* func, size_t nJobs, Args... args)
-{	if(nThreads<=0) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
-	if(nThreads>1) suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
-	std::thread** tArr = new std::thread*[nThreads-1];
-	for(int t=0; t<nThreads; t++)
-	{	size_t i1 = (nJobs>0 ? (  t   * nJobs)/nThreads : t);
-		size_t i2 = (nJobs>0 ? ((t+1) * nJobs)/nThreads : nThreads);
-		if(t<nThreads-1) tArr[t] = new std::thread(func, i1, i2, args...);
-		else (*func)(i1, i2, args...);
+{	int chunksPerThread = 1; //explicit thread counts get exactly one contiguous range per thread
+	if(nThreads<=0)
+	{	nThreads = nOperatorThreads();
+		chunksPerThread = std::max(1,threadPoolChunksPerThread);
 	}
-	for(int t=0; t<nThreads-1; t++)
-	{	tArr[t]->join();
-		delete tArr[t];
-	}
-	delete[] tArr;
+	if(nThreads<=1) { (*func)(0, nJobs>0 ? nJobs : 1, args...); return; } //no threading overhead at all
+	size_t nChunks = nJobs>0 ? std::min(nJobs, size_t(nThreads)*chunksPerThread) : size_t(nThreads);
+	if(nJobs>0) nThreads = std::min(size_t(nThreads), nChunks); //no idle threads
+	auto chunk = [&](size_t iChunk)
+	{	size_t i1 = (nJobs>0 ? (  iChunk   * nJobs)/nChunks : iChunk);
+		size_t i2 = (nJobs>0 ? ((iChunk+1) * nJobs)/nChunks : nThreads);
+		(*func)(i1, i2, args...);
+	};
+	if(nThreads>1) suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
+	threadPoolRun(nThreads, nChunks, threadPoolJob<decltype(chunk)>, &chunk);
 	if(nThreads>1) resumeOperatorThreading(); //End nested threading guard section
 }
 
@@ -138,6 +189,13 @@ void threadLaunch(Callable* func, size_t nJobs, Args... args)
 {	threadLaunch(0, func, nJobs, args...);
 }
 
+template<typename Callable,typename ... Args>
+void threadTeamLaunch(int nTeams, Callable* func, Args... args)
+{	nTeams = std::max(1, std::min(nTeams, nProcsAvailable));
+	auto team = [&](size_t iTeam) { (*func)(int(iTeam), nTeams, args...); };
+	threadTeamRun(nTeams, threadPoolJob<decltype(team)>, &team);
+}
+
 
 template<typename Callable,typename ... Args>
 void threadedLoop_sub(size_t iMin, size_t iMax, Callable* func, Args... args)
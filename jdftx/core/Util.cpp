@@ -21,6 +21,10 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Thread.h>
 #include <core/ManagedMemory.h>
 #include <core/GpuUtil.h>
+#include <core/Random.h>
+#include <core/AsyncWrite.h>
+#include <core/matrix.h>
+#include <core/GridInfo.h>
 #include <cmath>
 #include <csignal>
 #include <list>
@@ -72,6 +76,8 @@ void printUsage(const char *name, const InitParams& ip)
 	logPrintf("\t-n --dry-run            quit after initialization (to verify commands and other input files)\n");
 	logPrintf("\t-c --cores              number of cores per process (ignored when launched using SLURM)\n");
 	logPrintf("\t-G --nGroups            number of MPI process groups (default or 0 => each process in own group of size 1)\n");
+	logPrintf("\t                        (processes within a group share k-points and split the work on bands;\n");
+	logPrintf("\t                        wavefunctions are replicated within a group, so memory per process is not reduced)\n");
 	logPrintf("\t-s --skip-defaults      skip printing status of default commands issued automatically.\n");
 	logPrintf("\n");
 }
@@ -105,7 +111,7 @@ void sigIntHandler(int sig)
 		printf("Enter [Q/A/I]: "); fflush(stdout);
 		char c = getchar();
 		switch(c)
-		{	case 'q': case 'Q': printf("Quitting now ...\n"); mpiWorld->exit(0);
+		{	case 'q': case 'Q': printf("Quitting now ...\n"); asyncWriteFlushFromSignal(); mpiWorld->exit(0);
 			case 'a': case 'A':
 				printf("Will quit after current iteration ...\n");
 				killFlag = true; registerHandlers(); return;
@@ -152,6 +158,8 @@ MPIUtil* mpiGroupHead = 0;
 bool mpiDebugLog = false;
 bool manualThreadCount = false;
 size_t mempoolSize = 0;
+size_t memcacheSize = size_t(64) << 20;
+size_t memcacheSharedSize = size_t(256) << 20;
 static double startTime_us; //Time at which system was initialized in microseconds
 const char* argv0 = 0;
 uint32_t crc32(const string& s); //CRC32 checksum for a string (implemented below)
@@ -233,12 +241,15 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 	printProcessDistribution("Running on hosts", hostname, &mpiHost, &mpiHostHead);
 	
 	//Initialize process groups:
-	if(nProcessGroups <= 0) nProcessGroups = mpiWorld->nProcesses(); //default: one group per process
+	if(nProcessGroups <= 0 or nProcessGroups > mpiWorld->nProcesses()) nProcessGroups = mpiWorld->nProcesses(); //default: one group per process
+	if(mpiWorld->nProcesses() % nProcessGroups)
+		die("Number of processes (%d) must be a multiple of number of process groups (%d).\n", mpiWorld->nProcesses(), nProcessGroups);
 	mpiGroup = new MPIUtil(0,0, MPIUtil::ProcDivision(mpiWorld, nProcessGroups));
 	mpiGroupHead = new MPIUtil(0,0, MPIUtil::ProcDivision(mpiWorld, 0, mpiGroup->iProcess())); //communicator between similar rank within each group
 	{	ostringstream oss; oss << mpiGroup->procDivision.iGroup;
 		printProcessDistribution("Divided in process groups", oss.str(), mpiGroup, mpiGroupHead);
 	}
+	Random::seed(mpiGroup->procDivision.iGroup); //processes in a group hold identical copies of (random) wavefunctions
 	
 	double nGPUs = 0.;
 	#ifdef GPU_ENABLED
@@ -272,7 +283,35 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 			logPrintf("Could not determine thread count from SLURM_CPUS_PER_TASK=\"%s\".\n", slurmCpusPerTask);
 	}
 	resumeOperatorThreading(); //if necessary, this informs MKL of the thread count
-	
+
+	//Thread pool options (Thread.h):
+	const char* envThreadPool = getenv("JDFTX_THREAD_POOL");
+	if(envThreadPool && string(envThreadPool)=="no")
+	{	threadPoolEnabled = false;
+		logPrintf("Thread pool disabled: threads will be launched per parallel section.\n");
+	}
+	const char* envThreadChunks = getenv("JDFTX_THREAD_CHUNKS");
+	if(envThreadChunks)
+	{	int nChunks;
+		if(sscanf(envThreadChunks, "%d", &nChunks)==1 && nChunks>=1)
+		{	threadPoolChunksPerThread = nChunks;
+			logPrintf("Thread pool splitting jobs into %d chunks per thread.\n", threadPoolChunksPerThread);
+		}
+		else
+			logPrintf("Could not determine chunks per thread from JDFTX_THREAD_CHUNKS=\"%s\".\n", envThreadChunks);
+	}
+	const char* envThreadPinning = getenv("JDFTX_THREAD_PINNING");
+	if(envThreadPinning && string(envThreadPinning)=="yes")
+	{	//Offset cores by those used by preceding processes on this host:
+		std::vector<int> nProcsHost(mpiHost.nProcesses(), 0);
+		nProcsHost[mpiHost.iProcess()] = nProcsAvailable;
+		mpiHost.allReduceData(nProcsHost, MPIUtil::ReduceSum);
+		threadPoolPinOffset = 0;
+		for(int iSibling=0; iSibling<mpiHost.iProcess(); iSibling++)
+			threadPoolPinOffset += nProcsHost[iSibling];
+		logPrintf("Thread pool workers pinned to cores starting at offset %d.\n", threadPoolPinOffset);
+	}
+
 	//Print total resources used by run:
 	{	int nProcsTot = nProcsAvailable; mpiWorld->allReduce(nProcsTot, MPIUtil::ReduceSum);
 		double nGPUsTot = nGPUs; mpiWorld->allReduce(nGPUsTot, MPIUtil::ReduceSum);
@@ -291,6 +330,49 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 		else
 			logPrintf("Could not determine memory pool size from JDFTX_MEMPOOL_SIZE=\"%s\".\n", mempoolSizeStr);
 	}
+	const char* memcacheSizeStr = getenv("JDFTX_MEMCACHE_SIZE");
+	if(memcacheSizeStr)
+	{	int memcacheSizeMB;
+		if(sscanf(memcacheSizeStr, "%d", &memcacheSizeMB)==1 && memcacheSizeMB>=0)
+		{	memcacheSize = ((size_t)memcacheSizeMB) << 20; //convert to bytes
+			logPrintf("Memory cache size: %d MB (per thread)\n", memcacheSizeMB);
+		}
+		else
+			logPrintf("Could not determine memory cache size from JDFTX_MEMCACHE_SIZE=\"%s\".\n", memcacheSizeStr);
+	}
+	memcacheSharedSize = 4*memcacheSize; //default, unless overridden below
+	const char* memcacheSharedSizeStr = getenv("JDFTX_MEMCACHE_SHARED_SIZE");
+	if(memcacheSharedSizeStr)
+	{	int memcacheSharedSizeMB;
+		if(sscanf(memcacheSharedSizeStr, "%d", &memcacheSharedSizeMB)==1 && memcacheSharedSizeMB>=0)
+		{	memcacheSharedSize = ((size_t)memcacheSharedSizeMB) << 20; //convert to bytes
+			logPrintf("Shared memory cache size: %d MB\n", memcacheSharedSizeMB);
+		}
+		else
+			logPrintf("Could not determine shared memory cache size from JDFTX_MEMCACHE_SHARED_SIZE=\"%s\".\n", memcacheSharedSizeStr);
+	}
+	
+	//Dense diagonalization settings:
+	const char* envScaLAPACKnCut = getenv("JDFTX_SCALAPACK_NCUT");
+	if(envScaLAPACKnCut)
+	{	int nCut;
+		if(sscanf(envScaLAPACKnCut, "%d", &nCut)==1 && nCut>=0)
+		{	scaLAPACKnCut = nCut;
+			logPrintf("ScaLAPACK used for matrix dimensions >= %d\n", scaLAPACKnCut);
+		}
+		else
+			logPrintf("Could not determine ScaLAPACK cutoff from JDFTX_SCALAPACK_NCUT=\"%s\".\n", envScaLAPACKnCut);
+	}
+	const char* envScaLAPACKblockSize = getenv("JDFTX_SCALAPACK_BLOCKSIZE");
+	if(envScaLAPACKblockSize)
+	{	int blockSize;
+		if(sscanf(envScaLAPACKblockSize, "%d", &blockSize)==1 && blockSize>0)
+		{	scaLAPACKblockSize = blockSize;
+			logPrintf("ScaLAPACK block size: %d\n", scaLAPACKblockSize);
+		}
+		else
+			logPrintf("Could not determine ScaLAPACK block size from JDFTX_SCALAPACK_BLOCKSIZE=\"%s\".\n", envScaLAPACKblockSize);
+	}
 	
 	//Add citations to the code for all calculations:
 	Citations::add("Software package",
@@ -384,20 +466,12 @@ void initSystemCmdline(int argc, char** argv, InitParams& ip)
 	initSystem(argc, argv, &ip);
 }
 
-#ifdef ENABLE_PROFILING
-void stopWatchManager(const StopWatch* addWatch=0, const string* watchName=0)
-{	static std::multimap<string, const StopWatch*> watches; //static array of all watches
-	if(addWatch) watches.insert(std::make_pair(*watchName,addWatch));
-	else //print timings:
-	{	logPrintf("\n");
-		for(const auto& wPair: watches) wPair.second->print();
-	}
-}
-#endif // ENABLE_PROFILING
-
 
 void finalizeSystem(bool successful)
 {
+	asyncWriteFlush(); //complete any background output (see dump-async) before reporting
+	GridInfo::exportWisdom(); //save FFTW plans for later runs (see fftw-planning)
+	
 	time_t endTime = time(0);
 	char* endTimeString = ctime(&endTime);
 	endTimeString[strlen(endTimeString)-1] = 0; //get rid of the newline in output of ctime
@@ -415,8 +489,8 @@ void finalizeSystem(bool successful)
 			fprintf(stderr, "Failed.\n");
 	}
 	
+	Profiler::finalize(successful); //timings and trace output (see command profile)
 	#ifdef ENABLE_PROFILING
-	stopWatchManager();
 	logPrintf("\n");
 	ManagedMemoryBase::reportUsage();
 	#endif
@@ -450,34 +524,6 @@ double clock_sec()
 }
 
 
-#ifdef ENABLE_PROFILING
-StopWatch::StopWatch(string name) : Ttot(0), TsqTot(0), nT(0), name(name) { stopWatchManager(this, &name); }
-void StopWatch::start()
-{
-	#ifdef GPU_ENABLED
-	cudaDeviceSynchronize();
-	#endif
-	tPrev = clock_us();
-}
-void StopWatch::stop()
-{
-	#ifdef GPU_ENABLED
-	cudaDeviceSynchronize();
-	#endif
-	double T = clock_us()-tPrev;
-	Ttot+=T; TsqTot+=T*T; nT++;
-}
-void StopWatch::print() const
-{	if(nT)
-	{	double meanT = Ttot/nT;
-		double sigmaT = sqrt(TsqTot/nT - meanT*meanT);
-		logPrintf("PROFILER: %30s %12.6lf +/- %12.6lf s, %4d calls, %13.6lf s total\n",
-			name.c_str(), meanT*1e-6, sigmaT*1e-6, nT, Ttot*1e-6);
-	}
-}
-#endif //ENABLE_PROFILING
-
-
 // Print a minimal stack trace (convenient for debugging)
 void printStack(bool detailedStackScript)
 {	const int maxStackLength = 1024;
@@ -588,6 +634,7 @@ size_t fwriteLE(const void *ptr, size_t size, size_t nmemb, FILE *fp)
 // Exit on error with a more in-depth stack trace
 void stackTraceExit(int code)
 {	printStack(true);
+	asyncWriteFlush(); //keep outputs (eg. checkpoints) already handed to the I/O thread
 	mpiWorld->exit(code);
 }
 
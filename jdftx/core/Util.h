@@ -26,6 +26,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 //! @file Util.h Miscellaneous utilities
 
 #include <core/MPIUtil.h>
+#include <core/Profiler.h>
 #include <map>
 #include <array>
 #include <cstring>
@@ -45,6 +46,8 @@ extern MPIUtil* mpiGroup; //!< MPI within current group of processes
 extern MPIUtil* mpiGroupHead; //!< MPI across equal ranks in each group
 extern bool mpiDebugLog; //!< If true, all processes output to seperate debug log files, otherwise only head process outputs (set before calling initSystem())
 extern size_t mempoolSize; //!< If non-zero, size of memory pool managed internally by JDFTx
+extern size_t memcacheSize; //!< Capacity of each thread's cache of freed CPU memory blocks (0 disables caching)
+extern size_t memcacheSharedSize; //!< Capacity of the cache of freed CPU memory blocks shared by all threads
 
 //! Parameters used for common initialization functions
 struct InitParams
@@ -84,34 +87,6 @@ Code must be self-contained as a scope, as it will be surrounded by { }, and sho
 	fprintf(fp, "%s took %.2le s.\n", title, runTime*1e-6); \
 }
 
-//! Quick drop-in profiler for any function. Usage:
-//! * Create a static object of this class in the function
-//! * Call start and stop before and after the section to be timed
-//! * Timing statistics of the code block will be printed on exit
-#ifdef ENABLE_PROFILING
-class StopWatch
-{
-public:
-	StopWatch(string name);
-	void start();
-	void stop();
-	void print() const;
-private:
-	double tPrev, Ttot, TsqTot; int nT;
-	string name;
-};
-#else //ENABLE_PROFILING
-//Version which does no profiling for release versions
-class StopWatch
-{
-public:
-	StopWatch(string name) {}
-	void start() {}
-	void stop() {}
-};
-#endif //ENABLE_PROFILING
-
-
 
 // -----------  Debugging ---------------
 void printStack(bool detailedStackScript=false); //!< Print a minimal stack trace and optionally write a script that, when run, will print a more detailed stacktrace
@@ -173,6 +148,7 @@ off_t fileSize(const char *filename);
 #endif
 
 //Endianness utilities (all binary I/O is from little-endian files regardless of operating endianness):
+bool isLittleEndian(); //!< Whether operating endianness is little-endian
 void convertToLE(void* ptr, size_t size, size_t nmemb); //!< Convert data from operating endianness to little-endian
 void convertFromLE(void* ptr, size_t size, size_t nmemb); //!< Convert data from little-endian to operating endianness
 size_t freadLE(void *ptr, size_t size, size_t nmemb, FILE* fp); //!< Read from a little-endian binary file, regardless of operating endianness
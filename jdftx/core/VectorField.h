@@ -110,6 +110,13 @@ template<class T,int N> TptrMul operator*(const TptrMul& inM, const Tptr& inS) {
 template<class T,int N> TptrMul operator*(const Tptr& inS, const TptrMul& inM) { TptrMul out(inM.clone()); return out *= inS; } //!< Elementwise multiply each component (preserve inputs)
 template<class T,int N> TptrMul operator*(TptrMul&& inM, const Tptr& inS) { return inM *= inS; } //!< Elementwise multiply each component (destructible input)
 template<class T,int N> TptrMul operator*(const Tptr& inS, TptrMul&& inM) { return inM *= inS; } //!< Elementwise multiply each component (destructible input)
+#ifndef GPU_ENABLED
+//Fused singlet expressions (see ScalarFieldExpression.h) are evaluated once and then multiplied into each component:
+template<int N, typename E> RptrMul operator*(const RptrMul& inM, const ScalarFieldExpr<E>& inS) { return inM * ScalarField(inS); } //!< Elementwise multiply each component (preserve inputs)
+template<int N, typename E> RptrMul operator*(const ScalarFieldExpr<E>& inS, const RptrMul& inM) { return inM * ScalarField(inS); } //!< Elementwise multiply each component (preserve inputs)
+template<int N, typename E> RptrMul operator*(RptrMul&& inM, const ScalarFieldExpr<E>& inS) { return inM *= ScalarField(inS); } //!< Elementwise multiply each component (destructible input)
+template<int N, typename E> RptrMul operator*(const ScalarFieldExpr<E>& inS, RptrMul&& inM) { return inM *= ScalarField(inS); } //!< Elementwise multiply each component (destructible input)
+#endif
 
 //Multiplication by scalars:
 template<class T,int N> TptrMul& operator*=(TptrMul& in, double scaleFac) { Nloop(in[i]*=scaleFac;) return in; } //!< Scale
@@ -301,9 +308,9 @@ namespace ScalarFieldMultipletPrivate
 
 	template<typename FuncOut, typename FuncIn, typename Out, typename In>
 	void threadUnary(FuncOut (*func)(FuncIn,int), int N, Out* out, In in)
-	{	int nThreadsTot = (isGpuEnabled() || !shouldThreadOperators()) ? 1 : nProcsAvailable;
-		int nOperatorThreads = std::min(nThreadsTot, N);
-		threadLaunch(nOperatorThreads, threadUnary_sub<FuncOut,FuncIn,Out,In>, 0, nThreadsTot, N, func, out, in);
+	{	int nThreadsTot = isGpuEnabled() ? 1 : nOperatorThreads();
+		int nOuterThreads = std::min(nThreadsTot, N);
+		threadLaunch(nOuterThreads, threadUnary_sub<FuncOut,FuncIn,Out,In>, 0, nThreadsTot, N, func, out, in);
 	}
 };
 
@@ -94,7 +94,13 @@ public:
 	void print(FILE* fp, const char* fmt="%lg%+lgi\t") const; //!< print (ascii) to stream
 	void print_real(FILE* fp, const char* fmt="%lg\t") const; //!< print (ascii) real parts to stream
 	
-	void diagonalize(matrix& evecs, diagMatrix& eigs) const; //!< diagonalize a hermitian matrix
+	//! Diagonalize a hermitian matrix. If mpiUtil is specified, the matrix must be identical on all its processes,
+	//! and large matrices are then diagonalized using a block-cyclic distribution over those processes (when ScaLAPACK is available)
+	void diagonalize(matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil=0) const;
+	static bool diagonalizeReal; //!< if set (Gamma-only mode), diagonalize() uses a real-symmetric solver for exactly real matrices
+	//! Solve the generalized hermitian eigenproblem this * evecs = O * evecs * eigs for positive-definite O, with evecs orthonormal w.r.t O.
+	//! Distribution over mpiUtil (if specified) works as for the standard eigenproblem above.
+	void diagonalize(const matrix& O, matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil=0) const;
 	void diagonalize(matrix& levecs, std::vector<complex>& eigs, matrix& revecs) const; //!< diagonalize an arbitrary matrix
 	void svd(matrix& U, diagMatrix& S, matrix& Vdag) const; //!< singular value decomposition (for dimensions of this: MxN, on output U: MxM, S: min(M,N), Vdag: NxN)
 	
@@ -195,6 +201,9 @@ void randomize(matrix& x);
 
 diagMatrix diagDot(const matrix& X, const matrix& Y); //!< Compute diag(dagger(X)*Y) efficiently (avoid the off-diagonals)
 
+extern int scaLAPACKnCut; //!< Minimum matrix dimension for which diagonalize() uses ScaLAPACK (set by JDFTX_SCALAPACK_NCUT)
+extern int scaLAPACKblockSize; //!< Maximum block size of the ScaLAPACK block-cyclic distribution (set by JDFTX_SCALAPACK_BLOCKSIZE)
+
 //------- Nonlinear matrix functions and their gradients ---------
 
 //! Compute inverse of an arbitrary matrix A (via LU decomposition)
@@ -32,6 +32,10 @@ extern "C"
 		double* VL, double* VU, int* IL, int* IU, double* ABSTOL, int* M,
 		double* W, complex* Z, int* LDZ, int* ISUPPZ, complex* WORK, int* LWORK,
 		double* RWORK, int* LRWORK, int* IWORK, int* LIWORK, int* INFO);
+	void dsyevr_(char* JOBZ, char* RANGE, char* UPLO, int * N, double* A, int * LDA,
+		double* VL, double* VU, int* IL, int* IU, double* ABSTOL, int* M,
+		double* W, double* Z, int* LDZ, int* ISUPPZ, double* WORK, int* LWORK,
+		int* IWORK, int* LIWORK, int* INFO);
 	void zgeev_(char* JOBVL, char* JOBVR, int* N, complex* A, int* LDA,
 		complex* W, complex* VL, int* LDVL, complex* VR, int* LDVR,
 		complex* WORK, int* LWORK, double* RWORK, int* INFO);
@@ -52,8 +56,11 @@ extern "C"
 double relativeHermiticityError_gpu(int N, const complex* data); //implemented in matrixOperators.cu
 #endif
 double relativeHermiticityError(int N, const complex* data); //implemented in matrixOperators.cpp
+bool diagonalizeDistributed(const matrix& H, const matrix* O, matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil); //implemented in matrixScaLAPACK.cpp
+
+bool matrix::diagonalizeReal = false;
 
-void matrix::diagonalize(matrix& evecs, diagMatrix& eigs) const
+void matrix::diagonalize(matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil) const
 {	static StopWatch watch("matrix::diagonalize");
 	watch.start();
 	
@@ -95,20 +102,50 @@ void matrix::diagonalize(matrix& evecs, diagMatrix& eigs) const
 		if(info>0) logPrintf("WARNING: %d elements failed to converge in cusolverDn eigenvalue routine Zheevj; falling back to CPU LAPACK.\n", info);
 	}
 #endif
+	//Distributed solve for large matrices replicated over several processes:
+	if(diagonalizeDistributed(*this, 0, evecs, eigs, mpiUtil))
+	{	watch.stop();
+		return;
+	}
 	char jobz = 'V'; //compute eigenvectors and eigenvalues
 	char range = 'A'; //compute all eigenvalues
 	char uplo = 'U'; //use upper-triangular part
-	matrix A = *this; //copy input matrix (zheevr destroys input matrix)
 	double eigMin = 0., eigMax = 0.; //eigenvalue range (not used for range-type 'A')
 	int indexMin = 0, indexMax = 0; //eignevalue index range (not used for range-type 'A')
 	double absTol = 0.; int nEigsFound;
+	int info=0;
 	eigs.resize(N);
-	evecs.init(N, N);
 	std::vector<int> iSuppz(2*N);
+	int liwork = 10*N; std::vector<int> iwork(liwork); //from doc of zheevr / dsyevr
+	
+	//Use the real-symmetric solver for exactly real matrices (eg. subspace matrices of real wavefunctions at Gamma):
+	if(diagonalizeReal)
+	{	const complex* thisData = data();
+		bool isReal = true;
+		for(int i=0; i<N*N; i++)
+			if(thisData[i].imag()) { isReal = false; break; }
+		if(isReal)
+		{	std::vector<double> Areal(N*N), evecsReal(N*N);
+			for(int i=0; i<N*N; i++) Areal[i] = thisData[i].real();
+			int lwork = (64+6)*N; std::vector<double> work(lwork); //optimal size suggested in doc of dsyevr (with the same magic block size as below)
+			dsyevr_(&jobz, &range, &uplo, &N, Areal.data(), &N,
+				&eigMin, &eigMax, &indexMin, &indexMax, &absTol, &nEigsFound,
+				eigs.data(), evecsReal.data(), &N, iSuppz.data(), work.data(), &lwork,
+				iwork.data(), &liwork, &info);
+			if(info<0) { logPrintf("Argument# %d to LAPACK eigenvalue routine DSYEVR is invalid.\n", -info); stackTraceExit(1); }
+			if(info>0) { logPrintf("Error code %d in LAPACK eigenvalue routine DSYEVR.\n", info); stackTraceExit(1); }
+			evecs = zeroes(N, N);
+			complex* evecsData = evecs.data();
+			for(int i=0; i<N*N; i++) evecsData[i] = evecsReal[i];
+			watch.stop();
+			return;
+		}
+	}
+	
+	matrix A = *this; //copy input matrix (zheevr destroys input matrix)
+	evecs.init(N, N);
 	int lwork = (64+1)*N; std::vector<complex> work(lwork); //Magic number 64 obtained by running ILAENV as suggested in doc of zheevr (and taking the max over all N)
 	int lrwork = 24*N; std::vector<double> rwork(lrwork); //from doc of zheevr
-	int liwork = 10*N; std::vector<int> iwork(liwork); //from doc of zheevr
-	int info=0;
 	zheevr_(&jobz, &range, &uplo, &N, A.data(), &N,
 		&eigMin, &eigMax, &indexMin, &indexMax, &absTol, &nEigsFound,
 		eigs.data(), evecs.data(), &N, iSuppz.data(), work.data(), &lwork,
@@ -118,6 +155,25 @@ void matrix::diagonalize(matrix& evecs, diagMatrix& eigs) const
 	watch.stop();
 }
 
+void matrix::diagonalize(const matrix& O, matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil) const
+{	static StopWatch watch("matrix::diagonalizeGeneralized");
+	assert(nCols()==nRows());
+	assert(O.nRows()==nRows());
+	assert(O.nCols()==nCols());
+	
+	//Distributed solve (Cholesky reduction) for large matrices replicated over several processes:
+	watch.start();
+	bool done = diagonalizeDistributed(dagger_symmetrize(*this), &O, evecs, eigs, mpiUtil);
+	watch.stop();
+	if(done) return;
+	
+	//Otherwise, reduce to standard problem by symmetric orthonormalization w.r.t O:
+	matrix U = invsqrt(O);
+	matrix Hortho = dagger_symmetrize(dagger(U) * (*this) * U);
+	Hortho.diagonalize(evecs, eigs);
+	evecs = U * evecs;
+}
+
 void matrix::diagonalize(matrix& levecs, std::vector<complex>& eigs, matrix& revecs) const
 {	static StopWatch watch("matrix::diagonalizeNH");
 	watch.start();
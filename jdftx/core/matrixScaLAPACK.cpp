@@ -0,0 +1,215 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/matrix.h>
+
+#if defined(SCALAPACK_ENABLED) and defined(MPI_ENABLED)
+	#define USE_SCALAPACK
+#endif
+
+int scaLAPACKnCut = 384; //replicated LAPACK is faster for small matrices
+int scaLAPACKblockSize = 64;
+
+#ifdef USE_SCALAPACK
+
+//BLACS (C interface, which allows grids on arbitrary communicators) and ScaLAPACK forward declarations
+extern "C"
+{	int Csys2blacs_handle(MPI_Comm comm);
+	void Cfree_blacs_system_handle(int handle);
+	void Cblacs_gridinit(int* context, const char* order, int nProcsRow, int nProcsCol);
+	void Cblacs_gridinfo(int context, int* nProcsRow, int* nProcsCol, int* iProcRow, int* iProcCol);
+	void Cblacs_gridexit(int context);
+
+	int numroc_(const int* n, const int* nb, const int* iproc, const int* srcproc, const int* nprocs);
+	void descinit_(int* desc, const int* m, const int* n, const int* mb, const int* nb,
+		const int* irsrc, const int* icsrc, const int* ictxt, const int* lld, int* info);
+
+	void pzpotrf_(const char* uplo, const int* n, complex* a, const int* ia, const int* ja, const int* desca, int* info);
+	void pdpotrf_(const char* uplo, const int* n, double* a, const int* ia, const int* ja, const int* desca, int* info);
+	void pzhegst_(const int* ibtype, const char* uplo, const int* n, complex* a, const int* ia, const int* ja, const int* desca,
+		const complex* b, const int* ib, const int* jb, const int* descb, double* scale, int* info);
+	void pdsygst_(const int* ibtype, const char* uplo, const int* n, double* a, const int* ia, const int* ja, const int* desca,
+		const double* b, const int* ib, const int* jb, const int* descb, double* scale, int* info);
+	void pzheevd_(const char* jobz, const char* uplo, const int* n, complex* a, const int* ia, const int* ja, const int* desca,
+		double* w, complex* z, const int* iz, const int* jz, const int* descz,
+		complex* work, const int* lwork, double* rwork, const int* lrwork, int* iwork, const int* liwork, int* info);
+	void pdsyevd_(const char* jobz, const char* uplo, const int* n, double* a, const int* ia, const int* ja, const int* desca,
+		double* w, double* z, const int* iz, const int* jz, const int* descz,
+		double* work, const int* lwork, int* iwork, const int* liwork, int* info);
+	void pztrsm_(const char* side, const char* uplo, const char* transa, const char* diag, const int* m, const int* n,
+		const complex* alpha, const complex* a, const int* ia, const int* ja, const int* desca,
+		complex* b, const int* ib, const int* jb, const int* descb);
+	void pdtrsm_(const char* side, const char* uplo, const char* transa, const char* diag, const int* m, const int* n,
+		const double* alpha, const double* a, const int* ia, const int* ja, const int* desca,
+		double* b, const int* ib, const int* jb, const int* descb);
+}
+
+//Wrappers selecting the complex-hermitian or real-symmetric ScaLAPACK routine by scalar type
+//(all operate on the full N x N matrix using the upper triangle):
+namespace ScaLAPACK
+{
+	static const int one = 1;
+
+	inline void potrf(int N, complex* a, const int* desc, int& info) { pzpotrf_("U", &N, a, &one, &one, desc, &info); }
+	inline void potrf(int N, double* a, const int* desc, int& info) { pdpotrf_("U", &N, a, &one, &one, desc, &info); }
+
+	inline void hegst(int N, complex* a, const complex* b, const int* desc, int& info)
+	{	double scale; pzhegst_(&one, "U", &N, a, &one, &one, desc, b, &one, &one, desc, &scale, &info);
+	}
+	inline void hegst(int N, double* a, const double* b, const int* desc, int& info)
+	{	double scale; pdsygst_(&one, "U", &N, a, &one, &one, desc, b, &one, &one, desc, &scale, &info);
+	}
+
+	inline void trsm(int N, const complex* a, complex* b, const int* desc)
+	{	complex alpha(1.); pztrsm_("L", "U", "N", "N", &N, &N, &alpha, a, &one, &one, desc, b, &one, &one, desc);
+	}
+	inline void trsm(int N, const double* a, double* b, const int* desc)
+	{	double alpha(1.); pdtrsm_("L", "U", "N", "N", &N, &N, &alpha, a, &one, &one, desc, b, &one, &one, desc);
+	}
+
+	//Divide and conquer eigensolvers (including workspace query):
+	inline void heevd(int N, complex* a, double* w, complex* z, const int* desc, int& info)
+	{	int lwork=-1, lrwork=-1, liwork=-1;
+		std::vector<complex> work(1); std::vector<double> rwork(1); std::vector<int> iwork(1);
+		for(int pass=0; pass<2; pass++) //first pass is workspace query, next pass is actual calculation
+		{	pzheevd_("V", "U", &N, a, &one, &one, desc, w, z, &one, &one, desc,
+				work.data(), &lwork, rwork.data(), &lrwork, iwork.data(), &liwork, &info);
+			if(info || pass) break;
+			lwork = int(work[0].real()); work.resize(lwork);
+			lrwork = int(rwork[0]); rwork.resize(lrwork);
+			liwork = std::max(iwork[0], 7*N+8); iwork.resize(liwork); //ensure documented minimum (query underestimates in some versions)
+		}
+	}
+	inline void heevd(int N, double* a, double* w, double* z, const int* desc, int& info)
+	{	int lwork=-1, liwork=-1;
+		std::vector<double> work(1); std::vector<int> iwork(1);
+		for(int pass=0; pass<2; pass++) //first pass is workspace query, next pass is actual calculation
+		{	pdsyevd_("V", "U", &N, a, &one, &one, desc, w, z, &one, &one, desc,
+				work.data(), &lwork, iwork.data(), &liwork, &info);
+			if(info || pass) break;
+			lwork = int(work[0]); work.resize(lwork);
+			liwork = std::max(iwork[0], 7*N+8); iwork.resize(liwork); //ensure documented minimum (query underestimates in some versions)
+		}
+	}
+
+	inline void set(complex& x, const complex& z) { x = z; }
+	inline void set(double& x, const complex& z) { x = z.real(); }
+
+	//Global index corresponding to local index iLocal in block-cyclic distribution:
+	inline int globalIndex(int iLocal, int blockSize, int iProcDim, int nProcsDim)
+	{	return (iLocal/blockSize)*blockSize*nProcsDim + iProcDim*blockSize + (iLocal%blockSize);
+	}
+}
+
+//Solve (generalized if Odata non-null) eigenproblem of matrices replicated on all processes of mpiUtil,
+//using a block-cyclic distribution on the squarest possible process grid. Returns false if O is not positive definite.
+template<typename scalar> bool diagonalizeBlockCyclic(int N, const complex* Hdata, const complex* Odata,
+	matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil)
+{	//Initialize BLACS process grid:
+	int nProcesses = mpiUtil->nProcesses();
+	int nProcsRow = int(round(sqrt(nProcesses)));
+	while(nProcesses % nProcsRow) nProcsRow--;
+	int nProcsCol = nProcesses / nProcsRow;
+	int blacsHandle = Csys2blacs_handle(mpiUtil->communicator());
+	int blacsContext = blacsHandle, iProcRow, iProcCol;
+	Cblacs_gridinit(&blacsContext, "Row-major", nProcsRow, nProcsCol);
+	Cblacs_gridinfo(blacsContext, &nProcsRow, &nProcsCol, &iProcRow, &iProcCol);
+
+	//Initialize block-cyclic distribution (reducing block size if needed to have data on all processes):
+	int blockSize = std::max(1, std::min(scaLAPACKblockSize, N/std::max(nProcsRow, nProcsCol)));
+	int zero = 0, info = 0;
+	int nRowsMine = numroc_(&N, &blockSize, &iProcRow, &zero, &nProcsRow);
+	int nColsMine = numroc_(&N, &blockSize, &iProcCol, &zero, &nProcsCol);
+	int lld = std::max(1, nRowsMine);
+	int desc[9];
+	descinit_(desc, &N, &N, &blockSize, &blockSize, &zero, &zero, &blacsContext, &lld, &info); assert(info==0);
+
+	//Extract local blocks (inputs are replicated, so no communication needed):
+	std::vector<int> iRowsMine(nRowsMine), iColsMine(nColsMine);
+	for(int iLocal=0; iLocal<nRowsMine; iLocal++) iRowsMine[iLocal] = ScaLAPACK::globalIndex(iLocal, blockSize, iProcRow, nProcsRow);
+	for(int jLocal=0; jLocal<nColsMine; jLocal++) iColsMine[jLocal] = ScaLAPACK::globalIndex(jLocal, blockSize, iProcCol, nProcsCol);
+	std::vector<scalar> Hlocal(lld*nColsMine), Olocal(Odata ? lld*nColsMine : 0), Zlocal(lld*nColsMine);
+	for(int jLocal=0; jLocal<nColsMine; jLocal++)
+		for(int iLocal=0; iLocal<nRowsMine; iLocal++)
+		{	int index = iRowsMine[iLocal] + N*iColsMine[jLocal]; //global column-major index
+			ScaLAPACK::set(Hlocal[iLocal+lld*jLocal], Hdata[index]);
+			if(Odata) ScaLAPACK::set(Olocal[iLocal+lld*jLocal], Odata[index]);
+		}
+
+	//Reduce generalized problem to standard form using the Cholesky factor of O:
+	bool success = true;
+	if(Odata)
+	{	ScaLAPACK::potrf(N, Olocal.data(), desc, info);
+		if(info<0) { logPrintf("Argument# %d to ScaLAPACK Cholesky routine POTRF is invalid.\n", -info); stackTraceExit(1); }
+		if(info>0) success = false; //O not positive definite: caller falls back to replicated LAPACK
+		else
+		{	ScaLAPACK::hegst(N, Hlocal.data(), Olocal.data(), desc, info);
+			if(info<0) { logPrintf("Argument# %d to ScaLAPACK reduction routine HEGST is invalid.\n", -info); stackTraceExit(1); }
+		}
+	}
+
+	if(success)
+	{	//Standard eigenproblem:
+		eigs.resize(N);
+		ScaLAPACK::heevd(N, Hlocal.data(), eigs.data(), Zlocal.data(), desc, info);
+		if(info<0) { logPrintf("Argument# %d to ScaLAPACK eigenvalue routine HEEVD is invalid.\n", -info); stackTraceExit(1); }
+		if(info>0) { logPrintf("Error code %d in ScaLAPACK eigenvalue routine HEEVD.\n", info); stackTraceExit(1); }
+		if(Odata) ScaLAPACK::trsm(N, Olocal.data(), Zlocal.data(), desc); //back-transform eigenvectors
+
+		//Collect eigenvectors and eigenvalues (identical on all processes):
+		evecs = zeroes(N, N);
+		complex* evecsData = evecs.data();
+		for(int jLocal=0; jLocal<nColsMine; jLocal++)
+			for(int iLocal=0; iLocal<nRowsMine; iLocal++)
+				evecsData[iRowsMine[iLocal] + N*iColsMine[jLocal]] = Zlocal[iLocal+lld*jLocal];
+		mpiUtil->allReduceData(evecs, MPIUtil::ReduceSum); //exact, since each entry is non-zero on only one process
+		mpiUtil->bcast(eigs.data(), N);
+	}
+	Cblacs_gridexit(blacsContext);
+	Cfree_blacs_system_handle(blacsHandle);
+	return success;
+}
+
+#endif //USE_SCALAPACK
+
+
+bool diagonalizeDistributed(const matrix& H, const matrix* O, matrix& evecs, diagMatrix& eigs, const MPIUtil* mpiUtil)
+{
+#ifdef USE_SCALAPACK
+	int N = H.nRows();
+	if(!mpiUtil || mpiUtil->nProcesses()<2 || N<scaLAPACKnCut) return false; //replicated LAPACK is faster
+	static StopWatch watch("matrix::diagonalizeScaLAPACK");
+	watch.start();
+	//Use the real-symmetric solvers for exactly real matrices (eg. subspace matrices of real wavefunctions at Gamma):
+	bool isReal = true;
+	for(const matrix* M: { &H, O })
+		if(M)
+		{	const complex* Mdata = M->data();
+			for(int i=0; i<N*N; i++)
+				if(Mdata[i].imag()) { isReal = false; break; }
+		}
+	bool success = isReal
+		? diagonalizeBlockCyclic<double>(N, H.data(), O ? O->data() : 0, evecs, eigs, mpiUtil)
+		: diagonalizeBlockCyclic<complex>(N, H.data(), O ? O->data() : 0, evecs, eigs, mpiUtil);
+	watch.stop();
+	return success;
+#else
+	return false;
+#endif
+}
@@ -25,7 +25,7 @@ BandDavidson::BandDavidson(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.
 {	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
 }
 
-void BandDavidson::minimize()
+void BandDavidson::minimize(const MinimizeParams& mp)
 {	//Use the same working set as the CG minimizer:
 	ColumnBundle& C = eVars.C[q];
 	std::vector<matrix>& VdagC = eVars.VdagC[q];
@@ -44,16 +44,15 @@ void BandDavidson::minimize()
 	diagMatrix I = eye(nBandsOut);
 	Energies ener; //not really used here
 	eVars.applyHamiltonian(q, I, HC, ener, true);
-	Hsub = C^HC;
-	Hsub.diagonalize(Hsub_evecs, Hsub_eigs);
+	Hsub = innerWfns(C, HC);
+	Hsub.diagonalize(Hsub_evecs, Hsub_eigs, mpiGroup);
 	//--- switch C to subspace eigenbasis:
-	C = C * Hsub_evecs;
-	HC = HC * Hsub_evecs;
+	C = multiplyWfns(C, Hsub_evecs);
+	HC = multiplyWfns(HC, Hsub_evecs);
 	e.iInfo.project(C, VdagC, &Hsub_evecs);
 	double Eband = qnum.weight * trace(Hsub_eigs);
-	logPrintf("BandDavidson: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(globalLog);
+	fprintf(mp.fpLog, "BandDavidson: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(mp.fpLog);
 	
-	const MinimizeParams& mp = e.elecMinParams;
 	int iter=1;
 	for(; iter<=mp.nIterations; iter++)
 	{	int nBands = C.nCols();
@@ -74,7 +73,7 @@ void BandDavidson::minimize()
 				bOut++;
 			}
 			if(!bOut) //This is unlikely, but just in case (to avoid zero column matrices below)
-			{	logPrintf("BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+			{	fprintf(mp.fpLog, "BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
 				break;
 			}
 			if(bOut<nBands)
@@ -91,9 +90,9 @@ void BandDavidson::minimize()
 		{	ColumnBundle OCexp = O(Cexp, &VdagCexp);
 			matrix rotExisting = eye(Cexp.nCols());
 			e.iInfo.project(Cexp, VdagCexp, &rotExisting);
-			matrix CdagOCexp = C ^ OCexp;
+			matrix CdagOCexp = innerWfns(C, OCexp);
 			bigOsub.set(0,nBands, 0,nBands, eye(nBands)); //since C's are already orthonormal
-			bigOsub.set(nBands,nBandsBig, nBands,nBandsBig, Cexp ^ OCexp);
+			bigOsub.set(nBands,nBandsBig, nBands,nBandsBig, innerWfns(Cexp, OCexp));
 			bigOsub.set(0,nBands, nBands,nBandsBig, CdagOCexp);
 			bigOsub.set(nBands,nBandsBig, 0,nBands, dagger(CdagOCexp));
 		}
@@ -109,24 +108,21 @@ void BandDavidson::minimize()
 			SWAP_C_Cexp //Temporarily swap C and Cexp
 			eVars.applyHamiltonian(q, eye(nBandsNew), HCexp, ener, true); //Hamiltonian always operates on C, where we put Cexp 
 			SWAP_C_Cexp  //Restore C and Cexp to correct places
-			matrix CdagHCexp = C  ^ HCexp;
+			matrix CdagHCexp = innerWfns(C, HCexp);
 			bigHsub.set(0,nBands, 0,nBands, Hsub_eigs);
 			bigHsub.set(nBands,nBandsBig, nBands,nBandsBig, HsubExp);
 			bigHsub.set(0,nBands, nBands,nBandsBig, CdagHCexp);
 			bigHsub.set(nBands,nBandsBig, 0,nBands, dagger(CdagHCexp));
 		}
 		//Solve expanded subspace generalized eigenvalue problem:
-		matrix bigU = invsqrt(bigOsub);
-		bigHsub = dagger_symmetrize(dagger(bigU) * bigHsub * bigU); //switch to the symmetrically-orthonormalized basis
-		matrix bigHsub_evecs; diagMatrix bigHsub_eigs;
-		bigHsub.diagonalize(bigHsub_evecs, bigHsub_eigs);
-		matrix rot = bigU * bigHsub_evecs; //rotation from [C,Cexp] to the expanded subspace eigenbasis
+		matrix rot; diagMatrix bigHsub_eigs; //rot is the rotation from [C,Cexp] to the expanded subspace eigenbasis
+		bigHsub.diagonalize(bigOsub, rot, bigHsub_eigs, mpiGroup);
 		int nBandsNext = std::min(nBandsMax, nBandsBig); //number of bands to retain for next iteration
 		matrix Crot = rot(0,nBands, 0,nBandsNext); //contribution of C to lowest nBandsNext eigenvectors
 		matrix CexpRot = rot(nBands,nBandsBig, 0,nBandsNext); //contribution of Cexp to lowest nBandsNext eigenvectors
 		//Update C to optimum nBands subspace from [C,Cexp]
-		C = C*Crot + Cexp*CexpRot;
-		HC = HC*Crot + HCexp*CexpRot;
+		C = multiplyWfns(C, Crot) + multiplyWfns(Cexp, CexpRot);
+		HC = multiplyWfns(HC, Crot) + multiplyWfns(HCexp, CexpRot);
 		Hsub_eigs = bigHsub_eigs(0,nBandsNext);
 		for(size_t sp=0; sp<VdagC.size(); sp++) if(VdagC[sp])
 			VdagC[sp] = VdagC[sp]*Crot + VdagCexp[sp]*CexpRot;
@@ -134,15 +130,15 @@ void BandDavidson::minimize()
 		double EbandPrev = Eband;
 		Eband = qnum.weight * trace(Hsub_eigs(0,nBandsOut));
 		double dEband = Eband - EbandPrev;
-		logPrintf("BandDavidson: Iter: %3d  Eband: %+.15lf  dEband: %le  t[s]: %9.2lf\n", iter, Eband, dEband, clock_sec()); fflush(globalLog);
+		fprintf(mp.fpLog, "BandDavidson: Iter: %3d  Eband: %+.15lf  dEband: %le  t[s]: %9.2lf\n", iter, Eband, dEband, clock_sec()); fflush(mp.fpLog);
 		if(dEband<0 and fabs(dEband)<mp.energyDiffThreshold)
-		{	logPrintf("BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+		{	fprintf(mp.fpLog, "BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
 			break;
 		}
 	}
 	if(iter>mp.nIterations)
-		logPrintf("BandDavidson: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
-	fflush(globalLog);
+		fprintf(mp.fpLog, "BandDavidson: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
+	fflush(mp.fpLog);
 	
 	//Update final quantities:
 	if(C.nCols() != nBandsOut)
@@ -33,7 +33,7 @@ class BandDavidson
 {
 public:
 	BandDavidson(Everything& e, int q); //!< Construct Davidson eigenvalue solver for quantum number q
-	void minimize(); //!< Converge eigenproblem with tolerance set by e.elecMinParams
+	void minimize(const MinimizeParams& mp); //!< Converge eigenproblem with tolerance set by mp (usually e.elecMinParams), logging to mp.fpLog
 	
 private:
 	Everything& e;
@@ -0,0 +1,205 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/BandLOBPCG.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+
+BandLOBPCG::BandLOBPCG(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
+{	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
+}
+
+void BandLOBPCG::minimize(const MinimizeParams& mp)
+{	//Use the same working set as the CG minimizer:
+	ColumnBundle& C = eVars.C[q];
+	std::vector<matrix>& VdagC = eVars.VdagC[q];
+	matrix& Hsub = eVars.Hsub[q];
+	matrix& Hsub_evecs = eVars.Hsub_evecs[q];
+	diagMatrix& Hsub_eigs = eVars.Hsub_eigs[q];
+	const QuantumNumber& qnum = eInfo.qnums[q];
+	int nBands = eInfo.nBands;
+	if(3*nBands >= int(C.basis->nbasis))
+		die_alone("Cannot use LOBPCG eigenvalue algorithm when 3 x nBands > nBasis.\n"
+			"Reduce nBands, increase nBasis (Ecut) or use elec-eigen-algo CG.\n\n");
+	const double overlapCut = 1e-10; //relative cutoff on subspace overlap eigenvalues (discards linearly-dependent directions)
+	
+	//Initial subspace eigenvalue problem:
+	ColumnBundle HC;
+	diagMatrix I = eye(nBands);
+	Energies ener; //not really used here
+	eVars.applyHamiltonian(q, I, HC, ener, true);
+	Hsub = innerWfns(C, HC);
+	Hsub.diagonalize(Hsub_evecs, Hsub_eigs, mpiGroup);
+	//--- switch C to subspace eigenbasis:
+	C = multiplyWfns(C, Hsub_evecs);
+	HC = multiplyWfns(HC, Hsub_evecs);
+	e.iInfo.project(C, VdagC, &Hsub_evecs);
+	double Eband = qnum.weight * trace(Hsub_eigs);
+	fprintf(mp.fpLog, "BandLOBPCG: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(mp.fpLog);
+	
+	//Previous search directions (none in the first iteration):
+	ColumnBundle P, HP;
+	std::vector<matrix> VdagP;
+	
+	int iter=1;
+	for(; iter<=mp.nIterations; iter++)
+	{	//Preconditioned residuals:
+		diagMatrix KEref = (-0.5) * diagDot(C, L(C)); //Update reference KE for preconditioning:
+		ColumnBundle W = HC; W -= O(C) * Hsub_eigs; //Calculate residual of current eigenvector guesses
+		precond_inv_kinetic_band(W, KEref);
+		//Drop converged eigenpairs and approximately normalize residuals (for avoiding roundoff issues only):
+		diagMatrix Wnorm = diagDot(W, W);
+		double WnormCut = std::max(mp.energyDiffThreshold/nBands, 1e-15*W.colLength());
+		{	//Drop columns whose norm falls below above cutoff
+			complex* Wdata = W.dataPref();
+			int bOut = 0;
+			for(int b=0; b<nBands; b++)
+			{	if(Wnorm[b]<WnormCut) continue;
+				Wnorm[bOut] = 1/sqrt(Wnorm[b]);
+				if(bOut<b) callPref(eblas_copy)(Wdata+W.index(bOut,0), Wdata+W.index(b,0), W.colLength());
+				bOut++;
+			}
+			if(!bOut) //This is unlikely, but just in case (to avoid zero column matrices below)
+			{	fprintf(mp.fpLog, "BandLOBPCG: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+				break;
+			}
+			if(bOut<nBands)
+			{	W = W.getSub(0,bOut);
+				Wnorm = Wnorm(0,bOut);
+			}
+		}
+		W = W * Wnorm;
+		//Normalize previous search directions similarly (zeroing out vanishing ones, which get discarded below):
+		int nW = W.nCols();
+		int nP = P ? P.nCols() : 0;
+		if(nP)
+		{	diagMatrix Pnorm = diagDot(P, P);
+			for(double& norm: Pnorm) norm = (norm<WnormCut) ? 0. : 1/sqrt(norm);
+			P = P * Pnorm;
+			HP = HP * Pnorm;
+			for(matrix& m: VdagP) if(m) m = m * Pnorm;
+		}
+		int nBig = nBands + nW + nP;
+		
+		//Apply Hamiltonian to residuals:
+		std::vector<matrix> VdagW;
+		ColumnBundle OW = O(W, &VdagW);
+		{	matrix rotExisting = eye(nW);
+			e.iInfo.project(W, VdagW, &rotExisting);
+		}
+		ColumnBundle HW;
+		matrix HsubW;
+		{	diagMatrix HsubW_eigs;
+			#define SWAP_C_W \
+				std::swap(C, W); \
+				std::swap(VdagC, VdagW); \
+				std::swap(Hsub, HsubW); \
+				std::swap(Hsub_eigs, HsubW_eigs);
+			SWAP_C_W //Temporarily swap C and W
+			eVars.applyHamiltonian(q, eye(nW), HW, ener, true); //Hamiltonian always operates on C, where we put W
+			SWAP_C_W //Restore C and W to correct places
+			#undef SWAP_C_W
+		}
+		
+		//Subspace overlaps and Hamiltonian in the basis [C,W,P]:
+		matrix bigOsub(nBig, nBig), bigHsub(nBig, nBig);
+		#define SET_BLOCK(M, iStart,iStop, jStart,jStop, block) \
+			{	matrix Mblock = block; \
+				M.set(iStart,iStop, jStart,jStop, Mblock); \
+				if(iStart != jStart) M.set(jStart,jStop, iStart,iStop, dagger(Mblock)); \
+			}
+		int iW = nBands, iP = nBands + nW;
+		bigOsub.set(0,nBands, 0,nBands, eye(nBands)); //since C's are already orthonormal
+		bigHsub.set(0,nBands, 0,nBands, Hsub_eigs); //since C's are subspace eigenvectors
+		SET_BLOCK(bigOsub, 0,nBands, iW,iP, innerWfns(C, OW))
+		SET_BLOCK(bigOsub, iW,iP, iW,iP, innerWfns(W, OW))
+		SET_BLOCK(bigHsub, 0,nBands, iW,iP, innerWfns(C, HW))
+		SET_BLOCK(bigHsub, iW,iP, iW,iP, HsubW)
+		OW.free();
+		if(nP)
+		{	ColumnBundle OP = O(P);
+			SET_BLOCK(bigOsub, 0,nBands, iP,nBig, innerWfns(C, OP))
+			SET_BLOCK(bigOsub, iW,iP, iP,nBig, innerWfns(W, OP))
+			SET_BLOCK(bigOsub, iP,nBig, iP,nBig, innerWfns(P, OP))
+			SET_BLOCK(bigHsub, 0,nBands, iP,nBig, innerWfns(C, HP))
+			SET_BLOCK(bigHsub, iW,iP, iP,nBig, innerWfns(W, HP))
+			SET_BLOCK(bigHsub, iP,nBig, iP,nBig, innerWfns(P, HP))
+		}
+		#undef SET_BLOCK
+		
+		//Solve subspace eigenvalue problem, discarding (nearly) linearly-dependent directions of [C,W,P]:
+		matrix rot; diagMatrix bigHsub_eigs; //rot is the rotation from [C,W,P] to the lowest nBands subspace eigenvectors
+		{	matrix Oevecs; diagMatrix Oeigs;
+			bigOsub.diagonalize(Oevecs, Oeigs, mpiGroup);
+			int iStart = 0;
+			while(Oeigs[iStart] < overlapCut*Oeigs.back()) iStart++;
+			int nKept = nBig - iStart;
+			assert(nKept >= nBands); //guaranteed since C is orthonormal
+			diagMatrix OinvSqrt(nKept);
+			for(int i=0; i<nKept; i++) OinvSqrt[i] = 1./sqrt(Oeigs[iStart+i]);
+			matrix U = Oevecs(0,nBig, iStart,nBig) * OinvSqrt; //orthonormal basis of retained subspace
+			matrix Htilde = dagger(U) * bigHsub * U, Hevecs;
+			Htilde.diagonalize(Hevecs, bigHsub_eigs, mpiGroup);
+			rot = U * Hevecs(0,nKept, 0,nBands);
+		}
+		matrix Crot = rot(0,nBands, 0,nBands); //contribution of C to lowest nBands eigenvectors
+		matrix Wrot = rot(iW,iP, 0,nBands); //contribution of W to lowest nBands eigenvectors
+		
+		//Update search directions to the components of the new eigenvectors along [W,P]:
+		ColumnBundle Pnew = multiplyWfns(W, Wrot);
+		ColumnBundle HPnew = multiplyWfns(HW, Wrot);
+		std::vector<matrix> VdagPnew(VdagW.size());
+		for(size_t sp=0; sp<VdagW.size(); sp++) if(VdagW[sp])
+			VdagPnew[sp] = VdagW[sp]*Wrot;
+		if(nP)
+		{	matrix Prot = rot(iP,nBig, 0,nBands); //contribution of P to lowest nBands eigenvectors
+			Pnew += multiplyWfns(P, Prot);
+			HPnew += multiplyWfns(HP, Prot);
+			for(size_t sp=0; sp<VdagP.size(); sp++) if(VdagP[sp])
+				VdagPnew[sp] += VdagP[sp]*Prot;
+		}
+		std::swap(P, Pnew); Pnew.free();
+		std::swap(HP, HPnew); HPnew.free();
+		std::swap(VdagP, VdagPnew);
+		//Update C to optimum nBands subspace from [C,W,P]:
+		C = multiplyWfns(C, Crot); C += P;
+		HC = multiplyWfns(HC, Crot); HC += HP;
+		for(size_t sp=0; sp<VdagC.size(); sp++) if(VdagC[sp])
+			VdagC[sp] = VdagC[sp]*Crot + VdagP[sp];
+		Hsub_eigs = bigHsub_eigs(0,nBands);
+		
+		//Print and test convergence
+		double EbandPrev = Eband;
+		Eband = qnum.weight * trace(Hsub_eigs);
+		double dEband = Eband - EbandPrev;
+		fprintf(mp.fpLog, "BandLOBPCG: Iter: %3d  Eband: %+.15lf  dEband: %le  t[s]: %9.2lf\n", iter, Eband, dEband, clock_sec()); fflush(mp.fpLog);
+		if(dEband<0 and fabs(dEband)<mp.energyDiffThreshold)
+		{	fprintf(mp.fpLog, "BandLOBPCG: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+			break;
+		}
+	}
+	if(iter>mp.nIterations)
+		fprintf(mp.fpLog, "BandLOBPCG: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
+	fflush(mp.fpLog);
+	
+	//Update final quantities:
+	Hsub = Hsub_eigs;
+	Hsub_evecs = I;
+}
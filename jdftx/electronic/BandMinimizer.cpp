@@ -23,7 +23,6 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 BandMinimizer::BandMinimizer(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
 {	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
-	e.elecMinParams.energyLabel = relevantFreeEnergyName(e);
 }
 
 void BandMinimizer::step(const ColumnBundle& dir, double alpha)
@@ -37,10 +36,11 @@ double BandMinimizer::compute(ColumnBundle* grad, ColumnBundle* Kgrad)
 	diagMatrix Fq = eye(eInfo.nBands);
 	const QuantumNumber& qnum = eInfo.qnums[q];
 	ColumnBundle Hq;
-	double KEq = eVars.applyHamiltonian(q, Fq, Hq, e.ener, true);
+	Energies ener; //not really used here (and kept separate from e.ener for thread safety)
+	double KEq = eVars.applyHamiltonian(q, Fq, Hq, ener, true);
 	if(grad)
 	{	double KErollover = 2.*KEq/(qnum.weight*eInfo.nBands);
-		Hq -=  O(eVars.C[q])*eVars.Hsub[q]; //orthonormality contribution
+		Hq -= multiplyWfns(O(eVars.C[q]), eVars.Hsub[q]); //orthonormality contribution
 		Hq *= qnum.weight;
 		std::swap(*grad, Hq);
 		if(Kgrad)
@@ -52,5 +52,5 @@ double BandMinimizer::compute(ColumnBundle* grad, ColumnBundle* Kgrad)
 }
 
 void BandMinimizer::constrain(ColumnBundle& dir)
-{	dir -= eVars.C[q] * (eVars.C[q]^O(dir));
+{	dir -= multiplyWfns(eVars.C[q], innerWfns(eVars.C[q], O(dir)));
 }
@@ -0,0 +1,200 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/BandRMMDIIS.h>
+#include <electronic/BandDavidson.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+
+BandRMMDIIS::BandRMMDIIS(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
+{	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
+}
+
+//DIIS coefficients minimizing alpha^T B alpha subject to sum(alpha)=1, given residual overlaps B
+inline std::vector<double> diisCoefficients(const matrix& B)
+{	int m = B.nRows();
+	std::vector<double> alpha(m, 0.);
+	double Bmax = 0.;
+	for(int i=0; i<m; i++) Bmax = std::max(Bmax, B(i,i).real());
+	if(!Bmax) { alpha.back() = 1.; return alpha; } //all residuals vanish: retain latest
+	matrix Breg = (1./Bmax)*B + 1e-12*eye(m); //regularize (nearly) linearly-dependent residuals
+	matrix ones(m, 1);
+	for(int i=0; i<m; i++) ones.set(i,0, 1.);
+	matrix x = invApply(Breg, ones);
+	double xSum = 0.;
+	for(int i=0; i<m; i++) xSum += x(i,0).real();
+	for(int i=0; i<m; i++) alpha[i] = x(i,0).real() / xSum;
+	return alpha;
+}
+
+void BandRMMDIIS::minimize(const MinimizeParams& mp)
+{	//Use the same working set as the CG minimizer:
+	ColumnBundle& C = eVars.C[q];
+	std::vector<matrix>& VdagC = eVars.VdagC[q];
+	matrix& Hsub = eVars.Hsub[q];
+	matrix& Hsub_evecs = eVars.Hsub_evecs[q];
+	diagMatrix& Hsub_eigs = eVars.Hsub_eigs[q];
+	const QuantumNumber& qnum = eInfo.qnums[q];
+	int nBands = eInfo.nBands;
+	const int nSteps = 3; //number of DIIS steps per band in each iteration (one Hamiltonian application each)
+	const double overlapCutoff = 1e-8; //minimum ratio of overlap eigenvalues of the trial bands before falling back to Davidson
+	
+	//Initial subspace eigenvalue problem:
+	ColumnBundle HC;
+	diagMatrix I = eye(nBands);
+	Energies ener; //not really used here
+	eVars.applyHamiltonian(q, I, HC, ener, true);
+	Hsub = innerWfns(C, HC);
+	Hsub.diagonalize(Hsub_evecs, Hsub_eigs, mpiGroup);
+	//--- switch C to subspace eigenbasis:
+	C = multiplyWfns(C, Hsub_evecs);
+	HC = multiplyWfns(HC, Hsub_evecs);
+	e.iInfo.project(C, VdagC, &Hsub_evecs);
+	double Eband = qnum.weight * trace(Hsub_eigs);
+	fprintf(mp.fpLog, "BandRMMDIIS: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(mp.fpLog);
+	
+	//Apply Hamiltonian to Y (returned in HY), computing projections VdagY along the way; returns O(Y)
+	auto applyOH = [&](ColumnBundle& Y, std::vector<matrix>& VdagY, ColumnBundle& HY)
+	{	VdagY.clear();
+		ColumnBundle OY = O(Y, &VdagY);
+		matrix rotExisting = eye(Y.nCols());
+		e.iInfo.project(Y, VdagY, &rotExisting);
+		ColumnBundle HYnew;
+		matrix HsubY; diagMatrix HsubY_eigs;
+		#define SWAP_C_Y \
+			std::swap(C, Y); \
+			std::swap(VdagC, VdagY); \
+			std::swap(Hsub, HsubY); \
+			std::swap(Hsub_eigs, HsubY_eigs);
+		SWAP_C_Y //Temporarily swap C and Y
+		eVars.applyHamiltonian(q, eye(nBands), HYnew, ener, true); //Hamiltonian always operates on C, where we put Y
+		SWAP_C_Y //Restore C and Y to correct places
+		#undef SWAP_C_Y
+		HY = HYnew;
+		return OY;
+	};
+	
+	int iter=1;
+	for(; iter<=mp.nIterations; iter++)
+	{	diagMatrix KEref = (-0.5) * diagDot(C, L(C)); //Update reference KE for preconditioning
+		//Trial bands, starting from current eigenvectors:
+		ColumnBundle Y = C, HY = HC, OY = O(C);
+		std::vector<matrix> VdagY = VdagC;
+		diagMatrix eps = Hsub_eigs; //Rayleigh quotient of each trial band
+		ColumnBundle R = HY; R -= OY * eps;
+		//History of each band and its residual (DIIS is performed independently for each band):
+		std::vector<ColumnBundle> Yhist, Rhist;
+		std::vector<std::vector<diagMatrix>> Bhist; //Bhist[i][j] = Re<R_i|R_j> for each band (j <= i)
+		diagMatrix lambda(nBands); //preconditioned step size for each band
+		for(int iStep=0; iStep<nSteps; iStep++)
+		{	//Add current trial bands to history:
+			Bhist.push_back(std::vector<diagMatrix>());
+			for(const ColumnBundle& Rprev: Rhist) Bhist.back().push_back(diagDot(R, Rprev));
+			Bhist.back().push_back(diagDot(R, R));
+			Yhist.push_back(Y);
+			Rhist.push_back(R);
+			//DIIS extrapolation of each band from its history:
+			int m = Yhist.size();
+			ColumnBundle Ybar = Y, Rbar = R;
+			if(m > 1)
+			{	std::vector<diagMatrix> alpha(m, diagMatrix(nBands));
+				for(int b=0; b<nBands; b++)
+				{	matrix B(m, m);
+					for(int i=0; i<m; i++)
+						for(int j=0; j<=i; j++)
+						{	B.set(i,j, Bhist[i][j][b]);
+							B.set(j,i, Bhist[i][j][b]);
+						}
+					std::vector<double> alphaB = diisCoefficients(B);
+					for(int i=0; i<m; i++) alpha[i][b] = alphaB[i];
+				}
+				Ybar = Yhist[0] * alpha[0];
+				Rbar = Rhist[0] * alpha[0];
+				for(int i=1; i<m; i++)
+				{	Ybar += Yhist[i] * alpha[i];
+					Rbar += Rhist[i] * alpha[i];
+				}
+			}
+			//Preconditioned residual step:
+			ColumnBundle D = Rbar; Rbar.free();
+			precond_inv_kinetic_band(D, KEref);
+			if(iStep == 0)
+			{	//Determine step size of each band by minimizing its residual norm along D:
+				std::vector<matrix> VdagD; ColumnBundle HD;
+				ColumnBundle OD = applyOH(D, VdagD, HD);
+				ColumnBundle dR = HD; dR -= OD * eps; //derivative of residual along D
+				diagMatrix RdotdR = diagDot(R, dR), dRdotdR = diagDot(dR, dR);
+				for(int b=0; b<nBands; b++)
+					lambda[b] = dRdotdR[b] ? -RdotdR[b]/dRdotdR[b] : 0.;
+				//Hamiltonian, overlap and projections of the first step follow linearly:
+				Y += D * lambda;
+				HY += HD * lambda;
+				OY += OD * lambda;
+				for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+					VdagY[sp] += VdagD[sp] * lambda;
+			}
+			else
+			{	Y = Ybar; Y += D * lambda;
+				OY = applyOH(Y, VdagY, HY);
+			}
+			//Update Rayleigh quotients and residuals:
+			diagMatrix YdotHY = diagDot(Y, HY), YdotOY = diagDot(Y, OY);
+			for(int b=0; b<nBands; b++) eps[b] = YdotHY[b] / YdotOY[b];
+			R = HY; R -= OY * eps;
+		}
+		Yhist.clear(); Rhist.clear();
+		
+		//Orthonormalize and rotate to subspace eigenvectors:
+		matrix YdagHY = innerWfns(Y, HY), YdagOY = innerWfns(Y, OY);
+		//--- check for bands that collapsed onto each other (near-singular overlap):
+		matrix YdagOY_evecs; diagMatrix YdagOY_eigs;
+		YdagOY.diagonalize(YdagOY_evecs, YdagOY_eigs, mpiGroup);
+		double overlapRatio = YdagOY_eigs.front() / YdagOY_eigs.back(); //eigenvalues are in ascending order
+		if(overlapRatio < overlapCutoff)
+		{	fprintf(mp.fpLog, "BandRMMDIIS: Bands collapsed (min/max overlap eigenvalue %le < %le); switching to Davidson.\n",
+				overlapRatio, overlapCutoff); fflush(mp.fpLog);
+			BandDavidson(e, q).minimize(mp); //restarts from C, which still holds the previous (orthonormal) eigenvectors
+			return;
+		}
+		matrix rot; //rotation from Y to subspace eigenvectors
+		YdagHY.diagonalize(YdagOY, rot, Hsub_eigs, mpiGroup);
+		C = multiplyWfns(Y, rot);
+		HC = multiplyWfns(HY, rot);
+		for(size_t sp=0; sp<VdagY.size(); sp++)
+			VdagC[sp] = VdagY[sp] ? VdagY[sp]*rot : matrix();
+		
+		//Print and test convergence
+		double EbandPrev = Eband;
+		Eband = qnum.weight * trace(Hsub_eigs);
+		double dEband = Eband - EbandPrev;
+		fprintf(mp.fpLog, "BandRMMDIIS: Iter: %3d  Eband: %+.15lf  dEband: %le  t[s]: %9.2lf\n", iter, Eband, dEband, clock_sec()); fflush(mp.fpLog);
+		if(dEband<0 and fabs(dEband)<mp.energyDiffThreshold)
+		{	fprintf(mp.fpLog, "BandRMMDIIS: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+			break;
+		}
+	}
+	if(iter>mp.nIterations)
+		fprintf(mp.fpLog, "BandRMMDIIS: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
+	fflush(mp.fpLog);
+	
+	//Update final quantities:
+	Hsub = Hsub_eigs;
+	Hsub_evecs = I;
+}
@@ -0,0 +1,53 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_BANDRMMDIIS_H
+#define JDFTX_ELECTRONIC_BANDRMMDIIS_H
+
+#include <core/Minimize.h>
+
+class Everything;
+
+//! @addtogroup ElecSystem
+//! @{
+
+//! Residual minimization / direct inversion in the iterative subspace (RMM-DIIS) eigensolver.
+//! Each band is refined independently by DIIS extrapolation of its own history of preconditioned
+//! residual steps, without any orthonormalization between these inner steps; the bands are
+//! orthonormalized only by the single subspace rotation at the end of each iteration.
+//! This requires reasonable starting wavefunctions (such as within SCF), since bands refined
+//! independently may otherwise converge to the same eigenvector. Such a collapse is detected
+//! from the overlap of the trial bands becoming near-singular, in which case the minimization
+//! of that quantum number continues with BandDavidson from the last orthonormal eigenvectors.
+class BandRMMDIIS
+{
+public:
+	BandRMMDIIS(Everything& e, int q); //!< Construct RMM-DIIS eigenvalue solver for quantum number q
+	void minimize(const MinimizeParams& mp); //!< Converge eigenproblem with tolerance set by mp (usually e.elecMinParams), logging to mp.fpLog
+	
+private:
+	Everything& e;
+	class ElecVars& eVars;
+	const class ElecInfo& eInfo;
+	int q;  //!< Current quantum number
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_BANDRMMDIIS_H
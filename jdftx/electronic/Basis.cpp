@@ -29,6 +29,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 Basis::Basis()
 {	gInfo = 0;
 	nbasis = 0;
+	realWavefunctions = false;
 }
 
 Basis::Basis(const Basis& basis)
@@ -42,6 +43,8 @@ Basis& Basis::operator=(const Basis& basis)
 	iGarr = basis.iGarr;
 	index = basis.index;
 	head = basis.head;
+	realWavefunctions = basis.realWavefunctions;
+	indexMinus = basis.indexMinus;
 	return *this;
 }
 
@@ -98,6 +101,8 @@ void Basis::setup(const GridInfo& gInfo, const IonInfo& iInfo,
 	memcpy(iGarr.data(), &iGvec[0], sizeof(vector3<int>)*nbasis);
 	memcpy(index.data(), &indexVec[0], sizeof(int)*nbasis);
 
+	realWavefunctions = false;
+	
 	//Initialize head:
 	head.clear();
 	for(size_t n=0; n<nbasis; n++)
@@ -105,3 +110,25 @@ void Basis::setup(const GridInfo& gInfo, const IonInfo& iInfo,
 			head.push_back(n);
 }
 
+void Basis::setupRealWavefunctions()
+{	//Retain G=0 (placed first) and the 'positive' one of each pair of +/-G:
+	std::vector< vector3<int> > iGvec(1, vector3<int>(0,0,0));
+	std::vector<int> indexVec(1, gInfo->fullGindex(vector3<int>(0,0,0)));
+	bool zeroFound = false;
+	for(const vector3<int>& iG: iGarr)
+	{	if(!iG.length_squared()) { zeroFound = true; continue; }
+		if(iG[0]>0 || (iG[0]==0 && (iG[1]>0 || (iG[1]==0 && iG[2]>0))))
+		{	iGvec.push_back(iG);
+			indexVec.push_back(gInfo->fullGindex(iG));
+		}
+	}
+	if(!zeroFound || 2*iGvec.size()-1 != nbasis)
+		die("Basis is not inversion symmetric, as required for real wavefunctions at Gamma.\n");
+	setup(*gInfo, *iInfo, indexVec, iGvec);
+	//Full G-space index of -G for each retained G:
+	indexMinus.init(nbasis);
+	int* indexMinusData = indexMinus.data();
+	for(size_t n=0; n<nbasis; n++)
+		indexMinusData[n] = gInfo->fullGindex(-iGvec[n]);
+	realWavefunctions = true;
+}
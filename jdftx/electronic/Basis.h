@@ -41,6 +41,14 @@ public:
 	IndexArray index;
 	std::vector<int> head; //!< short list of low G basis locations (used for phase fixing)
 	
+	//! Whether wavefunctions on this basis are real in real space (Gamma-only mode), so that C(-G) = C(G)*.
+	//! Only G=0 (always first) and one half of the remaining G-sphere are then stored, with the -G half implied by the symmetry;
+	//! see ColumnBundle::getColumn and operator^ for how the implied half is accounted for.
+	bool realWavefunctions;
+	IndexArray indexMinus; //!< full G-space index of -G for each stored G (only set when realWavefunctions)
+	
+	size_t nbasisFull() const { return realWavefunctions ? 2*nbasis-1 : nbasis; } //!< number of G-vectors in the full sphere, including those implied in Gamma-only mode
+	
 	Basis();
 	Basis(const Basis&); //!< copy by reference
 	Basis& operator=(const Basis&); //!< copy by reference
@@ -51,6 +59,10 @@ public:
 	//! Create a custom basis with an arbitrary indexing scheme
 	void setup(const GridInfo& gInfo, const IonInfo& iInfo, const std::vector<int>& indexVec);
 	
+	//! Switch on Gamma-only mode (realWavefunctions), reducing the basis to G=0 and half of the rest of the sphere,
+	//! and setting up indexMinus (basis must be an inversion-symmetric one at the Gamma point)
+	void setupRealWavefunctions();
+	
 private:
 	void setup(const GridInfo& gInfo, const IonInfo& iInfo,
 		const std::vector<int>& indexVec,
@@ -24,7 +24,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Random.h>
 #include <core/BlasExtra.h>
 #include <core/ScalarFieldIO.h>
+#include <core/AsyncWrite.h>
 #include <fftw3.h>
+#include <fcntl.h>
 
 // Called by other constructors to do the work
 void ColumnBundle::init(int nc, size_t len, const Basis *b, const QuantumNumber* q, bool onGpu)
@@ -95,6 +97,10 @@ void randomize(ColumnBundle& x)
 
 double dot(const ColumnBundle& x, const ColumnBundle& y)
 {	complex result = dotc(x, y)*2.0;
+	if(x.basis && x.basis->realWavefunctions) //Gamma-only mode: add the implied -G half, without double counting G=0
+	{	result *= 2.;
+		result -= 2.*callPref(eblas_zdotc)(x.nCols(), x.dataPref(), x.colLength(), y.dataPref(), y.colLength());
+	}
 	return result.real();
 }
 
@@ -126,6 +132,8 @@ complexScalarFieldTilde ColumnBundle::getColumn(int i, int s) const
 	complexScalarFieldTilde full; nullToZero(full, gInfo); //initialize a full G-space vector to zero
 	//scatter from the i'th column to the full vector:
 	callPref(eblas_scatter_zdaxpy)(basis->nbasis, 1., basis->index.dataPref(), dataPref()+index(i,s*basis->nbasis), full->dataPref());
+	if(basis->realWavefunctions) //Gamma-only mode: fill in the implied -G half of the sphere as C(-G) = C(G)* (skipping G=0)
+		callPref(eblas_scatter_zdaxpy)(basis->nbasis-1, 1., basis->indexMinus.dataPref()+1, dataPref()+index(i,1), full->dataPref(), true);
 	return full;
 }
 
@@ -140,6 +148,11 @@ void ColumnBundle::accumColumn(int i, int s, const complexScalarFieldTilde& full
 {	assert(full);
 	CHECK_COLUMN_INDEX
 	//Gather-accumulate from the full vector into the i'th column
+	if(basis->realWavefunctions) //Gamma-only mode: keep the part satisfying C(-G) = C(G)* (real part at G=0)
+	{	callPref(eblas_gather_zdaxpy)(basis->nbasis, 0.5, basis->index.dataPref(), full->dataPref(), dataPref()+index(i,0));
+		callPref(eblas_gather_zdaxpy)(basis->nbasis, 0.5, basis->indexMinus.dataPref(), full->dataPref(), dataPref()+index(i,0), true);
+		return;
+	}
 	callPref(eblas_gather_zdaxpy)(basis->nbasis, 1., basis->index.dataPref(), full->dataPref(), dataPref()+index(i,s*basis->nbasis));
 }
 #undef CHECK_COLUMN_INDEX
@@ -173,6 +186,9 @@ void ColumnBundle::randomize(int colStart, int colStop)
 				thisData[index(i,j+s*basis->nbasis)] = Random::normalComplex(sigma);
 		j++;
 	}
+	if(basis->realWavefunctions) //Gamma-only mode: G=0 component (stored first) must be real
+		for(int i=colStart; i<colStop; i++)
+			thisData[index(i,0)] = thisData[index(i,0)].real();
 	watch.stop();
 }
 void randomize(std::vector<ColumnBundle>& Y, const ElecInfo& eInfo)
@@ -182,8 +198,54 @@ void randomize(std::vector<ColumnBundle>& Y, const ElecInfo& eInfo)
 
 //--------- Read/write an array of ColumnBundles from/to a file --------------
 
+#if !MPI_SAFE_WRITE
+//Write nBytes of data at offset in a file of total length fSize, using plain POSIX I/O so that it can run on the background I/O thread.
+//Every process writes its own segment, and the head process sets the file length, so no ordering between processes is needed.
+static void writeSegment(const char* fname, const char* data, size_t nBytes, long offset, long fSize, bool setLength)
+{	int fd = open(fname, O_WRONLY | O_CREAT, 0666);
+	if(fd < 0) die_alone("Error opening file '%s' for writing.\n", fname);
+	if(setLength && ftruncate(fd, fSize)) die_alone("Error setting length of file '%s'.\n", fname);
+	while(nBytes)
+	{	ssize_t nWrote = pwrite(fd, data, nBytes, offset);
+		if(nWrote <= 0) die_alone("Error writing to file '%s'.\n", fname);
+		data += nWrote; offset += nWrote; nBytes -= nWrote;
+	}
+	close(fd);
+}
+#endif
+
+//Whether any of the local wavefunctions in Y are stored on a Gamma-only mode basis (Basis::realWavefunctions)
+static bool hasRealWavefunctions(const ElecInfo& eInfo, const std::vector<ColumnBundle>& Y)
+{	for(int q=eInfo.qStart; q<std::min(eInfo.qStop, int(Y.size())); q++)
+		if(Y[q].basis && Y[q].basis->realWavefunctions)
+			return true;
+	return false;
+}
+
+//Set up bases on the full G-sphere, and corresponding ColumnBundles, for the Gamma-only mode wavefunctions in Y
+static void setupFullBasis(const ElecInfo& eInfo, const std::vector<ColumnBundle>& Y, double Ecut,
+	std::vector<Basis>& basisFull, std::vector<ColumnBundle>& Yfull)
+{	basisFull.resize(eInfo.qStop);
+	Yfull.resize(eInfo.qStop);
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	const Basis& basis = *(Y[q].basis);
+		assert(basis.realWavefunctions);
+		logSuspend();
+		basisFull[q].setup(*(basis.gInfo), *(basis.iInfo), Ecut, Y[q].qnum->k);
+		logResume();
+		Yfull[q].init(Y[q].nCols(), basisFull[q].nbasis, &basisFull[q], Y[q].qnum, isGpuEnabled());
+	}
+}
+
 void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) const
-{
+{	if(hasRealWavefunctions(*this, Y)) //Expand to the full G-sphere, so that the file format is independent of gamma-only mode:
+	{	std::vector<Basis> basisFull; std::vector<ColumnBundle> Yfull;
+		setupFullBasis(*this, Y, e->cntrl.Ecut, basisFull, Yfull);
+		for(int q=qStart; q<qStop; q++)
+			makeFull(Yfull[q], Y[q]);
+		write(Yfull, fname); //bases of Yfull are not real, so this writes directly
+		return;
+	}
 #if MPI_SAFE_WRITE
 	//Safe mode / write from head:
 	if(mpiWorld->isHead())
@@ -201,7 +263,7 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 		}
 		fclose(fp);
 	}
-	else
+	else if(mpiGroup->isHead())
 		for(int q=qStart; q<qStop; q++)
 		{	mpiWorld->send(Y[q].nData(), 0, q);
 			mpiWorld->sendData(Y[q], 0, q);
@@ -209,8 +271,9 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 #else
 	//Compute output length from each process:
 	std::vector<long> nBytes(mpiWorld->nProcesses(), 0); //total bytes to be written on each process
-	for(int q=qStart; q<qStop; q++)
-		nBytes[mpiWorld->iProcess()] += Y[q].nData()*sizeof(complex);
+	if(mpiGroup->isHead()) //other processes in group have identical copies
+		for(int q=qStart; q<qStop; q++)
+			nBytes[mpiWorld->iProcess()] += Y[q].nData()*sizeof(complex);
 	//Sync nBytes across processes:
 	if(mpiWorld->nProcesses()>1)
 		for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
@@ -221,11 +284,34 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 	{	if(iSrc<mpiWorld->iProcess()) offset += nBytes[iSrc];
 		fsize += nBytes[iSrc];
 	}
+	if(asyncWriteEnabled)
+	{	//Snapshot local data and write it from the background I/O thread:
+		size_t nBytesMine = nBytes[mpiWorld->iProcess()];
+		auto buf = std::make_shared<std::vector<char>>(nBytesMine);
+		if(nBytesMine)
+		{	char* bufPtr = buf->data();
+			for(int q=qStart; q<qStop; q++)
+			{	size_t nBytesQ = Y[q].nData()*sizeof(complex);
+				memcpy(bufPtr, Y[q].data(), nBytesQ);
+				bufPtr += nBytesQ;
+			}
+			convertToLE(buf->data(), sizeof(double), nBytesMine/sizeof(double));
+		}
+		bool setLength = mpiWorld->isHead();
+		if(!(nBytesMine || setLength)) return; //nothing to do on this process
+		string fnameCopy(fname);
+		asyncWrite([buf, fnameCopy, offset, fsize, setLength]()
+		{	writeSegment(fnameCopy.c_str(), buf->data(), buf->size(), offset, fsize, setLength);
+		}, nBytesMine);
+		return;
+	}
 	//Write to file:
 	MPIUtil::File fp; mpiWorld->fopenWrite(fp, fname);
-	mpiWorld->fseek(fp, offset, SEEK_SET);
-	for(int q=qStart; q<qStop; q++)
-		mpiWorld->fwriteData(Y[q], fp);
+	if(mpiGroup->isHead())
+	{	mpiWorld->fseek(fp, offset, SEEK_SET);
+		for(int q=qStart; q<qStop; q++)
+			mpiWorld->fwriteData(Y[q], fp);
+	}
 	mpiWorld->fclose(fp);
 #endif
 }
@@ -237,7 +323,15 @@ ElecInfo::ColumnBundleReadConversion::ColumnBundleReadConversion()
 }
 
 void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion) const
-{	if(conversion && conversion->realSpace)
+{	if(hasRealWavefunctions(*this, Y)) //Read on the full G-sphere and convert to real wavefunctions:
+	{	std::vector<Basis> basisFull; std::vector<ColumnBundle> Yfull;
+		setupFullBasis(*this, Y, e->cntrl.Ecut, basisFull, Yfull);
+		read(Yfull, fname, conversion); //bases of Yfull are not real, so this reads directly
+		for(int q=qStart; q<qStop; q++)
+			makeReal(Y[q], Yfull[q]);
+		return;
+	}
+	if(conversion && conversion->realSpace)
 	{	if(qStop==qStart) return; //no k-point on this process
 		const GridInfo* gInfoWfns = Y[qStart].basis->gInfo;
 		//Create a custom gInfo if necessary:
@@ -287,16 +381,18 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 			const Basis* basis = customBasis ? &basisTmp[q] : Y[q].basis;
 			int nSpinor = Y[q].spinorLength();
 			if(needTmp) Ytmp[q].init(nCols, basis->nbasis*nSpinor, basis, Y[q].qnum);
-			nBytes[mpiWorld->iProcess()] += nCols * basis->nbasis*nSpinor * sizeof(complex);
+			if(mpiGroup->isHead()) //other processes in group read the same data
+				nBytes[mpiWorld->iProcess()] += nCols * basis->nbasis*nSpinor * sizeof(complex);
 		}
 		//Sync nBytes:
 		if(mpiWorld->nProcesses()>1)
 			for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
 				mpiWorld->bcast(nBytes[iSrc], iSrc);
-		//Compute offset of current process, and expected file length:
+		//Compute offset of current process (same as head of its group), and expected file length:
 		long offset=0, fsize=0;
+		int iGroupHead = mpiWorld->iProcess() - mpiGroup->iProcess();
 		for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
-		{	if(iSrc<mpiWorld->iProcess()) offset += nBytes[iSrc];
+		{	if(iSrc<iGroupHead) offset += nBytes[iSrc];
 			fsize += nBytes[iSrc];
 		}
 		//Read data into Ytmp or Y as appropriate, and convert if necessary:
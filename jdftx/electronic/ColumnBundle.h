@@ -135,9 +135,25 @@ ColumnBundle operator+(const ColumnBundleMatrixProduct &XM1, const ColumnBundleM
 ColumnBundle operator-(const ColumnBundleMatrixProduct &XM1, const ColumnBundleMatrixProduct &XM2);
 
 ColumnBundle operator*(const scaled<ColumnBundle>&, const diagMatrix&);
-matrix operator^(const scaled<ColumnBundle>&, const scaled<ColumnBundle>&); //!< inner product
+//! Inner product. In Gamma-only mode (Basis::realWavefunctions), this sums over the full G-sphere by adding the implied -G half,
+//! which is valid only when both operands are real in real space (eg. wavefunctions, and projectors and orbitals with the Gamma-only phases);
+//! the result is then real and is computed with a real matrix multiply at half the cost.
+matrix operator^(const scaled<ColumnBundle>&, const scaled<ColumnBundle>&);
 vector3<matrix> spinOverlap(const scaled<ColumnBundle> &sY); //!< spin-resolved inner product for a spinorial ColumnBundle
 
+//! Inner product Y1^Y2 of wavefunction-like bundles (eg. C and O(C) or H(C)), which is real in Gamma-only mode (see operator^).
+//! Columns of the result are split over mpiGroup (see band-parallel work below), so this must be called by all processes in mpiGroup.
+matrix innerWfns(const ColumnBundle& Y1, const ColumnBundle& Y2);
+
+//! Set Gamma-only mode wavefunctions Y (on a Basis with realWavefunctions) from arbitrary ones, Yfull, on the full G-sphere,
+//! retaining as much of the span of Yfull as possible with wavefunctions that are real in real space.
+//! The result is not orthonormal and must be orthonormalized by the caller.
+void makeReal(ColumnBundle& Y, const ColumnBundle& Yfull);
+
+//! Expand Gamma-only mode wavefunctions Y to Yfull on the full G-sphere (Yfull must be allocated with the same
+//! number of columns on a basis with Y.basis->nbasisFull() entries); inverse of makeReal for wavefunctions that are already real.
+void makeFull(ColumnBundle& Yfull, const ColumnBundle& Y);
+
 //------------------------------ Other operators ---------------------------------
 
 //! Return Idag V .* I C (evaluated columnwise)
@@ -163,6 +179,19 @@ void translateColumns(ColumnBundle&, const vector3<>* dr); //!< translate each c
 
 ColumnBundle switchBasis(const ColumnBundle&, const Basis&); //!< return wavefunction projected to a different basis
 
+//------------------------------ Band-parallel work ---------------------------------
+
+//When mpiGroup has more than one process, all processes in a group share the group's states and hold identical
+//copies of the wavefunctions, but split the work on columns (bands) amongst themselves using the functions below.
+//This parallelizes the work only: wavefunctions, projectors and O() remain replicated on every process of the group.
+//These must be called by all processes in mpiGroup, and reduce to the corresponding serial operations otherwise.
+
+TaskDivision bandDivision(int nCols); //!< division of nCols columns amongst processes in mpiGroup
+void allGatherColumns(ColumnBundle& Y, const TaskDivision& bandDiv); //!< make columns of Y computed by each process (in its range of bandDiv) available to all of mpiGroup
+void allGatherColumns(matrix& M, const TaskDivision& bandDiv); //!< make columns of M computed by each process (in its range of bandDiv) available to all of mpiGroup
+ColumnBundle multiplyWfns(const ColumnBundle& Y, const matrix& M); //!< Y * M with columns of the result split over mpiGroup
+ColumnBundle Idag_DiagV_I_wfns(const ColumnBundle& C, const ScalarFieldArray& V); //!< Idag_DiagV_I with columns split over mpiGroup
+
 //------------------------------ Reductions ---------------------------------
 
 //! Return trace(F*X^Y)
@@ -84,6 +84,26 @@ void ColumnBundleMatrixProduct::scaleAccumulate(double alpha, double beta, Colum
 		nColsOut = Mst.nCols();
 		if(beta) { assert(YM); assert(YM.nCols()==nColsOut); assert(YM.colLength()==Y.colLength()); }
 		else YM = Y.similar(nColsOut);
+		#ifndef GPU_ENABLED
+		//Real matrices (eg. subspace rotations in Gamma-only mode) can be applied with a real matrix multiply at half the cost:
+		int nRowsM = Mst.nRows();
+		std::vector<double> Mreal(nRowsM*nColsOut);
+		bool isReal = true;
+		for(int j=0; j<nColsOut && isReal; j++)
+			for(int i=0; i<nRowsM; i++)
+			{	const complex& Mij = Mst.mat.data()[Mst.index(i,j)];
+				if(Mij.imag()) { isReal = false; break; }
+				Mreal[i+nRowsM*j] = Mij.real();
+			}
+		if(isReal)
+		{	int colLength = 2*Y.colLength(); //complex columns viewed as real arrays
+			eblas_dgemm(CblasNoTrans, CblasNoTrans, colLength, nColsOut, Y.nCols(),
+				scaleFac, (const double*)Y.data(), colLength, Mreal.data(), nRowsM,
+				beta, (double*)YM.data(), colLength);
+			watch.stop();
+			return;
+		}
+		#endif
 	}
 	callPref(eblas_zgemm)(CblasNoTrans, Mop, Y.colLength(), nColsOut, Y.nCols(),
 		scaleFac, Y.dataPref(), Y.colLength(), Mdata, ldM,
@@ -144,6 +164,28 @@ matrix operator^(const scaled<ColumnBundle> &sY1, const scaled<ColumnBundle> &sY
 		colLength = Y1.basis->nbasis;
 	}
 	matrix Y1dY2(nCols1, nCols2, isGpuEnabled());
+	if(Y1.basis && Y1.basis->realWavefunctions) //Gamma-only mode: sum over the full G-sphere, adding the implied -G half
+	{	//Y1^Y2 = 2 Re(sum over stored half) - (G=0 term, which is stored first and would be counted twice):
+		#ifdef GPU_ENABLED
+		eblas_zgemm_gpu(CblasConjTrans, CblasNoTrans, nCols1, nCols2, colLength,
+			scaleFac, Y1.dataGpu(), colLength, Y2.dataGpu(), colLength,
+			0.0, Y1dY2.dataGpu(), Y1dY2.nRows());
+		Y1dY2 += conj(Y1dY2);
+		#else
+		//Real part from a real matrix multiply of the data viewed as real arrays of twice the column length (half the cost of zgemm):
+		std::vector<double> Y1dY2real(nCols1*nCols2);
+		eblas_dgemm(CblasTrans, CblasNoTrans, nCols1, nCols2, 2*colLength,
+			2.*scaleFac, (const double*)Y1.data(), 2*colLength, (const double*)Y2.data(), 2*colLength,
+			0., Y1dY2real.data(), nCols1);
+		complex* Y1dY2data = Y1dY2.data();
+		for(int i=0; i<nCols1*nCols2; i++) Y1dY2data[i] = Y1dY2real[i];
+		#endif
+		callPref(eblas_zgemm)(CblasConjTrans, CblasNoTrans, nCols1, nCols2, 1,
+			-scaleFac, Y1.dataPref(), colLength, Y2.dataPref(), colLength,
+			1.0, Y1dY2.dataPref(), Y1dY2.nRows());
+		watch.stop();
+		return Y1dY2;
+	}
 	callPref(eblas_zgemm)(CblasConjTrans, CblasNoTrans, nCols1, nCols2, colLength,
 		scaleFac, Y1.dataPref(), colLength, Y2.dataPref(), colLength,
 		0.0, Y1dY2.dataPref(), Y1dY2.nRows());
@@ -164,6 +206,50 @@ matrix operator^(const scaled<ColumnBundle> &sY1, const scaled<ColumnBundle> &sY
 	else return Y1dY2; //normal mode (neither is a spinor)
 }
 
+matrix innerWfns(const ColumnBundle& Y1, const ColumnBundle& Y2)
+{	assert(Y1.basis && Y1.basis==Y2.basis);
+	if(mpiGroup->nProcesses() == 1) return Y1^Y2;
+	//Split columns of the result over the process group:
+	TaskDivision bandDiv = bandDivision(Y2.nCols());
+	matrix Y1dY2 = zeroes(Y1.nCols(), Y2.nCols());
+	if(bandDiv.stop() > bandDiv.start())
+		Y1dY2.set(0,Y1.nCols(), bandDiv.start(),bandDiv.stop(), Y1^Y2.getSub(bandDiv.start(),bandDiv.stop()));
+	allGatherColumns(Y1dY2, bandDiv);
+	return Y1dY2;
+}
+
+void makeReal(ColumnBundle& Y, const ColumnBundle& Yfull)
+{	static StopWatch watch("makeReal"); watch.start();
+	assert(Y.basis->realWavefunctions);
+	assert(!Y.isSpinor());
+	assert(Y.nCols() == Yfull.nCols());
+	//Real and imaginary parts of each column (parts of psi and -i psi satisfying C(-G) = C(G)*):
+	int nCols = Y.nCols();
+	ColumnBundle R = Y.similar(2*nCols);
+	ColumnBundle minusIYfull = Yfull * complex(0,-1);
+	for(int b=0; b<nCols; b++)
+	{	R.setColumn(b,0, Yfull.getColumn(b,0));
+		R.setColumn(b+nCols,0, minusIYfull.getColumn(b,0));
+	}
+	//Retain the dominant nCols-dimensional subspace of those 2*nCols real columns:
+	matrix Rsub_evecs; diagMatrix Rsub_eigs;
+	innerWfns(R, R).diagonalize(Rsub_evecs, Rsub_eigs); //eigenvalues in ascending order
+	Y = R * Rsub_evecs(0,2*nCols, nCols,2*nCols);
+	watch.stop();
+}
+
+void makeFull(ColumnBundle& Yfull, const ColumnBundle& Y)
+{	static StopWatch watch("makeFull"); watch.start();
+	assert(Y.basis->realWavefunctions);
+	assert(!Y.isSpinor());
+	assert(!Yfull.basis->realWavefunctions);
+	assert(Yfull.nCols() == Y.nCols());
+	assert(Yfull.colLength() == Y.basis->nbasisFull());
+	for(int b=0; b<Y.nCols(); b++)
+		Yfull.setColumn(b,0, Y.getColumn(b,0)); //getColumn fills in the implied -G half
+	watch.stop();
+}
+
 vector3<matrix> spinOverlap(const scaled<ColumnBundle> &sY)
 {	const ColumnBundle& Y = sY.data;
 	double scaleFac = std::pow(sY.scale, 2) * Y.basis->gInfo->detR; //norm conserving part of O
@@ -215,6 +301,175 @@ void Idag_DiagVmat_I_sub(int colStart, int colEnd, const ColumnBundle* C, const
 	
 }
 
+#ifndef GPU_ENABLED
+//Gamma-only mode: scatter-accumulate a times a real wavefunction from its stored half G-sphere (C) into a full G-space box,
+//filling in the implied -G half as a C(G)* (G=0 is stored first and has no separate -G entry)
+inline void scatterReal(const Basis& basis, complex a, const complex* C, complex* full)
+{	eblas_scatter_zaxpy(basis.nbasis, a, basis.index.data(), C, full);
+	eblas_scatter_zaxpy(basis.nbasis-1, a, basis.indexMinus.data()+1, C+1, full, true);
+}
+
+//Batched CPU versions of the above: process several columns at once with a single multi-transform FFTW plan,
+//scattering directly from the G-sphere into the batch of boxes, and gathering directly back out of them
+namespace IdagDiagVIbatch
+{
+	const int nBatchMax = 16; //maximum number of transforms per batch (power of 2)
+	const size_t bufSizeMax = size_t(1) << 25; //maximum batch buffer size in bytes per thread
+	
+	//Maximum number of transforms per batch for a given grid: a power of 2 independent of the work split,
+	//so that only the batch sizes 2, 4, ..., nBatchMax are ever planned for each grid
+	inline int getBatchSize(const GridInfo& gInfo)
+	{	int nBatchMem = std::max(size_t(1), bufSizeMax / (sizeof(complex)*gInfo.batchStride()));
+		int nBatch = 1;
+		while(2*nBatch <= std::min(nBatchMax, nBatchMem)) nBatch *= 2;
+		return nBatch;
+	}
+	
+	//Number of transforms to process next: largest power of 2 not exceeding nBatch and nRemaining
+	//(splits remainders into smaller planned batches, down to single transforms)
+	inline int getCurBatch(int nBatch, int nRemaining)
+	{	int nCur = 1;
+		while(2*nCur <= std::min(nBatch, nRemaining)) nCur *= 2;
+		return nCur;
+	}
+	
+	//Transform nCur arrays in buf (nCur must be a power of 2, as returned by getCurBatch):
+	inline void transform(const GridInfo& gInfo, GridInfo::PlanType planType, int nCur, complex* buf)
+	{	static StopWatch watch("FFT(batch)"); watch.start();
+		if(nCur>1)
+			fftw_execute_dft(gInfo.getPlanBatch(planType, 1, nCur), (fftw_complex*)buf, (fftw_complex*)buf);
+		else
+			fftw_execute_dft(gInfo.getPlan(planType, 1), (fftw_complex*)buf, (fftw_complex*)buf);
+		watch.stop();
+	}
+	
+	void collinear_sub(int colStart, int colEnd, const ColumnBundle* C, const ScalarFieldArray* V, ColumnBundle* VC)
+	{	const ScalarField& Vs = V->at(V->size()==1 ? 0 : C->qnum->index());
+		const Basis& basis = *(C->basis);
+		const GridInfo& gInfo = *(basis.gInfo);
+		const int* index = basis.index.data();
+		const int nSpinor = VC->spinorLength();
+		const int stride = gInfo.batchStride();
+		const int nTransforms = (colEnd-colStart) * nSpinor; //each (column,spinor) pair is one transform
+		const int nBatch = getBatchSize(gInfo);
+		ManagedArray<complex> bufMem; bufMem.init(size_t(stride)*getCurBatch(nBatch, nTransforms));
+		complex* buf = bufMem.data();
+		for(int jStart=0, nCur=0; jStart<nTransforms; jStart+=nCur)
+		{	nCur = getCurBatch(nBatch, nTransforms-jStart);
+			//Scatter from G-sphere to boxes:
+			eblas_zero(stride*nCur, buf);
+			for(int j=0; j<nCur; j++)
+			{	int col = colStart + (jStart+j)/nSpinor, s = (jStart+j)%nSpinor;
+				eblas_scatter_zdaxpy(basis.nbasis, 1., index, C->data()+C->index(col,s*basis.nbasis), buf+j*stride);
+			}
+			//Apply potential in real space:
+			transform(gInfo, GridInfo::PlanInverseInPlace, nCur, buf);
+			for(int j=0; j<nCur; j++)
+				eblas_zmuld(gInfo.nr, Vs->data(false), 1, buf+j*stride, 1);
+			transform(gInfo, GridInfo::PlanForwardInPlace, nCur, buf);
+			//Gather-accumulate from boxes to G-sphere (potential scale factor absorbed here):
+			for(int j=0; j<nCur; j++)
+			{	int col = colStart + (jStart+j)/nSpinor, s = (jStart+j)%nSpinor;
+				eblas_gather_zdaxpy(basis.nbasis, Vs->scale, index, buf+j*stride, VC->data()+VC->index(col,s*basis.nbasis));
+			}
+		}
+	}
+	
+	//Gamma-only version of collinear_sub: two real wavefunctions are transformed together as the real and imaginary parts of one complex FFT.
+	//Columns 2*pair and 2*pair+1 are processed for each pair in [pairStart,pairEnd) (the last pair may have only one column).
+	//Each column is expanded from the stored half G-sphere with C(-G) = C(G)* (see ColumnBundle::getColumn), which makes both real in
+	//real space (Hermitian in G-space) by construction, provided their G=0 components are real (as maintained by accumColumn and randomize).
+	//The separation of the two results below relies on this, and silently drops the imaginary part of any G=0 component.
+	void realPair_sub(int pairStart, int pairEnd, const ColumnBundle* C, const ScalarFieldArray* V, ColumnBundle* VC)
+	{	const ScalarField& Vs = V->at(V->size()==1 ? 0 : C->qnum->index());
+		const Basis& basis = *(C->basis);
+		const GridInfo& gInfo = *(basis.gInfo);
+		const int* index = basis.index.data();
+		const int* indexMinus = basis.indexMinus.data();
+		const int stride = gInfo.batchStride();
+		const int nTransforms = pairEnd - pairStart;
+		const int nBatch = getBatchSize(gInfo);
+		ManagedArray<complex> bufMem; bufMem.init(size_t(stride)*getCurBatch(nBatch, nTransforms));
+		complex* buf = bufMem.data();
+		for(int jStart=0, nCur=0; jStart<nTransforms; jStart+=nCur)
+		{	nCur = getCurBatch(nBatch, nTransforms-jStart);
+			//Scatter C[col0] + i C[col1] from G-sphere to boxes:
+			eblas_zero(stride*nCur, buf);
+			for(int j=0; j<nCur; j++)
+			{	int col0 = 2*(pairStart+jStart+j), col1 = col0+1;
+				scatterReal(basis, 1., C->data()+C->index(col0,0), buf+j*stride);
+				if(col1 < C->nCols())
+					scatterReal(basis, complex(0,1), C->data()+C->index(col1,0), buf+j*stride);
+			}
+			//Apply potential in real space:
+			transform(gInfo, GridInfo::PlanInverseInPlace, nCur, buf);
+			for(int j=0; j<nCur; j++)
+				eblas_zmuld(gInfo.nr, Vs->data(false), 1, buf+j*stride, 1);
+			transform(gInfo, GridInfo::PlanForwardInPlace, nCur, buf);
+			//Separate the two results using C(-G) = C(G)* and accumulate (potential scale factor absorbed here):
+			const complex halfScale = 0.5*Vs->scale, minusHalfScaleI = complex(0, -0.5*Vs->scale);
+			for(int j=0; j<nCur; j++)
+			{	int col0 = 2*(pairStart+jStart+j), col1 = col0+1;
+				const complex* F = buf+j*stride;
+				complex* VC0 = VC->data()+VC->index(col0,0);
+				complex* VC1 = (col1 < C->nCols()) ? VC->data()+VC->index(col1,0) : 0;
+				for(size_t n=0; n<basis.nbasis; n++)
+				{	complex Fplus = F[index[n]], FminusConj = F[indexMinus[n]].conj();
+					VC0[n] += halfScale * (Fplus + FminusConj);
+					if(VC1) VC1[n] += minusHalfScaleI * (Fplus - FminusConj);
+				}
+			}
+		}
+	}
+	
+	//Apply 2x2 potential matrix to a pair of up and down spinor components in real space:
+	inline void applyVmat(int nr, const double* Vup, const double* Vdn, const complex* VupDn, const complex* VdnUp, complex* up, complex* dn)
+	{	for(int i=0; i<nr; i++)
+		{	complex upOut = Vup[i]*up[i] + VupDn[i]*dn[i];
+			complex dnOut = Vdn[i]*dn[i] + VdnUp[i]*up[i];
+			up[i] = upOut;
+			dn[i] = dnOut;
+		}
+	}
+	
+	void noncollinear_sub(int colStart, int colEnd, const ColumnBundle* C, const ScalarField* Vup, const ScalarField* Vdn,
+		const complexScalarField* VupDn, const complexScalarField* VdnUp, ColumnBundle* VC)
+	{	const Basis& basis = *(C->basis);
+		const GridInfo& gInfo = *(basis.gInfo);
+		const int* index = basis.index.data();
+		const int stride = gInfo.batchStride();
+		const int nTransforms = (colEnd-colStart) * 2; //up and down components of each column in adjacent slots
+		const int nBatch = std::max(2, getBatchSize(gInfo)); //keep batch even to keep spinor pairs together
+		ManagedArray<complex> bufMem; bufMem.init(size_t(stride)*getCurBatch(nBatch, nTransforms));
+		complex* buf = bufMem.data();
+		//Potential scale factors have been absorbed by caller (avoid absorbing concurrently from threads):
+		const double* VupData = (*Vup)->data(false);
+		const double* VdnData = (*Vdn)->data(false);
+		const complex* VupDnData = (*VupDn)->data(false);
+		const complex* VdnUpData = (*VdnUp)->data(false);
+		for(int jStart=0, nCur=0; jStart<nTransforms; jStart+=nCur)
+		{	nCur = getCurBatch(nBatch, nTransforms-jStart); //always even, since nBatch and nTransforms are
+			//Scatter from G-sphere to boxes:
+			eblas_zero(stride*nCur, buf);
+			for(int j=0; j<nCur; j++)
+			{	int col = colStart + (jStart+j)/2, s = (jStart+j)%2;
+				eblas_scatter_zdaxpy(basis.nbasis, 1., index, C->data()+C->index(col,s*basis.nbasis), buf+j*stride);
+			}
+			//Apply potential in real space:
+			transform(gInfo, GridInfo::PlanInverseInPlace, nCur, buf);
+			for(int j=0; j<nCur; j+=2)
+				applyVmat(gInfo.nr, VupData, VdnData, VupDnData, VdnUpData, buf+j*stride, buf+(j+1)*stride);
+			transform(gInfo, GridInfo::PlanForwardInPlace, nCur, buf);
+			//Gather-accumulate from boxes to G-sphere:
+			for(int j=0; j<nCur; j++)
+			{	int col = colStart + (jStart+j)/2, s = (jStart+j)%2;
+				eblas_gather_zdaxpy(basis.nbasis, 1., index, buf+j*stride, VC->data()+VC->index(col,s*basis.nbasis));
+			}
+		}
+	}
+}
+#endif
+
 ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V)
 {	static StopWatch watch("Idag_DiagV_I"); watch.start();
 	ColumnBundle VC = C.similar(); VC.zero();
@@ -228,13 +483,27 @@ ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V)
 	assert(Vwfns.size()==1 || Vwfns.size()==2 || Vwfns.size()==4);
 	if(Vwfns.size()==2) assert(!C.isSpinor());
 	if(Vwfns.size()==1 || Vwfns.size()==2)
-	{	threadLaunch(isGpuEnabled()?1:0, Idag_DiagV_I_sub, C.nCols(), &C, &Vwfns, &VC);
+	{
+		#ifdef GPU_ENABLED
+		threadLaunch(1, Idag_DiagV_I_sub, C.nCols(), &C, &Vwfns, &VC);
+		#else
+		if(C.basis->realWavefunctions)
+			threadLaunch(IdagDiagVIbatch::realPair_sub, (C.nCols()+1)/2, &C, &Vwfns, &VC);
+		else
+			threadLaunch(IdagDiagVIbatch::collinear_sub, C.nCols(), &C, &Vwfns, &VC);
+		#endif
 	}
 	else //Vwfns.size()==4
 	{	assert(C.isSpinor());
 		complexScalarField VupDn = 0.5*Complex(Vwfns[2], Vwfns[3]);
 		complexScalarField VdnUp = conj(VupDn);
-		threadLaunch(isGpuEnabled()?1:0, Idag_DiagVmat_I_sub, C.nCols(), &C, &Vwfns[0], &Vwfns[1], &VupDn, &VdnUp, &VC);
+		#ifdef GPU_ENABLED
+		threadLaunch(1, Idag_DiagVmat_I_sub, C.nCols(), &C, &Vwfns[0], &Vwfns[1], &VupDn, &VdnUp, &VC);
+		#else
+		for(int s=0; s<2; s++) Vwfns[s]->absorbScale();
+		VupDn->absorbScale(); VdnUp->absorbScale();
+		threadLaunch(IdagDiagVIbatch::noncollinear_sub, C.nCols(), &C, &Vwfns[0], &Vwfns[1], &VupDn, &VdnUp, &VC);
+		#endif
 	}
 	watch.stop();
 	return VC;
@@ -308,6 +577,7 @@ matrix3<> Lstress(const ColumnBundle &Y, const diagMatrix& F)
 		basis.nbasis, Y.nCols()*nSpinor, Y.data(), Fbuf.data(), basis.iGarr.data(), Y.qnum->k, result.data());
 	#endif
 	matrix3<> resultSum = callPref(eblas_sum)(basis.nbasis, result.dataPref());
+	if(basis.realWavefunctions) resultSum *= 2.; //Gamma-only mode: implied -G half contributes equally (and G=0 contributes nothing)
 	//Process result:
 	return 2*gInfo.detR * (gInfo.GT * resultSum * gInfo.G); //note explicit detR derivative not included here
 }
@@ -393,6 +663,9 @@ diagMatrix diagDot(const ColumnBundle& X, const ColumnBundle& Y)
 	const complex* Ydata = Y.dataPref();
 	for(size_t b=0; b<ret.size(); b++)
 		ret[b] = callPref(eblas_zdotc)(X.colLength(), Xdata+X.index(b,0),1, Ydata+Y.index(b,0),1).real();
+	if(X.basis->realWavefunctions) //Gamma-only mode: add the implied -G half, without double counting G=0 (stored first)
+		for(size_t b=0; b<ret.size(); b++)
+			ret[b] = 2.*ret[b] - callPref(eblas_zdotc)(1, Xdata+X.index(b,0),1, Ydata+Y.index(b,0),1).real();
 	return ret;
 }
 
@@ -483,6 +756,11 @@ complex traceinner(const diagMatrix &F, const ColumnBundle &X, const ColumnBundl
 	complex result = 0.0;
 	for (int i=0; i < X.nCols(); i++)
 		result += F[i] * callPref(eblas_zdotc)(X.colLength(), X.dataPref()+X.index(i,0), 1, Y.dataPref()+Y.index(i,0), 1);
+	if(X.basis && X.basis->realWavefunctions) //Gamma-only mode: add the implied -G half, without double counting G=0 (stored first)
+	{	result = 2.*result.real();
+		for (int i=0; i < X.nCols(); i++)
+			result -= F[i] * callPref(eblas_zdotc)(1, X.dataPref()+X.index(i,0), 1, Y.dataPref()+Y.index(i,0), 1);
+	}
 	return result;
 }
 
@@ -496,6 +774,28 @@ void diagouterI_sub(int iThread, int nThreads, const diagMatrix *F, const Column
 	ScalarFieldArray& nLocal = (*nSub)[iThread];
 	nullToZero(nLocal, *(X->basis->gInfo)); //sets to zero
 	int nDensities = nLocal.size();
+	#ifndef GPU_ENABLED
+	if(X->basis->realWavefunctions) //Gamma-only mode: transform pairs of real wavefunctions as real and imaginary parts of one FFT
+	{	//Both columns are expanded from the half G-sphere as in realPair_sub, so they are real in real space by construction
+		//(given real G=0 components); any imaginary part at G=0 would leak between the two densities.
+		const Basis& basis = *(X->basis);
+		const int nr = basis.gInfo->nr;
+		double* nData = nLocal[0]->data();
+		for(int i=colStart; i<colStop; i+=2)
+		{	complexScalarFieldTilde pairTilde = X->getColumn(i,0);
+			double Fi = (*F)[i], Fnext = 0.;
+			if(i+1 < colStop)
+			{	scatterReal(basis, complex(0,1), X->data()+X->index(i+1,0), pairTilde->data());
+				Fnext = (*F)[i+1];
+			}
+			complexScalarField psiPair = I(pairTilde);
+			const complex* psiData = psiPair->data();
+			for(int r=0; r<nr; r++)
+				nData[r] += Fi*std::pow(psiData[r].real(),2) + Fnext*std::pow(psiData[r].imag(),2);
+		}
+		return;
+	}
+	#endif
 	if(nDensities==1) //Note that nDensities==2 below will also enter this branch sinc eonly one component is non-zero
 	{	int nSpinor = X->spinorLength();
 		for(int i=colStart; i<colStop; i++)
@@ -539,7 +839,7 @@ ScalarFieldArray diagouterI(const diagMatrix &F,const ColumnBundle &X,  int nDen
 	if(nDensities==4) assert(X.isSpinor());
 	
 	//Collect the contributions for different sets of columns in separate scalar fields (one per thread):
-	int nThreads = isGpuEnabled() ? 1: nProcsAvailable;
+	int nThreads = isGpuEnabled() ? 1: nOperatorThreads();
 	std::vector<ScalarFieldArray> nSub(nThreads, ScalarFieldArray(nDensities==2 ? 1 : nDensities)); //collinear spin-polarized will have only one non-zero output channel
 	threadLaunch(nThreads, diagouterI_sub, 0, &F, &X, &nSub);
 
@@ -559,3 +859,50 @@ ScalarFieldArray diagouterI(const diagMatrix &F,const ColumnBundle &X,  int nDen
 	}
 	return nSub[0]; //rest cleaned up destructor
 }
+
+
+//------------------------------ Band-parallel work ---------------------------------
+
+TaskDivision bandDivision(int nCols)
+{	return TaskDivision(nCols, mpiGroup);
+}
+
+void allGatherColumns(ColumnBundle& Y, const TaskDivision& bandDiv)
+{	if(mpiGroup->nProcesses() == 1) return;
+	static StopWatch watch("allGatherColumns"); watch.start();
+	for(int iSrc=0; iSrc<mpiGroup->nProcesses(); iSrc++)
+	{	int colStart = bandDiv.start(iSrc), colStop = bandDiv.stop(iSrc);
+		if(colStop > colStart) //columns are contiguous in memory:
+			mpiGroup->bcast(Y.data()+Y.index(colStart,0), (colStop-colStart)*Y.colLength(), iSrc);
+	}
+	watch.stop();
+}
+
+void allGatherColumns(matrix& M, const TaskDivision& bandDiv)
+{	if(mpiGroup->nProcesses() == 1) return;
+	for(int iSrc=0; iSrc<mpiGroup->nProcesses(); iSrc++)
+	{	int colStart = bandDiv.start(iSrc), colStop = bandDiv.stop(iSrc);
+		if(colStop > colStart) //columns are contiguous in memory:
+			mpiGroup->bcast(M.data()+M.index(0,colStart), (colStop-colStart)*M.nRows(), iSrc);
+	}
+}
+
+ColumnBundle multiplyWfns(const ColumnBundle& Y, const matrix& M)
+{	if(mpiGroup->nProcesses() == 1) return Y * M;
+	TaskDivision bandDiv = bandDivision(M.nCols());
+	ColumnBundle YM = Y.similar(M.nCols());
+	if(bandDiv.stop() > bandDiv.start())
+		YM.setSub(bandDiv.start(), Y * M(0,M.nRows(), bandDiv.start(),bandDiv.stop()));
+	allGatherColumns(YM, bandDiv);
+	return YM;
+}
+
+ColumnBundle Idag_DiagV_I_wfns(const ColumnBundle& C, const ScalarFieldArray& V)
+{	if(mpiGroup->nProcesses() == 1) return Idag_DiagV_I(C, V);
+	TaskDivision bandDiv = bandDivision(C.nCols());
+	ColumnBundle VC = C.similar();
+	if(bandDiv.stop() > bandDiv.start())
+		VC.setSub(bandDiv.start(), Idag_DiagV_I(C.getSub(bandDiv.start(),bandDiv.stop()), V));
+	allGatherColumns(VC, bandDiv);
+	return VC;
+}
@@ -62,6 +62,15 @@ ColumnBundleTransform::ColumnBundleTransform(const vector3<>& kC, const Basis& b
 		*(indexPtr++) = basisDwrapper.table[dot(basisDwrapper.pitch, iG_D + basisDwrapper.iGbox)]; //use lookup table to get D index
 	}
 	assert(*std::min_element(index.begin(), index.end()) >= 0); //make sure all entries were found
+	if(basisC.realWavefunctions) //Gamma-only mode: also map the implied -G entries of C
+	{	indexConj.init(basisC.nbasis);
+		int* indexConjPtr = indexConj.data();
+		for(const vector3<int>& iG_C: basisC.iGarr)
+		{	vector3<int> iG_D = (-iG_C) * affine + offset;
+			*(indexConjPtr++) = basisDwrapper.table[dot(basisDwrapper.pitch, iG_D + basisDwrapper.iGbox)];
+		}
+		assert(*std::min_element(indexConj.begin(), indexConj.end()) >= 0);
+	}
 	
 	//Initialize translation phase (if necessary)
 	if(sym.a.length_squared())
@@ -99,12 +108,25 @@ void ColumnBundleTransform::scatterAxpy(complex alpha, const ColumnBundle& C_C,
 				C_C.dataPref() + C_C.index(bC, sC*C_C.basis->nbasis),
 				C_D.dataPref() + C_D.index(bD, sD*C_D.basis->nbasis), invert<0,
 				phase.dataPref(), invert<0);
+	if(basisC.realWavefunctions) //Gamma-only mode: implied -G entries (excluding G=0) are conjugates of the stored ones
+		callPref(eblas_scatter_zaxpy)(index.nData()-1, alpha, indexConj.dataPref()+1,
+			C_C.dataPref() + C_C.index(bC,1), C_D.dataPref() + C_D.index(bD,0), !(invert<0),
+			phase.dataPref() ? phase.dataPref()+1 : 0, !(invert<0));
 }
 
 void ColumnBundleTransform::gatherAxpy(complex alpha, const ColumnBundle& C_D, int bD, ColumnBundle& C_C, int bC) const
 {	//Check inputs:
 	assert(C_C.colLength() == nSpinor*basisC.nbasis); assert(bC >= 0 && bC < C_C.nCols());
 	assert(C_D.colLength() == nSpinor*basisD.nbasis); assert(bD >= 0 && bD < C_D.nCols());
+	if(basisC.realWavefunctions) //Gamma-only mode: average contributions at +G and (conjugated) -G to retain the real part in real space
+	{	callPref(eblas_gather_zaxpy)(index.nData(), 0.5*alpha, index.dataPref(),
+			C_D.dataPref() + C_D.index(bD,0), C_C.dataPref() + C_C.index(bC,0), invert<0,
+			phase.dataPref(), true);
+		callPref(eblas_gather_zaxpy)(index.nData(), 0.5*alpha, indexConj.dataPref(),
+			C_D.dataPref() + C_D.index(bD,0), C_C.dataPref() + C_C.index(bC,0), !(invert<0),
+			phase.dataPref(), true);
+		return;
+	}
 	//Gather:
 	matrix spinorRotInv = (invert<0) ? transpose(spinorRot) : dagger(spinorRot);
 	for(int sD=0; sD<nSpinor; sD++)
@@ -50,7 +50,9 @@ public:
 	Optionally, super specifies a transform to a supercell (D corresponds to a supercell of C);
 	columnbundles will however not be automatically re-normalized for the supercell
 	Note that the transformation is kD = kC * sym * invert * super + offset (where offset is determined automatically).
-	If the ColumnBundles are spinorial (nSpinor=2), corresponding spin-space transformations will also be applied
+	If the ColumnBundles are spinorial (nSpinor=2), corresponding spin-space transformations will also be applied.
+	If basisC is a Gamma-only mode basis (Basis::realWavefunctions), scatter also fills in the implied -G half of the sphere,
+	and gather retains the part of the result that is real in real space (exactly the adjoint of scatter only for real alpha).
 	*/
 	ColumnBundleTransform(const vector3<>& kC, const Basis& basisC, const vector3<>& kD, const BasisWrapper& basisDwrapper,
 		int nSpinor, const SpaceGroupOp& sym, int invert, const matrix3<int>& super = matrix3<int>(1,1,1));
@@ -79,6 +81,7 @@ private:
 	
 	//Index array:
 	IndexArray index;
+	IndexArray indexConj; //index in D of the implied -G entries of C (only in Gamma-only mode)
 	ManagedArray<complex> phase; //Bloch phase for space-group translation
 
 	matrix spinorRot; //spinor space rotation
@@ -32,7 +32,7 @@ enum BasisKdep { BasisKpointDep, BasisKpointIndep } ;
 static EnumStringMap<BasisKdep> kdepMap(BasisKpointDep, "kpoint-dependent", BasisKpointIndep, "single" );
 
 //! Electronic eigenvalue method
-enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson };
+enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson, ElecEigenLOBPCG, ElecEigenRMMDIIS };
 
 //! Miscellaneous flags controlling electronic DFT
 class Control
@@ -40,11 +40,17 @@ class Control
 public:
 	bool fixed_H; //!< fixed Hamiltonian (band structure) mode for electronic sector
 	bool cacheProjectors; //!< whether to cache nonlocal projectors
+	bool realSpaceProjectors; //!< whether to apply nonlocal projectors on spheres of real-space grid points around each atom
+	double realSpaceProjectorThreshold; //!< maximum fraction of projector norm discarded outside the real-space spheres
 	double davidsonBandRatio; //!< ratio of number of Davidson working bands to actual bands in system (>= 1)
 	int exxBlockSize; //!< number of bands per FFT block used in exact exchange
+	int exxAceRebuilds; //!< if non-zero, use adaptively compressed exchange in band minimization, rebuilding projectors at most this many times per band minimization
+	double exxAceThreshold; //!< stop rebuilding ACE projectors when band energy changes by less than this
 	
 	ElecEigenAlgo elecEigenAlgo; //!< Eigenvalue algorithm
+	int elecEigenTeams; //!< number of thread teams minimizing different quantum numbers concurrently in band minimization
 	BasisKdep basisKdep; //!< k-dependence of basis
+	bool gammaOnly; //!< whether wavefunctions are constrained to be real in real space (Gamma-point only calculations)
 	double Ecut, EcutRho; //!< energy cutoff for electrons and charge density grid (EcutRho=0 => EcutRho = 4 Ecut)
 	
 	bool dragWavefunctions; //!< whether to drag wavefunctions using atomic orbital projections on ionic steps
@@ -67,8 +73,8 @@ public:
 	
 	Control()
 	:	fixed_H(false),
-		cacheProjectors(true), davidsonBandRatio(1.1), exxBlockSize(16),
-		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
+		cacheProjectors(true), realSpaceProjectors(false), realSpaceProjectorThreshold(1e-4), davidsonBandRatio(1.1), exxBlockSize(16), exxAceRebuilds(0), exxAceThreshold(1e-6),
+		elecEigenAlgo(ElecEigenDavidson), elecEigenTeams(1), basisKdep(BasisKpointDep), gammaOnly(false), Ecut(0), EcutRho(0), dragWavefunctions(true),
 		fluidGummel_nIterations(10), fluidGummel_Atol(1e-5),
 		shouldPrintEigsFillings(false), shouldPrintEcomponents(false), shouldPrintMuSearch(false), shouldPrintKpointsBasis(false),
 		subspaceRotationFactor(1.), subspaceRotationAdjust(true), scf(false), convergeEmptyStates(false), dumpOnly(false)
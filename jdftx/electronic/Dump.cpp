@@ -30,6 +30,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/FluidSolver.h>
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
+#include <core/AsyncWrite.h>
 #include <ctime>
 
 Dump::Dump()
@@ -98,7 +99,7 @@ void Dump::operator()(DumpFrequency freq, int iter)
 
 	#define DUMP_nocheck(object, prefix) \
 		{	StartDump(prefix) \
-			if(mpiWorld->isHead()) saveRawBinary(object, fname.c_str()); \
+			if(mpiWorld->isHead()) saveRawBinaryAsync(object, fname.c_str()); \
 			EndDump \
 		}
 	
@@ -289,7 +290,7 @@ void Dump::operator()(DumpFrequency freq, int iter)
 		{	matrix proj; //orbitals: nOrbitals x nBands
 			if(eInfo.isMine(q))
 			{	proj = iInfo.getAtomicOrbitals(q, true) ^ eVars.C[q]; //dagger(Opsi).Cq
-				if(not mpiWorld->isHead()) mpiWorld->sendData(proj, 0, q); //send to head for writing
+				if(mpiGroup->isHead() and not mpiWorld->isHead()) mpiWorld->sendData(proj, 0, q); //send to head for writing
 			}
 			if(mpiWorld->isHead())
 			{	if(not eInfo.isMine(q)) //recv from process that stored q
@@ -563,7 +564,7 @@ void Dump::operator()(DumpFrequency freq, int iter)
 				}
 				fclose(fp);
 			}
-			else
+			else if(mpiGroup->isHead())
 			{	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
 					mpiWorld->sendData(v[q], 0, q);
 			} 
@@ -615,10 +616,10 @@ void Dump::operator()(DumpFrequency freq, int iter)
 						}
 					}
 				}
-				mpiWorld->allReduceData(gEf, MPIUtil::ReduceSum);
-				mpiWorld->allReduceData(vFabsSum, MPIUtil::ReduceSum);
-				mpiWorld->allReduceData(vFsum, MPIUtil::ReduceSum);
-				mpiWorld->allReduceData(vFsqSum, MPIUtil::ReduceSum);
+				mpiGroupHead->allReduceData(gEf, MPIUtil::ReduceSum);
+				mpiGroupHead->allReduceData(vFabsSum, MPIUtil::ReduceSum);
+				mpiGroupHead->allReduceData(vFsum, MPIUtil::ReduceSum);
+				mpiGroupHead->allReduceData(vFsqSum, MPIUtil::ReduceSum);
 				for(vector3<>& m: vFabsSum) m *= (0.5/symCart.size()); //all rotated versions accumulated above (0.5 from Landauer formula)
 				for(matrix3<>& m: vFsum) e->symm.symmetrize(m);
 				for(matrix3<>& m: vFsqSum) e->symm.symmetrize(m);
@@ -647,7 +648,7 @@ void Dump::operator()(DumpFrequency freq, int iter)
 		}
 	}
 	
-	if(ShouldDump(RealSpaceWfns))
+	if(ShouldDump(RealSpaceWfns) and mpiGroup->isHead()) //other processes in group have identical copies
 	{	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
 		{	int nSpinor = eVars.C[q].spinorLength();
 			for(int b=0; b<eInfo.nBands; b++) for(int s=0; s<nSpinor; s++)
@@ -771,6 +772,8 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	//The following compute-intensive things are free to clear wavefunctions
 	//to conserve memory etc. and should therefore happen at the very end
 	
+	if(freq==DumpFreq_End) asyncWriteFlush(); //final outputs complete on disk (and staging memory released) before these
+	
 	if(freq==DumpFreq_End && ShouldDump(Polarizability))
 	{	polarizability->dump(*e);
 	}
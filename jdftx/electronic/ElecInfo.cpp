@@ -60,8 +60,10 @@ void ElecInfo::setup(const Everything &everything, std::vector<diagMatrix>& F, E
 	nStates = qnums.size();
 	
 	//Determine distribution amongst processes:
-	qDivision.init(nStates, mpiWorld);
+	qDivision.init(nStates, mpiGroupHead); //all processes in a group share the same states (and split bands)
 	qDivision.myRange(qStart, qStop);
+	if(mpiGroup->nProcesses() > 1)
+		logPrintf("Splitting band work of each state over %d processes per group (wavefunctions replicated on each).\n", mpiGroup->nProcesses());
 	
 	//Allocate the fillings matrices.
 	F.resize(nStates);
@@ -165,7 +167,7 @@ void ElecInfo::setup(const Everything &everything, std::vector<diagMatrix>& F, E
 		nElectrons=0.;
 		for(int q=qStart; q<qStop; q++)
 			nElectrons += qnums[q].weight * trace(F[q]);
-		mpiWorld->allReduce(nElectrons, MPIUtil::ReduceSum, true);
+		mpiGroupHead->allReduce(nElectrons, MPIUtil::ReduceSum, true);
 	}
 	
 	//Check that number of bands is sufficient:
@@ -186,7 +188,7 @@ void ElecInfo::setup(const Everything &everything, std::vector<diagMatrix>& F, E
 		{	scalarFillings = true;
 			for(int q=qStart; q<qStop; q++)
 				scalarFillings &= F[q].isScalar();
-			mpiWorld->allReduce(scalarFillings, MPIUtil::ReduceLAnd);
+			mpiGroupHead->allReduce(scalarFillings, MPIUtil::ReduceLAnd);
 			if(!scalarFillings)
 				logPrintf("Turning on subspace rotations due to non-scalar fillings.\n");
 		}
@@ -214,7 +216,7 @@ void ElecInfo::printFillings(FILE* fp) const
 			}
 			((*Fq) * spinWeight).print(fp, "%.15lf ");
 		}
-	else
+	else if(mpiGroup->isHead())
 		for(int q=qStart; q<qStop; q++)
 			mpiWorld->sendData(e->eVars.F[q], 0, q);
 }
@@ -261,14 +263,14 @@ void ElecInfo::updateFillingsEnergies(const std::vector<diagMatrix>& eps, Energi
 	ener.TS = 0.0;
 	for(int q=qStart; q<qStop; q++)
 		ener.TS += smearingWidth * qnums[q].weight * trace(smearEntropy(muEff(mu,Bz,q), eps[q]));
-	mpiWorld->allReduce(ener.TS, MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(ener.TS, MPIUtil::ReduceSum);
 
 	//Magnetic field contributions if any:
 	if(!std::isnan(this->Bz))
 	{	double Mz = 0.;
 		for(int q=qStart; q<qStop; q++)
 			Mz += qnums[q].spin * qnums[q].weight * trace(smear(muEff(mu,Bz,q), eps[q]));
-		mpiWorld->allReduce(Mz, MPIUtil::ReduceSum);
+		mpiGroupHead->allReduce(Mz, MPIUtil::ReduceSum);
 		ener.E["minusMzBz"] = -Mz*Bz;
 	}
 	
@@ -363,8 +365,8 @@ double ElecInfo::magnetizationCalc(double mu, double Bz, const std::vector<diagM
 			M += s * wf;
 		}
 	}
-	mpiWorld->allReduce(N, MPIUtil::ReduceSum, true);
-	mpiWorld->allReduce(M, MPIUtil::ReduceSum, true);
+	mpiGroupHead->allReduce(N, MPIUtil::ReduceSum, true);
+	mpiGroupHead->allReduce(M, MPIUtil::ReduceSum, true);
 	return M;
 }
 
@@ -550,14 +552,16 @@ void ElecInfo::write(const std::vector<diagMatrix>& M, const char *fname, int nR
 		}
 		fclose(fp);
 	}
-	else for(int q=qStart; q<qStop; q++) mpiWorld->sendData(M[q], 0, q);
+	else if(mpiGroup->isHead()) for(int q=qStart; q<qStop; q++) mpiWorld->sendData(M[q], 0, q);
 #else
 	//Collective write using MPI I/O:
 	MPIUtil::File fp; mpiWorld->fopenWrite(fp, fname);
-	mpiWorld->fseek(fp, qStart*nRows*sizeof(double), SEEK_SET);
-	for(int q=qStart; q<qStop; q++)
-	{	assert(M[q].nRows()==nRows);
-		mpiWorld->fwriteData(M[q], fp);
+	if(mpiGroup->isHead()) //other processes in group have identical copies
+	{	mpiWorld->fseek(fp, qStart*nRows*sizeof(double), SEEK_SET);
+		for(int q=qStart; q<qStop; q++)
+		{	assert(M[q].nRows()==nRows);
+			mpiWorld->fwriteData(M[q], fp);
+		}
 	}
 	mpiWorld->fclose(fp);
 #endif
@@ -582,15 +586,17 @@ void ElecInfo::write(const std::vector<matrix>& M, const char *fname, int nRowsO
 		}
 		fclose(fp);
 	}
-	else for(int q=qStart; q<qStop; q++) mpiWorld->sendData(M[q], 0, q);
+	else if(mpiGroup->isHead()) for(int q=qStart; q<qStop; q++) mpiWorld->sendData(M[q], 0, q);
 #else
 	//Collective write using MPI I/O:
 	MPIUtil::File fp; mpiWorld->fopenWrite(fp, fname);
-	mpiWorld->fseek(fp, qStart*nRows*nCols*sizeof(complex), SEEK_SET);
-	for(int q=qStart; q<qStop; q++)
-	{	assert(M[q].nRows()==nRows);
-		assert(M[q].nCols()==nCols);
-		mpiWorld->fwriteData(M[q], fp);
+	if(mpiGroup->isHead()) //other processes in group have identical copies
+	{	mpiWorld->fseek(fp, qStart*nRows*nCols*sizeof(complex), SEEK_SET);
+		for(int q=qStart; q<qStop; q++)
+		{	assert(M[q].nRows()==nRows);
+			assert(M[q].nCols()==nCols);
+			mpiWorld->fwriteData(M[q], fp);
+		}
 	}
 	mpiWorld->fclose(fp);
 #endif
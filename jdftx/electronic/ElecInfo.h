@@ -22,7 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_ELECTRONIC_ELECINFO_H
 
 #include <core/vector3.h>
-#include <core/MPIUtil.h>
+#include <core/Util.h>
 
 class matrix;
 class diagMatrix;
@@ -64,9 +64,9 @@ public:
 	int nDensities, spinWeight, qWeightSum; //!< number of density components, spin weight factor (= max occupation per state) and sum of k-point weights
 	int qStart, qStop; //!< Range of states handled by current process (= 0 and nStates for non-MPI jobs)
 	bool isMine(int q) const { return qDivision.isMine(q); } //!< check if state index is local
-	int whose(int q) const { return qDivision.whose(q); } //!< find out which process this state index belongs to
-	int qStartOther(int iProc) const { return qDivision.start(iProc); } //!< find out qStart for another process
-	int qStopOther(int iProc) const { return qDivision.stop(iProc); } //!< find out qStop for another process
+	int whose(int q) const { return qDivision.whose(q) * mpiGroup->nProcesses(); } //!< find out which process this state index belongs to (head of the process group if bands are distributed)
+	int qStartOther(int iProc) const { return qDivision.start(iProc / mpiGroup->nProcesses()); } //!< find out qStart for another process
+	int qStopOther(int iProc) const { return qDivision.stop(iProc / mpiGroup->nProcesses()); } //!< find out qStop for another process
 	
 	SpinType spinType; //!< type of spin treatment
 	double nElectrons; //!< the number of electrons = Sum w Tr[F]
@@ -152,7 +152,7 @@ public:
 
 private:
 	const Everything* e;
-	TaskDivision qDivision; //!< MPI division of k-points
+	TaskDivision qDivision; //!< MPI division of k-points amongst process groups (all processes in mpiGroup share the same states)
 	
 	//Initial fillings:
 	int nBandsOld; //!<number of bands in file being read
@@ -20,6 +20,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ElecMinimizer.h>
 #include <electronic/BandMinimizer.h>
 #include <electronic/BandDavidson.h>
+#include <electronic/BandLOBPCG.h>
+#include <electronic/BandRMMDIIS.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/ExactExchange.h>
 #include <electronic/Everything.h>
@@ -27,7 +29,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/FluidSolver.h>
 #include <core/Random.h>
 #include <core/ScalarField.h>
+#include <core/Thread.h>
 #include <ctime>
+#include <atomic>
 #include <electronic/SCF.h>
 
 void ElecGradient::init(const Everything& e)
@@ -56,10 +60,10 @@ double dot(const ElecGradient& x, const ElecGradient& y, double* auxContrib)
 {	assert(x.eInfo == y.eInfo);
 	std::vector<double> result(2, 0.); //calculate wavefunction and auxiliary contributions separately
 	for(int q=x.eInfo->qStart; q<x.eInfo->qStop; q++)
-	{	if(x.C[q] && y.C[q]) result[0] += dotc(x.C[q], y.C[q]).real()*2.0;
+	{	if(x.C[q] && y.C[q]) result[0] += dot(x.C[q], y.C[q]);
 		if(x.Haux[q] && y.Haux[q]) result[1] += dotc(x.Haux[q], y.Haux[q]).real();
 	}
-	mpiWorld->allReduceData(result, MPIUtil::ReduceSum);
+	mpiGroupHead->allReduceData(result, MPIUtil::ReduceSum);
 	if(auxContrib) *auxContrib=result[1]; //store auxiliary contribution, if requested
 	return result[0]+result[1]; //return total
 }
@@ -102,7 +106,7 @@ struct SubspaceRotationAdjust
 		{	gDotKgPrevHaux = 0.;
 			for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 				gDotKgPrevHaux += dotc(grad.Haux[q], KgPrevHaux[q]).real();
-			mpiWorld->allReduce(gDotKgPrevHaux, MPIUtil::ReduceSum);
+			mpiGroupHead->allReduce(gDotKgPrevHaux, MPIUtil::ReduceSum);
 			mpiWorld->bcast(gDotKgPrevHaux);
 		}
 	}
@@ -254,6 +258,8 @@ bool ElecMinimizer::report(int iter)
 			rotPrevCinv[q] = dagger(rotPrev[q]);
 		}
 	
+	Profiler::cycleEnd("ElecMinimize", iter);
+	
 	//Subspace rotation preconditioner handling:
 	if(sra) return sra->report(KgradHaux);
 	return false;
@@ -263,7 +269,7 @@ void ElecMinimizer::constrain(ElecGradient& dir)
 {	assert(dir.eInfo == &eInfo);
 	//Project component of search direction along current wavefunctions:
 	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-		dir.C[q] -= eVars.C[q] * (eVars.C[q]^O(dir.C[q]));
+		dir.C[q] -= multiplyWfns(eVars.C[q], innerWfns(eVars.C[q], O(dir.C[q])));
 }
 
 double ElecMinimizer::sync(double x) const
@@ -271,21 +277,82 @@ double ElecMinimizer::sync(double x) const
 	return x;
 }
 
+//Minimize bands of quantum number q with the selected eigenvalue algorithm
+void bandMinimize_q(Everything& e, int q, const MinimizeParams& mp)
+{	static StopWatch watch("bandMinimize"); watch.start();
+	switch(e.cntrl.elecEigenAlgo)
+	{	case ElecEigenCG: { BandMinimizer(e, q).minimize(mp); break; }
+		case ElecEigenDavidson: { BandDavidson(e, q).minimize(mp); break; }
+		case ElecEigenLOBPCG: { BandLOBPCG(e, q).minimize(mp); break; }
+		case ElecEigenRMMDIIS: { BandRMMDIIS(e, q).minimize(mp); break; }
+	}
+	watch.stop();
+}
+
+//Minimize quantum numbers taken one at a time from qNext, concurrently with other teams
+void bandMinimize_team(int iTeam, int nTeams, Everything* e, const MinimizeParams* mp, std::atomic<int>* qNext)
+{	for(int q=(*qNext)++; q<e->eInfo.qStop; q=(*qNext)++)
+		bandMinimize_q(*e, q, *mp);
+}
+
 void bandMinimize(Everything& e)
 {	bool fixed_H = true; std::swap(fixed_H, e.cntrl.fixed_H); //remember fixed_H flag and temporarily set it to true
 	if(e.exCorr.exxFactor())
 		e.exx->setOccupied(e.eVars.F, e.eVars.C);
+	bool useACE = e.exCorr.exxFactor() && e.cntrl.exxAceRebuilds;
 	logPrintf("Minimization will be done independently for each quantum number.\n");
-	e.ener.Eband = 0.;
-	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
-	{	logPrintf("\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
-		switch(e.cntrl.elecEigenAlgo)
-		{	case ElecEigenCG: { BandMinimizer(e, q).minimize(e.elecMinParams); break; }
-			case ElecEigenDavidson: { BandDavidson(e, q).minimize(); break; }
+	e.elecMinParams.energyLabel = relevantFreeEnergyName(e);
+	//Check whether quantum numbers can be minimized concurrently in thread teams:
+	int nTeams = std::min(std::min(e.cntrl.elecEigenTeams, nProcsAvailable), e.eInfo.qStop-e.eInfo.qStart);
+	if(nTeams > 1)
+	{	const char* reason = 0;
+		if(isGpuEnabled()) reason = "GPU operators must be called from a single thread";
+		else if(mpiGroup->nProcesses() > 1) reason = "quantum numbers are shared between processes";
+		else if(e.exCorr.exxFactor() && !useACE) reason = "exact exchange requires ACE";
+		if(reason)
+		{	logPrintf("Minimizing one quantum number at a time (elec-eigen-teams ignored: %s).\n", reason);
+			nTeams = 1;
+		}
+		else logPrintf("Minimizing quantum numbers concurrently in %d thread teams.\n", nTeams);
+	}
+	double EbandPrev = 0.;
+	for(int iACE=0; ; iACE++)
+	{	if(useACE)
+		{	logPrintf("\n---- Building ACE exchange projectors (pass %d) ----\n", iACE+1);
+			e.exx->setupACE(e.exCorr.exxFactor(), e.exCorr.exxRange(), e.eVars.C);
 		}
-		e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
+		if(nTeams > 1)
+		{	MinimizeParams mpTeam = e.elecMinParams;
+			mpTeam.fpLog = nullLog; //per-iteration output of concurrent minimizations would be interleaved
+			std::atomic<int> qNext(e.eInfo.qStart);
+			threadTeamLaunch(nTeams, bandMinimize_team, &e, (const MinimizeParams*)&mpTeam, &qNext);
+			logPrintf("\n");
+			for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+			{	logPrintf("Minimized quantum number: "); e.eInfo.kpointPrint(globalLog, q, true);
+				logPrintf("  Eband: %+.15lf\n", e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]));
+			}
+			logFlush();
+		}
+		else
+		{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+			{	logPrintf("\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
+				bandMinimize_q(e, q, e.elecMinParams);
+			}
+		}
+		//Band energy (accumulated in a fixed order, independent of teams):
+		e.ener.Eband = 0.;
+		for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+			e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
+		mpiGroupHead->allReduce(e.ener.Eband, MPIUtil::ReduceSum);
+		if(!useACE) break;
+		//Check whether ACE projectors need to be rebuilt:
+		double dEband = e.ener.Eband - EbandPrev;
+		EbandPrev = e.ener.Eband;
+		if(iACE) logPrintf("\nACE pass %d: Eband = %.15lf  dEband = %le\n", iACE+1, e.ener.Eband, dEband);
+		if((iACE && fabs(dEband) < e.cntrl.exxAceThreshold) || iACE+1 >= e.cntrl.exxAceRebuilds)
+			break;
 	}
-	mpiWorld->allReduce(e.ener.Eband, MPIUtil::ReduceSum);
+	if(useACE) e.exx->clearACE();
 	if(e.cntrl.shouldPrintEigsFillings)
 	{	//Print the eigenvalues if requested
 		print_Hsub_eigs(e);
@@ -217,11 +217,11 @@ void ElecVars::setup(const Everything &everything)
 				{	//Ensure that the initalized bands are orthonormal:
 					ColumnBundle Cfixed = C[q].getSub(0, nBandsInited);
 					ColumnBundle OCfixed = O(Cfixed);
-					matrix ortho = invsqrt(Cfixed^OCfixed);
+					matrix ortho = invsqrt(innerWfns(Cfixed, OCfixed));
 					Cfixed = Cfixed * ortho;
 					OCfixed = OCfixed * ortho;
 					//Project out initalized band directions from the rest:
-					C[q] -= Cfixed * (OCfixed^C[q]);
+					C[q] -= Cfixed * innerWfns(OCfixed, C[q]);
 					C[q].setSub(0, Cfixed);
 				}
 			}
@@ -229,8 +229,8 @@ void ElecVars::setup(const Everything &everything)
 		
 		//Orthogonalize initial wavefunctions:
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-		{	matrix CdagOC = C[q] ^ O(C[q]);
-			C[q] = C[q] * invsqrt(CdagOC);
+		{	matrix CdagOC = innerWfns(C[q], O(C[q]));
+			C[q] = multiplyWfns(C[q], invsqrt(CdagOC));
 			iInfo.project(C[q], VdagC[q]);
 		}
 	}
@@ -414,7 +414,7 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 	{	double KEq = applyHamiltonian(q, F[q], HC[q], ener, need_Hsub);
 		if(grad) //Calculate wavefunction gradients:
 		{	const QuantumNumber& qnum = eInfo.qnums[q];
-			HC[q] -= O(C[q]) * Hsub[q]; //Include orthonormality contribution
+			HC[q] -= multiplyWfns(O(C[q]), Hsub[q]); //Include orthonormality contribution
 			grad->C[q] = HC[q] * (F[q]*qnum.weight);
 			if(Kgrad)
 			{	double Nq = qnum.weight*trace(F[q]);
@@ -424,8 +424,8 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 			}
 		}
 	}
-	mpiWorld->allReduce(ener.E["KE"], MPIUtil::ReduceSum);
-	mpiWorld->allReduce(ener.E["Enl"], MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(ener.E["KE"], MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(ener.E["Enl"], MPIUtil::ReduceSum);
 	
 	double dmuContrib = 0., dBzContrib = 0.;
 	bool Mconstrain = (eInfo.spinType==SpinZ) and std::isnan(eInfo.Bz); //whether magnetization needs to be constrained
@@ -438,8 +438,8 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 			dmuNum[sIndex] += w * trace(fprime * (diag(Hsub[q])-Haux_eigs[q]));
 			dmuDen[sIndex] += w * trace(fprime);
 		}
-		mpiWorld->allReduce(dmuNum, 2, MPIUtil::ReduceSum);
-		mpiWorld->allReduce(dmuDen, 2, MPIUtil::ReduceSum);
+		mpiGroupHead->allReduce(dmuNum, 2, MPIUtil::ReduceSum);
+		mpiGroupHead->allReduce(dmuDen, 2, MPIUtil::ReduceSum);
 		if(std::isnan(eInfo.mu) and Mconstrain)
 		{	//Fixed N and M (effectively independent constraints on Nup and Ndn)
 			double dmuContribUp = dmuNum[0]/dmuDen[0];
@@ -489,7 +489,7 @@ matrix3<> ElecVars::latticeGrad() const
 		//KE-density contribution for meta-GGAs:
 		if(e->exCorr.needsKEdensity())
 		{	for(int iDir=0; iDir<3; iDir++)
-			{	ColumnBundle VCi = Idag_DiagV_I(D(C[q],iDir), Vtau);
+			{	ColumnBundle VCi = Idag_DiagV_I_wfns(D(C[q],iDir), Vtau);
 				for(int jDir=iDir; jDir<3; jDir++)
 				{	double tauStress_ij = (-e->eInfo.qnums[q].weight * e->gInfo.dV)
 						* traceinner(F[q], VCi, D(C[q],jDir)).real();
@@ -500,7 +500,7 @@ matrix3<> ElecVars::latticeGrad() const
 			}
 		}
 	}
-	mpiWorld->allReduce(E_RRT, MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(E_RRT, MPIUtil::ReduceSum);
 	
 	//Add q-independent contributions:
 	//--- volume contribution in various terms
@@ -584,7 +584,7 @@ void ElecVars::setEigenvectors()
 	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
 	{
 		fixPhase(Hsub_evecs[q], Hsub_eigs[q], C[q]);
-		C[q] = C[q] * Hsub_evecs[q];
+		C[q] = multiplyWfns(C[q], Hsub_evecs[q]);
 		for(matrix& VdagCq_sp: VdagC[q])
 			if(VdagCq_sp) VdagCq_sp = VdagCq_sp * Hsub_evecs[q];
 		
@@ -599,10 +599,15 @@ void ElecVars::setEigenvectors()
 
 ScalarFieldArray ElecVars::KEdensity() const
 {	ScalarFieldArray tau(n.size());
-	//Compute KE density from valence electrons:
+	//Compute KE density from valence electrons (bands split over mpiGroup, collected with the sum over states below):
 	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
+	{	TaskDivision bandDiv = bandDivision(C[q].nCols());
+		if(bandDiv.stop() == bandDiv.start()) continue;
+		ColumnBundle Cq = C[q].getSub(bandDiv.start(), bandDiv.stop());
+		diagMatrix Fq = F[q](bandDiv.start(), bandDiv.stop());
 		for(int iDir=0; iDir<3; iDir++)
-			tau += (0.5*C[q].qnum->weight) * diagouterI(F[q], D(C[q],iDir), tau.size(), &e->gInfo);
+			tau += (0.5*C[q].qnum->weight) * diagouterI(Fq, D(Cq,iDir), tau.size(), &e->gInfo);
+	}
 	for(ScalarField& tau_s: tau)
 	{	nullToZero(tau_s, e->gInfo);
 		tau_s->allReduceData(mpiWorld, MPIUtil::ReduceSum);
@@ -620,9 +625,21 @@ ScalarFieldArray ElecVars::KEdensity() const
 ScalarFieldArray ElecVars::calcDensity() const
 {	ScalarFieldArray density(n.size());
 	//Runs over all states and accumulates density to the corresponding spin channel of the total density
+	//(bands are split over mpiGroup, and collected along with the sum over states below)
 	e->iInfo.augmentDensityInit();
 	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
-	{	density += e->eInfo.qnums[q].weight * diagouterI(F[q], C[q], density.size(), &e->gInfo);
+	{	if(mpiGroup->nProcesses() > 1)
+		{	TaskDivision bandDiv = bandDivision(C[q].nCols());
+			if(bandDiv.stop() == bandDiv.start()) continue;
+			diagMatrix Fq = F[q](bandDiv.start(), bandDiv.stop());
+			std::vector<matrix> VdagCq(VdagC[q].size());
+			for(size_t sp=0; sp<VdagCq.size(); sp++)
+				if(VdagC[q][sp]) VdagCq[sp] = VdagC[q][sp](0,VdagC[q][sp].nRows(), bandDiv.start(),bandDiv.stop());
+			density += e->eInfo.qnums[q].weight * diagouterI(Fq, C[q].getSub(bandDiv.start(), bandDiv.stop()), density.size(), &e->gInfo);
+			e->iInfo.augmentDensitySpherical(e->eInfo.qnums[q], Fq, VdagCq);
+			continue;
+		}
+		density += e->eInfo.qnums[q].weight * diagouterI(F[q], C[q], density.size(), &e->gInfo);
 		e->iInfo.augmentDensitySpherical(e->eInfo.qnums[q], F[q], VdagC[q]); //pseudopotential contribution
 	}
 	e->iInfo.augmentDensityGrid(density);
@@ -637,9 +654,9 @@ ScalarFieldArray ElecVars::calcDensity() const
 void ElecVars::orthonormalize(int q, matrix* extraRotation)
 {	assert(e->eInfo.isMine(q));
 	VdagC[q].clear();
-	matrix rot = invsqrt(C[q]^O(C[q], &VdagC[q])); //Compute U:
+	matrix rot = invsqrt(innerWfns(C[q], O(C[q], &VdagC[q]))); //Compute U:
 	if(extraRotation) *extraRotation = (rot = rot * (*extraRotation)); //set rot and extraRotation to the net transformation
-	C[q] = C[q] * rot;
+	C[q] = multiplyWfns(C[q], rot);
 	e->iInfo.project(C[q], VdagC[q], &rot); //update the atomic projections
 }
 
@@ -650,11 +667,11 @@ double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq
 	
 	//Propagate grad_n (Vscloc) to HCq (which is grad_Cq upto weights and fillings) if required
 	if(need_Hsub)
-	{	HCq += Idag_DiagV_I(C[q], Vscloc); //Accumulate Idag Diag(Vscloc) I C
+	{	HCq += Idag_DiagV_I_wfns(C[q], Vscloc); //Accumulate Idag Diag(Vscloc) I C
 		e->iInfo.augmentDensitySphericalGrad(qnum, VdagC[q], HVdagCq); //Contribution via pseudopotential density augmentation
 		if(e->exCorr.needsKEdensity() && Vtau[qnum.index()]) //Contribution via orbital KE:
 		{	for(int iDir=0; iDir<3; iDir++)
-				HCq -= (0.5*e->gInfo.dV) * D(Idag_DiagV_I(D(C[q],iDir), Vtau), iDir);
+				HCq -= (0.5*e->gInfo.dV) * D(Idag_DiagV_I_wfns(D(C[q],iDir), Vtau), iDir);
 		}
 		if(e->eInfo.hasU) //Contribution via atomic density matrix projections (DFT+U)
 			e->iInfo.rhoAtom_grad(C[q], U_rhoAtom, HCq);
@@ -682,8 +699,8 @@ double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq
 	
 	//Compute subspace hamiltonian if needed:
 	if(need_Hsub)
-	{	Hsub[q] = C[q] ^ HCq;
-		Hsub[q].diagonalize(Hsub_evecs[q], Hsub_eigs[q]);
+	{	Hsub[q] = innerWfns(C[q], HCq);
+		Hsub[q].diagonalize(Hsub_evecs[q], Hsub_eigs[q], mpiGroup);
 	}
 	return KEq;
 }
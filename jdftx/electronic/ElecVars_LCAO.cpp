@@ -53,7 +53,7 @@ struct LCAOminimizer : Minimizable<ElecGradient> //Uses only the Haux entries of
 			//Adjust rotations to make Haux diagonal again:
 			Haux.diagonalize(Haux_evecs, eVars.Haux_eigs[q]);
 			rotPrev[q] = rotPrev[q] * Haux_evecs;
-			eVars.C[q] = eVars.C[q] * Haux_evecs;
+			eVars.C[q] = multiplyWfns(eVars.C[q], Haux_evecs);
 			for(unsigned sp=0; sp<e.iInfo.species.size(); sp++)
 				if(eVars.VdagC[q][sp]) eVars.VdagC[q][sp] = eVars.VdagC[q][sp] * Haux_evecs;
 		}
@@ -90,12 +90,12 @@ struct LCAOminimizer : Minimizable<ElecGradient> //Uses only the Haux entries of
 		
 			//Gradient and subspace Hamiltonian:
 			if(grad)
-			{	ColumnBundle HCq = Idag_DiagV_I(eVars.C[q], eVars.Vscloc); //Accumulate Idag Diag(Vscloc) I C
+			{	ColumnBundle HCq = Idag_DiagV_I_wfns(eVars.C[q], eVars.Vscloc); //Accumulate Idag Diag(Vscloc) I C
 				if(eInfo.hasU) e.iInfo.rhoAtom_grad(eVars.C[q], eVars.U_rhoAtom, HCq); //Contribution via atomic density matrices (DFT+U)
 				std::vector<matrix> HVdagCq(e.iInfo.species.size());
 				e.iInfo.augmentDensitySphericalGrad(qnum, eVars.VdagC[q], HVdagCq); //Contribution via pseudopotential density augmentation
 				e.iInfo.projectGrad(HVdagCq, eVars.C[q], HCq);
-				eVars.Hsub[q] = HniRot + (eVars.C[q]^HCq);
+				eVars.Hsub[q] = HniRot + innerWfns(eVars.C[q], HCq);
 				eVars.Hsub[q].diagonalize(eVars.Hsub_evecs[q], eVars.Hsub_eigs[q]);
 				//N/M constraint contributions to gradient:
 				diagMatrix fprime = eInfo.smearPrime(eInfo.muEff(mu,Bz,q), eVars.Haux_eigs[q]);
@@ -105,12 +105,12 @@ struct LCAOminimizer : Minimizable<ElecGradient> //Uses only the Haux entries of
 				dmuDen[sIndex] += w * trace(fprime);
 			}
 		}
-		mpiWorld->allReduce(ener.E["NI"], MPIUtil::ReduceSum);
+		mpiGroupHead->allReduce(ener.E["NI"], MPIUtil::ReduceSum);
 		
 		//Final gradient propagation to auxiliary Hamiltonian:
 		if(grad) 
-		{	mpiWorld->allReduce(dmuNum, 2, MPIUtil::ReduceSum);
-			mpiWorld->allReduce(dmuDen, 2, MPIUtil::ReduceSum);
+		{	mpiGroupHead->allReduce(dmuNum, 2, MPIUtil::ReduceSum);
+			mpiGroupHead->allReduce(dmuDen, 2, MPIUtil::ReduceSum);
 			double dmuContrib, dBzContrib;
 			if((eInfo.spinType==SpinZ) and std::isnan(eInfo.Bz))
 			{	//Fixed N and M (effectively independent constraints on Nup and Ndn)
@@ -193,7 +193,7 @@ int ElecVars::LCAO()
 		std::vector<matrix> HVdagCq(iInfo.species.size());
 		iInfo.EnlAndGrad(eInfo.qnums[q], eye(lcao.nBands), VdagC[q], HVdagCq); //non-local pseudopotentials
 		iInfo.projectGrad(HVdagCq, C[q], HniCq);
-		lcao.HniSub[q] = C[q]^HniCq;
+		lcao.HniSub[q] = innerWfns(C[q], HniCq);
 		lcao.rotPrev[q] = eye(lcao.nBands);
 		F[q].resize(lcao.nBands, 0.);
 	}
@@ -229,15 +229,15 @@ int ElecVars::LCAO()
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
 		{
 			//Calculate subspace Hamiltonian:
-			ColumnBundle HCq = Idag_DiagV_I(C[q], Vscloc); //local self-consistent potential
+			ColumnBundle HCq = Idag_DiagV_I_wfns(C[q], Vscloc); //local self-consistent potential
 			std::vector<matrix> HVdagCq(iInfo.species.size());
 			iInfo.augmentDensitySphericalGrad(eInfo.qnums[q], VdagC[q], HVdagCq); //ultrasoft augmentation
 			iInfo.projectGrad(HVdagCq, C[q], HCq);
-			Hsub[q] = dagger(lcao.rotPrev[q]) * lcao.HniSub[q] * lcao.rotPrev[q] + (C[q]^HCq);
+			Hsub[q] = dagger(lcao.rotPrev[q]) * lcao.HniSub[q] * lcao.rotPrev[q] + innerWfns(C[q], HCq);
 			
 			//Switch to eigenvectors of Hsub:
 			Hsub[q].diagonalize(Hsub_evecs[q], Hsub_eigs[q]);
-			C[q] = C[q] * Hsub_evecs[q];
+			C[q] = multiplyWfns(C[q], Hsub_evecs[q]);
 			for(unsigned sp=0; sp<iInfo.species.size(); sp++)
 				if(VdagC[q][sp]) VdagC[q][sp] = VdagC[q][sp] * Hsub_evecs[q]; 
 			lcao.rotPrev[q] = lcao.rotPrev[q] * Hsub_evecs[q];
@@ -25,7 +25,12 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/SphericalHarmonics.h>
 #include <core/LatticeUtils.h>
 #include <core/Random.h>
+#include <core/AsyncWrite.h>
 #include <commands/command.h>
+#include <condition_variable>
+#include <thread>
+#include <list>
+#include <set>
 
 //Matrix imaginary part (in the operator sense; not elementwise):
 matrix Im(const matrix& m)
@@ -43,9 +48,99 @@ double regularizedDelta(double omega, double omega0, double etaInv)
 	return (1./M_PI) * (etaInv/(1+t*t));
 }
 
+//Bounded LRU cache of reduced-mesh wavefunctions read on demand from a spill file (distributedWfns mode).
+//Entries are handed out as shared pointers, so that eviction never invalidates wavefunctions still in use.
+class WfnsCache
+{
+public:
+	WfnsCache(const Everything& e, string fname, size_t nBytesMax)
+	: e(e), fname(fname), nBytesMax(nBytesMax), nBytesCached(0), nGets(0), nLoads(0)
+	{	offset.assign(e.eInfo.nStates+1, 0);
+		for(int q=0; q<e.eInfo.nStates; q++)
+			offset[q+1] = offset[q] + nBytes(q); //same layout as ElecInfo::write
+	}
+	
+	~WfnsCache()
+	{	if(prefetchThread.joinable()) prefetchThread.join();
+		logPrintf("Fetched %lu of %lu requested wavefunctions from spill file.\n", nLoads, nGets);
+		if(mpiWorld->isHead()) remove(fname.c_str());
+	}
+	
+	//Get wavefunctions of reduced state q, reading from the spill file if not cached:
+	std::shared_ptr<const ColumnBundle> get(int q)
+	{	std::unique_lock<std::mutex> lock(mutex);
+		nGets++;
+		while(loading.count(q)) loaded.wait(lock); //being read by the other thread
+		auto iter = cache.find(q);
+		if(iter != cache.end())
+		{	lru.splice(lru.begin(), lru, iter->second.lruPos); //mark most-recently used
+			return iter->second.C;
+		}
+		//Read from spill file with the lock released:
+		loading.insert(q);
+		lock.unlock();
+		std::shared_ptr<const ColumnBundle> C = load(q);
+		lock.lock();
+		loading.erase(q);
+		nLoads++;
+		//Insert and evict least-recently used entries beyond memory limit:
+		lru.push_front(q);
+		cache[q] = Entry{C, lru.begin()};
+		nBytesCached += nBytes(q);
+		while(nBytesCached > nBytesMax && lru.size() > 1)
+		{	int qOld = lru.back();
+			lru.pop_back();
+			cache.erase(qOld);
+			nBytesCached -= nBytes(qOld);
+		}
+		loaded.notify_all();
+		return C;
+	}
+	
+	//Start fetching a list of reduced states on a background thread (waits for any previous prefetch):
+	void prefetch(const std::vector<int>& qArr)
+	{	if(prefetchThread.joinable()) prefetchThread.join();
+		prefetchThread = std::thread([this, qArr]()
+		{	for(int q: qArr) get(q);
+		});
+	}
+	
+private:
+	const Everything& e;
+	string fname;
+	std::vector<long> offset; //byte offset of each reduced state in spill file
+	size_t nBytesMax, nBytesCached;
+	size_t nGets, nLoads; //statistics for final report
+	struct Entry
+	{	std::shared_ptr<const ColumnBundle> C;
+		std::list<int>::iterator lruPos;
+	};
+	std::map<int,Entry> cache;
+	std::list<int> lru; //most-recently used at front
+	std::set<int> loading; //states currently being read
+	std::mutex mutex;
+	std::condition_variable loaded;
+	std::thread prefetchThread;
+	
+	size_t nBytes(int q) const
+	{	return e.eInfo.nBands * e.basis[q].nbasis * e.eInfo.spinorLength() * sizeof(complex);
+	}
+	
+	std::shared_ptr<const ColumnBundle> load(int q) const
+	{	auto C = std::make_shared<ColumnBundle>(e.eInfo.nBands, e.basis[q].nbasis * e.eInfo.spinorLength(), &e.basis[q], &e.eInfo.qnums[q]);
+		FILE* fp = fopen(fname.c_str(), "rb");
+		if(!fp) die_alone("Error opening spill file '%s' for reading.\n", fname.c_str());
+		fseek(fp, offset[q], SEEK_SET);
+		((ManagedMemory<complex>&)(*C)).read(fp);
+		fclose(fp);
+		return C;
+	}
+};
+
+
 ElectronScattering::ElectronScattering()
 : eta(0.), Ecut(0.), fCut(1e-6), omegaMax(0.), RPA(false), slabResponse(false), EcutTransverse(0.),
-	computeRange(false), iqStart(0), iqStop(0)
+	computeRange(false), iqStart(0), iqStop(0), distributedWfns(false), wfnsCacheMB(1024.)
 {
 }
 
@@ -135,12 +230,12 @@ void ElectronScattering::dump(const Everything& everything)
 			std::swap(VdagC[q], e.eVars.VdagC[q]);
 		}
 		else
-		{	C[q].init(nBands, e.basis[q].nbasis * nSpinor, &e.basis[q], &e.eInfo.qnums[q]);
+		{	if(!distributedWfns) C[q].init(nBands, e.basis[q].nbasis * nSpinor, &e.basis[q], &e.eInfo.qnums[q]);
 			E[q].resize(nBands);
 			F[q].resize(nBands);
 			VdagC[q].resize(e.iInfo.species.size());
 		}
-		mpiWorld->bcastData(C[q], procSrc);
+		if(!distributedWfns) mpiWorld->bcastData(C[q], procSrc);
 		mpiWorld->bcastData(E[q], procSrc);
 		mpiWorld->bcastData(F[q], procSrc);
 		for(unsigned iSp=0; iSp<e.iInfo.species.size(); iSp++)
@@ -150,6 +245,19 @@ void ElectronScattering::dump(const Everything& everything)
 				mpiWorld->bcastData(VdagC[q][iSp], procSrc);
 			}
 	}
+	if(distributedWfns)
+	{	//Spill local wavefunctions to disk, from where all processes fetch them on demand:
+		string fnameSpill = e.dump.getFilename("wfnsSpill");
+		logPrintf("Spilling wavefunctions to %s for on-demand access ... ", fnameSpill.c_str()); logFlush();
+		bool asyncWriteSave = asyncWriteEnabled;
+		asyncWriteEnabled = false; //file must be complete before it is read below
+		e.eInfo.write(C, fnameSpill.c_str());
+		asyncWriteEnabled = asyncWriteSave;
+		bool done = true; mpiWorld->bcast(done); //wait for head in case it wrote on behalf of others
+		C.clear();
+		wfnsCache = std::make_shared<WfnsCache>(e, fnameSpill, size_t(wfnsCacheMB * (1<<20)));
+		logPrintf("done.\n"); logFlush();
+	}
 	
 	//Randomize supercell to improve load balancing on k-mesh:
 	{	std::vector< vector3<> >& kmesh = e.coulombParams.supercell->kmesh;
@@ -305,6 +413,7 @@ void ElectronScattering::dump(const Everything& everything)
 			{	logPrintf("%d%% ", int(round(ikDone*100./nkMine)));
 				logFlush();
 			}
+			if(!iSpin && ik+1 < ikStop) prefetchWfns(ik+1, iq); //overlap reading next states with the GEMMs below
 			//Get events:
 			size_t jk; matrix nij;
 			std::vector<Event> events = getEvents(true, iSpin, ik, iq, jk, nij);
@@ -363,6 +472,7 @@ void ElectronScattering::dump(const Everything& everything)
 			{	logPrintf("%d%% ", int(round(ikDone*100./nkMine)));
 				logFlush();
 			}
+			if(!iSpin && ik+1 < ikStop) prefetchWfns(ik+1, iq); //overlap reading next states with the frequency integrals below
 			//Get events:
 			size_t jk; matrix nij;
 			std::vector<Event> events = getEvents(false, iSpin, ik, iq, jk, nij);
@@ -414,6 +524,8 @@ void ElectronScattering::dump(const Everything& everything)
 	}
 	logPrintf("\n");
 	
+	wfnsCache.reset(); //no longer needed (also removes spill file)
+	
 	if(computeRange)
 	{	logPrintf("Perform a run without 'computeRange' to collect final results after calculating all momentum transfers.\n\n");
 		return;
@@ -562,12 +674,29 @@ ColumnBundle ElectronScattering::getWfns(size_t ik, int iSpin, const vector3<>&
 	result.zero();
 	const ColumnBundleTransform& cbt = *(transform.find(kSup)->second);
 	const Supercell::KmeshTransform& kmt = supercell->kmeshTransform[ik];
-	cbt.scatterAxpy(1., C[kmt.iReduced+iSpin*qCount], result,0,1);
+	cbt.scatterAxpy(1., *getReducedWfns(kmt.iReduced+iSpin*qCount), result,0,1);
 	if(VdagCi) *VdagCi = cbt.transformVdagC(VdagC[kmt.iReduced+iSpin*qCount], kmt.iSym);
 	watch.stop();
 	return result;
 }
 
+std::shared_ptr<const ColumnBundle> ElectronScattering::getReducedWfns(int q) const
+{	if(wfnsCache) return wfnsCache->get(q);
+	return std::shared_ptr<const ColumnBundle>(std::shared_ptr<const ColumnBundle>(), &C[q]); //non-owning
+}
+
+void ElectronScattering::prefetchWfns(size_t ik, size_t iq) const
+{	if(!wfnsCache) return;
+	size_t jk = plook->find(supercell->kmesh[ik] + qmesh[iq].k);
+	assert(jk != string::npos);
+	std::vector<int> qArr;
+	for(int iSpin=0; iSpin<nSpins; iSpin++)
+	{	qArr.push_back(supercell->kmeshTransform[ik].iReduced + iSpin*qCount);
+		qArr.push_back(supercell->kmeshTransform[jk].iReduced + iSpin*qCount);
+	}
+	wfnsCache->prefetch(qArr);
+}
+
 matrix ElectronScattering::coulombMatrix(size_t iq, matrix& Kxc) const
 {	//Use functions implemented in Polarizability:
 	matrix coulombMatrix(const ColumnBundle& V, const Everything& e, vector3<> dk);
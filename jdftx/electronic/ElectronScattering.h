@@ -47,6 +47,9 @@ struct ElectronScattering
 	bool computeRange; //!< only compute a subset of momentum transfers
 	size_t iqStart, iqStop; //!< range of q to compute in the current run
 	
+	bool distributedWfns; //!< if true, spill wavefunctions to disk and fetch them on demand, instead of replicating them on all processes
+	double wfnsCacheMB; //!< memory limit in MB for wavefunctions fetched on demand when distributedWfns = true
+	
 	ElectronScattering();
 	void dump(const Everything& e); //!< compute and dump Im(Sigma_ee) for each eigenstate
 
@@ -54,7 +57,7 @@ private:
 	const Everything* e;
 	int nBands, nSpinor, nSpins, qCount;
 	double Emin, Emax; //!< energy range that contributes to transitions less than omegaMax
-	std::vector<ColumnBundle> C; //wavefunctions, made available on all processes
+	std::vector<ColumnBundle> C; //wavefunctions, made available on all processes (unless distributedWfns)
 	std::vector<diagMatrix> E, F; //energies and fillings, available on all processes
 	std::vector<std::vector<matrix>> VdagC; //pseudopotential projections
 	std::shared_ptr<const Supercell> supercell; //contains transformations between full and reduced k-mesh
@@ -65,6 +68,7 @@ private:
 	std::map< vector3<int>, std::shared_ptr<class ColumnBundleTransform> > transform; //k-mesh transformations
 	std::map< vector3<int>, QuantumNumber > qnumMesh; //equivalent of eInfo.qnums for entire k-mesh
 	std::vector<matrix> nAugRhoAtom; //augmentation pair densities per atomic density-matrix element for each species
+	std::shared_ptr<class WfnsCache> wfnsCache; //bounded cache of wavefunctions fetched from spill file (distributedWfns mode only)
 	
 	struct Event
 	{	int i, j; //band indices
@@ -82,6 +86,8 @@ private:
 	) const;
 	
 	ColumnBundle getWfns(size_t ik, int iSpin, const vector3<>& k, std::vector<matrix>* VdagCi=0) const; //get wavefunctions at an arbitrary point in k-mesh
+	std::shared_ptr<const ColumnBundle> getReducedWfns(int q) const; //get wavefunctions of reduced state q (from C, or fetched via wfnsCache)
+	void prefetchWfns(size_t ik, size_t iq) const; //start fetching reduced states needed for k-mesh index ik and momentum transfer iq in the background
 	matrix coulombMatrix(size_t iq, matrix& Kxc) const; //retrieve the Coulomb and XC (if not RPA) operators for a specific momentum transfer
 	void nAugRhoAtomInit(size_t iq); //Initialize nAugRhoAtom for a specific momentum transfer
 	void dumpSlabResponse(Everything& e, const diagMatrix& omegaGrid);
@@ -89,6 +89,32 @@ void Everything::setup()
 	}
 	avg_nbasis /= eInfo.qWeightSum;
 	if(!cntrl.shouldPrintKpointsBasis) logResume();
+	if(cntrl.gammaOnly)
+	{	if(eInfo.isNoncollinear()) die("gamma-only is not supported with noncollinear magnetism or spin-orbit coupling.\n");
+		for(const QuantumNumber& qnum: eInfo.qnums)
+			if(qnum.k.length_squared()) die("gamma-only requires the Gamma point to be the only k-point.\n");
+		for(auto dumpPair: dump)
+			switch(dumpPair.second)
+			{	case DumpQMC: case DumpOcean: case DumpBGW: case DumpPolarizability: case DumpElectronScattering:
+				case DumpSIC: case DumpExcitations: case DumpFCI:
+					die("Requested dump output is not supported in gamma-only mode.\n");
+				default:;
+			}
+		size_t nbasisFull = basis[0].nbasis;
+		for(int q=0; q<eInfo.nStates; q++)
+		{	if(cntrl.basisKdep==BasisKpointDep || q==0) basis[q].setupRealWavefunctions();
+			else basis[q] = basis[0]; //re-share the reduced basis
+		}
+		matrix::diagonalizeReal = true;
+		logPrintf("Using real wavefunctions (gamma-only mode): storing %lu of %lu basis functions (half G-sphere).\n", basis[0].nbasis, nbasisFull);
+	}
+	//Features that do not support band-parallel process groups are rejected by the corresponding commands,
+	//except for LibXC hybrids, which are only identified after functional setup:
+	if(mpiGroup->nProcesses() > 1)
+	{	bool exxUsed = exCorr.exxFactor();
+		for(auto ec: exCorrDiff) if(ec->exxFactor()) exxUsed = true;
+		if(exxUsed) die("Exact exchange does not support band-parallel process groups: use one process per group (-G).\n");
+	}
 	logPrintf("average nbasis = %7.3lf , ideal nbasis = %7.3lf\n", avg_nbasis,
 		pow(sqrt(2*cntrl.Ecut),3)*(gInfo.detR/(6*M_PI*M_PI)));
 	logFlush();
@@ -141,7 +167,7 @@ void Everything::setup()
 		if(eInfo.fillingsUpdate==ElecInfo::FillingsHsub)
 			elecMinParams.nDim += eInfo.nBands * eInfo.nBands;
 	}
-	mpiWorld->allReduce(elecMinParams.nDim, MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(elecMinParams.nDim, MPIUtil::ReduceSum);
 	elecMinParams.fpLog = globalLog;
 	elecMinParams.linePrefix = "ElecMinimize: ";
 	elecMinParams.energyLabel = relevantFreeEnergyName(*this);
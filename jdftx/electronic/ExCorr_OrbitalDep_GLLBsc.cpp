@@ -41,8 +41,8 @@ std::vector<double> ExCorr_OrbitalDep_GLLBsc::getExtremalEnergy(bool HOMO) const
 				wExtremal[s] += w;
 			}
 		}
-		mpiWorld->allReduceData(eExtremal, MPIUtil::ReduceSum);
-		mpiWorld->allReduceData(wExtremal, MPIUtil::ReduceSum);
+		mpiGroupHead->allReduceData(eExtremal, MPIUtil::ReduceSum);
+		mpiGroupHead->allReduceData(wExtremal, MPIUtil::ReduceSum);
 		for(int s=0; s<nSpins; s++) eExtremal[s] /= wExtremal[s];
 		return eExtremal;
 	}
@@ -175,7 +175,8 @@ ScalarFieldArray ExCorr_OrbitalDep_GLLBsc::getPotential(std::vector<double> eHOM
 	const double Kx = 8*sqrt(2)/(3*M_PI*M_PI);
 	ScalarFieldArray V(nSpins);
 	e.iInfo.augmentDensityInit();
-	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	int qStop = mpiGroup->isHead() ? e.eInfo.qStop : e.eInfo.qStart; //count states once per process group (reduced over mpiWorld below)
+	for(int q=e.eInfo.qStart; q<qStop; q++)
 	{	const QuantumNumber& qnum = e.eInfo.qnums[q];
 		int s = qnum.index();
 		diagMatrix Feff(e.eInfo.nBands);
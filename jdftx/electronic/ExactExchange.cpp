@@ -69,6 +69,10 @@ private:
 	//Occupied state properties for fixed-H mode:
 	std::vector<diagMatrix> Focc;
 	std::vector<ColumnBundle> Cocc;
+	
+	//Adaptively compressed exchange (ACE) projectors, such that exchange operator = -xi xi^ for each local state:
+	std::vector<ColumnBundle> aceXi;
+	double aceAXX, aceOmega; //!< exchange parameters with which aceXi were computed
 };
 
 
@@ -168,7 +172,16 @@ void ExactExchange::setOccupied(const std::vector<diagMatrix>& F, const std::vec
 
 
 void ExactExchange::applyHamiltonian(double aXX, double omega, int q, const ColumnBundle& Cq, ColumnBundle& HCq)
-{	int iSpin = q / eval->qCount;
+{	//Use ACE projectors when available:
+	if(eval->aceXi.size() && eval->aceXi[q] && aXX==eval->aceAXX && omega==eval->aceOmega)
+	{	static StopWatch watch("ExactExchangeACE"); watch.start();
+		const ColumnBundle& xi = eval->aceXi[q];
+		HCq -= xi * (xi ^ Cq);
+		watch.stop();
+		return;
+	}
+	//Full evaluation:
+	int iSpin = q / eval->qCount;
 	diagMatrix Fq = eval->Focc[q]; Fq.resize(Cq.nCols());
 	for(int ikReduced=0; ikReduced<eval->qCount; ikReduced++)
 	{	int ikSrc = ikReduced + iSpin*eval->qCount;
@@ -179,6 +192,29 @@ void ExactExchange::applyHamiltonian(double aXX, double omega, int q, const Colu
 }
 
 
+void ExactExchange::setupACE(double aXX, double omega, const std::vector<ColumnBundle>& C)
+{	static StopWatch watch("ExactExchangeACEsetup"); watch.start();
+	clearACE();
+	std::vector<ColumnBundle> aceXi(e.eInfo.nStates);
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	//Apply full exchange operator to wavefunctions:
+		ColumnBundle W = C[q].similar(); W.zero();
+		applyHamiltonian(aXX, omega, q, C[q], W);
+		//Factorize the (negative definite) exchange operator in the subspace:
+		matrix M = dagger_symmetrize(C[q] ^ W);
+		aceXi[q] = W * invsqrt(-M); //so that W inv(M) W^ = -xi xi^
+	}
+	std::swap(eval->aceXi, aceXi);
+	eval->aceAXX = aXX;
+	eval->aceOmega = omega;
+	watch.stop();
+}
+
+void ExactExchange::clearACE()
+{	eval->aceXi.clear();
+}
+
+
 //--------------- class ExactExchangeEval implementation ----------------------
 
 
@@ -189,7 +225,8 @@ ExactExchangeEval::ExactExchangeEval(const Everything& e)
 	nSpins(e.eInfo.nSpins()),
 	nSpinor(e.eInfo.spinorLength()),
 	qCount(e.eInfo.nStates/nSpins),
-	blockSize(e.cntrl.exxBlockSize)
+	blockSize(e.cntrl.exxBlockSize),
+	aceAXX(0.), aceOmega(0.)
 {
 	//Find all symmtries relating each kmesh point to corresponding reduced point:
 	const Supercell& supercell = *(e.coulombParams.supercell);
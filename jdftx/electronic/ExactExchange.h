@@ -44,8 +44,14 @@ public:
 	//! Set the occupied wavefunctions and occupation factors in preparation for applyHamiltonian
 	void setOccupied(const std::vector<diagMatrix>& F, const std::vector<ColumnBundle>& C);
 	
-	//! Apply Hamiltonian:
+	//! Apply Hamiltonian (using the ACE representation if set up with matching aXX and omega):
 	void applyHamiltonian(double aXX, double omega, int q, const ColumnBundle& Cq, ColumnBundle& HCq);
+	
+	//! Build adaptively compressed exchange (ACE) projectors for local states from wavefunctions C,
+	//! using occupied states from a preceding setOccupied(). Subsequent applyHamiltonian calls with
+	//! the same aXX and omega reduce to dense matrix multiplies against these projectors.
+	void setupACE(double aXX, double omega, const std::vector<ColumnBundle>& C);
+	void clearACE(); //!< discard ACE projectors, reverting applyHamiltonian to the full evaluation
 
 	//! Add Hamiltonian in plane-wave basis (used for dense diagonalization for BGW):
 	void addHamiltonian(double aXX, double omega, int q, matrix& H,
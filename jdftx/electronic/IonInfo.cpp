@@ -287,19 +287,31 @@ double IonInfo::ionicEnergyAndGrad()
 	//--------- Forces due to nonlocal pseudopotential contributions ---------
 	IonicGradient forcesNL; forcesNL.init(*this);
 	matrix3<> Enl_RRT, *Enl_RRTptr = computeStress ? &Enl_RRT : 0;
-	if(eInfo.hasU) //Include DFT+U contribution if any:
+	bool qContrib = mpiGroup->isHead(); //state contributions are identical on all processes in a group: count once
+	if(eInfo.hasU and qContrib) //Include DFT+U contribution if any:
 		rhoAtom_forces(eVars.F, eVars.C, eVars.U_rhoAtom, forcesNL, Enl_RRTptr);
 	augmentDensityGridGrad(eVars.Vscloc, &forcesNL, Enl_RRTptr);
-	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	for(int q=eInfo.qStart; q<(qContrib ? eInfo.qStop : eInfo.qStart); q++)
 	{	const QuantumNumber& qnum = e->eInfo.qnums[q];
 		//Collect gradients with respect to VdagCq (not including fillings and state weight):
 		std::vector<matrix> HVdagCq(species.size()); 
 		EnlAndGrad(qnum, eVars.F[q], eVars.VdagC[q], HVdagCq);
 		augmentDensitySphericalGrad(qnum, eVars.VdagC[q], HVdagCq);
 		//Propagate to atomic positions:
+		matrix grad_CdagOCq = -(eVars.Hsub_eigs[q] * eVars.F[q]); //gradient of energy w.r.t overlap matrix
 		for(unsigned sp=0; sp<species.size(); sp++) if(HVdagCq[sp])
-		{	matrix grad_CdagOCq = -(eVars.Hsub_eigs[q] * eVars.F[q]); //gradient of energy w.r.t overlap matrix
-			species[sp]->accumNonlocalForces(eVars.C[q], eVars.VdagC[q][sp], HVdagCq[sp]*eVars.F[q], grad_CdagOCq, forcesNL[sp], Enl_RRTptr);
+		{	const SpeciesInfo& s = *species[sp];
+			bool realSpace = s.useRealSpaceProjectors(eVars.C[q]);
+			s.accumNonlocalForces(eVars.C[q], eVars.VdagC[q][sp], HVdagCq[sp]*eVars.F[q], grad_CdagOCq, forcesNL[sp], realSpace ? 0 : Enl_RRTptr);
+			if(realSpace && Enl_RRTptr)
+			{	//Lattice derivatives are only available for the plane-wave projectors:
+				//evaluate this species' stress contribution consistently with those instead.
+				matrix VdagCpw = (*s.getV(eVars.C[q])) ^ eVars.C[q];
+				matrix HVdagCpw;
+				s.EnlAndGrad(qnum, eVars.F[q], VdagCpw, HVdagCpw);
+				s.augmentDensitySphericalGrad(qnum, VdagCpw, HVdagCpw);
+				s.accumNonlocalStress(eVars.C[q], VdagCpw, HVdagCpw*eVars.F[q], grad_CdagOCq, *Enl_RRTptr);
+			}
 		}
 	}
 	for(auto& force: forcesNL) //Accumulate contributions over processes
@@ -358,18 +370,38 @@ void IonInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const std::
 
 void IonInfo::project(const ColumnBundle& Cq, std::vector<matrix>& VdagCq, matrix* rotExisting) const
 {	VdagCq.resize(species.size());
+	std::vector<const SpeciesInfo*> spRealSpace(species.size(), 0); bool anyRealSpace = false;
 	for(unsigned sp=0; sp<e->iInfo.species.size(); sp++)
 	{	if(rotExisting && VdagCq[sp]) VdagCq[sp] = VdagCq[sp] * (*rotExisting); //rotate and keep the existing projections
+		else if(species[sp]->useRealSpaceProjectors(Cq))
+		{	spRealSpace[sp] = species[sp].get(); //compute together below
+			anyRealSpace = true;
+		}
 		else
 		{	auto V = e->iInfo.species[sp]->getV(Cq);
 			if(V) VdagCq[sp] = (*V) ^ Cq;
 		}
 	}
+	if(anyRealSpace)
+	{	std::vector<matrix> VdagCqRealSpace;
+		SpeciesInfo::projectRealSpace(spRealSpace, Cq, VdagCqRealSpace);
+		for(unsigned sp=0; sp<species.size(); sp++)
+			if(spRealSpace[sp]) VdagCq[sp] = VdagCqRealSpace[sp];
+	}
 }
 
 void IonInfo::projectGrad(const std::vector<matrix>& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const
-{	for(unsigned sp=0; sp<species.size(); sp++)
-		if(HVdagCq[sp]) HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+{	std::vector<const SpeciesInfo*> spRealSpace(species.size(), 0); bool anyRealSpace = false;
+	for(unsigned sp=0; sp<species.size(); sp++)
+		if(HVdagCq[sp])
+		{	if(species[sp]->useRealSpaceProjectors(Cq))
+			{	spRealSpace[sp] = species[sp].get(); //handle together below
+				anyRealSpace = true;
+			}
+			else HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+		}
+	if(anyRealSpace)
+		SpeciesInfo::projectGradRealSpace(spRealSpace, HVdagCq, Cq, HCq);
 }
 
 //----- DFT+U functions --------
@@ -540,8 +572,8 @@ double IonInfo::calcEpulay(matrix3<>* E_RRT) const
 	
 	double nbasisAvg = 0.0;
 	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
-		nbasisAvg += 0.5*e->eInfo.qnums[q].weight * e->basis[q].nbasis;
-	mpiWorld->allReduce(nbasisAvg, MPIUtil::ReduceSum);
+		nbasisAvg += 0.5*e->eInfo.qnums[q].weight * e->basis[q].nbasisFull();
+	mpiGroupHead->allReduce(nbasisAvg, MPIUtil::ReduceSum);
 	
 	if(E_RRT)
 		*E_RRT += matrix3<>(1,1,1) * (dEtot_dnG * nbasisAvg/e->gInfo.detR);
@@ -75,6 +75,21 @@ IonicDynamics::IonicDynamics(Everything& e)
 	for(auto dumpPair: e.dump)
 		if(dumpPair.second == DumpElecDensityAccum)
 			nAccumNeeded = true;
+	
+	//Wavefunction extrapolation coefficients (Kolafa's always-stable predictor of order K):
+	if(idp.wfnsExtrapolation>=0 and (not e.iInfo.ljOverride))
+	{	int K = idp.wfnsExtrapolation;
+		auto binom = [](int n, int k)
+		{	double result = 1.;
+			for(int i=1; i<=k; i++) result *= double(n-k+i)/i;
+			return result;
+		};
+		double normFac = 1./binom(2*K+2, K+1);
+		for(int j=1; j<=K+2; j++)
+			extrapCoeff.push_back((j%2 ? 1. : -1.) * j * binom(2*K+4, K+2-j) * normFac);
+		Chistory.resize(e.eInfo.nStates);
+		logPrintf("Extrapolating wavefunctions with ASPC of order %d from the previous %d steps.\n", K, K+2);
+	}
 }
 
 void IonicDynamics::initializeVelocities()
@@ -181,6 +196,52 @@ LatticeGradient IonicDynamics::computePE()
 	return accel;
 }
 
+bool IonicDynamics::canExtrapolate() const
+{	if(extrapCoeff.empty()) return false;
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+		if(Chistory[q].size() < extrapCoeff.size())
+			return false;
+	return true;
+}
+
+void IonicDynamics::saveWavefunctions()
+{	if(extrapCoeff.empty()) return;
+	static StopWatch watch("IonicDynamics::saveWfns"); watch.start();
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	const ColumnBundle& Cq = e.eVars.C[q];
+		std::deque<ColumnBundle>& hist = Chistory[q];
+		if(hist.size() and hist.front().colLength()!=Cq.colLength())
+			hist.clear(); //basis changed: history no longer usable
+		if(hist.size() == extrapCoeff.size())
+			hist.pop_back(); //drop oldest
+		//Align history to the gauge of Cq (within the occupied subspace and across degeneracies):
+		if(hist.size())
+		{	//Unitary rotation minimizing |Cprev rot - Cq| is the polar factor of Cprev^O(Cq):
+			matrix U, Vdag; diagMatrix S;
+			innerWfns(hist.front(), O(Cq)).svd(U, S, Vdag);
+			matrix rot = U * Vdag;
+			for(ColumnBundle& Cprev: hist)
+				Cprev = multiplyWfns(Cprev, rot);
+		}
+		hist.push_front(Cq);
+	}
+	watch.stop();
+}
+
+void IonicDynamics::extrapolateWavefunctions()
+{	static StopWatch watch("IonicDynamics::extrapolateWfns"); watch.start();
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	const std::deque<ColumnBundle>& hist = Chistory[q];
+		ColumnBundle& Cq = e.eVars.C[q];
+		Cq = hist[0];
+		Cq *= extrapCoeff[0];
+		for(size_t j=1; j<extrapCoeff.size(); j++)
+			Cq += extrapCoeff[j] * hist[j];
+		e.eVars.orthonormalize(q);
+	}
+	watch.stop();
+}
+
 LatticeGradient IonicDynamics::thermostat(const LatticeGradient& vel)
 {	const IonicDynamicsParams& idp = e.ionicDynParams;
 	//Update KE and pressure first:
@@ -260,6 +321,7 @@ void IonicDynamics::run()
 	//Initial energies and forces
 	if(nAccumNeeded) nullToZero(e.eVars.nAccum, e.gInfo);
 	LatticeGradient accel = computePE(), accelV = thermostat(getVelocities()); //in Cartesian coordinates
+	saveWavefunctions();
 	
 	for(int iter=0; iter<=idp.nSteps; iter++)
 	{	double t = iter*idp.dt;
@@ -271,8 +333,17 @@ void IonicDynamics::run()
 		LatticeGradient vel = getVelocities();
 		axpy(0.5*idp.dt, accel+accelV, vel);
 		//--- position and position-dependent acceleration update:
-		lmin.step(vel, idp.dt);
+		if(canExtrapolate())
+		{	//Skip the wavefunction drag, since it is superseded by the extrapolation:
+			bool dragWavefunctions = e.cntrl.dragWavefunctions;
+			e.cntrl.dragWavefunctions = false;
+			lmin.step(vel, idp.dt);
+			e.cntrl.dragWavefunctions = dragWavefunctions;
+			extrapolateWavefunctions();
+		}
+		else lmin.step(vel, idp.dt);
 		accel = computePE();
+		saveWavefunctions();
 		//--- velocity update: second half step estimator
 		axpy(0.5*idp.dt, accel+accelV, vel); //note second-order error here due to first-order error in accelV
 		//--- velocity update: second half step corrector
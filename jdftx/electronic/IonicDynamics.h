@@ -21,7 +21,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_ELECTRONIC_IONICDYNAMICS_H
 
 #include <electronic/LatticeMinimizer.h>
+#include <electronic/ColumnBundle.h>
 #include <core/matrix3.h>
+#include <deque>
 
 //! @addtogroup IonicSystem
 //! @{
@@ -51,6 +53,10 @@ private:
 	double p; //!< current pressure
 	matrix3<> stress; //!< current stress tensor (includes kinetic stress whereas IonInfo::stress does not)
 	
+	//Wavefunction extrapolation (ASPC predictor):
+	std::vector<std::deque<ColumnBundle>> Chistory; //!< converged wavefunctions of previous steps for each local state (most recent first), all in the gauge of the most recent
+	std::vector<double> extrapCoeff; //!< ASPC predictor coefficients for Chistory (empty if extrapolation disabled)
+	
 	//Utility functions
 	void initializeVelocities(); //!< Initialize Maxwell-Boltzmann distribution of velocities
 	LatticeGradient getVelocities(); //!< Get Cartesian velocities from SpeciesInfo lattice-coordinate versions
@@ -60,6 +66,9 @@ private:
 	LatticeGradient computePE(); //!< Update potential energy and return acceleration (due to potential forces)
 	LatticeGradient thermostat(const LatticeGradient& vel); //!< Return velocity-dependent acceleration due to thermostat (calls setVelocities, computeKE and computePressure)
 	bool report(int iter, double t); //!< Report properties at current step
+	bool canExtrapolate() const; //!< Whether enough history is available to extrapolate wavefunctions
+	void saveWavefunctions(); //!< Align history to current converged wavefunctions and add them to it
+	void extrapolateWavefunctions(); //!< Replace wavefunctions by ASPC prediction from history (call after ionic step, before compute)
 };
 
 //! @}
@@ -39,11 +39,12 @@ struct IonicDynamicsParams
 	int chainLengthT; //!< Nose-Hoover chain length for thermostat
 	int chainLengthP; //!< Nose-Hoover chain length for barostat
 	double B0; //!< characteristic bulk modulus for Berendsen barostat (default: water bulk modulus)
+	int wfnsExtrapolation; //!< order K of ASPC wavefunction extrapolation from K+2 previous steps (-1 => disabled)
 	
 	IonicDynamicsParams() : dt(1.*fs), nSteps(0), statMethod(StatNone),
 		T0(298*Kelvin), P0(NAN), stress0(NAN,NAN,NAN),
 		tDampT(50.*fs), tDampP(100.*fs),
-		chainLengthT(3), chainLengthP(3), B0(2.2E9*Pascal) {}
+		chainLengthT(3), chainLengthP(3), B0(2.2E9*Pascal), wfnsExtrapolation(-1) {}
 };
 
 //! @}
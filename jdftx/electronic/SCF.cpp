@@ -115,7 +115,8 @@ double SCF::sync(double x) const
 }
 
 double SCF::cycle(double dEprev, std::vector<double>& extraValues)
-{	const SCFparams& sp = e.scfParams;
+{	static StopWatch watch("SCF cycle"); watch.start();
+	const SCFparams& sp = e.scfParams;
 	
 	//Cache required quantities:
 	std::vector<diagMatrix> eigsPrev = e.eVars.Hsub_eigs;
@@ -134,6 +135,7 @@ double SCF::cycle(double dEprev, std::vector<double>& extraValues)
 	mpiWorld->bcast(E); //ensure consistency to machine precision
 
 	extraValues[0] = eigDiffRMS(eigsPrev, e.eVars.Hsub_eigs);
+	watch.stop();
 	return E;
 }
 
@@ -151,6 +153,7 @@ void SCF::report(int iter)
 		saveState(fname.c_str());
 		logPrintf("done\n"); logFlush();
 	}
+	Profiler::cycleEnd("SCF", iter);
 }
 
 
@@ -333,8 +336,8 @@ double SCF::eigDiffRMS(const std::vector<diagMatrix>& eigs1, const std::vector<d
 			rmsDen += wq;
 		}
 	}
-	mpiWorld->allReduce(rmsNum, MPIUtil::ReduceSum);
-	mpiWorld->allReduce(rmsDen, MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(rmsNum, MPIUtil::ReduceSum);
+	mpiGroupHead->allReduce(rmsDen, MPIUtil::ReduceSum);
 	return sqrt(rmsNum/rmsDen);
 }
 
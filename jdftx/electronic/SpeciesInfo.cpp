@@ -37,6 +37,7 @@ void SpeciesInfo::sync_atpos()
 	atposManaged = ManagedArray<vector3<>>(atpos); //it will get transferred to GPU if/when necessary
 	//Invalidate cached projectors:
 	cachedV.clear();
+	rsProj.valid = false;
 }
 
 inline bool isParallel(vector3<> x, vector3<> y)
@@ -27,6 +27,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ScalarFieldArray.h>
 #include <core/vector3.h>
 #include <core/string.h>
+#include <mutex>
 
 class ColumnBundle;
 class QuantumNumber;
@@ -94,8 +95,26 @@ public:
 	//! If derivDir is non-null, return the derivative with respct to Cartesian k direction *derivDir instead (never cached).
 	//! If stressDir is >=0, then calculate (i,j) component of dVnl/dR . RT where stressDir = 3*i+j
 	std::shared_ptr<ColumnBundle> getV(const ColumnBundle& Cq, const vector3<>* derivDir=0, const int stressDir=-1) const;
+	//! Gamma-only mode: diagonal phases (i for odd l) that getV includes in each atom's projectors to keep them real in real space,
+	//! so that projections from getV equal dagger(P) times the standard ones. Returns an empty matrix otherwise.
+	//! Terms that mix projectors of different l (ultrasoft augmentation) must undo this phase.
+	matrix getProjectorPhase() const;
 	int nProjectors() const { return MnlAll.nRows() * atpos.size(); } //!< total number of projectors for all atoms in this species (number of columns in result of getV)
 	
+	//! Whether projections of Cq onto this species are computed on real-space spheres (see Control::realSpaceProjectors).
+	//! Prepares the sphere data if atom positions or lattice vectors have changed, so call outside threaded regions.
+	bool useRealSpaceProjectors(const ColumnBundle& Cq) const;
+	matrix project(const ColumnBundle& Cq) const; //!< Projections V^Cq onto this species, in real space if enabled, and with getV otherwise
+	void projectGrad(const matrix& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const; //!< Accumulate V*HVdagCq into HCq (in real space if enabled)
+	
+	//! Compute real-space projections VdagCq[i] for each non-null spArr[i], sharing a single FFT per column of Cq amongst all species.
+	//! All non-null species must satisfy useRealSpaceProjectors(Cq).
+	static void projectRealSpace(const std::vector<const SpeciesInfo*>& spArr, const ColumnBundle& Cq, std::vector<matrix>& VdagCq);
+	//! Accumulate the real-space projector gradient for each non-null spArr[i] and HVdagCq[i] into HCq, with a single FFT per column
+	static void projectGradRealSpace(const std::vector<const SpeciesInfo*>& spArr, const std::vector<matrix>& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq);
+	void projectRealSpaceColumn(const complex* psi, const vector3<>& k, complex* VdagPsi, int stride) const; //!< Accumulate projections of real-space psi (strided output)
+	void projectGradRealSpaceColumn(const complex* HVdagPsi, int stride, const vector3<>& k, complex* psi) const; //!< Accumulate projector gradient onto real-space psi
+	
 	//! Return non-local energy for this species and quantum number q and optionally accumulate
 	//! projected electronic gradient in HVdagCq (if non-null)
 	double EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const matrix& VdagCq, matrix& HVdagCq) const;
@@ -159,6 +178,10 @@ public:
 	//! Additionally accumulate nonlocal stresses if Enl_RRT is non-null
 	void accumNonlocalForces(const ColumnBundle& Cq, const matrix& VdagC, const matrix& E_VdagC, const matrix& grad_CdagOCq, std::vector<vector3<> >& forces, matrix3<>* Enl_RRT) const;
 	
+	//! Accumulate nonlocal stresses alone (called by accumNonlocalForces), given projections VdagC onto the plane-wave projectors (getV)
+	//! and the corresponding gradient E_VdagC. With real-space projectors, the caller evaluates VdagC and E_VdagC with getV instead.
+	void accumNonlocalStress(const ColumnBundle& Cq, const matrix& VdagC, const matrix& E_VdagC, const matrix& grad_CdagOCq, matrix3<>& Enl_RRT) const;
+	
 	//! Spin-angle helper functions:
 	static matrix getYlmToSpinAngleMatrix(int l, int j2); //!< Get the ((2l+1)*2)x(j2+1) matrix that transforms the Ylm+spin to the spin-angle functions, where j2=2*j with j = l+/-0.5
 	static matrix getYlmOverlapMatrix(int l, int j2); //!< Get the ((2l+1)*2)x((2l+1)*2) overlap matrix of the spin-spherical harmonics for total angular momentum j (note j2=2*j)
@@ -177,6 +200,22 @@ private:
 	matrix QintAll; //!< block matrix containing Qint for all l,m 
 	
 	std::map<std::pair<vector3<>,const Basis*>, std::shared_ptr<ColumnBundle> > cachedV; //cached projectors (identified by k-point and basis pointer)
+	mutable std::mutex cacheLock; //guards lazily initialized cachedV and rsProj, which may be accessed concurrently from thread teams in bandMinimize
+	
+	//! Nonlocal projectors at Gamma, restricted to spheres of real-space grid points around each atom (see Control::realSpaceProjectors)
+	struct RealSpaceProjectors
+	{	bool valid; //!< whether the data below is up to date with atpos and R
+		matrix3<> R; //!< lattice vectors for which the data was computed
+		double rCut; //!< sphere radius (0 if plane-wave projectors must be used instead)
+		int nProj; //!< number of projectors per atom
+		std::vector<size_t> atomStart; //!< offset of each atom's points in the arrays below (size nAtoms+1)
+		std::vector<int> index; //!< index of each point into the full real-space grid
+		std::vector<vector3<>> x; //!< unwrapped lattice coordinates of each point (for the Bloch phase)
+		std::vector<complex> B; //!< projector values, nProj consecutive entries per point
+		RealSpaceProjectors() : valid(false), rCut(0.), nProj(0) {}
+	};
+	RealSpaceProjectors rsProj;
+	void setupRealSpaceProjectors(); //!< Compute rsProj for current atom positions (implemented in SpeciesInfo_realSpace.cpp)
 	
 	struct QijIndex
 	{	int l1, p1; //!< Angular momentum and projector index for channel i
@@ -215,6 +215,11 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n,
 			size_t offs = iCol * psi.colLength();
 			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
 				e->gInfo.G, atposManaged.dataPref(), fRadial[l][n], psi.dataPref()+offs, derivDir, stressDir);
+			if(basis.realWavefunctions && (l % 2)) //Gamma-only mode: an extra phase of i makes odd-l orbitals real in real space
+			{	complex* dataPtr = psi.dataPref()+offs;
+				for(size_t a=0; a<atpos.size(); a++)
+					callPref(eblas_zscal)(basis.nbasis, complex(0,1), dataPtr+a*atomStride, 1);
+			}
 			if(nSpinCopies>1) //make copy for other spin
 			{	complex* dataPtr = psi.dataPref()+offs;
 				for(size_t a=0; a<atpos.size(); a++)
@@ -30,10 +30,9 @@ void SpeciesInfo::augmentOverlap(const ColumnBundle& Cq, ColumnBundle& OCq, matr
 {	static StopWatch watch("augmentOverlap"); watch.start();
 	if(!atpos.size()) return; //unused species
 	if(!Qint.size()) return; //no overlap augmentation
-	std::shared_ptr<ColumnBundle> V = getV(Cq);
-	matrix VdagCq = (*V) ^ Cq;
+	matrix VdagCq = project(Cq);
 	if(VdagCqPtr) *VdagCqPtr = VdagCq; //cache for later usage
-	OCq += (*V) * (tiledBlockMatrix(QintAll,atpos.size()) * VdagCq);
+	projectGrad(tiledBlockMatrix(QintAll,atpos.size()) * VdagCq, Cq, OCq);
 	watch.stop();
 }
 
@@ -41,7 +40,7 @@ void SpeciesInfo::augmentSpinOverlap(const ColumnBundle& Cq, vector3<matrix>& Sq
 {	if(!atpos.size()) return; //unused species
 	if(!Qint.size()) return; //no overlap augmentation
 	assert(e->eInfo.isNoncollinear());
-	matrix VdagCq = (*getV(Cq)) ^ Cq; //pseudopotential projection
+	matrix VdagCq = project(Cq); //pseudopotential projection
 	//Pauli sigma matrices:
 	std::vector<matrix> pauli(3, zeroes(2,2));
 	pauli[0].set(0,1, +1); pauli[0].set(1,0, +1);
@@ -109,11 +108,13 @@ void SpeciesInfo::augmentDensitySpherical(const QuantumNumber& qnum, const diagM
 	int nProj = MnlAll.nRows();
 	const GridInfo &gInfo = e->gInfo;
 	complex* nAugData = nAug.data();
+	matrix P = getProjectorPhase(); //Gamma-only mode phases included in VdagCq (if any)
 	
 	//Loop over atoms:
 	for(unsigned atom=0; atom<atpos.size(); atom++)
 	{	//Get projections and calculate density matrix at this atom:
 		matrix atomVdagC = VdagCq(atom*nProj,(atom+1)*nProj, 0,VdagCq.nCols());
+		if(P) atomVdagC = P * atomVdagC; //undo Gamma-only mode phases, since the density matrix mixes different l
 		matrix RhoAll = atomVdagC * Fq * dagger(atomVdagC); //density matrix in projector basis on this atom
 		if(isRelativistic()) RhoAll = fljAll * RhoAll * fljAll; //transformation for relativistic pseudopotential
 		std::vector<matrix> Rho(e->eInfo.nDensities); //RhoAll split by spin(-density-matrix) components
@@ -233,6 +234,7 @@ void SpeciesInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const m
 	int nProj = MnlAll.nRows();
 	const GridInfo &gInfo = e->gInfo;
 	const complex* E_nAugData = E_nAug.data();
+	matrix P = getProjectorPhase(); //Gamma-only mode phases included in VdagCq (if any)
 
 	matrix E_RhoVdagC(VdagCq.nRows(),VdagCq.nCols(),isGpuEnabled());
 	
@@ -292,7 +294,9 @@ void SpeciesInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const m
 		//Propagate gradients from densiy matrix to projections:
 		if(isRelativistic()) E_RhoAll = fljAll * E_RhoAll * fljAll; //transformation for relativistic pseudopotential
 		matrix atomVdagC = VdagCq(atom*nProj,(atom+1)*nProj, 0,VdagCq.nCols());
+		if(P) atomVdagC = P * atomVdagC; //undo Gamma-only mode phases (as in augmentDensitySpherical)
 		matrix E_atomRhoVdagC = E_RhoAll * atomVdagC;
+		if(P) E_atomRhoVdagC = dagger(P) * E_atomRhoVdagC; //propagate gradient back to the projections with phases
 		E_RhoVdagC.set(atom*nProj,(atom+1)*nProj, 0,VdagCq.nCols(), E_atomRhoVdagC);
 	}
 	HVdagCq += E_RhoVdagC;
@@ -88,7 +88,7 @@ void SpeciesInfo::rhoAtom_calc(const std::vector<diagMatrix>& F, const std::vect
 		for(int s=0; s<nSpins; s++)
 		{	//Collect contributions from all processes:
 			if(!rho[s]) rho[s] = zeroes(matSize, matSize);
-			mpiWorld->allReduceData(rho[s], MPIUtil::ReduceSum);
+			mpiGroupHead->allReduceData(rho[s], MPIUtil::ReduceSum);
 			//Symmetrize:
 			e->symm.symmetrizeSpherical(rho[s], this);
 			//Collect density matrices per atom:
@@ -275,20 +275,15 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 {
 	//Cartesian gradient of VdagC:
 	matrix DVdagC[3]; 
+	if(useRealSpaceProjectors(Cq))
+	{	for(int k=0; k<3; k++)
+			DVdagC[k] = -project(D(Cq,k)); //D(V)^C = -V^D(C) since D is anti-hermitian
+	}
+	else
 	{	auto V = getV(Cq);
 		for(int k=0; k<3; k++)
 			DVdagC[k] = D(*V,k)^Cq;
 	}
-	//Lattice derivative of VdagC
-	matrix VdagC_RRT[6]; 
-	if(Enl_RRT)
-	{	for(int ij=0; ij<6; ij++) //loop over stress components
-		{	int iDir = RRTindex[ij][0];
-			int jDir = RRTindex[ij][1];
-			int stressDir = 3*iDir+jDir; //combined index for stress projector functions
-			VdagC_RRT[ij] = (*getV(Cq, 0, stressDir)) ^ Cq;
-		}
-	}
 	int nProj = MnlAll.nRows();
 	//Loop over atoms:
 	for(unsigned atom=0; atom<atpos.size(); atom++)
@@ -302,21 +297,51 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 			fCart[k] = trace(E_atomVdagC * dagger(atomDVdagC)).real();
 		}
 		forces[atom] += 2.*Cq.qnum->weight * (e->gInfo.RT * fCart);
-		
-		if(Enl_RRT)
-		{	for(int ij=0; ij<6; ij++) //loop over stress components
-			{	int iDir = RRTindex[ij][0];
-				int jDir = RRTindex[ij][1];
-				matrix atomVdagC_RRT = VdagC_RRT[ij](atom*nProj,(atom+1)*nProj, 0,E_VdagC.nCols());
-				double Enl_RRT_ij = 2.*Cq.qnum->weight * trace(E_atomVdagC * dagger(atomVdagC_RRT)).real();
-				(*Enl_RRT)(iDir,jDir) += Enl_RRT_ij;
-				if(iDir != jDir)
-					(*Enl_RRT)(jDir,iDir) += Enl_RRT_ij;
-			}
+	}
+	if(Enl_RRT) accumNonlocalStress(Cq, VdagC, E_VdagC, grad_CdagOCq, *Enl_RRT);
+}
+
+void SpeciesInfo::accumNonlocalStress(const ColumnBundle& Cq, const matrix& VdagC, const matrix& E_VdagC, const matrix& grad_CdagOCq, matrix3<>& Enl_RRT) const
+{	//Lattice derivative of VdagC (always using the plane-wave projectors):
+	matrix VdagC_RRT[6]; 
+	for(int ij=0; ij<6; ij++) //loop over stress components
+	{	int iDir = RRTindex[ij][0];
+		int jDir = RRTindex[ij][1];
+		int stressDir = 3*iDir+jDir; //combined index for stress projector functions
+		VdagC_RRT[ij] = (*getV(Cq, 0, stressDir)) ^ Cq;
+	}
+	int nProj = MnlAll.nRows();
+	//Loop over atoms:
+	for(unsigned atom=0; atom<atpos.size(); atom++)
+	{	matrix atomVdagC = VdagC(atom*nProj,(atom+1)*nProj, 0,E_VdagC.nCols());
+		matrix E_atomVdagC = E_VdagC(atom*nProj,(atom+1)*nProj, 0,E_VdagC.nCols());
+		if(QintAll) E_atomVdagC += QintAll * atomVdagC * grad_CdagOCq; //Contribution via overlap augmentation
+		for(int ij=0; ij<6; ij++) //loop over stress components
+		{	int iDir = RRTindex[ij][0];
+			int jDir = RRTindex[ij][1];
+			matrix atomVdagC_RRT = VdagC_RRT[ij](atom*nProj,(atom+1)*nProj, 0,E_VdagC.nCols());
+			double Enl_RRT_ij = 2.*Cq.qnum->weight * trace(E_atomVdagC * dagger(atomVdagC_RRT)).real();
+			Enl_RRT(iDir,jDir) += Enl_RRT_ij;
+			if(iDir != jDir)
+				Enl_RRT(jDir,iDir) += Enl_RRT_ij;
 		}
 	}
 }
 
+matrix SpeciesInfo::getProjectorPhase() const
+{	if(!e->cntrl.gammaOnly) return matrix();
+	int nProj = MnlAll.nRows();
+	matrix P = zeroes(nProj, nProj);
+	int iProj = 0;
+	for(int l=0; l<int(VnlRadial.size()); l++)
+		for(unsigned p=0; p<VnlRadial[l].size(); p++)
+			for(int m=-l; m<=l; m++)
+			{	P.set(iProj,iProj, (l % 2) ? complex(0,1) : complex(1,0));
+				iProj++;
+			}
+	return P;
+}
+
 std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const vector3<>* derivDir, const int stressDir) const
 {	const QuantumNumber& qnum = *(Cq.qnum);
 	const Basis& basis = *(Cq.basis);
@@ -325,7 +350,8 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const ve
 	if(!nProj) return 0; //purely local psp
 	//First check cache
 	if(e->cntrl.cacheProjectors && (!derivDir) && (!stressDir))
-	{	auto iter = cachedV.find(cacheKey);
+	{	std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = cachedV.find(cacheKey);
 		if(iter != cachedV.end()) //found
 			return iter->second; //return cached value
 	}
@@ -339,10 +365,16 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const ve
 				size_t atomStride = nProj * basis.nbasis;
 				callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, qnum.k, basis.iGarr.dataPref(),
 					basis.gInfo->G, atposManaged.dataPref(), VnlRadial[l][p], V->dataPref()+offs, derivDir, stressDir);
+				if(basis.realWavefunctions && (l % 2)) //Gamma-only mode: an extra phase of i makes odd-l projectors real in real space (see getProjectorPhase)
+				{	for(size_t a=0; a<atpos.size(); a++)
+						callPref(eblas_zscal)(basis.nbasis, complex(0,1), V->dataPref()+offs+a*atomStride, 1);
+				}
 				iProj++;
 			}
 	//Add to cache if necessary:
 	if(e->cntrl.cacheProjectors && (!derivDir) && (!stressDir))
+	{	std::lock_guard<std::mutex> lock(cacheLock);
 		((SpeciesInfo*)this)->cachedV[cacheKey] = V;
+	}
 	return V;
 }
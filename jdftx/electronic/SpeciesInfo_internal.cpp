@@ -110,7 +110,7 @@ template<int Nlm> void nAugmentGrad(const vector3<int> S, const matrix3<>& G,
 	const complex* ccE_n, double* E_nRadial, vector3<complex*> E_atpos, array<complex*,6> E_RRT, 
 	const uint64_t* nagIndex, const size_t* nagIndexPtr)
 {	
-	int nThreads = std::min(nProcsAvailable, std::max(1,nCoeff/12)); //Minimum 12 tasks per thread necessary for write-collision prevention logic below
+	int nThreads = std::min(nOperatorThreads(), std::max(1,nCoeff/12)); //Minimum 12 tasks per thread necessary for write-collision prevention logic below
 	for(int pass=0; pass<2; pass++) // two non-overlapping passes
 		threadLaunch(nThreads, nAugmentGrad_sub<Nlm>, nCoeff, S, G, nCoeff, dGinv, nRadial, atpos, ccE_n, E_nRadial, E_atpos, E_RRT, nagIndex, nagIndexPtr, pass);
 }
@@ -0,0 +1,269 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/SpeciesInfo.h>
+#include <electronic/SpeciesInfo_internal.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Operators.h>
+#include <core/Thread.h>
+#include <core/SphericalHarmonics.h>
+#include <core/Spline.h>
+#include <cfloat>
+
+//------- SpeciesInfo functions for nonlocal projectors applied on real-space spheres -------
+
+//The k-point projectors are approximated as V_k(r) = exp(-2 pi i k.x) B(r) for r in a sphere around each atom,
+//where x is the unwrapped lattice coordinate of r and B is the Gamma-point projector (band-limited to Ecut).
+//Projections are then (1/nr) sum_r conj(V_k(r)) I(C)(r) and gradients are (1/nr) Idag(sum_p V_k(r) HVdagC_p).
+//B is evaluated directly on the sphere points as i^l f_lp(|r|) Ylm(rHat), where the real-space radial function
+//f_lp(r) = (Omega/(2 pi^2)) integral_0^Gmax dG G^2 j_l(G r) VnlRadial_lp(G) is tabulated once per species.
+
+bool SpeciesInfo::useRealSpaceProjectors(const ColumnBundle& Cq) const
+{	if(!e->cntrl.realSpaceProjectors) return false;
+	if(!atpos.size() || !MnlAll.nRows()) return false; //unused species or purely local psp
+	if(Cq.basis->gInfo != &(e->gInfo)) return false; //custom grids use plane-wave projectors
+	std::lock_guard<std::mutex> lock(cacheLock);
+	if(!rsProj.valid || rsProj.R != e->gInfo.R)
+		((SpeciesInfo*)this)->setupRealSpaceProjectors();
+	return rsProj.rCut > 0.;
+}
+
+void SpeciesInfo::setupRealSpaceProjectors()
+{	static StopWatch watch("setupRealSpaceProjectors"); watch.start();
+	const GridInfo& gInfo = e->gInfo;
+	const vector3<int>& S = gInfo.S;
+	rsProj = RealSpaceProjectors();
+	rsProj.valid = true;
+	rsProj.R = gInfo.R;
+	updateLatticeDependent(); //make sure radial functions are up to date with R
+	rsProj.nProj = MnlAll.nRows() / e->eInfo.spinorLength();
+	
+	//Largest sphere that does not overlap its own periodic images:
+	double spacingMin = DBL_MAX; //minimum spacing between lattice planes
+	for(int i=0; i<3; i++)
+		spacingMin = std::min(spacingMin, 2*M_PI / gInfo.G.row(i).length());
+	const double rMax = 0.5*spacingMin;
+	
+	//Tabulate real-space radial functions (band-limited to Gmax) and determine sphere radius:
+	const double Gmax = sqrt(2*e->cntrl.Ecut);
+	const int nG = 2*int(ceil(0.5*Gmax/0.01)); //even number of Simpson intervals with dG <~ 0.01
+	const double dG = Gmax/nG;
+	const double dr = 0.05; //radial table spacing (quintic spline interpolation)
+	const int nRsub = 10; //subdivisions of dr for the norm integrals
+	const int nR = int(ceil(rMax/dr)) + 6; //extra samples so that rMax is well within the spline
+	const double prefac = gInfo.detR / (2*M_PI*M_PI);
+	std::vector<std::vector<std::vector<double>>> fCoeff(VnlRadial.size()); //spline coefficients of f_lp
+	double rCut = 0.;
+	for(int l=0; l<int(VnlRadial.size()); l++)
+	{	fCoeff[l].resize(VnlRadial[l].size());
+		for(unsigned p=0; p<VnlRadial[l].size(); p++)
+		{	const RadialFunctionG& F = VnlRadial[l][p];
+			//Simpson weights and G-space norm (Omega^2/(2 pi)^3) integral dG G^2 F(G)^2:
+			std::vector<double> wG(nG+1), G2F(nG+1);
+			double normSq = 0.;
+			for(int iG=0; iG<=nG; iG++)
+			{	double G = iG*dG;
+				wG[iG] = (dG/3) * ((iG==0 || iG==nG) ? 1 : (iG%2 ? 4 : 2));
+				G2F[iG] = G*G*F(G);
+				normSq += wG[iG] * G2F[iG] * F(G);
+			}
+			normSq *= std::pow(gInfo.detR, 2) / std::pow(2*M_PI, 3);
+			//Radial function samples:
+			std::vector<double> f(nR);
+			for(int iR=0; iR<nR; iR++)
+			{	double r = iR*dr, sum = 0.;
+				for(int iG=0; iG<=nG; iG++)
+					sum += wG[iG] * G2F[iG] * bessel_jl(l, iG*dG*r);
+				f[iR] = prefac * sum;
+			}
+			fCoeff[l][p] = QuinticSpline::getCoeff(f, l%2==1);
+			//Find radius beyond which at most the threshold fraction of the norm lies:
+			const double* coeff = fCoeff[l][p].data();
+			double normInSq = 0., rCurCut = -1.;
+			const double h = dr/nRsub;
+			for(int iR=0; iR*h < rMax; iR++)
+			{	//Simpson integral of r^2 f(r)^2 over [iR h, (iR+1) h]:
+				double rArr[3] = { iR*h, (iR+0.5)*h, (iR+1)*h }, wArr[3] = { h/6, 4*h/6, h/6 };
+				for(int j=0; j<3; j++)
+				{	double fr = QuinticSpline::value(coeff, rArr[j]/dr);
+					normInSq += wArr[j] * std::pow(rArr[j]*fr, 2);
+				}
+				if(normSq - normInSq <= e->cntrl.realSpaceProjectorThreshold * normSq)
+				{	rCurCut = (iR+1)*h;
+					break;
+				}
+			}
+			if(rCurCut < 0.)
+			{	logPrintf("Real-space projectors for species %s: projector l=%d p=%u extends beyond half the minimum lattice-plane spacing (%lg bohrs); using plane-wave projectors.\n",
+					name.c_str(), l, p, rMax);
+				rsProj.rCut = 0.;
+				watch.stop();
+				return;
+			}
+			rCut = std::max(rCut, rCurCut);
+		}
+	}
+	rsProj.rCut = rCut;
+	
+	//Evaluate projectors on the grid points within the sphere around each atom:
+	const complex iPowL[4] = { complex(1,0), complex(0,1), complex(-1,0), complex(0,-1) };
+	const int lPhase = e->cntrl.gammaOnly ? 1 : 0; //Gamma-only mode: extra phase of i for odd l, as in getV (see getProjectorPhase)
+	rsProj.atomStart.assign(1, 0);
+	for(size_t atom=0; atom<atpos.size(); atom++)
+	{	const vector3<>& pos = atpos[atom];
+		vector3<int> iMin, iMax, iR;
+		for(int i=0; i<3; i++)
+		{	double dxMax = rCut * gInfo.G.row(i).length() / (2*M_PI); //extent of sphere along lattice direction i
+			iMin[i] = int(ceil((pos[i]-dxMax)*S[i]));
+			iMax[i] = int(floor((pos[i]+dxMax)*S[i]));
+		}
+		for(iR[0]=iMin[0]; iR[0]<=iMax[0]; iR[0]++)
+			for(iR[1]=iMin[1]; iR[1]<=iMax[1]; iR[1]++)
+				for(iR[2]=iMin[2]; iR[2]<=iMax[2]; iR[2]++)
+				{	vector3<> x; vector3<int> iRwrapped;
+					for(int i=0; i<3; i++)
+					{	x[i] = iR[i]*(1./S[i]);
+						iRwrapped[i] = iR[i] % S[i];
+						if(iRwrapped[i] < 0) iRwrapped[i] += S[i];
+					}
+					vector3<> rVec = gInfo.R*(x-pos);
+					double r = rVec.length();
+					if(r > rCut) continue;
+					vector3<> rHat = rVec * (r ? 1./r : 0.);
+					rsProj.index.push_back(gInfo.fullRindex(iRwrapped));
+					rsProj.x.push_back(x);
+					for(int l=0; l<int(VnlRadial.size()); l++)
+						for(unsigned p=0; p<VnlRadial[l].size(); p++)
+						{	double fr = QuinticSpline::value(fCoeff[l][p].data(), r/dr);
+							for(int m=-l; m<=l; m++)
+								rsProj.B.push_back(iPowL[(l + lPhase*(l%2))%4] * (fr * Ylm(l, m, rHat)));
+						}
+				}
+		rsProj.atomStart.push_back(rsProj.index.size());
+	}
+	logPrintf("Real-space projectors for species %s: sphere radius %lg bohrs with %lu grid points per atom.\n",
+		name.c_str(), rCut, rsProj.index.size()/atpos.size());
+	watch.stop();
+}
+
+void SpeciesInfo::projectRealSpaceColumn(const complex* psi, const vector3<>& k, complex* VdagPsi, int stride) const
+{	const int nProj = rsProj.nProj;
+	const double normFac = 1./e->gInfo.nr;
+	for(size_t atom=0; atom<atpos.size(); atom++)
+	{	complex* VdagPsiAtom = VdagPsi + atom*nProj*stride;
+		for(size_t iPt=rsProj.atomStart[atom]; iPt<rsProj.atomStart[atom+1]; iPt++)
+		{	complex psiPhase = (normFac * psi[rsProj.index[iPt]]) * cis((2*M_PI)*dot(k, rsProj.x[iPt])); //conj of projector phase
+			const complex* B = rsProj.B.data() + iPt*nProj;
+			for(int iProj=0; iProj<nProj; iProj++)
+				VdagPsiAtom[iProj*stride] += B[iProj].conj() * psiPhase;
+		}
+	}
+}
+
+void SpeciesInfo::projectGradRealSpaceColumn(const complex* HVdagPsi, int stride, const vector3<>& k, complex* psi) const
+{	const int nProj = rsProj.nProj;
+	for(size_t atom=0; atom<atpos.size(); atom++)
+	{	const complex* HVdagPsiAtom = HVdagPsi + atom*nProj*stride;
+		for(size_t iPt=rsProj.atomStart[atom]; iPt<rsProj.atomStart[atom+1]; iPt++)
+		{	const complex* B = rsProj.B.data() + iPt*nProj;
+			complex result = 0.;
+			for(int iProj=0; iProj<nProj; iProj++)
+				result += B[iProj] * HVdagPsiAtom[iProj*stride];
+			psi[rsProj.index[iPt]] += result * cis((-2*M_PI)*dot(k, rsProj.x[iPt]));
+		}
+	}
+}
+
+void projectRealSpace_sub(size_t colStart, size_t colStop, const std::vector<const SpeciesInfo*>* spArr,
+	const ColumnBundle* Cq, const std::vector<complex*>* VdagCqData, const std::vector<int>* nRows)
+{	int nSpinor = Cq->spinorLength();
+	for(size_t col=colStart; col<colStop; col++)
+		for(int s=0; s<nSpinor; s++)
+		{	complexScalarField psi = I(Cq->getColumn(col,s));
+			const complex* psiData = psi->data();
+			for(size_t i=0; i<spArr->size(); i++)
+				if(spArr->at(i))
+					spArr->at(i)->projectRealSpaceColumn(psiData, Cq->qnum->k, VdagCqData->at(i) + s + nRows->at(i)*col, nSpinor);
+		}
+}
+
+void SpeciesInfo::projectRealSpace(const std::vector<const SpeciesInfo*>& spArr, const ColumnBundle& Cq, std::vector<matrix>& VdagCq)
+{	static StopWatch watch("projectRealSpace"); watch.start();
+	VdagCq.assign(spArr.size(), matrix());
+	std::vector<complex*> VdagCqData(spArr.size(), 0);
+	std::vector<int> nRows(spArr.size(), 0);
+	for(size_t i=0; i<spArr.size(); i++)
+		if(spArr[i])
+		{	VdagCq[i] = zeroes(spArr[i]->nProjectors(), Cq.nCols());
+			VdagCqData[i] = VdagCq[i].data();
+			nRows[i] = VdagCq[i].nRows();
+		}
+	threadLaunch(projectRealSpace_sub, Cq.nCols(), &spArr, &Cq, &VdagCqData, &nRows);
+	watch.stop();
+}
+
+void projectGradRealSpace_sub(size_t colStart, size_t colStop, const std::vector<const SpeciesInfo*>* spArr,
+	const std::vector<const complex*>* HVdagCqData, const std::vector<int>* nRows, const ColumnBundle* Cq, ColumnBundle* HCq)
+{	const GridInfo& gInfo = *(Cq->basis->gInfo);
+	int nSpinor = Cq->spinorLength();
+	for(size_t col=colStart; col<colStop; col++)
+		for(int s=0; s<nSpinor; s++)
+		{	complexScalarField psi; nullToZero(psi, gInfo);
+			complex* psiData = psi->data();
+			for(size_t i=0; i<spArr->size(); i++)
+				if(HVdagCqData->at(i))
+					spArr->at(i)->projectGradRealSpaceColumn(HVdagCqData->at(i) + s + nRows->at(i)*col, nSpinor, Cq->qnum->k, psiData);
+			HCq->accumColumn(col,s, (1./gInfo.nr) * Idag(psi));
+		}
+}
+
+void SpeciesInfo::projectGradRealSpace(const std::vector<const SpeciesInfo*>& spArr, const std::vector<matrix>& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq)
+{	static StopWatch watch("projectGradRealSpace"); watch.start();
+	std::vector<const complex*> HVdagCqData(spArr.size(), 0);
+	std::vector<int> nRows(spArr.size(), 0);
+	bool anyNonZero = false;
+	for(size_t i=0; i<spArr.size(); i++)
+		if(spArr[i] && HVdagCq[i])
+		{	HVdagCqData[i] = HVdagCq[i].data();
+			nRows[i] = HVdagCq[i].nRows();
+			anyNonZero = true;
+		}
+	if(anyNonZero)
+		threadLaunch(projectGradRealSpace_sub, Cq.nCols(), &spArr, &HVdagCqData, &nRows, &Cq, &HCq);
+	watch.stop();
+}
+
+matrix SpeciesInfo::project(const ColumnBundle& Cq) const
+{	if(useRealSpaceProjectors(Cq))
+	{	std::vector<matrix> VdagCq;
+		projectRealSpace(std::vector<const SpeciesInfo*>(1, this), Cq, VdagCq);
+		return VdagCq[0];
+	}
+	auto V = getV(Cq);
+	return V ? (*V)^Cq : matrix();
+}
+
+void SpeciesInfo::projectGrad(const matrix& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const
+{	if(!HVdagCq) return;
+	if(useRealSpaceProjectors(Cq))
+		projectGradRealSpace(std::vector<const SpeciesInfo*>(1, this), std::vector<matrix>(1, HVdagCq), Cq, HCq);
+	else
+		HCq += (*getV(Cq)) * HVdagCq;
+}
@@ -155,15 +155,15 @@ std::vector<QuantumNumber> Symmetries::reduceKmesh(const std::vector<QuantumNumb
 //Symmetrize scalar fields:
 void Symmetries::symmetrize(ScalarField& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
-	complexScalarFieldTilde xTilde = J(Complex(x));
+	ScalarFieldTilde xTilde = J(x);
 	symmetrize(xTilde);
-	x = Real(I(xTilde));
+	x = I(std::move(xTilde));
 }
 void Symmetries::symmetrize(ScalarFieldTilde& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
-	complexScalarFieldTilde xComplex = Complex(x);
-	symmetrize(xComplex);
-	x = Real(xComplex);
+	int nSymmClasses = symmIndexHalf.nData() / sym.size(); //number of equivalence classes
+	callPref(eblas_symmetrize_half)(nSymmClasses, sym.size(), symmIndexHalf.dataPref(), symmMirrorHalf.dataPref(),
+		symmMultHalf.dataPref(), symmIndexPhaseHalf.dataPref(), x->dataPref());
 }
 void Symmetries::symmetrize(complexScalarFieldTilde& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
@@ -175,10 +175,9 @@ void Symmetries::symmetrize(ScalarFieldArray& x) const
 	if(x.size()<=2) { for(ScalarField& x_s: x) symmetrize(x_s); } //everything but vector-spin mode
 	else
 	{	assert(x.size() == 4); //must be vector-spin
-		std::vector<complexScalarFieldTilde> xTilde(x.size());
-		for(unsigned s=0; s<x.size(); s++) xTilde[s] = J(Complex(x[s]));
+		ScalarFieldTildeArray xTilde = J(x);
 		symmetrize(xTilde);
-		for(unsigned s=0; s<x.size(); s++) x[s] = Real(I(xTilde[s]));
+		x = I(std::move(xTilde));
 	}
 }
 void Symmetries::symmetrize(ScalarFieldTildeArray& x) const
@@ -186,10 +185,9 @@ void Symmetries::symmetrize(ScalarFieldTildeArray& x) const
 	if(x.size()<=2) { for(ScalarFieldTilde& x_s: x) symmetrize(x_s); } //everything but vector-spin mode
 	else
 	{	assert(x.size() == 4); //must be vector-spin
-		std::vector<complexScalarFieldTilde> xComplex(x.size());
-		for(unsigned s=0; s<x.size(); s++) xComplex[s] = Complex(x[s]);
-		symmetrize(xComplex);
-		for(unsigned s=0; s<x.size(); s++) x[s] = Real(xComplex[s]);
+		int nSymmClasses = symmIndexHalf.nData() / sym.size(); //number of equivalence classes
+		callPref(eblas_symmetrize_half)(nSymmClasses, sym.size(), symmIndexHalf.dataPref(), symmMirrorHalf.dataPref(),
+			symmMultHalf.dataPref(), symmIndexPhaseHalf.dataPref(), symmRotSpin.dataPref(), dataPref(x));
 	}
 }
 void Symmetries::symmetrize(std::vector<complexScalarFieldTilde>& x) const
@@ -518,6 +516,47 @@ void Symmetries::initSymmIndex()
 			}
 		)
 	}
+	//Equivalence classes directly in the half-G space layout of real fields, with each class also covering its negative:
+	std::vector<int> symmIndexHalfVec, symmMirrorHalfVec, symmMultHalfVec;
+	std::vector<complex> symmIndexPhaseHalfVec;
+	symmIndexHalfVec.reserve(gInfo.nG);
+	symmMirrorHalfVec.reserve(gInfo.nG);
+	symmMultHalfVec.reserve(gInfo.nG / sym.size());
+	symmIndexPhaseHalfVec.reserve(gInfo.nG);
+	std::fill(done.begin(), done.end(), false);
+	{	const vector3<int>& S = gInfo.S;
+		auto isHalf = [&](const vector3<int>& iG) { return 2*iG[2] <= S[2]; }; //whether (wrapped) iG is stored in half-G space
+		auto negate = [&](const vector3<int>& iG) //wrapped index of -iG
+		{	vector3<int> iGneg;
+			for(int k=0; k<3; k++) iGneg[k] = positiveRemainder(-iG[k], S[k]);
+			return iGneg;
+		};
+		size_t iStart = 0, iStop = gInfo.nr;
+		THREAD_fullGspaceLoop
+		(	if(!done[i])
+			{	//Collect orbit:
+				std::vector<vector3<int>> orbit; std::set<int> orbitSet;
+				for(const SpaceGroupOp& op: sym)
+				{	vector3<int> iG2 = iG * op.rot;
+					for(int k=0; k<3; k++)
+						iG2[k] = positiveRemainder(iG2[k], S[k]);
+					orbit.push_back(iG2);
+					orbitSet.insert(gInfo.fullRindex(iG2));
+					symmIndexPhaseHalfVec.push_back(cis((-2*M_PI)*dot(iG,op.a)));
+				}
+				bool selfConjugate = orbitSet.count(gInfo.fullRindex(negate(orbit[0]))); //whether -G is in the same class
+				//Half-G space indices:
+				for(const vector3<int>& iG2: orbit)
+				{	vector3<int> iG2neg = negate(iG2);
+					symmIndexHalfVec.push_back(isHalf(iG2) ? gInfo.halfGindex(iG2) : ~gInfo.halfGindex(iG2neg));
+					symmMirrorHalfVec.push_back((isHalf(iG2neg) && !selfConjugate) ? gInfo.halfGindex(iG2neg) : -1);
+					done[gInfo.fullRindex(iG2)] = true;
+					done[gInfo.fullRindex(iG2neg)] = true;
+				}
+				symmMultHalfVec.push_back(sym.size()/orbitSet.size());
+			}
+		)
+	}
 	//Initialize Cartesian rotation matrices:
 	std::vector<matrix3<>> symmRotSpinVec(sym.size());
 	for(unsigned iRot=0; iRot<sym.size(); iRot++)
@@ -534,6 +573,15 @@ void Symmetries::initSymmIndex()
 	memcpy(symmMult.data(), &symmMultVec[0], symmMultVec.size()*sizeof(int));
 	memcpy(symmIndexPhase.data(), &symmIndexPhaseVec[0], nSymmIndex*sizeof(complex));
 	memcpy(symmRotSpin.data(), &symmRotSpinVec[0], sym.size()*sizeof(matrix3<>));
+	int nSymmIndexHalf = symmIndexHalfVec.size();
+	symmIndexHalf.init(nSymmIndexHalf);
+	symmMirrorHalf.init(nSymmIndexHalf);
+	symmMultHalf.init(symmMultHalfVec.size());
+	symmIndexPhaseHalf.init(nSymmIndexHalf);
+	memcpy(symmIndexHalf.data(), &symmIndexHalfVec[0], nSymmIndexHalf*sizeof(int));
+	memcpy(symmMirrorHalf.data(), &symmMirrorHalfVec[0], nSymmIndexHalf*sizeof(int));
+	memcpy(symmMultHalf.data(), &symmMultHalfVec[0], symmMultHalfVec.size()*sizeof(int));
+	memcpy(symmIndexPhaseHalf.data(), &symmIndexPhaseHalfVec[0], nSymmIndexHalf*sizeof(complex));
 }
 
 void Symmetries::sortSymmetries()
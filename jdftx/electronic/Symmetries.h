@@ -92,6 +92,11 @@ private:
 	IndexArray symmMult; //multiplicity (how many times each element is repeated) in each equivalence class
 	ManagedArray<complex> symmIndexPhase; //phase factor for entry at each index
 	ManagedArray<matrix3<>> symmRotSpin; //nSym Cartesian (pseudo-vector) rotation matrices for spin-density symmetrization
+	//Equivalent index map directly in the half-G space (r2c) layout of real scalar fields (see eblas_symmetrize_half)
+	IndexArray symmIndexHalf; //sets of nSym consecutive half-G space indices (~index for conjugate) per equivalence class
+	IndexArray symmMirrorHalf; //half-G space index of negated entry to also be updated (-1 if none)
+	IndexArray symmMultHalf; //multiplicity in each equivalence class
+	ManagedArray<complex> symmIndexPhaseHalf; //phase factor for entry at each index
 	void initSymmIndex();
 	
 	//Atom maps:
@@ -0,0 +1,385 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/WannierInterpolator.h>
+#include <core/Thread.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(string fname) : ptr(0), nDoubles(0), map(0), mapLength(0)
+{	off_t fsize = fileSize(fname.c_str());
+	if(fsize < 0) die("Could not open '%s' for reading.\n", fname.c_str());
+	if(fsize % sizeof(double)) die("Length of '%s' is not a multiple of %zu bytes.\n", fname.c_str(), sizeof(double));
+	nDoubles = fsize / sizeof(double);
+	if(!nDoubles) return;
+	if(isLittleEndian())
+	{	//Map file directly:
+		int fd = open(fname.c_str(), O_RDONLY);
+		if(fd >= 0)
+		{	void* result = mmap(0, fsize, PROT_READ, MAP_SHARED, fd, 0);
+			close(fd); //mapping remains valid
+			if(result != MAP_FAILED)
+			{	map = result;
+				mapLength = fsize;
+				ptr = (const double*)map;
+				return;
+			}
+		}
+	}
+	//Fall back to reading into memory (with endianness conversion):
+	buf.resize(nDoubles);
+	FILE* fp = fopen(fname.c_str(), "rb");
+	if(!fp) die("Could not open '%s' for reading.\n", fname.c_str());
+	if(freadLE(buf.data(), sizeof(double), nDoubles, fp) != nDoubles)
+		die("Error reading '%s'.\n", fname.c_str());
+	fclose(fp);
+	ptr = buf.data();
+}
+
+MappedFile::~MappedFile()
+{	if(map) munmap(map, mapLength);
+}
+
+//--------- Helper functions ---------
+
+//Substitute variable name into filename pattern:
+inline string substituteVar(string pattern, string varName)
+{	size_t pos = pattern.find("$VAR");
+	if(pos == string::npos) die("Filename pattern '%s' does not contain $VAR.\n", pattern.c_str());
+	return pattern.replace(pos, 4, varName);
+}
+
+//Read integer lattice coordinates from a cell map file written by writeCellMap:
+std::vector<vector3<int>> readCellMap(string fname)
+{	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp) die("Could not open cell map '%s' for reading.\n", fname.c_str());
+	std::vector<vector3<int>> cells;
+	char buf[256];
+	while(fgets(buf, sizeof(buf), fp))
+	{	if(buf[0] == '#') continue; //header
+		vector3<int> iR;
+		if(sscanf(buf, "%d %d %d", &iR[0], &iR[1], &iR[2]) == 3)
+			cells.push_back(iR);
+	}
+	fclose(fp);
+	if(!cells.size()) die("No cells found in cell map '%s'.\n", fname.c_str());
+	return cells;
+}
+
+//Index of cell iR within supercell sup (in the order used by the wannier and phonon codes):
+inline int reducedIndex(const vector3<int>& iR, const vector3<int>& sup)
+{	return (positiveRemainder(iR[0],sup[0])*sup[1] + positiveRemainder(iR[1],sup[1]))*sup[2] + positiveRemainder(iR[2],sup[2]);
+}
+
+//Element i of an array stored as real (nComp = 1) or complex (nComp = 2) numbers:
+inline complex getElement(const double* data, int nComp, size_t i)
+{	return (nComp == 1) ? complex(data[i], 0.) : complex(data[2*i], data[2*i+1]);
+}
+
+//Number of (real or complex) components per element in data file of expected length nElements, or die:
+int getComponentCount(const MappedFile& mf, size_t nElements, string fname)
+{	for(int nComp=1; nComp<=2; nComp++)
+		if(mf.size() == nComp*nElements) return nComp;
+	die("Length of '%s' is inconsistent with %zu real or complex elements.\n", fname.c_str(), nElements);
+	return 0;
+}
+
+//--------- Loading ---------
+
+WannierInterpolator::WannierInterpolator(string wannierPattern, vector3<int> kfold, string spinSuffix, double pruneThreshold)
+: wannierPattern(wannierPattern), spinSuffix(spinSuffix), nB(0), nM(0), pruneThreshold(pruneThreshold), nCompEph(0), prodPhononSup(0)
+{	//Read cell map and weights:
+	std::vector<vector3<int>> cellMap = readCellMap(substituteVar(wannierPattern, "mlwfCellMap"+spinSuffix));
+	string fnameW = substituteVar(wannierPattern, "mlwfCellWeights"+spinSuffix);
+	MappedFile weights(fnameW);
+	int nCellsIn = cellMap.size();
+	nB = int(round(sqrt(weights.size() / double(nCellsIn))));
+	int nBsq = nB*nB;
+	if(weights.size() != size_t(nCellsIn*nBsq))
+		die("Length of '%s' is inconsistent with %d cells in cell map.\n", fnameW.c_str(), nCellsIn);
+	
+	//Map reduced Hamiltonian and momenta:
+	int kfoldProd = kfold[0]*kfold[1]*kfold[2];
+	string fnameH = substituteVar(wannierPattern, "mlwfH"+spinSuffix);
+	MappedFile Hred(fnameH);
+	int nComp = getComponentCount(Hred, kfoldProd*nBsq, fnameH);
+	string fnameP = substituteVar(wannierPattern, "mlwfP"+spinSuffix);
+	std::shared_ptr<MappedFile> Pred;
+	if(fileSize(fnameP.c_str()) > 0)
+	{	Pred = std::make_shared<MappedFile>(fnameP);
+		if(Pred->size() != size_t(nComp*kfoldProd*3*nBsq))
+			die("Length of '%s' is inconsistent with '%s'.\n", fnameP.c_str(), fnameH.c_str());
+	}
+	
+	//Expand to cell map with weights folded in:
+	matrix HwAll = zeroes(nBsq, nCellsIn), PwAll;
+	if(Pred) PwAll = zeroes(3*nBsq, nCellsIn);
+	std::vector<double> cellMax(nCellsIn, 0.);
+	for(int iCell=0; iCell<nCellsIn; iCell++)
+	{	int iReduced = reducedIndex(cellMap[iCell], kfold);
+		const double* w = weights.data() + iCell*nBsq;
+		complex* HwData = HwAll.data() + iCell*nBsq;
+		for(int ab=0; ab<nBsq; ab++)
+		{	HwData[ab] = w[ab] * getElement(Hred.data(), nComp, iReduced*nBsq + ab);
+			cellMax[iCell] = std::max(cellMax[iCell], HwData[ab].abs());
+		}
+		if(Pred)
+		{	complex* PwData = PwAll.data() + iCell*3*nBsq;
+			for(int iDir=0; iDir<3; iDir++)
+				for(int ab=0; ab<nBsq; ab++)
+					PwData[iDir*nBsq+ab] = w[ab] * getElement(Pred->data(), nComp, (iReduced*3+iDir)*nBsq + ab);
+		}
+	}
+	
+	//Prune cells with negligible matrix elements:
+	double maxAll = *std::max_element(cellMax.begin(), cellMax.end());
+	std::vector<int> iCellKept;
+	for(int iCell=0; iCell<nCellsIn; iCell++)
+		if(cellMax[iCell] > pruneThreshold*maxAll)
+		{	iCellKept.push_back(iCell);
+			cells.push_back(cellMap[iCell]);
+		}
+	Hw.init(nBsq, cells.size());
+	if(Pred) Pw.init(3*nBsq, cells.size());
+	for(size_t iCell=0; iCell<cells.size(); iCell++)
+	{	Hw.set(0,nBsq, iCell,iCell+1, HwAll(0,nBsq, iCellKept[iCell],iCellKept[iCell]+1));
+		if(Pred) Pw.set(0,3*nBsq, iCell,iCell+1, PwAll(0,3*nBsq, iCellKept[iCell],iCellKept[iCell]+1));
+	}
+	logPrintf("Wannier interpolation: %d bands, %lu of %d cells retained%s.\n",
+		nB, cells.size(), nCellsIn, Pred ? ", with momenta" : "");
+}
+
+void WannierInterpolator::loadPhonon(string phononPattern, vector3<int> phononSup)
+{	//Force matrix (cell weights already included by the phonon code):
+	cellsPh = readCellMap(substituteVar(phononPattern, "phononCellMap"));
+	string fnameOmegaSq = substituteVar(phononPattern, "phononOmegaSq");
+	MappedFile omegaSq(fnameOmegaSq);
+	nM = int(round(sqrt(omegaSq.size() / double(cellsPh.size()))));
+	if(omegaSq.size() != size_t(nM*nM*cellsPh.size()) || nM % 3)
+		die("Length of '%s' is inconsistent with %lu cells in cell map.\n", fnameOmegaSq.c_str(), cellsPh.size());
+	OmegaSqW.init(nM*nM, cellsPh.size());
+	for(size_t i=0; i<omegaSq.size(); i++)
+		OmegaSqW.data()[i] = omegaSq.data()[i];
+	
+	//E-ph cell map and weights:
+	int nAtoms = nM/3;
+	cellsEph = readCellMap(substituteVar(wannierPattern, "mlwfCellMapPh"+spinSuffix));
+	string fnameWeph = substituteVar(wannierPattern, "mlwfCellWeightsPh"+spinSuffix);
+	MappedFile weights(fnameWeph);
+	if(weights.size() != cellsEph.size()*nAtoms*nB)
+		die("Length of '%s' is inconsistent with %lu cells, %d atoms and %d bands.\n", fnameWeph.c_str(), cellsEph.size(), nAtoms, nB);
+	wEph.assign(weights.data(), weights.data()+weights.size());
+	iReducedEph.clear();
+	for(const vector3<int>& iR: cellsEph)
+		iReducedEph.push_back(reducedIndex(iR, phononSup));
+	
+	//Map reduced e-ph matrix elements (too large to expand on the cell map):
+	prodPhononSup = phononSup[0]*phononSup[1]*phononSup[2];
+	string fnameHePh = substituteVar(wannierPattern, "mlwfHePh"+spinSuffix);
+	HePh = std::make_shared<MappedFile>(fnameHePh);
+	nCompEph = getComponentCount(*HePh, size_t(prodPhononSup)*prodPhononSup*nM*nB*nB, fnameHePh);
+	logPrintf("Wannier interpolation: %d phonon modes on %lu cells, e-ph matrix elements on %lu cells.\n",
+		nM, cellsPh.size(), cellsEph.size());
+}
+
+//--------- Interpolation ---------
+
+void getPhase_sub(size_t ikStart, size_t ikStop, const std::vector<vector3<int>>* cells, const std::vector<vector3<>>* k, complex* phase)
+{	size_t nCells = cells->size();
+	for(size_t ik=ikStart; ik<ikStop; ik++)
+	{	complex* phaseCur = phase + ik*nCells;
+		for(size_t iCell=0; iCell<nCells; iCell++)
+			phaseCur[iCell] = cis(2*M_PI*dot(k->at(ik), cells->at(iCell)));
+	}
+}
+matrix WannierInterpolator::getPhase(const std::vector<vector3<int>>& cells, const std::vector<vector3<>>& k)
+{	matrix phase(cells.size(), k.size());
+	threadLaunch(getPhase_sub, k.size(), &cells, &k, phase.data());
+	return phase;
+}
+
+//Diagonalize hermitian matrices stored as columns of Mk, optionally computing diagonal elements of Im(U^ P U) for 3 directions
+void diagonalize_sub(size_t ikStart, size_t ikStop, int N, const matrix* Mk, const matrix* Pk,
+	std::vector<diagMatrix>* E, std::vector<matrix>* U, std::vector<std::vector<vector3<>>>* v)
+{	int Nsq = N*N;
+	for(size_t ik=ikStart; ik<ikStop; ik++)
+	{	matrix M(N, N);
+		eblas_copy(M.data(), Mk->data()+ik*Nsq, Nsq);
+		matrix Uk;
+		dagger_symmetrize(M).diagonalize(Uk, E->at(ik));
+		if(v)
+		{	std::vector<vector3<>>& vk = v->at(ik);
+			vk.resize(N);
+			for(int iDir=0; iDir<3; iDir++)
+			{	matrix P(N, N);
+				eblas_copy(P.data(), Pk->data()+(ik*3+iDir)*Nsq, Nsq);
+				matrix UdagPU = dagger(Uk) * P * Uk;
+				for(int b=0; b<N; b++)
+					vk[b][iDir] = UdagPU(b,b).imag();
+			}
+		}
+		if(U) U->at(ik) = Uk;
+	}
+}
+
+void WannierInterpolator::eigen(const std::vector<vector3<>>& k, std::vector<diagMatrix>& E,
+	std::vector<matrix>* U, std::vector<std::vector<vector3<>>>* v) const
+{	static StopWatch watch("WannierInterpolator::eigen"); watch.start();
+	if(v && !hasMomenta()) die("Velocities require momenta (mlwfP) in Wannier interpolation.\n");
+	matrix phase = getPhase(cells, k);
+	matrix Hk = Hw * phase; //all cells and k-points in one GEMM
+	matrix Pk; if(v) Pk = Pw * phase;
+	E.resize(k.size());
+	if(U) U->resize(k.size());
+	if(v) v->resize(k.size());
+	threadLaunch(diagonalize_sub, k.size(), nB, &Hk, v ? &Pk : 0, &E, U, v);
+	watch.stop();
+}
+
+void WannierInterpolator::phonon(const std::vector<vector3<>>& q, std::vector<diagMatrix>& omega, std::vector<matrix>* U) const
+{	static StopWatch watch("WannierInterpolator::phonon"); watch.start();
+	assert(hasPhonon());
+	matrix OmegaSqq = OmegaSqW * getPhase(cellsPh, q);
+	omega.resize(q.size());
+	if(U) U->resize(q.size());
+	threadLaunch(diagonalize_sub, q.size(), nM, &OmegaSqq, (const matrix*)0, &omega, U, (std::vector<std::vector<vector3<>>>*)0);
+	for(diagMatrix& omegaCur: omega)
+		for(double& o: omegaCur)
+			o = sqrt(std::max(o, 0.)); //eigenvalues were omega^2
+	watch.stop();
+}
+
+//Sum of e-ph cell weights over cells equivalent within the phonon supercell, with phases cis(sign 2 pi k.R): result[j][atom][b]
+struct EphWeightFolder
+{	const std::vector<vector3<int>>& cells;
+	const std::vector<int>& iReduced;
+	const std::vector<double>& w; //[cell][b][atom]
+	int prodSup, nAtoms, nB;
+	
+	void operator()(const vector3<>& k, int sign, complex* result) const
+	{	std::fill(result, result + prodSup*nAtoms*nB, complex(0.,0.));
+		const double* wCur = w.data();
+		for(size_t iCell=0; iCell<cells.size(); iCell++)
+		{	complex phase = cis(sign*2*M_PI*dot(k, cells[iCell]));
+			complex* resultCur = result + iReduced[iCell]*nAtoms*nB;
+			for(int b=0; b<nB; b++)
+				for(int atom=0; atom<nAtoms; atom++)
+					resultCur[atom*nB+b] += phase * (*(wCur++));
+		}
+	}
+};
+
+//Fourier transform e-ph matrix elements over first cell, for each reduced second cell j2 in [j2start, j2stop)
+void ephFirstCell_sub(size_t j2start, size_t j2stop, int prodSup, int nM, int nB, const complex* C1, const double* HePh, int nComp, complex* B)
+{	int nAtoms = nM/3, nBsq = nB*nB;
+	size_t blockSize = nM*nBsq; //data per pair of reduced cells
+	for(size_t j2=j2start; j2<j2stop; j2++)
+	{	complex* Bj2 = B + j2*blockSize;
+		for(int j1=0; j1<prodSup; j1++)
+		{	size_t offset = (j1*prodSup + j2)*blockSize;
+			for(int x=0; x<nM; x++)
+			{	const complex* c = C1 + (j1*nAtoms + x/3)*nB; //folded weights and phases for atom of mode x
+				for(int b=0; b<nB; b++)
+					for(int a=0; a<nB; a++)
+					{	size_t i = x*nBsq + b*nB + a;
+						Bj2[i] += c[a] * getElement(HePh, nComp, offset + i);
+					}
+			}
+		}
+	}
+}
+
+//Fourier transform over second cell for each k2 in [ik2start, ik2stop)
+void ephSecondCell_sub(size_t ik2start, size_t ik2stop, const EphWeightFolder* fold, const std::vector<vector3<>>* k2,
+	int nM, const complex* B, std::vector<matrix>* g)
+{	int prodSup = fold->prodSup, nAtoms = fold->nAtoms, nB = fold->nB, nBsq = nB*nB;
+	std::vector<complex> D(prodSup*nAtoms*nB);
+	for(size_t ik2=ik2start; ik2<ik2stop; ik2++)
+	{	(*fold)(k2->at(ik2), +1, D.data());
+		matrix& gCur = g->at(ik2);
+		gCur = zeroes(nBsq, nM);
+		complex* gData = gCur.data();
+		for(int j2=0; j2<prodSup; j2++)
+			for(int x=0; x<nM; x++)
+			{	const complex* d = D.data() + (j2*nAtoms + x/3)*nB;
+				const complex* Bx = B + (j2*nM + x)*nBsq;
+				complex* gx = gData + x*nBsq;
+				for(int b=0; b<nB; b++)
+					for(int a=0; a<nB; a++)
+						gx[b*nB+a] += d[b] * Bx[b*nB+a];
+			}
+	}
+}
+
+void WannierInterpolator::ephWannier(const vector3<>& k1, const std::vector<vector3<>>& k2, std::vector<matrix>& g) const
+{	static StopWatch watch("WannierInterpolator::ephWannier"); watch.start();
+	assert(hasPhonon());
+	EphWeightFolder fold{cellsEph, iReducedEph, wEph, prodPhononSup, nM/3, nB};
+	//Fourier transform over first cell, working with reduced cells and folded weights:
+	std::vector<complex> C1(prodPhononSup*fold.nAtoms*nB);
+	fold(k1, -1, C1.data());
+	std::vector<complex> B(size_t(prodPhononSup)*nM*nB*nB, complex(0.,0.));
+	threadLaunch(ephFirstCell_sub, prodPhononSup, prodPhononSup, nM, nB, (const complex*)C1.data(), HePh->data(), nCompEph, B.data());
+	//Fourier transform over second cell for each k2:
+	g.resize(k2.size());
+	threadLaunch(ephSecondCell_sub, k2.size(), (const EphWeightFolder*)&fold, &k2, nM, (const complex*)B.data(), &g);
+	watch.stop();
+}
+
+//Rotate e-ph matrix elements to electronic and phonon eigenbases
+void ephRotate_sub(size_t ik2start, size_t ik2stop, int nB, int nM, const std::vector<matrix>* gWannier, const matrix* U1,
+	const std::vector<matrix>* U2, const std::vector<diagMatrix>* omegaPh, const std::vector<matrix>* Uph, std::vector<std::vector<matrix>>* g)
+{	int nBsq = nB*nB;
+	for(size_t ik2=ik2start; ik2<ik2stop; ik2++)
+	{	matrix gModes = gWannier->at(ik2) * Uph->at(ik2); //phonon eigenbasis
+		std::vector<matrix>& gCur = g->at(ik2);
+		gCur.resize(nM);
+		for(int iMode=0; iMode<nM; iMode++)
+		{	matrix gMode(nB, nB);
+			eblas_copy(gMode.data(), gModes.data()+iMode*nBsq, nBsq);
+			double normFac = sqrt(0.5/std::max(omegaPh->at(ik2)[iMode], 1e-6)); //phonon amplitude factor
+			gCur[iMode] = normFac * (dagger(*U1) * gMode * U2->at(ik2));
+		}
+	}
+}
+
+void WannierInterpolator::eph(const vector3<>& k1, const std::vector<vector3<>>& k2,
+	std::vector<std::vector<matrix>>& g, std::vector<diagMatrix>* omegaPh) const
+{	//Electrons:
+	std::vector<diagMatrix> E1, E2;
+	std::vector<matrix> U1, U2;
+	eigen(std::vector<vector3<>>(1, k1), E1, &U1);
+	eigen(k2, E2, &U2);
+	//Phonons:
+	std::vector<vector3<>> q(k2.size());
+	for(size_t ik2=0; ik2<k2.size(); ik2++)
+		q[ik2] = k1 - k2[ik2];
+	std::vector<diagMatrix> omega;
+	std::vector<matrix> Uph;
+	phonon(q, omega, &Uph);
+	//E-ph matrix elements:
+	std::vector<matrix> gWannier;
+	ephWannier(k1, k2, gWannier);
+	g.resize(k2.size());
+	threadLaunch(ephRotate_sub, k2.size(), nB, nM, (const std::vector<matrix>*)&gWannier, (const matrix*)&U1[0],
+		(const std::vector<matrix>*)&U2, (const std::vector<diagMatrix>*)&omega, (const std::vector<matrix>*)&Uph, &g);
+	if(omegaPh) std::swap(*omegaPh, omega);
+}
@@ -0,0 +1,108 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_WANNIERINTERPOLATOR_H
+#define JDFTX_ELECTRONIC_WANNIERINTERPOLATOR_H
+
+#include <core/matrix.h>
+#include <memory>
+
+//! @addtogroup Output
+//! @{
+//! @file WannierInterpolator.h Fast interpolation of Wannier-basis matrix elements to arbitrary k-points
+
+//! Read-only view of a binary file of doubles, memory-mapped when possible
+class MappedFile
+{
+public:
+	MappedFile(string fname); //!< map (or read, on big-endian systems) entire file; dies on failure
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete; //!< non-copyable: would double-unmap
+	MappedFile& operator=(const MappedFile&) = delete; //!< non-copyable: would double-unmap
+	const double* data() const { return ptr; } //!< file contents
+	size_t size() const { return nDoubles; } //!< number of doubles in file
+private:
+	const double* ptr;
+	size_t nDoubles;
+	void* map; size_t mapLength; //!< mmap region (if mapped)
+	std::vector<double> buf; //!< file contents (if not mapped)
+};
+
+/**
+Interpolate the real-space Wannier matrix elements output by the wannier code (mlwfH, mlwfP
+and optionally mlwfHePh along with the phonon code's force matrix) to arbitrary wave-vectors.
+Cell weights are folded in once on loading; thereafter each batch of k-points costs one
+phase-matrix construction and a single GEMM against all cells, followed by threaded
+diagonalization. Cells whose weighted matrix elements are all below pruneThreshold
+(relative to the largest element) are dropped from the Fourier sums.
+All wave-vectors are in reciprocal lattice coordinates.
+*/
+class WannierInterpolator
+{
+public:
+	//! Load electronic outputs from files matching wannierPattern (containing $VAR) for k-point folding kfold.
+	//! spinSuffix must be "Up" or "Dn" for z-spin calculations, and empty otherwise.
+	WannierInterpolator(string wannierPattern, vector3<int> kfold, string spinSuffix=string(), double pruneThreshold=0.);
+	
+	//! Additionally load phonons from files matching phononPattern and e-ph matrix elements for phonon supercell phononSup
+	void loadPhonon(string phononPattern, vector3<int> phononSup);
+	
+	int nBands() const { return nB; } //!< number of Wannier bands
+	int nModes() const { return nM; } //!< number of phonon modes (0 if phonons not loaded)
+	bool hasMomenta() const { return Pw.nData(); } //!< whether momenta (and hence velocities) are available
+	bool hasPhonon() const { return nM; } //!< whether phonons and e-ph matrix elements are available
+	size_t nCells() const { return cells.size(); } //!< number of cells retained in electronic Fourier sums
+	
+	//! Energies for a batch of k, along with optional eigenvectors (in Wannier basis) and band velocities
+	void eigen(const std::vector<vector3<>>& k, std::vector<diagMatrix>& E,
+		std::vector<matrix>* U=0, std::vector<std::vector<vector3<>>>* v=0) const;
+	
+	//! Phonon frequencies for a batch of q, along with optional eigenvectors (in Cartesian-displacement basis)
+	void phonon(const std::vector<vector3<>>& q, std::vector<diagMatrix>& omega, std::vector<matrix>* U=0) const;
+	
+	//! E-ph matrix elements between fixed k1 and a batch of k2 in the Wannier and Cartesian-displacement bases.
+	//! Each output is nBands^2 x nModes, with band indices at k1 and k2 as the inner and outer parts of the row index.
+	void ephWannier(const vector3<>& k1, const std::vector<vector3<>>& k2, std::vector<matrix>& g) const;
+	
+	//! E-ph matrix elements g[ik2][mode] (nBands x nBands, rows at k1, columns at k2) in the electronic eigenbasis
+	//! and phonon eigenbasis at q = k1 - k2, including the 1/sqrt(2 omega) amplitude factor. Optionally return phonon frequencies.
+	void eph(const vector3<>& k1, const std::vector<vector3<>>& k2,
+		std::vector<std::vector<matrix>>& g, std::vector<diagMatrix>* omegaPh=0) const;
+
+private:
+	string wannierPattern, spinSuffix;
+	int nB, nM; //number of bands and modes
+	double pruneThreshold;
+	std::vector<vector3<int>> cells; //cells retained in electronic Fourier sums
+	matrix Hw, Pw; //weighted Hamiltonian (nB^2 x nCells) and momenta (3 nB^2 x nCells)
+	std::vector<vector3<int>> cellsPh; //phonon force-matrix cells
+	matrix OmegaSqW; //phonon force matrix (nModes^2 x nCellsPh)
+	//E-ph matrix elements, kept in reduced (supercell) form with weights folded into phases:
+	std::shared_ptr<MappedFile> HePh; //reduced e-ph matrix elements [j1][j2][mode][b2][b1]
+	int nCompEph; //1 if HePh is real, 2 if complex
+	int prodPhononSup;
+	std::vector<vector3<int>> cellsEph; //e-ph cell map
+	std::vector<int> iReducedEph; //index of each entry of cellsEph within phonon supercell
+	std::vector<double> wEph; //e-ph cell weights [cell][band][atom]
+	
+	static matrix getPhase(const std::vector<vector3<int>>& cells, const std::vector<vector3<>>& k); //cis(2 pi k.R) (nCells x nk)
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_WANNIERINTERPOLATOR_H
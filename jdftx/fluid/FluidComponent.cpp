@@ -588,6 +588,7 @@ void FluidComponent::addToFluidMixture(FluidMixture* fluidMixture)
 		{	case LinearSpline: trans = std::make_shared<TranslationOperatorSpline>(gInfo, TranslationOperatorSpline::Linear); break;
 			case ConstantSpline: trans = std::make_shared<TranslationOperatorSpline>(gInfo, TranslationOperatorSpline::Constant); break;
 			case Fourier: trans = std::make_shared<TranslationOperatorFourier>(gInfo); break;
+			case FourierCached: trans = std::make_shared<TranslationOperatorFourier>(gInfo, true); break;
 		}
 		switch(representation)
 		{	case PsiAlpha: idealGas = std::make_shared<IdealGasPsiAlpha>(fluidMixture, this, *quad, *trans); break;
@@ -103,7 +103,8 @@ struct FluidComponent
 	enum TranslationMode
 	{	ConstantSpline,
 		LinearSpline, //!< default and recommended
-		Fourier
+		Fourier,
+		FourierCached //!< Fourier with phase kernels cached across iterations (faster, but more memory)
 	}
 	translationMode; //!< type of translation operator used for sampling rigid molecule geometry
 	
@@ -271,6 +271,38 @@ double FluidMixture::sync(double x) const
 	return x;
 }
 
+double FluidMixture::minimizeMultigrid(const MinimizeParams& mp, const std::vector<double>& levels, const CoarseMixtureBuilder& createCoarse)
+{	assert(state.size());
+	std::vector<double> fractions(levels);
+	std::sort(fractions.begin(), fractions.end()); //coarsest first
+	for(double fraction: fractions)
+	{	//Setup coarse grid with same lattice and FFT-suitable sample counts:
+		GridInfo gInfoCoarse;
+		gInfoCoarse.R = gInfo.R;
+		for(int k=0; k<3; k++)
+		{	int& Sk = gInfoCoarse.S[k];
+			Sk = std::max(2, int(round(fraction * gInfo.S[k])));
+			while(!fftSuitable(Sk)) Sk++;
+			Sk = std::min(Sk, gInfo.S[k]);
+		}
+		if(gInfoCoarse.S == gInfo.S) continue; //level would be no coarser than this grid
+		gInfoCoarse.initialize(true);
+		logPrintf("\n---- Fluid multigrid level with sample counts %d x %d x %d ----\n", gInfoCoarse.S[0], gInfoCoarse.S[1], gInfoCoarse.S[2]);
+		//Solve on coarse grid starting from current state:
+		std::shared_ptr<FluidMixture> coarse = createCoarse(gInfoCoarse);
+		assert(coarse->get_nIndep() == get_nIndep());
+		coarse->state.resize(state.size());
+		for(unsigned i=0; i<state.size(); i++)
+			coarse->state[i] = changeGrid(state[i], gInfoCoarse);
+		coarse->minimize(mp);
+		//Interpolate solution back to this grid:
+		for(unsigned i=0; i<state.size(); i++)
+			state[i] = changeGrid(coarse->state[i], gInfo);
+	}
+	logPrintf("\n---- Fluid multigrid final level with sample counts %d x %d x %d ----\n", gInfo.S[0], gInfo.S[1], gInfo.S[2]);
+	return minimize(mp);
+}
+
 double FluidMixture::compute_p(double Ntot) const
 {	std::vector<double> Nmol(component.size()), Phi_Nmol(component.size());
 	double Nguess=0.;
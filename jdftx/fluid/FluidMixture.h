@@ -25,6 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Units.h>
 #include <core/Minimize.h>
 #include <core/EnergyComponents.h>
+#include <functional>
 
 //! @addtogroup ClassicalDFT
 //! @{
@@ -114,6 +115,18 @@ public:
 	
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
 	
+	//! Create an equivalent (initialized, with rhoExternal and couplings set) fluid mixture on a coarser grid
+	typedef std::function<std::shared_ptr<FluidMixture>(const GridInfo& gInfoCoarse)> CoarseMixtureBuilder;
+	
+	//! @brief Coarse-to-fine minimization: warm-start the minimize on this grid using solutions on coarser grids
+	//! @param mp Minimization parameters used at each level
+	//! @param levels Fractions (in (0,1)) of the sample counts of this grid for each coarse level, solved coarsest first
+	//! @param createCoarse Constructs the equivalent mixture on each coarse grid
+	//! The current state (which must be set) is the initial guess for the coarsest level, and each level's solution
+	//! is Fourier-interpolated with changeGrid() to form the initial guess of the next finer level
+	//! @return Free energy at the end of the final minimize on this grid
+	double minimizeMultigrid(const MinimizeParams& mp, const std::vector<double>& levels, const CoarseMixtureBuilder& createCoarse);
+	
 private:
 	unsigned nIndepIdgas; //!< number of scalar fields used as independent variables for the component ideal gases
 	unsigned nDensities; //!< total number of site densities
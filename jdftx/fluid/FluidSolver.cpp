@@ -59,6 +59,52 @@ private:
 	const Everything& e;
 };
 
+//Equivalent fluid mixture on a coarser grid, which owns its components, mixing functionals and couplings
+//(used for coarse-to-fine warm starts of ConvolutionJDFT, see FluidMixture::minimizeMultigrid)
+class FluidMixtureCoarse : public FluidMixture
+{
+public:
+	FluidMixtureCoarse(const GridInfo& gInfoCoarse, const FluidSolverParams& fsp, double epsBulk, double epsInf)
+	: FluidMixture(gInfoCoarse, fsp.T)
+	{	verboseLog = fsp.verboseLog;
+		//Copy the components, with grid-dependent members recreated on the coarse grid
+		//(copying the molecule copies only site properties, so that addToFluidMixture sets up its kernels afresh):
+		for(const auto& cFine: fsp.components)
+		{	auto c = std::make_shared<FluidComponent>(*cFine);
+			assert(!c->molecule);
+			c->quad = 0;
+			c->trans = 0;
+			c->idealGas = 0;
+			c->fex = 0;
+			c->addToFluidMixture(this);
+			components.push_back(c);
+		}
+		//Mixing functionals between corresponding coarse components:
+		for(const auto& f: fsp.FmixList)
+		{	auto c1 = coarseComponent(fsp, f.fluid1);
+			auto c2 = coarseComponent(fsp, f.fluid2);
+			if(f.FmixType == GaussianKernel)
+				FmixPtr.push_back(std::make_shared<Fmix_GaussianKernel>(this, c1, c2, f.energyScale, f.lengthScale));
+			else if(f.FmixType == LJPotential)
+				FmixPtr.push_back(std::make_shared<Fmix_LJ>(this, c1, c2, f.energyScale, f.lengthScale));
+		}
+		initialize(fsp.P, epsBulk, epsInf);
+	}
+	
+	std::vector<std::shared_ptr<FluidComponent>> components;
+	std::vector<std::shared_ptr<Fmix>> FmixPtr;
+	std::shared_ptr<ConvCoupling> coupling;
+	std::shared_ptr<VDWCoupling> vdwCoupling;
+
+private:
+	std::shared_ptr<FluidComponent> coarseComponent(const FluidSolverParams& fsp, const std::shared_ptr<FluidComponent>& cFine) const
+	{	auto iter = std::find(fsp.components.begin(), fsp.components.end(), cFine);
+		if(iter == fsp.components.end())
+			die("Mixing functional component not found in fluid component list.\n");
+		return components[iter - fsp.components.begin()];
+	}
+};
+
 
 class ConvolutionJDFT : public FluidSolver
 {
@@ -70,10 +116,12 @@ class ConvolutionJDFT : public FluidSolver
 	EnergyComponents Adiel; //fluid free energy components
 	ScalarFieldTilde Adiel_rhoExplicitTilde; //cached gradient of free energy of fluidMixture wrt rhoExplicit
 	ScalarFieldTildeArray Ntilde; //cached densities of fluid
+	ScalarFieldTilde nCavityTilde; //cached cavity density (to set up coarse-grid couplings)
+	bool multigridPending; //whether next minimize should warm start on coarse grids (only for a fresh initial state)
 
 public:
 	ConvolutionJDFT(const Everything& e, const FluidSolverParams& fsp)
-	: FluidSolver(e, fsp), Adiel_rhoExplicitTilde(0)
+	: FluidSolver(e, fsp), Adiel_rhoExplicitTilde(0), multigridPending(false)
 	{
 		//Initialize fluid mixture:
 		fluidMixture = new FluidMixtureJDFT(e, gInfo, fsp.T);
@@ -219,9 +267,13 @@ public:
 	{	
 		//Set nCavity for nonlinear coupling functional
 		coupling->setExplicit(nCavityTilde);
+		this->nCavityTilde = nCavityTilde;
 		//set rhoExplicit for electrostatic coupling
 		fluidMixture->rhoExternal = rhoExplicitTilde;
-		if(!fluidMixture->state.size()) fluidMixture->initState(0.15, -3*fsp.T);
+		if(!fluidMixture->state.size())
+		{	fluidMixture->initState(0.15, -3*fsp.T);
+			multigridPending = fsp.multigridLevels.size();
+		}
 		if(!Adiel_rhoExplicitTilde) updateCached();
 	}
 	
@@ -237,11 +289,29 @@ public:
 
 	void minimizeFluid()
 	{	TIME("Fluid minimize", globalLog,
-			fluidMixture->minimize(e.fluidMinParams);
+			if(multigridPending)
+			{	fluidMixture->minimizeMultigrid(e.fluidMinParams, fsp.multigridLevels,
+					[this](const GridInfo& gInfoCoarse) { return createCoarse(gInfoCoarse); });
+				multigridPending = false;
+			}
+			else fluidMixture->minimize(e.fluidMinParams);
 			updateCached();
 		)
 	}
 	
+	//Create equivalent fluid mixture with couplings and external densities on a coarser grid
+	std::shared_ptr<FluidMixture> createCoarse(const GridInfo& gInfoCoarse) const
+	{	auto fm = std::make_shared<FluidMixtureCoarse>(gInfoCoarse, fsp, epsBulk, epsInf);
+		fm->coupling = std::make_shared<ConvCoupling>(fm.get(), fsp.exCorr);
+		fm->coupling->setExplicit(changeGrid(nCavityTilde, gInfoCoarse));
+		fm->vdwCoupling = std::make_shared<VDWCoupling>(fm.get(), atpos, e.vanDerWaals,
+			e.vanDerWaals->getScaleFactor(fsp.exCorr.getName(), fsp.vdwScale));
+		if(fluidMixture->rhoExternal) fm->rhoExternal = changeGrid(fluidMixture->rhoExternal, gInfoCoarse);
+		fm->Eexternal = fluidMixture->Eexternal;
+		fm->useMFKernel = fluidMixture->useMFKernel;
+		return fm;
+	}
+	
 	double get_Adiel_and_grad_internal(ScalarFieldTilde& Adiel_rhoExplicitTilde, ScalarFieldTilde& Adiel_nCavityTilde, IonicGradient* extraForces, matrix3<>* Adiel_RRT) const
 	{
 		if(Adiel_RRT) die("Stress not yet implemented in ClassicalDFT fluid.\n")
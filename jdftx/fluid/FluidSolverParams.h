@@ -156,6 +156,7 @@ struct FluidSolverParams
 	//For Explicit Fluid JDFT alone:
 	ExCorr exCorr; //!< Fluid exchange-correlation and kinetic energy functional
         std::vector<FmixParams> FmixList; //!< Tabulates which components interact through an additional Fmix
+	std::vector<double> multigridLevels; //!< Coarse grid sample-count fractions for warm-starting the fluid minimize (disabled if empty)
 
 	string initWarnings; //!< warnings emitted during parameter initialization, if any
 	
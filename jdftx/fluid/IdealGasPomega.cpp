@@ -19,6 +19,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fluid/IdealGasPomega.h>
 #include <fluid/Euler.h>
+#include <core/Thread.h>
+#include <algorithm>
 
 IdealGasPomega::IdealGasPomega(const FluidMixture* fluidMixture, const FluidComponent* comp, const SO3quad& quad, const TranslationOperator& trans, unsigned nIndepOverride)
 : IdealGas(nIndepOverride ? nIndepOverride : quad.nOrientations(), fluidMixture, comp), quad(quad), trans(trans), pMol(molecule.getDipole())
@@ -43,21 +45,102 @@ void IdealGasPomega::convertGradients_o(int o, const matrix3<>& rot, const Scala
 }
 
 
-void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, double scale, double Elo, double Ehi) const
-{	for(int k=0; k<nIndep; k++) indep[k]=0;
-	ScalarFieldArray Veff(molecule.sites.size()); nullToZero(Veff, gInfo);
-	for(unsigned i=0; i<molecule.sites.size(); i++)
-	{	Veff[i] += V[i];
-		Veff[i] += Vex[i];
+//---------- Thread-parallel orientation engine ----------
+
+//Size of packed MPI reduction buffers (fields are batched up to this many bytes per message)
+static const size_t allReduceBatchBytes = size_t(64)<<20;
+
+int IdealGasPomega::nOrientationThreads() const
+{
+	#ifdef GPU_ENABLED
+	return 1; //operators are already parallel on the GPU, and must be called from one thread
+	#else
+	return std::max(1, std::min(oStop-oStart, nOperatorThreads()));
+	#endif
+}
+
+void IdealGasPomega::orientationBlock(int iThread, int nThreads, int& oBegin, int& oEnd) const
+{	oBegin = oStart + (iThread*(oStop-oStart))/nThreads;
+	oEnd = oStart + ((iThread+1)*(oStop-oStart))/nThreads;
+}
+
+//Sum per-thread field accumulators into out (null accumulators are skipped)
+inline void sumThreadFields(std::vector<ScalarFieldArray>& accum, ScalarField* out, int nFields)
+{	for(int k=0; k<nFields; k++)
+		for(ScalarFieldArray& a: accum)
+			if(a[k])
+			{	if(out[k]) out[k] += a[k];
+				else out[k] = a[k];
+			}
+}
+
+void IdealGasPomega::allReduceFields(const std::vector<ScalarField*>& fields, std::vector<double>* scalars) const
+{	for(ScalarField* x: fields) nullToZero(*x, gInfo);
+	if(mpiWorld->nProcesses() == 1) return;
+	const size_t nr = gInfo.nr;
+	const size_t batchMax = std::max(size_t(1), allReduceBatchBytes/(nr*sizeof(double)));
+	size_t nFields = fields.size(), iStart = 0;
+	std::vector<double> buf;
+	do
+	{	size_t iStop = std::min(nFields, iStart+batchMax);
+		bool last = (iStop == nFields);
+		size_t nScalars = (last && scalars) ? scalars->size() : 0;
+		buf.resize((iStop-iStart)*nr + nScalars);
+		//Pack:
+		double* bufPtr = buf.data();
+		for(size_t i=iStart; i<iStop; i++) { eblas_copy(bufPtr, (*fields[i])->data(), nr); bufPtr += nr; }
+		if(nScalars) eblas_copy(bufPtr, scalars->data(), nScalars);
+		//Reduce and unpack:
+		mpiWorld->allReduceData(buf, MPIUtil::ReduceSum);
+		bufPtr = buf.data();
+		for(size_t i=iStart; i<iStop; i++) { eblas_copy((*fields[i])->data(), bufPtr, nr); bufPtr += nr; }
+		if(nScalars) eblas_copy(scalars->data(), bufPtr, nScalars);
+		iStart = iStop;
+	}
+	while(iStart < nFields);
+}
+
+void IdealGasPomega::initState_sub(size_t iStart, size_t iStop, int nThreads, const IdealGasPomega* ig,
+	const TranslationSources* Veff, ScalarFieldArray* indepT, double scale, double Elo, double Ehi, double* EminT, double* EmaxT, double* EmeanT)
+{	for(size_t iThread=iStart; iThread<iStop; iThread++)
+	{	int oBegin, oEnd; ig->orientationBlock(iThread, nThreads, oBegin, oEnd);
+		ig->initState_block(oBegin, oEnd, *Veff, &indepT[iThread][0], scale, Elo, Ehi, EminT[iThread], EmaxT[iThread], EmeanT[iThread]);
+	}
+}
+
+void IdealGasPomega::getDensities_sub(size_t iStart, size_t iStop, int nThreads, const IdealGasPomega* ig,
+	const ScalarField* indep, ScalarFieldArray* NT, VectorField* PT, double* ST)
+{	for(size_t iThread=iStart; iThread<iStop; iThread++)
+	{	int oBegin, oEnd; ig->orientationBlock(iThread, nThreads, oBegin, oEnd);
+		ig->getDensities_block(oBegin, oEnd, indep, &NT[iThread][0], PT[iThread], ST[iThread]);
 	}
-	double Emin=+DBL_MAX, Emax=-DBL_MAX, Emean=0.0;
-	for(int o=oStart; o<oStop; o++)
+}
+
+void IdealGasPomega::convertGradients_sub(size_t iStart, size_t iStop, int nThreads, const IdealGasPomega* ig,
+	const ScalarField* indep, const TranslationSources* Phi_N, const vector3<>* Phi_P0, ScalarFieldArray* Phi_indepT, double Nscale)
+{	for(size_t iThread=iStart; iThread<iStop; iThread++)
+	{	int oBegin, oEnd; ig->orientationBlock(iThread, nThreads, oBegin, oEnd);
+		ig->convertGradients_block(oBegin, oEnd, indep, *Phi_N, *Phi_P0, &Phi_indepT[iThread][0], Nscale);
+	}
+}
+
+//---------- Orientation loops ----------
+
+std::vector<std::vector<vector3<>>> IdealGasPomega::siteTranslations(const matrix3<>& rot, double sign) const
+{	std::vector<std::vector<vector3<>>> tArr(molecule.sites.size());
+	for(unsigned i=0; i<molecule.sites.size(); i++)
+		for(const vector3<>& pos: molecule.sites[i]->positions)
+			tArr[i].push_back(sign * (rot*pos));
+	return tArr;
+}
+
+void IdealGasPomega::initState_block(int oBegin, int oEnd, const TranslationSources& Veff, ScalarField* indep,
+	double scale, double Elo, double Ehi, double& Emin, double& Emax, double& Emean) const
+{	for(int o=oBegin; o<oEnd; o++)
 	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
 		ScalarField Emolecule;
 		//Sum the potentials collected over sites for each orientation:
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(-(rot*pos), 1., Veff[i], Emolecule);
+		trans.taxpyGather(siteTranslations(rot, -1.), 1., Veff, Emolecule);
 		//Accumulate stats and cap:
 		Emean += quad.weight(o) * sum(Emolecule)/gInfo.nr;
 		double Emin_o, Emax_o;
@@ -67,42 +150,77 @@ void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, doubl
 		//Set contributions to the state (with appropriate scale factor):
 		initState_o(o, rot, scale, Emolecule, indep);
 	}
-	//MPI collect:
-	for(int k=0; k<nIndep; k++)
-	{	nullToZero(indep[k],gInfo);
-		indep[k]->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+}
+
+void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, double scale, double Elo, double Ehi) const
+{	for(int k=0; k<nIndep; k++) indep[k]=0;
+	ScalarFieldArray Veff(molecule.sites.size()); nullToZero(Veff, gInfo);
+	for(unsigned i=0; i<molecule.sites.size(); i++)
+	{	Veff[i] += V[i];
+		Veff[i] += Vex[i];
 	}
+	//Loop over orientations, in parallel over threads:
+	int nThreads = nOrientationThreads();
+	std::vector<ScalarFieldArray> indepT(nThreads, ScalarFieldArray(nIndep));
+	std::vector<double> EminT(nThreads, +DBL_MAX), EmaxT(nThreads, -DBL_MAX), EmeanT(nThreads, 0.);
+	TranslationSources VeffSources = trans.prepareSources(Veff.data(), Veff.size());
+	threadLaunch(nThreads, initState_sub, nThreads, nThreads, this, &VeffSources, indepT.data(), scale, Elo, Ehi, EminT.data(), EmaxT.data(), EmeanT.data());
+	sumThreadFields(indepT, indep, nIndep);
+	double Emin = *std::min_element(EminT.begin(), EminT.end());
+	double Emax = *std::max_element(EmaxT.begin(), EmaxT.end());
+	double Emean = 0.; for(double EmeanThread: EmeanT) Emean += EmeanThread;
+	//MPI collect:
+	std::vector<ScalarField*> fields(nIndep);
+	for(int k=0; k<nIndep; k++) fields[k] = &indep[k];
+	std::vector<double> scalars(1, Emean);
+	allReduceFields(fields, &scalars);
+	Emean = scalars[0];
 	mpiWorld->allReduce(Emin, MPIUtil::ReduceMin);
 	mpiWorld->allReduce(Emax, MPIUtil::ReduceMax);
-	mpiWorld->allReduce(Emean, MPIUtil::ReduceSum);
 	//Print stats:
 	logPrintf("\tIdealGas%s[%s] single molecule energy: min = %le, max = %le, mean = %le\n",
 		   representationName().c_str(), molecule.name.c_str(), Emin, Emax, Emean);
 }
 
-void IdealGasPomega::getDensities(const ScalarField* indep, ScalarField* N, vector3<>& P0) const
-{	for(unsigned i=0; i<molecule.sites.size(); i++) N[i]=0;
-	double& S = ((IdealGasPomega*)this)->S;
-	S=0.0;
-	VectorField P;
-	//Loop over orientations:
-	for(int o=oStart; o<oStop; o++)
+void IdealGasPomega::getDensities_block(int oBegin, int oEnd, const ScalarField* indep, ScalarField* N, VectorField& P, double& Sblock) const
+{	for(int o=oBegin; o<oEnd; o++)
 	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
 		ScalarField logPomega_o; getDensities_o(o, rot, indep,logPomega_o);
 		ScalarField N_o = (quad.weight(o) * Nbulk) * exp(logPomega_o); //contribution form this orientation
 		//Accumulate N_o to each site density with appropriate translations:
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(rot*pos, 1., N_o, N[i]);
+		trans.taxpyScatter(siteTranslations(rot, +1.), 1., N_o, N);
 		//Accumulate contributions to the entropy:
-		S += gInfo.dV*dot(N_o, logPomega_o);
+		Sblock += gInfo.dV*dot(N_o, logPomega_o);
 		//Accumulate the polarization density:
 		if(pMol.length_squared()) P += (rot * pMol) * N_o;
 	}
-	//MPI collect:
-	for(unsigned i=0; i<molecule.sites.size(); i++) { nullToZero(N[i],gInfo); N[i]->allReduceData(mpiWorld, MPIUtil::ReduceSum); }
-	mpiWorld->allReduce(S, MPIUtil::ReduceSum);
-	if(pMol.length_squared()) for(int k=0; k<3; k++) { nullToZero(P[k],gInfo); P[k]->allReduceData(mpiWorld, MPIUtil::ReduceSum); }
+}
+
+void IdealGasPomega::getDensities(const ScalarField* indep, ScalarField* N, vector3<>& P0) const
+{	unsigned nSites = molecule.sites.size();
+	for(unsigned i=0; i<nSites; i++) N[i]=0;
+	VectorField P;
+	//Loop over orientations, in parallel over threads:
+	int nThreads = nOrientationThreads();
+	std::vector<ScalarFieldArray> NT(nThreads, ScalarFieldArray(nSites));
+	std::vector<VectorField> PT(nThreads);
+	std::vector<double> ST(nThreads, 0.);
+	threadLaunch(nThreads, getDensities_sub, nThreads, nThreads, this, indep, NT.data(), PT.data(), ST.data());
+	sumThreadFields(NT, N, nSites);
+	for(VectorField& PThread: PT)
+		for(int k=0; k<3; k++)
+			if(PThread[k])
+			{	if(P[k]) P[k] += PThread[k];
+				else P[k] = PThread[k];
+			}
+	std::vector<double> scalars(1, 0.);
+	for(double SThread: ST) scalars[0] += SThread;
+	//MPI collect (all site densities, polarization and entropy together):
+	std::vector<ScalarField*> fields;
+	for(unsigned i=0; i<nSites; i++) fields.push_back(&N[i]);
+	if(pMol.length_squared()) for(int k=0; k<3; k++) fields.push_back(&P[k]);
+	allReduceFields(fields, &scalars);
+	((IdealGasPomega*)this)->S = scalars[0];
 	//Compute and cache dipole correlation correction:
 	IdealGasPomega* cache = ((IdealGasPomega*)this);
 	if(pMol.length_squared())
@@ -135,18 +253,14 @@ double IdealGasPomega::compute(const ScalarField* indep, const ScalarField* N, S
 	return PhiNI;
 }
 
-void IdealGasPomega::convertGradients(const ScalarField* indep, const ScalarField* N, const ScalarField* Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const
-{	for(int k=0; k<nIndep; k++) Phi_indep[k]=0;
-	//Loop over orientations:
-	for(int o=oStart; o<oStop; o++)
+void IdealGasPomega::convertGradients_block(int oBegin, int oEnd, const ScalarField* indep, const TranslationSources& Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const
+{	for(int o=oBegin; o<oEnd; o++)
 	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
 		ScalarField logPomega_o; getDensities_o(o, rot, indep, logPomega_o);
 		ScalarField N_o = (quad.weight(o) * Nbulk * Nscale) * exp(logPomega_o);
 		ScalarField Phi_N_o; //gradient w.r.t N_o (as calculated in getDensities)
 		//Collect the contributions from each Phi_N in Phi_N_o
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(-rot*pos, 1., Phi_N[i], Phi_N_o);
+		trans.taxpyGather(siteTranslations(rot, -1.), 1., Phi_N, Phi_N_o);
 		//Collect the contributions from the entropy:
 		Phi_N_o += T*logPomega_o;
 		//Collect the contribution from Phi_P0 and Ecorr_P:
@@ -154,6 +268,18 @@ void IdealGasPomega::convertGradients(const ScalarField* indep, const ScalarFiel
 		//Propagate Phi_N_o to Phi_logPomega_o and then to Phi_indep:
 		convertGradients_o(o, rot, N_o*Phi_N_o, Phi_indep);
 	}
-	for(int k=0; k<nIndep; k++) { nullToZero(Phi_indep[k],gInfo); Phi_indep[k]->allReduceData(mpiWorld, MPIUtil::ReduceSum); }
 }
 
+void IdealGasPomega::convertGradients(const ScalarField* indep, const ScalarField* N, const ScalarField* Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const
+{	for(int k=0; k<nIndep; k++) Phi_indep[k]=0;
+	//Loop over orientations, in parallel over threads:
+	int nThreads = nOrientationThreads();
+	std::vector<ScalarFieldArray> Phi_indepT(nThreads, ScalarFieldArray(nIndep));
+	TranslationSources Phi_Nsources = trans.prepareSources(Phi_N, molecule.sites.size());
+	threadLaunch(nThreads, convertGradients_sub, nThreads, nThreads, this, indep, &Phi_Nsources, &Phi_P0, Phi_indepT.data(), Nscale);
+	sumThreadFields(Phi_indepT, Phi_indep, nIndep);
+	//MPI collect:
+	std::vector<ScalarField*> fields(nIndep);
+	for(int k=0; k<nIndep; k++) fields[k] = &Phi_indep[k];
+	allReduceFields(fields);
+}
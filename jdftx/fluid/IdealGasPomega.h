@@ -58,6 +58,27 @@ protected:
 private:
 	double S; //!< cache the entropy, because it is most efficiently computed during getDensities()
 	double Ecorr; VectorField Ecorr_P; //!< cache the correlation correction and its derivatives, since they are most efficiently computed during getDensities()
+	
+	//Thread-parallel orientation engine: the orientations [oStart,oStop) of this process are split into one contiguous
+	//block per thread, each accumulating into its own output fields; these are summed and then MPI-reduced in packed batches
+	int nOrientationThreads() const; //!< number of threads for orientation loops: nOperatorThreads() (the thread team's share) capped at the local orientation count
+	void orientationBlock(int iThread, int nThreads, int& oBegin, int& oEnd) const; //!< orientations handled by one thread
+	void allReduceFields(const std::vector<ScalarField*>& fields, std::vector<double>* scalars=0) const; //!< MPI sum fields (and scalars) in few messages
+	
+	std::vector<std::vector<vector3<>>> siteTranslations(const matrix3<>& rot, double sign) const; //!< translations sign*rot*pos of each site position
+	
+	//Orientation loops over [oBegin,oEnd), accumulating to the supplied outputs:
+	void initState_block(int oBegin, int oEnd, const TranslationSources& Veff, ScalarField* indep, double scale, double Elo, double Ehi, double& Emin, double& Emax, double& Emean) const;
+	void getDensities_block(int oBegin, int oEnd, const ScalarField* indep, ScalarField* N, VectorField& P, double& Sblock) const;
+	void convertGradients_block(int oBegin, int oEnd, const ScalarField* indep, const TranslationSources& Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const;
+	
+	//Thread launchers for the above (one job per thread block):
+	static void initState_sub(size_t iStart, size_t iStop, int nThreads, const IdealGasPomega* ig,
+		const TranslationSources* Veff, ScalarFieldArray* indepT, double scale, double Elo, double Ehi, double* EminT, double* EmaxT, double* EmeanT);
+	static void getDensities_sub(size_t iStart, size_t iStop, int nThreads, const IdealGasPomega* ig,
+		const ScalarField* indep, ScalarFieldArray* NT, VectorField* PT, double* ST);
+	static void convertGradients_sub(size_t iStart, size_t iStop, int nThreads, const IdealGasPomega* ig,
+		const ScalarField* indep, const TranslationSources* Phi_N, const vector3<>* Phi_P0, ScalarFieldArray* Phi_indepT, double Nscale);
 };
 
 //! @}
@@ -72,7 +72,7 @@ void LinearPCM::set_internal(const ScalarFieldTilde& rhoExplicitTilde, const Sca
 
 	//Update the preconditioner
 	ScalarField epsilon = 1 + (epsBulk-1)*shape[0];
-	ScalarField kappaSq = k2factor ? k2factor*shape.back() : 0; //set kappaSq to null pointer if no screening
+	ScalarField kappaSq = k2factor ? ScalarField(k2factor*shape.back()) : 0; //set kappaSq to null pointer if no screening
 	updatePreconditioner(epsilon, kappaSq);
 	
 	//Initialize the state if it hasn't been loaded:
@@ -26,6 +26,14 @@ Molecule::Site::Site(string name, int atomicNumber) : name(name), Rhs(0), atomic
 {	
 }
 
+//Copy only the user-specified properties; deltaS and the kernels are computed in setup()
+Molecule::Site::Site(const Site& s)
+: name(s.name), Rhs(s.Rhs), atomicNumber(s.atomicNumber), Znuc(s.Znuc), sigmaNuc(s.sigmaNuc), Zelec(s.Zelec), aElec(s.aElec), Zsite(s.Zsite), deltaS(0),
+	sigmaElec(s.sigmaElec), rcElec(s.rcElec), elecFilename(s.elecFilename), elecFilenameG(s.elecFilenameG), alpha(s.alpha), aPol(s.aPol),
+	positions(s.positions), initialized(false)
+{
+}
+
 Molecule::Site::~Site()
 {	free();
 }
@@ -242,6 +250,11 @@ Molecule::Molecule(string name) : name(name), initialized(false)
 {
 }
 
+Molecule::Molecule(const Molecule& m) : name(m.name), initialized(false)
+{	for(const auto& site: m.sites)
+		sites.push_back(std::make_shared<Site>(*site));
+}
+
 Molecule::~Molecule()
 {	if(initialized)
 	{	mfKernel.free();
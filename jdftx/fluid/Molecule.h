@@ -48,6 +48,8 @@ struct Molecule
 		std::vector< vector3<> > positions; //!< Positions w.r.t molecular origin in the reference orientation
 
 		Site(string name, int atomicNumber=0);
+		Site(const Site&); //!< copy the properties specified above; the copy must be setup separately
+		Site& operator=(const Site&) = delete;
 		~Site();
 		void setup(const GridInfo& gInfo); //!< initialize the radial functions from the properties specified above
 		explicit operator bool() const { return initialized; } //!< return whether site has been setup
@@ -62,6 +64,8 @@ struct Molecule
 	RadialFunctionG mfKernel; //!< Mean field interaction kernel (with minimum Coulomb self energy while preserving intermolecular interactions)
 
 	Molecule(string name=string());
+	Molecule(const Molecule&); //!< copy name and (deep-copied) site properties; the copy must be setup separately
+	Molecule& operator=(const Molecule&) = delete;
 	~Molecule();
 	void setup(const GridInfo& gInfo, double Rmf);
 	explicit operator bool() const { return initialized; } //!< return whether site has been setup
@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/LinearPCM.h>
 #include <fluid/PCM_internal.h>
 #include <core/ScalarFieldIO.h>
+#include <core/DistributedFFT.h>
 #include <core/Util.h>
 
 //Utility functions to extract/set the members of a MuEps
@@ -111,6 +112,8 @@ NonlinearPCM::NonlinearPCM(const Everything& e, const FluidSolverParams& fsp)
 	{	//Initialize preconditioner (for mu channel):
 		double muByEps = (ionZ/pMol) * (1.-dielectricEval->alpha/3); //relative scale between mu and eps
 		preconditioner.init(0, 0.02, gInfo.GmaxGrid, setPreconditioner, k2factor/epsBulk, muByEps*muByEps);
+		if(DistributedFFT::enabled && mpiWorld->nProcesses()>1 && gInfo.nr>=DistributedFFT::nrMin)
+			fftDist = std::make_shared<DistributedFFT>(gInfo, mpiWorld);
 	}
 }
 
@@ -309,9 +312,13 @@ double NonlinearPCM::compute(ScalarFieldMuEps* grad, ScalarFieldMuEps* Kgrad)
 	{	const ScalarFieldMuEps& in = grad ? *grad : gradUnused;
 		double dielPrefac = 1./(gInfo.dV * dielectricEval->NT);
 		double ionsPrefac = screeningEval ? 1./(gInfo.dV * screeningEval->NT) : 0.;
+		//Fluid minimization runs on all processes together, so these convolutions may use distributed transforms:
+		auto applyPreconditioner = [&](const ScalarField& x)
+		{	return fftDist ? fftDist->convolve(x, preconditioner) : I(preconditioner*J(x));
+		};
 		setMuEps(*Kgrad,
-			ionsPrefac * I(preconditioner*J(getMuPlus(in))),
-			ionsPrefac * I(preconditioner*J(getMuMinus(in))),
+			ionsPrefac * applyPreconditioner(getMuPlus(in)),
+			ionsPrefac * applyPreconditioner(getMuMinus(in)),
 			dielPrefac * getEps(in));
 	}
 	return E;
@@ -339,12 +346,12 @@ void NonlinearPCM::dumpDensities(const char* filenamePattern) const
 			ScalarField muMinus = getMuMinus(state);
 			double Qexp = integral(rhoExplicitTilde);
 			double mu0 = screeningEval->neutralityConstraint(muPlus, muMinus, shape.back(), Qexp);
-			Nplus = ionNbulk * shape.back() * (fsp.linearScreening ? 1.+(mu0+muPlus) : exp(mu0+muPlus));
-			Nminus = ionNbulk * shape.back() * (fsp.linearScreening ? 1.-(mu0+muMinus) : exp(-(mu0+muMinus)));
+			Nplus = ionNbulk * shape.back() * (fsp.linearScreening ? ScalarField(1.+(mu0+muPlus)) : exp(mu0+muPlus));
+			Nminus = ionNbulk * shape.back() * (fsp.linearScreening ? ScalarField(1.-(mu0+muMinus)) : exp(-(mu0+muMinus)));
 		}
 		FLUID_DUMP(Nplus, "N+");
 		FLUID_DUMP(Nminus, "N-");
-		FLUID_DUMP(ionZ*(Nplus-Nminus), "RhoIon");
+		FLUID_DUMP(ScalarField(ionZ*(Nplus-Nminus)), "RhoIon");
 	}
 }
 
@@ -68,6 +68,7 @@ private:
 	NonlinearPCMeval::Screening* screeningEval; //!< Internal helper class for Screening from PCM_internal
 	NonlinearPCMeval::Dielectric* dielectricEval; //!< Internal helper class for Dielectric from PCM_internal
 	RadialFunctionG preconditioner; //!< preconditioner for minimizer version
+	std::shared_ptr<class DistributedFFT> fftDist; //!< distributed transforms for applying the preconditioner, if enabled (see command fft-distributed)
 	std::shared_ptr<RealKernel> metric; //!< Pulay metric for SCF version
 	RadialFunctionG gLookup, xLookup; //!< lookup tables for transcendental solutions involved in the dielectric and ionic SCF method
 	std::shared_ptr<class LinearPCM> linearPCM;
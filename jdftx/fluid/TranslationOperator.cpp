@@ -26,6 +26,25 @@ TranslationOperator::TranslationOperator(const GridInfo& gInfo) : gInfo(gInfo)
 {
 }
 
+void TranslationOperator::taxpyScatter(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const ScalarField& x, ScalarField* y) const
+{	for(size_t i=0; i<tArr.size(); i++)
+		for(const vector3<>& t: tArr[i])
+			taxpy(t, alpha, x, y[i]);
+}
+
+TranslationSources TranslationOperator::prepareSources(const ScalarField* x, int nSources) const
+{	TranslationSources sources;
+	sources.x.assign(x, x+nSources);
+	return sources;
+}
+
+void TranslationOperator::taxpyGather(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const TranslationSources& x, ScalarField& y) const
+{	assert(tArr.size() <= x.x.size());
+	for(size_t i=0; i<tArr.size(); i++)
+		for(const vector3<>& t: tArr[i])
+			taxpy(t, alpha, x.x[i], y);
+}
+
 TranslationOperatorSpline::TranslationOperatorSpline(const GridInfo& gInfo, SplineType splineType)
 : TranslationOperator(gInfo), splineType(splineType)
 {
@@ -90,8 +109,8 @@ void TranslationOperatorSpline::taxpy(const vector3<>& t, double alpha, const Sc
 	}
 }
 
-TranslationOperatorFourier::TranslationOperatorFourier(const GridInfo& gInfo)
-: TranslationOperator(gInfo)
+TranslationOperatorFourier::TranslationOperatorFourier(const GridInfo& gInfo, bool cacheKernels)
+: TranslationOperator(gInfo), cacheKernels(cacheKernels)
 {
 }
 inline void fourierTranslate_sub(size_t iStart, size_t iStop, const vector3<int> S, const vector3<> Gt, complex* xTilde)
@@ -109,3 +128,79 @@ void TranslationOperatorFourier::taxpy(const vector3<>& t, double alpha, const S
 	#endif
 	y += alpha*I(xTilde);
 }
+
+//---------- Fused multi-translation with (optionally cached) combined phase kernels ----------
+
+bool TranslationOperatorFourier::TranslationsLess::operator()(const Translations& a, const Translations& b) const
+{	if(a.size() != b.size()) return a.size() < b.size();
+	for(size_t j=0; j<a.size(); j++)
+		for(int k=0; k<3; k++)
+			if(a[j][k] != b[j][k]) return a[j][k] < b[j][k];
+	return false;
+}
+
+inline void fourierTranslateKernel_sub(size_t iStart, size_t iStop, const vector3<int> S, const vector3<>* Gt, int nT, complex* kernel)
+{	THREAD_halfGspaceLoop( fourierTranslateKernel_calc(i, iG, S, Gt, nT, kernel); )
+}
+
+std::shared_ptr<const std::vector<complex>> TranslationOperatorFourier::getKernel(const Translations& tList) const
+{	if(cacheKernels)
+	{	std::lock_guard<std::mutex> lock(kernelCacheLock);
+		auto iter = kernelCache.find(tList);
+		if(iter != kernelCache.end()) return iter->second;
+	}
+	//Compute kernel:
+	std::vector<vector3<>> Gt(tList.size());
+	for(size_t j=0; j<tList.size(); j++) Gt[j] = gInfo.G * tList[j];
+	auto kernel = std::make_shared<std::vector<complex>>(gInfo.nG);
+	threadLaunch(fourierTranslateKernel_sub, gInfo.nG, gInfo.S, Gt.data(), int(Gt.size()), kernel->data());
+	if(cacheKernels)
+	{	std::lock_guard<std::mutex> lock(kernelCacheLock);
+		kernelCache[tList] = kernel; //a concurrent identical insertion is harmless
+	}
+	return kernel;
+}
+
+inline void fourierKernelAccum_sub(size_t iStart, size_t iStop, const complex* kernel, const complex* xTilde, complex* yTilde)
+{	for(size_t i=iStart; i<iStop; i++) yTilde[i] += kernel[i] * xTilde[i];
+}
+
+void TranslationOperatorFourier::taxpyScatter(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const ScalarField& x, ScalarField* y) const
+{
+	#ifdef GPU_ENABLED
+	TranslationOperator::taxpyScatter(tArr, alpha, x, y);
+	#else
+	ScalarFieldTilde xTilde = J(x); //one forward transform shared by all targets
+	for(size_t i=0; i<tArr.size(); i++)
+		if(tArr[i].size())
+		{	ScalarFieldTilde yTilde; nullToZero(yTilde, gInfo);
+			threadLaunch(fourierKernelAccum_sub, gInfo.nG, getKernel(tArr[i])->data(), xTilde->data(), yTilde->data());
+			y[i] += alpha*I(yTilde); //one inverse transform per target
+		}
+	#endif
+}
+
+TranslationSources TranslationOperatorFourier::prepareSources(const ScalarField* x, int nSources) const
+{	TranslationSources sources;
+	sources.xTilde.resize(nSources);
+	for(int i=0; i<nSources; i++)
+		sources.xTilde[i] = J(x[i]);
+	#ifdef GPU_ENABLED
+	sources.x.assign(x, x+nSources); //default implementation used on GPU
+	#endif
+	return sources;
+}
+
+void TranslationOperatorFourier::taxpyGather(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const TranslationSources& x, ScalarField& y) const
+{
+	#ifdef GPU_ENABLED
+	TranslationOperator::taxpyGather(tArr, alpha, x, y);
+	#else
+	assert(tArr.size() <= x.xTilde.size());
+	ScalarFieldTilde yTilde; nullToZero(yTilde, gInfo);
+	for(size_t i=0; i<tArr.size(); i++)
+		if(tArr[i].size())
+			threadLaunch(fourierKernelAccum_sub, gInfo.nG, getKernel(tArr[i])->data(), x.xTilde[i]->data(), yTilde->data());
+	y += alpha*I(yTilde); //one inverse transform for all sources
+	#endif
+}
@@ -25,7 +25,15 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 //! @file TranslationOperator.h Various ways of translation used by rigid molecule ideal gas implementations
 
 #include <core/GridInfo.h>
-#include <core/ScalarField.h>
+#include <core/ScalarFieldArray.h>
+#include <map>
+#include <mutex>
+
+//! Source fields prepared for repeated TranslationOperator::taxpyGather() calls
+struct TranslationSources
+{	ScalarFieldArray x; //!< real-space sources (used by real-space implementations)
+	ScalarFieldTildeArray xTilde; //!< transformed sources (used by Fourier-space implementations)
+};
 
 //! Abstract base class for translation operators
 class TranslationOperator
@@ -41,6 +49,17 @@ public:
 	//! T must conserve integral(x) and satisfy @f$ T^{\dagger}_t = T_{-t} @f$ exactly for gradient correctness
 	//! Note that @f$ T^{-1}_t = T_{-t} @f$ may only be approximately true for some implementations.
 	virtual void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const=0;
+	
+	//! Translate one source into several targets: @f$ y_i += alpha \sum_{t \in tArr_i} T_t(x) @f$ for each i
+	//! The default implementation calls taxpy() for each translation
+	virtual void taxpyScatter(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const ScalarField& x, ScalarField* y) const;
+	
+	//! Prepare sources x[0:nSources] for repeated use in taxpyGather()
+	virtual TranslationSources prepareSources(const ScalarField* x, int nSources) const;
+	
+	//! Translate several sources into one target: @f$ y += alpha \sum_i \sum_{t \in tArr_i} T_t(x_i) @f$
+	//! The default implementation calls taxpy() for each translation
+	virtual void taxpyGather(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const TranslationSources& x, ScalarField& y) const;
 };
 
 //! Translation operator which works in real space using interpolating splines
@@ -57,12 +76,26 @@ public:
 	void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const;
 };
 
-//! The exact translation operator in PW basis, although much slower and with potential ringing issues
+//! The exact translation operator in PW basis, although much slower and with potential ringing issues.
+//! The multi-translation functions fuse all translations of a source / into a target into a single transform pair,
+//! and sources are transformed only once by prepareSources(). Optionally, the combined phase kernel
+//! of each distinct set of translations is cached and reused across calls, trading memory for speed.
 class TranslationOperatorFourier : public TranslationOperator
 {
 public:
-	TranslationOperatorFourier(const GridInfo& gInfo);
+	TranslationOperatorFourier(const GridInfo& gInfo, bool cacheKernels=false);
 	void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const;
+	void taxpyScatter(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const ScalarField& x, ScalarField* y) const;
+	TranslationSources prepareSources(const ScalarField* x, int nSources) const;
+	void taxpyGather(const std::vector<std::vector<vector3<>>>& tArr, double alpha, const TranslationSources& x, ScalarField& y) const;
+
+private:
+	const bool cacheKernels; //!< whether to cache phase kernels
+	typedef std::vector<vector3<>> Translations;
+	struct TranslationsLess { bool operator()(const Translations& a, const Translations& b) const; }; //!< exact lexicographic order
+	mutable std::map<Translations, std::shared_ptr<std::vector<complex>>, TranslationsLess> kernelCache;
+	mutable std::mutex kernelCacheLock; //!< kernels may be requested from several threads
+	std::shared_ptr<const std::vector<complex>> getKernel(const Translations& tList) const; //!< combined phase kernel, sum_t exp(-i G.t)
 };
 
 //! @}
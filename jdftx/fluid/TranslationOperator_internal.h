@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_FLUID_TRANSLATIONOPERATORINTERNAL_H
 
 #include <core/vector3.h>
+#include <core/scalar.h>
 
 //! @cond
 
@@ -69,5 +70,12 @@ void fourierTranslate_calc(int i, const vector3<int> iG, const vector3<int> S, c
 {	xTilde[i] *= cis(-dot(iG,Gt));
 }
 
+//! Combined phase kernel for a set of nT translations (Gt = G*t for each)
+inline void fourierTranslateKernel_calc(int i, const vector3<int> iG, const vector3<int> S, const vector3<>* Gt, int nT, complex* kernel)
+{	complex k = 0.;
+	for(int j=0; j<nT; j++) k += cis(-dot(iG,Gt[j]));
+	kernel[i] = k;
+}
+
 //! @endcond
 #endif // JDFTX_FLUID_TRANSLATIONOPERATORINTERNAL_H
@@ -27,30 +27,39 @@ void Phonon::dump()
 	dgrad.assign(modes.size(), zeroForce);
 	dHsub.assign(modes.size(), std::vector<matrix>(nSpins));
 	
-	//Accumulate contributions to force matrix and electron-phonon matrix elements for each irreducible perturbation:
-	unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
-	unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
-	std::vector<int> nStatesPert(perturbations.size());
-	for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
-	{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
-		ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
-		string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
-		fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
-		processPerturbation(perturbations[iPert], fnamePattern);
-		nStatesPert[iPert] = eSup->eInfo.nStates;
-		logPrintf("\n"); logFlush();
+	if(dfpt)
+	{	if(dryRun)
+		{	logPrintf("\nDry run: linear-response setup successful.\n");
+			return;
+		}
+		processDFPT();
 	}
-	if(dryRun)
-	{	logPrintf("\nParameter summary for supercell calculations:\n");
+	else
+	{	//Accumulate contributions to force matrix and electron-phonon matrix elements for each irreducible perturbation:
+		unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
+		unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
+		std::vector<int> nStatesPert(perturbations.size());
 		for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
-			logPrintf("\tPerturbation: %u  nStates: %d\n", iPert+1, nStatesPert[iPert]);
-		logPrintf("Use option iPerturbation of command phonon to run each supercell calculation separately.\n");
-		return;
-	}
-	if(iPerturbation>=0)
-	{	logPrintf("Completed supercell calculation for iPerturbation %d.\n", iPerturbation+1);
-		logPrintf("After completing all supercells, rerun with option collectPerturbations in command phonon.\n");
-		return;
+		{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
+			ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
+			string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
+			fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
+			processPerturbation(perturbations[iPert], fnamePattern);
+			nStatesPert[iPert] = eSup->eInfo.nStates;
+			logPrintf("\n"); logFlush();
+		}
+		if(dryRun)
+		{	logPrintf("\nParameter summary for supercell calculations:\n");
+			for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
+				logPrintf("\tPerturbation: %u  nStates: %d\n", iPert+1, nStatesPert[iPert]);
+			logPrintf("Use option iPerturbation of command phonon to run each supercell calculation separately.\n");
+			return;
+		}
+		if(iPerturbation>=0)
+		{	logPrintf("Completed supercell calculation for iPerturbation %d.\n", iPerturbation+1);
+			logPrintf("After completing all supercells, rerun with option collectPerturbations in command phonon.\n");
+			return;
+		}
 	}
 	
 	//Process force matrix:
@@ -121,6 +130,26 @@ void Phonon::dump()
 	for(const matrix& Fi: F)
 		omegaSq.push_back(invsqrtMmode * Fi * invsqrtMmode);
 	
+	//--- report frequencies at the q sampled directly by the supercell (for comparing calculation methods):
+	logPrintf("Phonon frequencies [cm^-1] at commensurate q (negative for imaginary):\n");
+	for(int iq=0; iq<prodSup; iq++)
+	{	vector3<int> qCell = getCell(iq);
+		vector3<> q; for(int j=0; j<3; j++) q[j] = qCell[j] / double(sup[j]);
+		matrix omegaSq_q;
+		auto iter = cellMap.begin();
+		for(size_t iCell=0; iCell<cellMap.size(); iCell++)
+		{	omegaSq_q += cis(2*M_PI*dot(iter->first, q)) * omegaSq[iCell];
+			iter++;
+		}
+		diagMatrix omegaSqEigs; matrix omegaSqEvecs;
+		dagger_symmetrize(omegaSq_q).diagonalize(omegaSqEvecs, omegaSqEigs);
+		logPrintf("\tq: [ %+.4lf %+.4lf %+.4lf ]  omega:", q[0], q[1], q[2]);
+		for(double omegaSqEig: omegaSqEigs)
+			logPrintf(" %.2lf", copysign(sqrt(fabs(omegaSqEig)), omegaSqEig)/invcm);
+		logPrintf("\n");
+	}
+	logPrintf("\n");
+	
 	//--- write to file
 	if(mpiWorld->isHead())
 	{	string fname = e.dump.getFilename("phononOmegaSq");
@@ -63,6 +63,7 @@ public:
 	int iPerturbation; //!< if >=0, only run one supercell calculation
 	bool collectPerturbations; //!< if true, collect results of previously computed perturbations (skips supercell SCF/Minimize)
 	bool saveHsub; //!< whether to compute / output electron-phonon matrix elements
+	bool dfpt; //!< whether to use linear response (density-functional perturbation theory) instead of supercell calculations
 	
 	Phonon();
 	void setup(bool printDefaults); //!< setup unit cell and basis modes for perturbations
@@ -106,6 +107,11 @@ private:
 	//!Calculate subspace Hamiltonian of perturbed supercell:
 	std::vector<matrix> getPerturbedHsub(const Perturbation& pert, const std::vector<diagMatrix>& Hsub0);
 	
+	//!Linear-response alternative to supercell calculations (implemented in Phonon_dfpt.cpp):
+	void dfptCheck() const; //!< check that the unit cell calculation is supported by the linear-response implementation
+	void processDFPT(); //!< compute dgrad (and dHsub if saveHsub) for all modes using density-functional perturbation theory
+	void dfptClearProjectorCache() const; //!< drop projectors cached by SpeciesInfo::getV for the temporary k-point bases of processDFPT
+	
 	//!Mapping between unit cell and current supercell k-points (generated by processPerturbation and used by setSupState)
 	struct StateMapEntry : public Supercell::KmeshTransform //contain source k-point rotation here
 	{	int qSup; //!< state index for supercell
@@ -0,0 +1,724 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <phonon/Phonon.h>
+#include <electronic/ColumnBundleTransform.h>
+#include <core/Minimize.h>
+#include <core/Pulay.h>
+#include <core/ScalarFieldIO.h>
+#include <core/LoopMacros.h>
+
+//Linear-response (density-functional perturbation theory) calculation of the force matrix
+//and electron-phonon matrix elements at all q commensurate with the phonon supercell.
+//All perturbations are Bloch sums of atomic displacements, u_{IR} = exp(2 pi i q.R) per unit displacement,
+//so that all fields below are the lattice-periodic parts of quantities with overall Bloch phase exp(i q.r).
+
+//Per-species quantities required for the perturbations (extracted from SpeciesInfo by Phonon, which is a friend)
+struct DfptSpecies
+{	const SpeciesInfo* sp;
+	int iSp; //!< species index
+	double Z; //!< valence charge
+	const RadialFunctionG* VlocRadial; //!< short-ranged local pseudopotential
+	matrix M; //!< nonlocal projector matrix for one atom
+	int nProj; //!< number of projectors per atom
+};
+
+//Apply the unit cell Kohn-Sham Hamiltonian (norm-conserving pseudopotentials, local functionals only)
+ColumnBundle applyH(const Everything& e, const ColumnBundle& C)
+{	ColumnBundle HC = Idag_DiagV_I(C, e.eVars.Vscloc);
+	ColumnBundle LC = L(C);
+	HC += (-0.5) * LC;
+	std::vector<matrix> VdagC, HVdagC(e.iInfo.species.size());
+	e.iInfo.project(C, VdagC);
+	e.iInfo.EnlAndGrad(*C.qnum, diagMatrix(C.nCols(), 1.), VdagC, HVdagC);
+	e.iInfo.projectGrad(HVdagC, C, HC);
+	return HC;
+}
+
+//Wavefunctions at an arbitrary point of the full k-mesh (or its periodic image), along with projections
+struct DfptKpoint
+{	QuantumNumber qnum;
+	Basis basis;
+	ColumnBundle C; //!< wavefunctions (first nBands bands of the unit cell calculation)
+	matrix Hsub; //!< subspace Hamiltonian (not necessarily diagonal due to the symmetry transformation)
+	diagMatrix KEref; //!< kinetic energy of each band for preconditioning
+	std::vector<matrix> VdagC, DVdagC[3]; //!< projections of C on the nonlocal projectors and their Cartesian gradients
+	
+	//Initialize basis and wavefunctions at k by transforming the reduced state specified by kt
+	//(k may differ from the corresponding kmesh entry by a reciprocal lattice vector)
+	void setup(const Everything& e, const vector3<>& k, const Supercell::KmeshTransform& kt, int nBands, double weight, const std::vector<SpaceGroupOp>& sym)
+	{	qnum.k = k;
+		qnum.spin = 0;
+		qnum.weight = weight;
+		logSuspend();
+		basis.setup(e.gInfo, e.iInfo, e.cntrl.Ecut, k);
+		logResume();
+		ColumnBundleTransform transform(e.eInfo.qnums[kt.iReduced].k, e.basis[kt.iReduced], k,
+			ColumnBundleTransform::BasisWrapper(basis), 1, sym[kt.iSym], kt.invert);
+		C.init(nBands, basis.nbasis, &basis, &qnum, isGpuEnabled());
+		C.zero();
+		transform.scatterAxpy(1., e.eVars.C[kt.iReduced].getSub(0,nBands), C, 0, 1);
+	}
+	
+	//Compute quantities required for the unperturbed side of the Sternheimer equation:
+	void prepare(const Everything& e)
+	{	Hsub = C ^ applyH(e, C);
+		KEref = (-0.5) * diagDot(C, L(C));
+		project(e);
+	}
+	
+	//Compute projections and their gradients:
+	void project(const Everything& e)
+	{	e.iInfo.project(C, VdagC);
+		for(int iDir=0; iDir<3; iDir++)
+			DVdagC[iDir].assign(e.iInfo.species.size(), matrix());
+		for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		{	auto V = e.iInfo.species[sp]->getV(C);
+			if(V)
+				for(int iDir=0; iDir<3; iDir++)
+					DVdagC[iDir][sp] = D(*V, iDir) ^ C;
+		}
+	}
+};
+
+//----------- Threaded helpers for Bloch-periodic fields on the full G-space grid -----------
+
+inline void localPerturbation_sub(size_t iStart, size_t iStop, const vector3<int>& S, const matrix3<>& G,
+	const RadialFunctionG* VlocRadial, double Z, double invVol, const vector3<>& atpos, int iDir, const vector3<>& q, complex* dV)
+{	THREAD_fullGspaceLoop
+	(	vector3<> kG = q + iG;
+		vector3<> K = kG * G;
+		double Ksq = K.length_squared();
+		if(Ksq < 1e-12) dV[i] = 0.;
+		else
+		{	double V = (*VlocRadial)(sqrt(Ksq)) - 4*M_PI*Z/Ksq; //short-ranged part and long-ranged point-charge part
+			dV[i] = (invVol * V) * complex(0, -K[iDir]) * cis(-2*M_PI*dot(kG, atpos));
+		}
+	)
+}
+//Change in the local potential due to a Bloch-sum displacement of an atom at atpos along Cartesian direction iDir
+complexScalarFieldTilde localPerturbation(const GridInfo& gInfo, const DfptSpecies& dsp, const vector3<>& atpos, int iDir, const vector3<>& q)
+{	complexScalarFieldTilde dV; nullToZero(dV, gInfo);
+	threadLaunch(localPerturbation_sub, gInfo.nr, gInfo.S, gInfo.G, dsp.VlocRadial, dsp.Z, 1./gInfo.detR, atpos, iDir, q, dV->data());
+	return dV;
+}
+
+inline void blochGradient_sub(size_t iStart, size_t iStop, const vector3<int>& S, const matrix3<>& G, const vector3<>& q, int iDir, complex* data)
+{	THREAD_fullGspaceLoop( data[i] *= complex(0, ((q + iG) * G)[iDir]); )
+}
+//Cartesian gradient of a Bloch function with wavevector q, specified by its periodic part
+complexScalarFieldTilde blochGradient(const complexScalarFieldTilde& X, const vector3<>& q, int iDir)
+{	complexScalarFieldTilde Y = clone(X);
+	threadLaunch(blochGradient_sub, X->gInfo.nr, X->gInfo.S, X->gInfo.G, q, iDir, Y->data());
+	return Y;
+}
+
+inline void blochCoulomb_sub(size_t iStart, size_t iStop, const vector3<int>& S, const matrix3<>& G, const vector3<>& q, complex* data)
+{	THREAD_fullGspaceLoop
+	(	double Ksq = ((q + iG) * G).length_squared();
+		data[i] *= (Ksq < 1e-12 ? 0. : 4*M_PI/Ksq);
+	)
+}
+//Periodic Coulomb kernel for a Bloch function with wavevector q, specified by its periodic part
+complexScalarFieldTilde blochCoulomb(const complexScalarFieldTilde& X, const vector3<>& q)
+{	complexScalarFieldTilde Y = clone(X);
+	threadLaunch(blochCoulomb_sub, X->gInfo.nr, X->gInfo.S, X->gInfo.G, q, Y->data());
+	return Y;
+}
+
+//Second derivative of the Hartree and exchange-correlation energy w.r.t density (LDA/GGA)
+struct HxcKernel
+{	ScalarField e_nn, e_sigma, e_nsigma, e_sigmasigma; //!< second derivatives of the XC energy density
+	VectorField Dn; //!< density gradient (for GGAs only)
+	
+	HxcKernel(const Everything& e)
+	{	e.exCorr.getSecondDerivatives(e.eVars.n[0], e_nn, e_sigma, e_nsigma, e_sigmasigma);
+		if(e_sigma) Dn = gradient(e.eVars.n[0]);
+	}
+	
+	//Return the change in Hartree + XC potential due to Bloch density change dn at wavevector q:
+	complexScalarFieldTilde operator()(const complexScalarFieldTilde& dn, const vector3<>& q) const
+	{	complexScalarFieldTilde dV = blochCoulomb(dn, q);
+		complexScalarField dnR = I(dn);
+		complexScalarField KV = e_nn * dnR;
+		if(e_sigma)
+		{	complexScalarField Ddn[3], DnDdn;
+			for(int iDir=0; iDir<3; iDir++)
+			{	Ddn[iDir] = I(blochGradient(dn, q, iDir));
+				DnDdn += 2. * (Dn[iDir] * Ddn[iDir]);
+			}
+			KV += e_nsigma * DnDdn;
+			complexScalarField DnTerm = e_nsigma * dnR;
+			DnTerm += e_sigmasigma * DnDdn;
+			for(int iDir=0; iDir<3; iDir++)
+			{	complexScalarField Vsigma = Dn[iDir] * DnTerm;
+				Vsigma += e_sigma * Ddn[iDir];
+				dV -= 2. * blochGradient(J(Vsigma), q, iDir);
+			}
+		}
+		dV += J(KV);
+		return dV;
+	}
+};
+
+//Hessian of the local pseudopotential energy w.r.t position of an atom at atpos (onsite, q-independent)
+matrix3<> localEnergyHessian(const GridInfo& gInfo, const complexScalarFieldTilde& nTilde, const DfptSpecies& dsp, const vector3<>& atpos)
+{	const vector3<int>& S = gInfo.S;
+	const matrix3<>& G = gInfo.G;
+	const complex* nData = nTilde->data();
+	matrix3<> hess;
+	size_t iStart = 0, iStop = gInfo.nr;
+	THREAD_fullGspaceLoop
+	(	vector3<> Gvec = iG * G;
+		double Gsq = Gvec.length_squared();
+		if(Gsq > 1e-12)
+		{	double V = (*dsp.VlocRadial)(sqrt(Gsq)) - 4*M_PI*dsp.Z/Gsq;
+			double nS = (nData[i].conj() * cis(-2*M_PI*dot(iG, atpos))).real();
+			hess -= (nS * V) * outer(Gvec, Gvec);
+		}
+	)
+	return hess;
+}
+
+//Change in wavefunctions kp due to the nonlocal pseudopotential for a Bloch-sum displacement of atom at,
+//returned in the basis of kq (at wavevector k+q)
+ColumnBundle nonlocalPerturbation(const DfptSpecies& dsp, int at, int iDir, const DfptKpoint& kp, const DfptKpoint& kq)
+{	ColumnBundle result = kq.C.similar(kp.C.nCols());
+	result.zero();
+	if(!dsp.nProj) return result;
+	int p0 = at*dsp.nProj, p1 = p0+dsp.nProj, nBands = kp.C.nCols();
+	ColumnBundle Vq = dsp.sp->getV(kq.C)->getSub(p0, p1);
+	ColumnBundle DVq = D(Vq, iDir);
+	result -= DVq * (dsp.M * kp.VdagC[dsp.iSp](p0,p1, 0,nBands));
+	result -= Vq * (dsp.M * kp.DVdagC[iDir][dsp.iSp](p0,p1, 0,nBands));
+	return result;
+}
+
+//Accumulate the action of a Bloch-periodic local potential (real space, including integration weight) on C onto Y
+void applyLocal(const complexScalarField& dVr, const ColumnBundle& C, ColumnBundle& Y)
+{	for(int b=0; b<C.nCols(); b++)
+		Y.accumColumn(b,0, Idag(dVr * I(C.getColumn(b,0))));
+}
+
+//Sternheimer equation for the first-order change in occupied wavefunctions of kp (in the basis of kq):
+//  H_{k+q} X - O X Hsub_k + alphaPv O P_{k+q} X = rhs, where P_{k+q} projects onto occupied states at k+q
+struct SternheimerSolver : public LinearSolvable<ColumnBundle>
+{	const Everything& e;
+	const DfptKpoint& kp;
+	const ColumnBundle& OCq; //!< overlap applied to occupied states at k+q
+	double alphaPv;
+	
+	SternheimerSolver(const Everything& e, const DfptKpoint& kp, const ColumnBundle& OCq, double alphaPv)
+	: e(e), kp(kp), OCq(OCq), alphaPv(alphaPv) {}
+	
+	ColumnBundle hessian(const ColumnBundle& X) const
+	{	ColumnBundle HX = applyH(e, X);
+		HX -= O(X) * kp.Hsub;
+		HX += OCq * (alphaPv * (OCq ^ X));
+		return HX;
+	}
+	
+	ColumnBundle precondition(const ColumnBundle& X) const
+	{	ColumnBundle KX = clone(X);
+		precond_inv_kinetic_band(KX, kp.KEref);
+		return KX;
+	}
+};
+
+//Self-consistent linear response to one Bloch perturbation, mixing the Hartree + XC potential change
+class PhononResponse : public Pulay<complexScalarFieldTilde>
+{
+public:
+	complexScalarFieldTilde dVhxc; //!< self-consistent change in Hartree + XC potential
+	complexScalarFieldTilde dn; //!< change in electron density
+	std::vector<ColumnBundle> dC; //!< change in occupied wavefunctions (at k+q) for each local k
+	
+	PhononResponse(const Everything& e, const PulayParams& pp, const HxcKernel& hxc, const vector3<>& q, double alphaPv,
+		const std::vector<DfptKpoint>& kpoints, const std::vector<DfptKpoint>& kqpoints,
+		const complexScalarFieldTilde& dVextLoc, const std::vector<ColumnBundle>& dVnlC)
+	: Pulay<complexScalarFieldTilde>(pp), e(e), hxc(hxc), q(q), alphaPv(alphaPv), mixFraction(pp.mixFraction),
+		kpoints(kpoints), kqpoints(kqpoints), dVextLoc(dVextLoc), dVnlC(dVnlC)
+	{	nullToZero(dVhxc, e.gInfo);
+		dC.resize(kpoints.size());
+		for(size_t ik=0; ik<kpoints.size(); ik++)
+		{	dC[ik] = dVnlC[ik].similar();
+			dC[ik].zero();
+		}
+		mp.fpLog = nullLog;
+		mp.nIterations = 100;
+		mp.knormThreshold = 1e-10;
+	}
+	
+protected:
+	double cycle(double dEprev, std::vector<double>& extraValues)
+	{	complexScalarField dVr = e.gInfo.dV * I(dVextLoc + dVhxc);
+		complexScalarField dnR; nullToZero(dnR, e.gInfo);
+		for(size_t ik=0; ik<kpoints.size(); ik++)
+		{	const DfptKpoint& kp = kpoints[ik];
+			ColumnBundle OCq = O(kqpoints[ik].C);
+			//Right hand side projected onto unoccupied states at k+q:
+			ColumnBundle rhs = clone(dVnlC[ik]);
+			applyLocal(dVr, kp.C, rhs);
+			rhs -= OCq * (kqpoints[ik].C ^ rhs);
+			rhs *= -1.;
+			//Solve Sternheimer equation (starting from previous cycle's solution):
+			SternheimerSolver solver(e, kp, OCq, alphaPv);
+			solver.state = dC[ik];
+			solver.solve(rhs, mp);
+			dC[ik] = solver.state;
+			//Accumulate density change (factor of 2 from time-reversal partner at -k-q):
+			for(int b=0; b<kp.C.nCols(); b++)
+				dnR += (2.*kp.qnum.weight) * (conj(I(kp.C.getColumn(b,0))) * I(dC[ik].getColumn(b,0)));
+		}
+		dnR->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+		dn = J(dnR);
+		dVhxc = hxc(dn, q);
+		return e.gInfo.detR * ::dot(dVextLoc, dn).real();
+	}
+	
+	void axpy(double alpha, const complexScalarFieldTilde& X, complexScalarFieldTilde& Y) const { ::axpy(alpha, X, Y); }
+	double dot(const complexScalarFieldTilde& X, const complexScalarFieldTilde& Y) const { return e.gInfo.detR * ::dot(X, Y).real(); }
+	size_t variableSize() const { return e.gInfo.nr * sizeof(complex); }
+	void readVariable(complexScalarFieldTilde& X, FILE* fp) const { nullToZero(X, e.gInfo); loadRawBinary(X, fp); }
+	void writeVariable(const complexScalarFieldTilde& X, FILE* fp) const { saveRawBinary(X, fp); }
+	complexScalarFieldTilde getVariable() const { return clone(dVhxc); }
+	void setVariable(const complexScalarFieldTilde& X) { dVhxc = clone(X); }
+	complexScalarFieldTilde precondition(const complexScalarFieldTilde& X) const { return mixFraction * X; }
+	complexScalarFieldTilde applyMetric(const complexScalarFieldTilde& X) const { return clone(X); }
+
+private:
+	const Everything& e;
+	const HxcKernel& hxc;
+	const vector3<> q;
+	const double alphaPv;
+	const double mixFraction;
+	const std::vector<DfptKpoint>& kpoints;
+	const std::vector<DfptKpoint>& kqpoints;
+	const complexScalarFieldTilde& dVextLoc;
+	const std::vector<ColumnBundle>& dVnlC;
+	MinimizeParams mp;
+};
+
+//Force matrix at q2, given force matrix D1 at q1 such that q2 * op.rot = (invert ? -q1 : q1) modulo reciprocal lattice vectors.
+//Modes are in order 3*atom + Cartesian direction, and op maps atom a to atomMap[a] (after a lattice translation).
+matrix rotateForceMatrix(const matrix& D1, const vector3<>& q2, const SpaceGroupOp& op, bool invert,
+	const GridInfo& gInfo, const std::vector<vector3<>>& xAtoms, const std::vector<int>& atomMap)
+{	int nAtoms = xAtoms.size();
+	matrix3<> rotCart = gInfo.R * op.rot * gInfo.invR;
+	//Lattice vectors by which the image of each atom differs from the atom it maps to:
+	std::vector<vector3<>> offset(nAtoms);
+	for(int a=0; a<nAtoms; a++)
+	{	offset[a] = op.applyReal(xAtoms[a]) - xAtoms[atomMap[a]];
+		for(int j=0; j<3; j++) offset[a][j] = round(offset[a][j]);
+	}
+	//Rotate each Cartesian block and permute atoms (time reversal conjugates the force matrix):
+	matrix D2 = zeroes(3*nAtoms, 3*nAtoms);
+	complex* D2data = D2.data();
+	for(int J=0; J<nAtoms; J++)
+		for(int I=0; I<nAtoms; I++)
+		{	complex phase = cis(-2*M_PI*dot(q2, offset[J]-offset[I]));
+			for(int i=0; i<3; i++)
+				for(int j=0; j<3; j++)
+				{	complex sum;
+					for(int k=0; k<3; k++)
+						for(int l=0; l<3; l++)
+						{	complex D1kl = D1(3*J+k, 3*I+l);
+							sum += (rotCart(i,k) * rotCart(j,l)) * (invert ? D1kl.conj() : D1kl);
+						}
+					D2data[D2.index(3*atomMap[J]+i, 3*atomMap[I]+j)] = phase * sum;
+				}
+		}
+	return D2;
+}
+
+//Ewald sum for the Cartesian Hessian of the point-charge interaction between atoms,
+//S_JI(q) = sum'_R exp(2 pi i q.R) grad grad (1/r) evaluated at r = x_I + R - x_J
+//(the primed sum excludes R=0 for I=J), returned as a 3 nAtoms x 3 nAtoms matrix
+matrix ewaldHessianSum(const GridInfo& gInfo, const std::vector<vector3<>>& xAtoms, const vector3<>& q)
+{	int nAtoms = xAtoms.size();
+	matrix S = zeroes(3*nAtoms, 3*nAtoms);
+	complex* Sdata = S.data();
+	auto accum = [&](int J, int I, const matrix3<complex>& h)
+	{	for(int i=0; i<3; i++)
+			for(int j=0; j<3; j++)
+				Sdata[S.index(3*J+i, 3*I+j)] += h(i,j);
+	};
+	const double eta = sqrt(M_PI) / pow(gInfo.detR, 1./3);
+	const double rMax = 6./eta, Gmax = 12.*eta;
+	const double A = 2.*eta/sqrt(M_PI);
+	vector3<int> Nreal, Nrecip;
+	for(int j=0; j<3; j++)
+	{	Nreal[j] = 1 + int(ceil(rMax * gInfo.invR.row(j).length()));
+		Nrecip[j] = 1 + int(ceil(Gmax * gInfo.R.column(j).length() / (2*M_PI)));
+	}
+	//Real space sum:
+	for(int J=0; J<nAtoms; J++)
+		for(int I=0; I<nAtoms; I++)
+		{	vector3<int> iR;
+			for(iR[0]=-Nreal[0]; iR[0]<=Nreal[0]; iR[0]++)
+			for(iR[1]=-Nreal[1]; iR[1]<=Nreal[1]; iR[1]++)
+			for(iR[2]=-Nreal[2]; iR[2]<=Nreal[2]; iR[2]++)
+			{	vector3<> r = gInfo.R * (xAtoms[I] - xAtoms[J] + iR);
+				double rMag = r.length();
+				if(rMag < symmThreshold || rMag > rMax) continue;
+				double erfcTerm = erfc(eta*rMag)/rMag, expTerm = A * exp(-eta*eta*rMag*rMag);
+				double h1 = -(erfcTerm + expTerm)/rMag; //first derivative of erfc(eta r)/r
+				double h2 = 2.*erfcTerm/(rMag*rMag) + expTerm*(2./(rMag*rMag) + 2.*eta*eta); //second derivative
+				vector3<> rHat = r * (1./rMag);
+				matrix3<> h = (h2 - h1/rMag) * outer(rHat, rHat) + (h1/rMag) * matrix3<>(1,1,1);
+				accum(J, I, cis(2*M_PI*dot(q, iR)) * matrix3<complex>(h));
+			}
+		}
+	//Reciprocal space sum (over K = G + q, using the inversion symmetry of the kernel):
+	vector3<int> iG;
+	for(iG[0]=-Nrecip[0]; iG[0]<=Nrecip[0]; iG[0]++)
+	for(iG[1]=-Nrecip[1]; iG[1]<=Nrecip[1]; iG[1]++)
+	for(iG[2]=-Nrecip[2]; iG[2]<=Nrecip[2]; iG[2]++)
+	{	vector3<> kG = q + iG;
+		vector3<> K = kG * gInfo.G;
+		double Ksq = K.length_squared();
+		if(Ksq < 1e-12 || Ksq > Gmax*Gmax) continue;
+		matrix3<> h = (-4*M_PI/gInfo.detR) * (exp(-0.25*Ksq/(eta*eta))/Ksq) * outer(K, K);
+		for(int J=0; J<nAtoms; J++)
+			for(int I=0; I<nAtoms; I++)
+				accum(J, I, cis(-2*M_PI*dot(kG, xAtoms[I]-xAtoms[J])) * matrix3<complex>(h));
+	}
+	//Remove self-interaction of the smooth part:
+	for(int J=0; J<nAtoms; J++)
+		accum(J, J, matrix3<complex>((4./3)*pow(eta,3)/sqrt(M_PI) * matrix3<>(1,1,1)));
+	return S;
+}
+
+
+void Phonon::dfptCheck() const
+{	if(e.eInfo.spinType != SpinNone)
+		die("\nLinear-response phonons (dfpt yes) currently require spin-unpolarized calculations.\n\n");
+	if(e.eInfo.fillingsUpdate != ElecInfo::FillingsConst)
+		die("\nLinear-response phonons (dfpt yes) currently require insulators (no smearing / fillings updates).\n\n");
+	if(e.eInfo.hasU)
+		die("\nLinear-response phonons (dfpt yes) do not yet support DFT+U.\n\n");
+	if(e.exCorr.exxFactor() || e.exCorr.needsKEdensity())
+		die("\nLinear-response phonons (dfpt yes) currently support only LDA and GGA functionals.\n\n");
+	if(e.eVars.fluidParams.fluidType != FluidNone)
+		die("\nLinear-response phonons (dfpt yes) do not yet support fluids.\n\n");
+	if(e.eVars.Vexternal.size() || e.eVars.rhoExternal)
+		die("\nLinear-response phonons (dfpt yes) do not yet support external potentials or charges.\n\n");
+	if(e.coulombParams.geometry != CoulombParams::Periodic)
+		die("\nLinear-response phonons (dfpt yes) currently require fully periodic Coulomb interactions.\n\n");
+	if(e.gInfoWfns)
+		die("\nLinear-response phonons (dfpt yes) require the wavefunction and density grids to be the same (EcutRho = 4 Ecut).\n\n");
+	if(e.iInfo.vdWenable || e.iInfo.ljOverride)
+		die("\nLinear-response phonons (dfpt yes) do not yet support pair-potential corrections.\n\n");
+	for(const auto& sp: e.iInfo.species)
+	{	if(sp->QintAll)
+			die("\nLinear-response phonons (dfpt yes) require norm-conserving pseudopotentials (species %s is ultrasoft).\n\n", sp->name.c_str());
+		if(sp->nCoreRadial || sp->tauCoreRadial)
+			die("\nLinear-response phonons (dfpt yes) do not yet support partial core corrections (species %s).\n\n", sp->name.c_str());
+		if(sp->Z_chargeball)
+			die("\nLinear-response phonons (dfpt yes) do not yet support chargeballs (species %s).\n\n", sp->name.c_str());
+	}
+}
+
+
+void Phonon::dfptClearProjectorCache() const
+{	//The cache is keyed by Basis pointer, so entries for the temporary bases below would accumulate and go stale:
+	for(const auto& sp: e.iInfo.species)
+	{	std::lock_guard<std::mutex> lock(sp->cacheLock);
+		sp->cachedV.clear();
+	}
+}
+
+
+void Phonon::processDFPT()
+{	static StopWatch watch("phonon::dfpt"); watch.start();
+	const Supercell& supercell = *(e.coulombParams.supercell);
+	const std::vector<vector3<>>& kmesh = supercell.kmesh;
+	const std::vector<SpaceGroupOp> sym = e.symm.getMatrices();
+	const int& nBands = e.eInfo.nBands;
+	int nModes = modes.size();
+	int nAtoms = nModes/3;
+	
+	//Occupied bands (fillings must be 0 or 1 for an insulator):
+	int nOcc = 0;
+	while(nOcc<nBands && e.eVars.F[0][nOcc] > 0.5) nOcc++;
+	double Emin = +DBL_MAX, Emax = -DBL_MAX;
+	for(int q=0; q<e.eInfo.nStates; q++)
+		for(int b=0; b<nBands; b++)
+		{	if(fabs(e.eVars.F[q][b] - (b<nOcc ? 1. : 0.)) > 1e-12)
+				die("\nLinear-response phonons require the same integer occupations at all k-points (insulator).\n\n");
+			if(b<nOcc)
+			{	Emin = std::min(Emin, e.eVars.Hsub_eigs[q][b]);
+				Emax = std::max(Emax, e.eVars.Hsub_eigs[q][b]);
+			}
+		}
+	if(!nOcc) die("\nNo occupied bands for linear-response phonons.\n\n");
+	double alphaPv = 2.*(Emax - Emin) + 1.; //shift occupied space above the valence band width
+	
+	//Species and atom properties:
+	std::vector<DfptSpecies> dspList(e.iInfo.species.size());
+	for(size_t iSp=0; iSp<dspList.size(); iSp++)
+	{	const SpeciesInfo& sp = *(e.iInfo.species[iSp]);
+		DfptSpecies& dsp = dspList[iSp];
+		dsp.sp = &sp;
+		dsp.iSp = iSp;
+		dsp.Z = sp.Z;
+		dsp.VlocRadial = &sp.VlocRadial;
+		dsp.M = sp.MnlAll;
+		dsp.nProj = sp.MnlAll.nRows();
+	}
+	std::vector<vector3<>> xAtoms(nAtoms); //lattice coordinates
+	std::vector<double> Zatoms(nAtoms);
+	for(int a=0; a<nAtoms; a++)
+	{	const Mode& mode = modes[3*a];
+		xAtoms[a] = e.iInfo.species[mode.sp]->atpos[mode.at];
+		Zatoms[a] = dspList[mode.sp].Z;
+	}
+	HxcKernel hxc(e);
+	
+	//Wavefunctions on the full k-mesh (occupied bands only), divided over processes:
+	logPrintf("\nSetting up linear-response phonon calculation with %d occupied bands on %d k-points ... ", nOcc, int(kmesh.size())); logFlush();
+	size_t ikStart, ikStop;
+	TaskDivision(kmesh.size(), mpiWorld).myRange(ikStart, ikStop);
+	double wk = e.eInfo.qWeightSum / kmesh.size();
+	std::vector<DfptKpoint> kpoints(ikStop-ikStart);
+	for(size_t ik=ikStart; ik<ikStop; ik++)
+	{	DfptKpoint& kp = kpoints[ik-ikStart];
+		kp.setup(e, kmesh[ik], supercell.kmeshTransform[ik], nOcc, wk, sym);
+		kp.prepare(e);
+	}
+	PeriodicLookup< vector3<> > plook(kmesh, e.gInfo.GGT);
+	logPrintf("done.\n"); logFlush();
+	
+	//Onsite (q-independent) second derivatives with density held fixed:
+	matrix Dfrozen = zeroes(nModes, nModes);
+	{	complex* Ddata = Dfrozen.data();
+		//--- nonlocal pseudopotential:
+		for(const DfptKpoint& kp: kpoints)
+			for(int a=0; a<nAtoms; a++)
+			{	const Mode& mode = modes[3*a];
+				const DfptSpecies& dsp = dspList[mode.sp];
+				if(!dsp.nProj) continue;
+				int p0 = mode.at*dsp.nProj, p1 = p0+dsp.nProj;
+				ColumnBundle V = dsp.sp->getV(kp.C)->getSub(p0, p1);
+				matrix MP = dsp.M * kp.VdagC[dsp.iSp](p0,p1, 0,nOcc);
+				matrix DP[3];
+				for(int iDir=0; iDir<3; iDir++)
+					DP[iDir] = kp.DVdagC[iDir][dsp.iSp](p0,p1, 0,nOcc);
+				for(int iDir=0; iDir<3; iDir++)
+					for(int jDir=0; jDir<3; jDir++)
+					{	matrix DDP = DD(V, iDir, jDir) ^ kp.C;
+						double hess = 2.*kp.qnum.weight * (trace(dagger(MP) * DDP) + trace(dagger(DP[iDir]) * dsp.M * DP[jDir])).real();
+						Ddata[Dfrozen.index(3*a+iDir, 3*a+jDir)] += hess;
+					}
+			}
+		mpiWorld->allReduceData(Dfrozen, MPIUtil::ReduceSum);
+		//--- local pseudopotential:
+		complexScalarFieldTilde nTilde = Complex(J(e.eVars.n[0]));
+		for(int a=0; a<nAtoms; a++)
+		{	matrix3<> hess = localEnergyHessian(e.gInfo, nTilde, dspList[modes[3*a].sp], xAtoms[a]);
+			for(int iDir=0; iDir<3; iDir++)
+				for(int jDir=0; jDir<3; jDir++)
+					Ddata[Dfrozen.index(3*a+iDir, 3*a+jDir)] += hess(iDir, jDir);
+		}
+		//--- ion-ion (Ewald) onsite term:
+		matrix S0 = ewaldHessianSum(e.gInfo, xAtoms, vector3<>());
+		for(int a=0; a<nAtoms; a++)
+			for(int b=0; b<nAtoms; b++)
+				for(int iDir=0; iDir<3; iDir++)
+					for(int jDir=0; jDir<3; jDir++)
+						Ddata[Dfrozen.index(3*a+iDir, 3*a+jDir)] += Zatoms[a] * Zatoms[b] * S0(3*a+iDir, 3*b+jDir);
+	}
+	dfptClearProjectorCache();
+	
+	//Map commensurate k-points (same order and convention as the supercell Gamma-point states):
+	stateMap.clear();
+	std::vector<vector3<>> kComm; //commensurate k-points in order
+	for(unsigned ik=0; ik<kmesh.size(); ik++)
+	{	double kSupErr; round(matrix3<>(Diag(sup)) * kmesh[ik], &kSupErr);
+		if(kSupErr < symmThreshold) //maps to supercell Gamma point
+		{	StateMapEntry sme;
+			(Supercell::KmeshTransform&)sme = supercell.kmeshTransform[ik]; //copy base class properties
+			sme.qSup = 0;
+			sme.nqPrev = stateMap.size();
+			sme.k = kmesh[ik];
+			stateMap.push_back(sme);
+			kComm.push_back(kmesh[ik]);
+		}
+	}
+	assert(int(stateMap.size()) == prodSup);
+	PeriodicLookup< vector3<> > plookComm(kComm, e.gInfo.GGT);
+	size_t ik2start, ik2stop;
+	TaskDivision(prodSup, mpiWorld).myRange(ik2start, ik2stop);
+	if(saveHsub)
+		for(int iMode=0; iMode<nModes; iMode++)
+			dHsub[iMode][0] = zeroes(nBands*prodSup, nBands*prodSup);
+	
+	//Linear response PulayParams:
+	PulayParams pp;
+	pp.fpLog = globalLog;
+	pp.linePrefix = "DFPT: ";
+	pp.energyLabel = "Dloc";
+	pp.energyDiffThreshold = 0.; //converge on residual alone
+	pp.residualThreshold = 1e-7;
+	pp.nIterations = 50;
+	pp.mixFraction = 0.5;
+	
+	//Reduce commensurate q using the unit cell space group and time reversal:
+	//(all q are needed explicitly for electron-phonon matrix elements)
+	std::vector<vector3<>> qList(prodSup);
+	for(int iq=0; iq<prodSup; iq++)
+	{	vector3<int> qCell = getCell(iq);
+		for(int j=0; j<3; j++) qList[iq][j] = qCell[j] / double(sup[j]);
+	}
+	struct QmapEntry { int iIrred, iSym; bool invert; }; //q * sym[iSym].rot = (invert ? -1 : +1) * irreducible q (modulo G)
+	std::vector<QmapEntry> qMap(prodSup);
+	std::vector<int> iqIrred;
+	for(int iq=0; iq<prodSup; iq++)
+	{	bool found = false;
+		if(!saveHsub)
+			for(int iIrred=0; iIrred<int(iqIrred.size()) && !found; iIrred++)
+				for(int iSym=0; iSym<int(sym.size()) && !found; iSym++)
+					for(int invert=0; invert<2 && !found; invert++)
+					{	vector3<> qIrred = qList[iqIrred[iIrred]] * (invert ? -1. : 1.);
+						if(circDistanceSquared(sym[iSym].applyRecip(qList[iq]), qIrred) < symmThresholdSq)
+						{	qMap[iq] = QmapEntry{ iIrred, iSym, bool(invert) };
+							found = true;
+						}
+					}
+		if(!found)
+		{	qMap[iq] = QmapEntry{ int(iqIrred.size()), 0, false }; //identity is the first symmetry
+			iqIrred.push_back(iq);
+		}
+	}
+	logPrintf("\n%d of %d commensurate q-points are irreducible.\n", int(iqIrred.size()), prodSup);
+	std::vector<int> atomOffset(e.iInfo.species.size()+1, 0); //index of first atom of each species in mode order
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		atomOffset[sp+1] = atomOffset[sp] + e.iInfo.species[sp]->atpos.size();
+	
+	//Loop over irreducible q:
+	std::vector<matrix> Dirred(iqIrred.size());
+	for(size_t iIrred=0; iIrred<iqIrred.size(); iIrred++)
+	{	int iq = iqIrred[iIrred];
+		const vector3<>& q = qList[iq];
+		logPrintf("\n########### Linear response at q-point %d of %d: [ %+.6lf %+.6lf %+.6lf ] #############\n",
+			int(iIrred)+1, int(iqIrred.size()), q[0], q[1], q[2]);
+		logFlush();
+		
+		//Occupied wavefunctions at k+q:
+		std::vector<DfptKpoint> kqpoints(kpoints.size());
+		for(size_t ik=ikStart; ik<ikStop; ik++)
+		{	vector3<> kq = kmesh[ik] + q;
+			size_t ikq = plook.find(kq);
+			assert(ikq != string::npos);
+			kqpoints[ik-ikStart].setup(e, kq, supercell.kmeshTransform[ikq], nOcc, wk, sym);
+		}
+		
+		//Self-consistent response to each mode:
+		std::vector<complexScalarFieldTilde> dVextLoc(nModes), dVscf(nModes), dn(nModes);
+		std::vector<std::vector<ColumnBundle>> dVnlC(nModes), dC(nModes);
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	const Mode& mode = modes[iMode];
+			const DfptSpecies& dsp = dspList[mode.sp];
+			int iDir = iMode % 3;
+			logPrintf("\n--- Perturbation %d of %d: %s %d [ %+lf %+lf %+lf ]\n", iMode+1, nModes,
+				dsp.sp->name.c_str(), mode.at, mode.dir[0], mode.dir[1], mode.dir[2]);
+			logFlush();
+			dVextLoc[iMode] = localPerturbation(e.gInfo, dsp, xAtoms[iMode/3], iDir, q);
+			dVnlC[iMode].resize(kpoints.size());
+			for(size_t ik=0; ik<kpoints.size(); ik++)
+				dVnlC[iMode][ik] = nonlocalPerturbation(dsp, mode.at, iDir, kpoints[ik], kqpoints[ik]);
+			PhononResponse response(e, pp, hxc, q, alphaPv, kpoints, kqpoints, dVextLoc[iMode], dVnlC[iMode]);
+			response.minimize();
+			dn[iMode] = response.dn;
+			dVscf[iMode] = dVextLoc[iMode] + response.dVhxc;
+			dC[iMode] = response.dC;
+		}
+		
+		//Force matrix at q: response part
+		matrix Dq = zeroes(nModes, nModes);
+		complex* Dqdata = Dq.data();
+		for(int iMode=0; iMode<nModes; iMode++)
+			for(int jMode=0; jMode<nModes; jMode++)
+				for(size_t ik=0; ik<kpoints.size(); ik++)
+					Dqdata[Dq.index(jMode,iMode)] += (2.*kpoints[ik].qnum.weight) * trace(dVnlC[jMode][ik] ^ dC[iMode][ik]);
+		mpiWorld->allReduceData(Dq, MPIUtil::ReduceSum);
+		for(int iMode=0; iMode<nModes; iMode++)
+			for(int jMode=0; jMode<nModes; jMode++)
+				Dqdata[Dq.index(jMode,iMode)] += e.gInfo.detR * ::dot(dVextLoc[jMode], dn[iMode]);
+		//--- frozen-density and ion-ion parts:
+		Dq += Dfrozen;
+		matrix Sq = ewaldHessianSum(e.gInfo, xAtoms, q);
+		for(int iMode=0; iMode<nModes; iMode++)
+			for(int jMode=0; jMode<nModes; jMode++)
+				Dqdata[Dq.index(jMode,iMode)] -= Zatoms[jMode/3] * Zatoms[iMode/3] * Sq(jMode,iMode);
+		Dirred[iIrred] = dagger_symmetrize(Dq);
+		
+		//Electron-phonon matrix elements <k2+q| dV |k2> for commensurate k2:
+		if(saveHsub)
+		{	for(size_t ik2=ik2start; ik2<ik2stop; ik2++)
+			{	DfptKpoint k2, k1;
+				const StateMapEntry& sme2 = stateMap[ik2];
+				k2.setup(e, sme2.k, sme2, nBands, wk, sym);
+				k2.project(e);
+				vector3<> k1vec = sme2.k + q;
+				size_t ik1 = plookComm.find(k1vec);
+				assert(ik1 != string::npos);
+				k1.setup(e, k1vec, stateMap[ik1], nBands, wk, sym);
+				for(int iMode=0; iMode<nModes; iMode++)
+				{	const Mode& mode = modes[iMode];
+					ColumnBundle Y = nonlocalPerturbation(dspList[mode.sp], mode.at, iMode%3, k2, k1);
+					applyLocal(e.gInfo.dV * I(dVscf[iMode]), k2.C, Y);
+					dHsub[iMode][0].set(ik1*nBands,(ik1+1)*nBands, ik2*nBands,(ik2+1)*nBands, (1./prodSup) * (k1.C ^ Y));
+				}
+				dfptClearProjectorCache();
+			}
+		}
+		dfptClearProjectorCache();
+	}
+	
+	//Accumulate force matrices at all commensurate q onto supercell force matrix:
+	const auto& symAtomMap = e.symm.getAtomMap();
+	for(int iq=0; iq<prodSup; iq++)
+	{	const vector3<>& q = qList[iq];
+		const QmapEntry& qme = qMap[iq];
+		std::vector<int> atomMap(nAtoms);
+		for(int a=0; a<nAtoms; a++)
+		{	const Mode& mode = modes[3*a];
+			atomMap[a] = atomOffset[mode.sp] + symAtomMap[mode.sp][mode.at][qme.iSym];
+		}
+		matrix Dq = rotateForceMatrix(Dirred[qme.iIrred], q, sym[qme.iSym], qme.invert, e.gInfo, xAtoms, atomMap);
+		for(int iMode=0; iMode<nModes; iMode++)
+			for(int jMode=0; jMode<nModes; jMode++)
+			{	const Mode& mode2 = modes[jMode];
+				int nAtoms2 = e.iInfo.species[mode2.sp]->atpos.size();
+				for(int unit=0; unit<prodSup; unit++)
+				{	vector3<int> cell = getCell(unit);
+					double phase = 2*M_PI*(q[0]*cell[0] + q[1]*cell[1] + q[2]*cell[2]);
+					double F = (Dq(jMode,iMode) * cis(phase)).real() / prodSup;
+					dgrad[iMode][mode2.sp][mode2.at + nAtoms2*unit] += F * mode2.dir;
+				}
+			}
+	}
+	if(saveHsub)
+		for(int iMode=0; iMode<nModes; iMode++)
+			mpiWorld->allReduceData(dHsub[iMode][0], MPIUtil::ReduceSum);
+	logPrintf("\n");
+	watch.stop();
+}
@@ -28,7 +28,7 @@ PhononEverything::PhononEverything(Phonon& phonon) : phonon(phonon)
 }
 
 Phonon::Phonon()
-: dr(0.1), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), saveHsub(true), e(*this), eSupTemplate(*this)
+: dr(0.1), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), saveHsub(true), dfpt(false), e(*this), eSupTemplate(*this)
 {
 }
 
@@ -54,6 +54,8 @@ void Phonon::setup(bool printDefaults)
 	//Ensure phonon command specified:
 	if(!sup.length())
 		die("phonon supercell must be specified using the phonon command.\n");
+	if(e.cntrl.gammaOnly)
+		die("phonon does not support gamma-only mode, since the supercell has k-points other than Gamma.\n");
 	//Check kpoint and supercell compatibility:
 	if(e.eInfo.qnums.size()>1 || e.eInfo.qnums[0].k.length_squared())
 		die("phonon requires a Gamma-centered uniform kpoint mesh.\n");
@@ -73,6 +75,7 @@ void Phonon::setup(bool printDefaults)
 		e.iInfo.species[sp]->constraints.assign(e.iInfo.species[sp]->atpos.size(), constraintFull);
 	e.setup();
 	if(!e.coulombParams.supercell) e.updateSupercell(true); //force supercell generation
+	if(dfpt) dfptCheck();
 
 	nSpins = e.eInfo.nSpins();
 	nSpinor = e.eInfo.spinorLength();
@@ -284,6 +287,8 @@ void Phonon::setup(bool printDefaults)
 	if(iPerturbation>=int(perturbations.size()))
 		die("Specified iPerturbation %d in command phonon is invalid (since it is > %lu).\n", iPerturbation+1, perturbations.size());
 	
+	if(dfpt) return; //unitary rotations below are only needed to symmetrize supercell perturbations
+	
 	//Determine wavefunction unitary rotations:
 	logPrintf("\nCalculating unitary rotations of unit cell states under symmetries:\n");
 	stateRot.resize(nSpins);
@@ -30,6 +30,7 @@ enum PhononMember
  	PM_T,
 	PM_Fcut,
 	PM_rSmooth,
+	PM_dfpt,
 	PM_delim
 };
 
@@ -41,7 +42,8 @@ EnumStringMap<PhononMember> phononMemberMap
 	PM_saveHsub, "saveHsub",
 	PM_T, "T",
 	PM_Fcut, "Fcut",
-	PM_rSmooth, "rSmooth"
+	PM_rSmooth, "rSmooth",
+	PM_dfpt, "dfpt"
 );
 
 struct CommandPhonon : public Command
@@ -78,7 +80,14 @@ struct CommandPhonon : public Command
 			"   are desired; this flag ensures that those extra bands do not affect the\n"
 			"   performance or memory requirements of the supercell calculations.\n"
 			"\n+ rSmooth <rSmooth>\n\n"
-			"   Width in bohrs of the supercell boundary region over which matrix elements are smoothed.";
+			"   Width in bohrs of the supercell boundary region over which matrix elements are smoothed.\n"
+			"\n+ dfpt yes|no\n\n"
+			"   Whether to compute the force matrix and electron-phonon matrix elements using\n"
+			"   density-functional perturbation theory (linear response in the unit cell at each\n"
+			"   q commensurate with the supercell) instead of perturbed supercell calculations.\n"
+			"   Currently supports spin-unpolarized insulators with norm-conserving pseudopotentials\n"
+			"   (without partial core corrections), LDA/GGA functionals and periodic Coulomb interactions.\n"
+			"   Default: no.";
 		
 		forbid("fix-electron-density");
 		forbid("fix-electron-potential");
@@ -108,11 +117,15 @@ struct CommandPhonon : public Command
 						throw string("perturbation number must be positive");
 					if(phonon.collectPerturbations)
 						throw string("cannot use iPerturbation in the same calculation as collectPerturbations");
+					if(phonon.dfpt)
+						throw string("cannot use iPerturbation in the same calculation as dfpt");
 					break;
 				case PM_collectPerturbations:
 					phonon.collectPerturbations = true;
 					if(phonon.iPerturbation>=0)
 						throw string("cannot use iPerturbation in the same calculation as collectPerturbations");
+					if(phonon.dfpt)
+						throw string("cannot use collectPerturbations in the same calculation as dfpt");
 					break;
 				case PM_saveHsub:
 					pl.get(phonon.saveHsub, true, boolMap, "saveHsub", true);
@@ -129,6 +142,11 @@ struct CommandPhonon : public Command
 					pl.get(phonon.rSmooth, 1., "rSmooth", true);
 					if(phonon.rSmooth <= 0.) throw string("<rSmooth> must be positive");
 					break;
+				case PM_dfpt:
+					pl.get(phonon.dfpt, false, boolMap, "dfpt", true);
+					if(phonon.dfpt && (phonon.iPerturbation>=0 || phonon.collectPerturbations))
+						throw string("cannot use dfpt in the same calculation as iPerturbation or collectPerturbations");
+					break;
 				case PM_delim: //should never be encountered
 					break;
 			}
@@ -145,6 +163,7 @@ struct CommandPhonon : public Command
 		logPrintf(" \\\n\tT %lg", phonon.T/Kelvin);
 		logPrintf(" \\\n\tFcut %lg", phonon.Fcut);
 		logPrintf(" \\\n\trSmooth %lg", phonon.rSmooth);
+		logPrintf(" \\\n\tdfpt %s", boolMap.getString(phonon.dfpt));
 	}
 }
 commandPhonon;
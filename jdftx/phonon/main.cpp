@@ -30,6 +30,8 @@ int main(int argc, char** argv)
 	Phonon phonon;
 	InitParams ip("Compute phonon band-structures and e-ph matrix elements.", &phonon.e);
 	initSystemCmdline(argc, argv, ip);
+	if(mpiGroup->nProcesses() > 1)
+		die("%s does not support band-parallel process groups: use one process per group (-G).\n", "phonon");
 
 	phonon.input = readInputFile(ip.inputFilename);
 	phonon.dryRun = ip.dryRun;
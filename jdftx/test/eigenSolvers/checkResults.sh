@@ -0,0 +1,12 @@
+#!/bin/bash
+
+echo "4"  #number of checks
+
+Edavidson="$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' Davidson.out)"
+od -An -v -t f8 -w8 Davidson.eigenvals > Davidson.eigenvals.txt
+for run in LOBPCG RMMDIIS; do
+	awk -v E0="$Edavidson" -v run="$run" '/IonicMinimize: Iter/ { E = $5 } END { print E, E0, "1e-7", run, "vs Davidson energy [Eh]" }' $run.out
+	#Maximum eigenvalue difference from Davidson (binary doubles in the same state / band order):
+	od -An -v -t f8 -w8 $run.eigenvals | paste Davidson.eigenvals.txt - \
+		| awk -v run="$run" '{ d = $2-$1; if(d<0) d=-d; if(d>dMax) dMax=d; n++ } END { print (n ? dMax : 1), "0 1e-6", run, "vs Davidson max eigenvalue difference [Eh]" }'
+done
@@ -0,0 +1,7 @@
+#!/bin/bash
+
+echo "1"  #number of checks
+
+#Multigrid warm start must converge to the same minimum as the direct fluid minimize:
+Edirect="$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' direct.out)"
+awk -v Edirect="$Edirect" '/IonicMinimize: Iter/ { E = $5 } END { print E, Edirect, "0.00001 Multigrid vs direct energy [Eh]" }' multigrid.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="direct multigrid"
+export nProcs="1"
@@ -0,0 +1,7 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+Edump="$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' Dump.out)"
+awk -v E0="$Edump" '/IonicMinimize: Iter/ { E = $5 } END { print E, E0, "1e-6 Gamma-only restart vs dumped energy [Eh]" }' Restart.out
+awk -v E0="$Edump" '/IonicMinimize: Iter/ { E = $5 } END { print E, E0, "1e-6 Full-sphere read vs dumped energy [Eh]" }' FullSphere.out
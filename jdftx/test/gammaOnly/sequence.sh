@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="Dump Restart FullSphere"
+export nProcs="1"
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+echo 9 #number of checks
+
+#Linear-response (DFPT) phonons compared to the frozen-phonon supercell calculation:
+paste <(awk '/omega:/ { print $NF }' dfpt.out) <(awk '/omega:/ { print $NF }' supercell.out) | awk '
+	{ printf("%f %f 10 Max frequency at q-point %d [inv-cm]\n", $1, $2, NR); }
+'
+paste <(awk '/ZPE:/ { print $2 }' dfpt.out) <(awk '/ZPE:/ { print $2 }' supercell.out) | awk '
+	{ printf("%f %f 5e-5 Zero-point energy [Eh]\n", $1, $2); }
+'
@@ -0,0 +1,4 @@
+#!/bin/bash
+export runs="totalE supercell dfpt"
+export programs="jdftx phonon phonon"
+export nProcs="4"
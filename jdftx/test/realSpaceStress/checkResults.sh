@@ -0,0 +1,10 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#Trace of the last stress tensor printed in each output file:
+stressTrace='/# Stress tensor/ { iRow = 1; tr = 0; next } iRow { tr += $(iRow+1); iRow = (iRow<3 ? iRow+1 : 0) } END { print tr }'
+trPlaneWave="$(awk "$stressTrace" PlaneWave.out)"
+EplaneWave="$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' PlaneWave.out)"
+awk -v E0="$EplaneWave" '/IonicMinimize: Iter/ { E = $5 } END { print E, E0, "1e-6 Real-space vs plane-wave projector energy [Eh]" }' RealSpace.out
+awk "$stressTrace" RealSpace.out | awk -v tr0="$trPlaneWave" '{ print $1, tr0, "1e-7 Real-space vs plane-wave projector stress trace [Eh/a0^3]" }'
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="PlaneWave RealSpace"
+export nProcs="1"
@@ -12,8 +12,10 @@ mkdir -p $testRunDir
 cd $testRunDir
 export SRCDIR="$testSrcDir"
 
-#Run JDFTx on all the runs that belong to this test (don't rerun tests which have succeeded)
+#Run JDFTx (or the executables listed in programs) on all the runs that belong to this test (don't rerun tests which have succeeded)
 source $testSrcDir/sequence.sh
+programList=($programs)
+iRun=0
 if [[ "$JDFTX_LAUNCH" == *'%d'* ]]; then
 	LAUNCH="$(printf "$JDFTX_LAUNCH" "$nProcs")"
 else
@@ -21,8 +23,10 @@ else
 fi
 echo "launch=\"$LAUNCH\""
 for run in $runs; do
+	program="${programList[$iRun]:-jdftx}"
+	iRun=$((iRun+1))
 	if [[ ! ( ( -f $run.out ) && ( "$(awk '/End date and time:/ {endLine=NR+1} NR==endLine {print}' $run.out)" == "Done!" ) ) ]]; then
-		$LAUNCH $jdftxBuildDir/jdftx$JDFTX_SUFFIX -i $testSrcDir/$run.in -d -o $run.out
+		$LAUNCH $jdftxBuildDir/$program$JDFTX_SUFFIX -i $testSrcDir/$run.in -d -o $run.out
 		if [ "$?" -ne "0" ]; then
 			echo "" > results
 			echo "FAILED: error running $run" > summary
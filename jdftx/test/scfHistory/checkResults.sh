@@ -0,0 +1,8 @@
+#!/bin/bash
+
+echo "3"  #number of checks
+
+awk '/SCF: Converged \(\|Residual\|</ { n++ } END { print n+0, "1 0 SCF converged to |Residual| < 1e-7 with SinglePrecision history" }' SinglePrecision.out
+awk '/SCF: Cycle:/ { for(i=1; i<NF; i++) if($i=="|Residual|:") R = $(i+1) } END { print R, "0 1e-7 Final SCF residual with SinglePrecision history" }' SinglePrecision.out
+EinMemory="$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' InMemory.out)"
+awk -v E0="$EinMemory" '/IonicMinimize: Iter/ { E = $5 } END { print E, E0, "1e-8 SinglePrecision vs InMemory history energy [Eh]" }' SinglePrecision.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="InMemory SinglePrecision"
+export nProcs="1"
@@ -30,6 +30,8 @@ int main(int argc, char** argv)
 	WannierEverything e;
 	InitParams ip("Compute maximally-localized Wannier functions.", &e);
 	initSystemCmdline(argc, argv, ip);
+	if(mpiGroup->nProcesses() > 1)
+		die("%s does not support band-parallel process groups: use one process per group (-G).\n", "wannier");
 
 	//Parse input file:
 	parse(readInputFile(ip.inputFilename), e, ip.printDefaults);
@@ -0,0 +1,219 @@
+/*-------------------------------------------------------------------
+Copyright 2020 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/WannierInterpolator.h>
+#include <commands/parser.h>
+#include <core/Random.h>
+#include <core/Util.h>
+
+//Parameters read from input file
+struct InterpParams
+{	string wannierPattern; //!< filename pattern of wannier outputs
+	vector3<int> kfold; //!< k-point folding of the Wannierized calculation
+	string spinSuffix; //!< Up or Dn for z-spin calculations
+	double pruneThreshold; //!< relative threshold for dropping cells from Fourier sums
+	string phononPattern; //!< filename pattern of phonon outputs (e-ph mode only)
+	vector3<int> phononSup; //!< phonon supercell (e-ph mode only)
+	string kpointsFile; //!< k-points to interpolate to (if non-empty)
+	size_t nRandom; //!< number of random k-points (if kpointsFile is empty)
+	int seed; //!< random seed (offset by process index)
+	bool ephMode; //!< whether to output e-ph matrix elements
+	vector3<> k1; //!< fixed first k-point for e-ph matrix elements
+	size_t batchSize; //!< number of k-points processed together
+	string outputPattern; //!< filename pattern for outputs
+	
+	InterpParams() : pruneThreshold(0.), nRandom(0), seed(0), ephMode(false), batchSize(1024) {}
+	
+	void parse(const std::vector<std::pair<string,string>>& input)
+	{	for(const auto& cmd: input)
+		{	istringstream iss(cmd.second);
+			const string& name = cmd.first;
+			if(name == "wannier-pattern") iss >> wannierPattern;
+			else if(name == "kpoint-folding") iss >> kfold[0] >> kfold[1] >> kfold[2];
+			else if(name == "spin") iss >> spinSuffix;
+			else if(name == "prune-threshold") iss >> pruneThreshold;
+			else if(name == "phonon-pattern") iss >> phononPattern;
+			else if(name == "phonon-supercell") iss >> phononSup[0] >> phononSup[1] >> phononSup[2];
+			else if(name == "kpoints-file") iss >> kpointsFile;
+			else if(name == "kpoints-random") { iss >> nRandom; if(!iss.eof()) iss >> seed; }
+			else if(name == "eph-k1") { iss >> k1[0] >> k1[1] >> k1[2]; ephMode = true; }
+			else if(name == "batch-size") iss >> batchSize;
+			else if(name == "output-pattern") iss >> outputPattern;
+			else die("Unknown command '%s' in input.\n", name.c_str());
+			if(iss.fail()) die("Invalid arguments '%s' to command '%s'.\n", cmd.second.c_str(), name.c_str());
+			logPrintf("%s %s\n", name.c_str(), cmd.second.c_str());
+		}
+		logPrintf("\n");
+		//Check parameters:
+		if(!wannierPattern.length()) die("Command wannier-pattern is required.\n");
+		if(kfold[0]<=0 || kfold[1]<=0 || kfold[2]<=0) die("Command kpoint-folding is required, with positive entries.\n");
+		if(spinSuffix.length() && spinSuffix!="Up" && spinSuffix!="Dn") die("Argument to spin must be Up or Dn.\n");
+		if(!outputPattern.length() || outputPattern.find("$VAR")==string::npos) die("Command output-pattern (containing $VAR) is required.\n");
+		if(bool(kpointsFile.length()) == (nRandom>0)) die("Specify exactly one of kpoints-file or kpoints-random.\n");
+		if(ephMode)
+		{	if(!phononPattern.length()) die("Command phonon-pattern is required for eph-k1.\n");
+			if(phononSup[0]<=0 || phononSup[1]<=0 || phononSup[2]<=0) die("Command phonon-supercell is required for eph-k1.\n");
+		}
+		if(!batchSize) die("batch-size must be positive.\n");
+	}
+	
+	string getFilename(string varName) const
+	{	string fname = outputPattern;
+		fname.replace(fname.find("$VAR"), 4, varName);
+		return fname;
+	}
+};
+
+//Read k-points in reciprocal lattice coordinates, one per line
+std::vector<vector3<>> readKpoints(string fname)
+{	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp) die("Could not open '%s' for reading.\n", fname.c_str());
+	std::vector<vector3<>> k;
+	char buf[256];
+	while(fgets(buf, sizeof(buf), fp))
+	{	if(buf[0] == '#') continue;
+		vector3<> kCur;
+		if(sscanf(buf, "%lg %lg %lg", &kCur[0], &kCur[1], &kCur[2]) == 3)
+			k.push_back(kCur);
+	}
+	fclose(fp);
+	return k;
+}
+
+//Binary output of fixed-size rows per k-point, with each process writing its range of k-points at the corresponding offset
+class RowWriter
+{	MPIUtil::File fp;
+public:
+	RowWriter(string fname, size_t rowLength, size_t ikStart)
+	{	logPrintf("Writing '%s' with %lu doubles per k-point.\n", fname.c_str(), rowLength);
+		mpiWorld->fopenWrite(fp, fname.c_str());
+		mpiWorld->fseek(fp, ikStart*rowLength*sizeof(double), SEEK_SET);
+	}
+	~RowWriter() { mpiWorld->fclose(fp); }
+	void write(const std::vector<double>& data) { mpiWorld->fwrite(data.data(), sizeof(double), data.size(), fp); }
+};
+
+//Interpolate to k-points selected by params, distributed over processes, and write outputs
+void interpolate(const InterpParams& params, const WannierInterpolator& wi)
+{//Divide k-points over processes:
+	std::vector<vector3<>> kAll;
+	size_t nk = params.nRandom;
+	if(params.kpointsFile.length())
+	{	kAll = readKpoints(params.kpointsFile);
+		nk = kAll.size();
+	}
+	size_t ikStart, ikStop;
+	TaskDivision(nk, mpiWorld).myRange(ikStart, ikStop);
+	if(!params.kpointsFile.length()) Random::seed(params.seed + mpiWorld->iProcess());
+	logPrintf("\nInterpolating to %lu k-points in batches of %lu.\n", nk, params.batchSize);
+	
+	//Open outputs:
+	int nB = wi.nBands(), nM = wi.nModes();
+	RowWriter kpointsOut(params.getFilename("kpoints"), 3, ikStart);
+	RowWriter eigsOut(params.getFilename("eigenvals"), nB, ikStart);
+	std::shared_ptr<RowWriter> velocitiesOut, omegaPhOut, ephSqOut;
+	if(wi.hasMomenta()) velocitiesOut = std::make_shared<RowWriter>(params.getFilename("velocities"), 3*nB, ikStart);
+	if(params.ephMode)
+	{	omegaPhOut = std::make_shared<RowWriter>(params.getFilename("omegaPh"), nM, ikStart);
+		ephSqOut = std::make_shared<RowWriter>(params.getFilename("ephSq"), nM*nB*nB, ikStart);
+	}
+	
+	//Process batches:
+	size_t nkMine = ikStop - ikStart;
+	size_t nBatches = ceildiv(nkMine, params.batchSize);
+	size_t batchInterval = std::max(size_t(1), size_t(round(nBatches/20.))); //interval for reporting progress
+	for(size_t iBatch=0; iBatch<nBatches; iBatch++)
+	{	//Get k-points:
+		size_t ikBatchStart = ikStart + iBatch*params.batchSize;
+		size_t ikBatchStop = std::min(ikBatchStart + params.batchSize, ikStop);
+		std::vector<vector3<>> k;
+		std::vector<double> buf;
+		for(size_t ik=ikBatchStart; ik<ikBatchStop; ik++)
+		{	vector3<> kCur;
+			if(kAll.size()) kCur = kAll[ik];
+			else for(int j=0; j<3; j++) kCur[j] = Random::uniform();
+			k.push_back(kCur);
+			buf.insert(buf.end(), &kCur[0], &kCur[0]+3);
+		}
+		kpointsOut.write(buf);
+		
+		//Energies and velocities:
+		std::vector<diagMatrix> E;
+		std::vector<std::vector<vector3<>>> v;
+		wi.eigen(k, E, 0, velocitiesOut ? &v : 0);
+		buf.clear();
+		for(const diagMatrix& Ek: E) buf.insert(buf.end(), Ek.begin(), Ek.end());
+		eigsOut.write(buf);
+		if(velocitiesOut)
+		{	buf.clear();
+			for(const std::vector<vector3<>>& vk: v)
+				for(const vector3<>& vkb: vk)
+					buf.insert(buf.end(), &vkb[0], &vkb[0]+3);
+			velocitiesOut->write(buf);
+		}
+		
+		//E-ph matrix elements:
+		if(params.ephMode)
+		{	std::vector<std::vector<matrix>> g;
+			std::vector<diagMatrix> omegaPh;
+			wi.eph(params.k1, k, g, &omegaPh);
+			buf.clear();
+			for(const diagMatrix& omegaPhk: omegaPh) buf.insert(buf.end(), omegaPhk.begin(), omegaPhk.end());
+			omegaPhOut->write(buf);
+			buf.clear();
+			for(const std::vector<matrix>& gk: g)
+				for(const matrix& gkMode: gk)
+				{	const complex* gData = gkMode.data();
+					for(int i=0; i<nB*nB; i++)
+						buf.push_back(gData[i].norm());
+				}
+			ephSqOut->write(buf);
+		}
+		
+		//Report progress:
+		if((iBatch+1) % batchInterval == 0)
+		{	logPrintf("%d%% ", int(round((iBatch+1)*100./nBatches)));
+			logFlush();
+		}
+	}
+	logPrintf("done.\n");
+}
+
+//Program entry point
+int main(int argc, char** argv)
+{	//Parse command line, initialize system and logs:
+	InitParams ip("Interpolate Wannier Hamiltonians, velocities and e-ph matrix elements to dense k-point sets.");
+	initSystemCmdline(argc, argv, ip);
+	InterpParams params;
+	params.parse(readInputFile(ip.inputFilename));
+	
+	//Load interpolator:
+	WannierInterpolator wi(params.wannierPattern, params.kfold, params.spinSuffix, params.pruneThreshold);
+	if(params.ephMode) wi.loadPhonon(params.phononPattern, params.phononSup);
+	if(ip.dryRun)
+	{	logPrintf("Dry run successful: commands are valid and initialization succeeded.\n");
+		finalizeSystem();
+		return 0;
+	}
+	
+	interpolate(params, wi);
+	
+	finalizeSystem();
+	return 0;
+}